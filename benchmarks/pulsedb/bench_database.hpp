@@ -0,0 +1,41 @@
+/**
+ * @file benchmarks/pulsedb/bench_database.hpp
+ * @brief The database file shared by the I/O benchmarks.
+ */
+
+#ifndef PULSEDB_BENCHMARKS_BENCH_DATABASE_HPP
+#define PULSEDB_BENCHMARKS_BENCH_DATABASE_HPP
+
+#include "pulsedb/cache/buffer_pool.hpp"
+#include "pulsedb/storage/disk_manager.hpp"
+#include <filesystem>
+
+namespace pulse::bench {
+  /** @brief Pages in the database, 64MB whatever the page size. */
+  inline constexpr uint32_t PAGE_COUNT = (64u << 20) / storage::Page::PAGE_SIZE;
+
+  /**
+   * @brief Get the benchmark database, creating it on first use.
+   * @return Path to a database of PAGE_COUNT empty data pages.
+   * @note The file isn't opened with direct I/O, so reads of it are mostly page cache hits.
+   */
+  inline const std::filesystem::path &database() {
+    static const std::filesystem::path path = [] {
+      auto path = std::filesystem::temp_directory_path() / "pulsedb-bench.db";
+
+      storage::DiskManager disk(path, true);
+      cache::BufferPool pool(disk, 256);
+      for (uint32_t i = 0; i < PAGE_COUNT; i++) {
+        auto *page = pool.createPage(storage::PageType::DATA);
+        pool.unpinPage(page->id(), true);
+      }
+
+      pool.flushAll();
+      return path;
+    }();
+
+    return path;
+  }
+} // namespace pulse::bench
+
+#endif // PULSEDB_BENCHMARKS_BENCH_DATABASE_HPP
@@ -0,0 +1,182 @@
+/**
+ * @file benchmarks/pulsedb/cache/bench_buffer_pool.cpp
+ * @brief Benchmarks for BufferPool class.
+ */
+
+#include "../bench_database.hpp"
+#include "pulsedb/cache/buffer_pool.hpp"
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace pulse::storage;
+using namespace pulse::cache;
+using pulse::bench::PAGE_COUNT;
+
+namespace {
+  /**
+   * @enum Workload
+   * @brief Which pages the threads fetch.
+   */
+  enum class Workload {
+    UNIFORM, /**< Every page equally likely. */
+    ZIPFIAN, /**< Skewed, a few pages take most fetches. */
+    SCAN     /**< Sequential, every thread from its own starting page. */
+  };
+
+  /**
+   * @class Zipfian
+   * @brief Zipfian distribution over 0 to n - 1, low values the most likely.
+   * @note Gray et al.'s generator, as used by YCSB.
+   */
+  class Zipfian {
+  public:
+    /**
+     * @brief Constructs a generator, summing the zeta constant once.
+     */
+    Zipfian(uint32_t n, double theta) : n(n), theta(theta), zetan(zeta(n, theta)) {
+      alpha = 1.0 / (1.0 - theta);
+      eta = (1.0 - std::pow(2.0 / n, 1.0 - theta)) / (1.0 - zeta(2, theta) / zetan);
+    }
+
+    /**
+     * @brief Draw a value.
+     */
+    uint32_t operator()(std::mt19937 &rng) {
+      const double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+      const double uz = u * zetan;
+
+      if (uz < 1.0) {
+        return 0;
+      }
+
+      if (uz < 1.0 + std::pow(0.5, theta)) {
+        return 1;
+      }
+
+      const auto value = static_cast<uint32_t>(n * std::pow(eta * u - eta + 1.0, alpha));
+      return std::min(value, n - 1);
+    }
+
+  private:
+    /**
+     * @brief Sum 1 / i^theta for i from 1 to n.
+     */
+    static double zeta(uint32_t n, double theta) {
+      double sum = 0.0;
+      for (uint32_t i = 1; i <= n; i++) {
+        sum += 1.0 / std::pow(i, theta);
+      }
+
+      return sum;
+    }
+
+    uint32_t n;   /**< Number of values. */
+    double theta; /**< Skew, YCSB uses 0.99. */
+    double zetan; /**< Zeta of n. */
+    double alpha; /**< 1 / (1 - theta). */
+    double eta;   /**< Scaling of the tail. */
+  };
+
+  /**
+   * @brief Build the page IDs a thread fetches, so the loop times only the pool.
+   */
+  std::vector<uint32_t> trace(Workload workload, int thread, int threads) {
+    std::vector<uint32_t> pageIds(1 << 16);
+    std::mt19937 rng(thread);
+
+    switch (workload) {
+      case Workload::UNIFORM: {
+        std::uniform_int_distribution<uint32_t> pick(0, PAGE_COUNT - 1);
+        for (uint32_t &pageId : pageIds) {
+          pageId = pick(rng);
+        }
+
+        break;
+      }
+
+      case Workload::ZIPFIAN: {
+        Zipfian pick(PAGE_COUNT, 0.99);
+        for (uint32_t &pageId : pageIds) {
+          pageId = pick(rng);
+        }
+
+        break;
+      }
+
+      case Workload::SCAN: {
+        const uint32_t start = static_cast<uint64_t>(PAGE_COUNT) * thread / threads;
+        for (size_t i = 0; i < pageIds.size(); i++) {
+          pageIds[i] = (start + i) % PAGE_COUNT;
+        }
+
+        break;
+      }
+    }
+
+    return pageIds;
+  }
+
+  std::unique_ptr<DiskManager> disk; /**< Disk manager of the pool being measured. */
+  std::unique_ptr<BufferPool> pool;  /**< The pool every thread of a run fetches from. */
+  PoolStats warm;                    /**< Counters of the pool once it was warmed up. */
+} // namespace
+
+static void BM_BufferPoolFetch(benchmark::State &state, Workload workload) {
+  if (state.thread_index() == 0) {
+    // Shards keep enough frames that every thread can hold a pin in the same one.
+    const auto frames = static_cast<uint32_t>(PAGE_COUNT * state.range(0) / 100);
+    disk = std::make_unique<DiskManager>(pulse::bench::database());
+    pool = std::make_unique<BufferPool>(*disk, frames, std::clamp<size_t>(frames / 128, 1, 16));
+
+    // Start from a full pool, holding the pages the skewed workload favours.
+    for (uint32_t pageId = 0; pageId < frames; pageId++) {
+      if (pool->fetchPage(pageId)) {
+        pool->unpinPage(pageId, false);
+      }
+    }
+
+    warm = pool->stats();
+  }
+
+  const std::vector<uint32_t> pageIds = trace(workload, state.thread_index(), state.threads());
+  size_t next = 0;
+
+  for (auto _ : state) {
+    const uint32_t pageId = pageIds[next++ & (pageIds.size() - 1)];
+    if (!pool->fetchPage(pageId)) {
+      state.SkipWithError("failed to fetch a page");
+      break;
+    }
+
+    pool->unpinPage(pageId, false);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  if (state.thread_index() == 0) {
+    const PoolStats stats = pool->stats();
+    const uint64_t hits = stats.hits - warm.hits;
+    const uint64_t misses = stats.misses - warm.misses;
+
+    const uint64_t fetches = std::max<uint64_t>(hits + misses, 1);
+    state.counters["hit_ratio"] = static_cast<double>(hits) / static_cast<double>(fetches);
+
+    pool.reset();
+    disk.reset();
+  }
+}
+
+/**
+ * @brief Run a pool benchmark at 10, 50 and 100 percent of the database, on 1 to 64 threads.
+ */
+static void poolSizes(benchmark::internal::Benchmark *benchmark) {
+  benchmark->ArgName("pool_percent")->Arg(10)->Arg(50)->Arg(100);
+  benchmark->ThreadRange(1, 64)->UseRealTime();
+}
+
+BENCHMARK_CAPTURE(BM_BufferPoolFetch, uniform, Workload::UNIFORM)->Apply(poolSizes);
+BENCHMARK_CAPTURE(BM_BufferPoolFetch, zipfian, Workload::ZIPFIAN)->Apply(poolSizes);
+BENCHMARK_CAPTURE(BM_BufferPoolFetch, scan, Workload::SCAN)->Apply(poolSizes);
@@ -0,0 +1,70 @@
+/**
+ * @file benchmarks/pulsedb/cache/bench_lru_replacer.cpp
+ * @brief Benchmarks for LRUReplacer class.
+ */
+
+#include "pulsedb/cache/policies/lru_replacer.hpp"
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace pulse::cache;
+
+namespace {
+  std::unique_ptr<LRUReplacer> shared; /**< The replacer every thread of a run churns. */
+} // namespace
+
+static void BM_LRUReplacerChurn(benchmark::State &state) {
+  const auto frames = static_cast<size_t>(state.range(0));
+  if (state.thread_index() == 0) {
+    shared = std::make_unique<LRUReplacer>();
+    for (size_t frameId = 0; frameId < frames; frameId++) {
+      shared->unpin(frameId);
+    }
+  }
+
+  // Frames are picked ahead of time, so the loop times only the replacer.
+  std::mt19937 rng(state.thread_index());
+  std::uniform_int_distribution<size_t> pick(0, frames - 1);
+  std::vector<size_t> frameIds(4096);
+  for (size_t &frameId : frameIds) {
+    frameId = pick(rng);
+  }
+
+  size_t next = 0;
+  for (auto _ : state) {
+    // A hit pins the frame, then unpinning it makes it the most recently used.
+    const size_t frameId = frameIds[next++ & (frameIds.size() - 1)];
+    shared->pin(frameId);
+    shared->unpin(frameId);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  if (state.thread_index() == 0) {
+    shared.reset();
+  }
+}
+BENCHMARK(BM_LRUReplacerChurn)
+    ->ArgName("frames")
+    ->Arg(1024)
+    ->Arg(65536)
+    ->ThreadRange(1, 64)
+    ->UseRealTime();
+
+static void BM_LRUReplacerVictim(benchmark::State &state) {
+  const auto frames = static_cast<size_t>(state.range(0));
+  LRUReplacer replacer;
+  for (size_t frameId = 0; frameId < frames; frameId++) {
+    replacer.unpin(frameId);
+  }
+
+  for (auto _ : state) {
+    // Evict the least recently used frame and hand it straight back, as a miss does.
+    const auto victimId = replacer.victim();
+    replacer.unpin(*victimId);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LRUReplacerVictim)->ArgName("frames")->Arg(1024)->Arg(65536);
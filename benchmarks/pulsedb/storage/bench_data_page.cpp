@@ -0,0 +1,107 @@
+/**
+ * @file benchmarks/pulsedb/storage/bench_data_page.cpp
+ * @brief Benchmarks for DataPage class.
+ */
+
+#include "pulsedb/storage/data_page.hpp"
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace pulse::storage;
+
+namespace {
+  /**
+   * @brief Get the keys 0 to count - 1 in random order.
+   */
+  std::vector<uint32_t> shuffledKeys(uint32_t count) {
+    std::vector<uint32_t> keys(count);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+
+    return keys;
+  }
+
+  /**
+   * @brief Fill a page with records of one length.
+   * @return The keys inserted.
+   */
+  std::vector<uint32_t> fill(DataPage &page, const std::string &record) {
+    std::vector<uint32_t> keys;
+    for (uint32_t key : shuffledKeys(Page::PAGE_SIZE)) {
+      if (!page.insertRecord(key, record.data(), record.size(), 1)) {
+        break;
+      }
+
+      keys.push_back(key);
+    }
+
+    return keys;
+  }
+} // namespace
+
+static void BM_DataPageInsertRecord(benchmark::State &state) {
+  const std::string record(state.range(0), 'x');
+  const std::vector<uint32_t> keys = shuffledKeys(Page::PAGE_SIZE);
+
+  std::vector<uint8_t> buffer(Page::PAGE_SIZE);
+  DataPage page(buffer.data(), 1);
+  size_t next = 0;
+
+  for (auto _ : state) {
+    // Every iteration is one insert, a full page is swapped for an empty one untimed.
+    if (!page.insertRecord(keys[next], record.data(), record.size(), 1)) {
+      state.PauseTiming();
+      page = DataPage(buffer.data(), 1);
+      next = 0;
+      state.ResumeTiming();
+
+      benchmark::DoNotOptimize(page.insertRecord(keys[next], record.data(), record.size(), 1));
+    }
+
+    next++;
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DataPageInsertRecord)->ArgName("length")->Arg(16)->Arg(128)->Arg(1024);
+
+static void BM_DataPageGetSlotId(benchmark::State &state) {
+  DataPage page(1);
+  std::vector<uint32_t> keys = fill(page, std::string(state.range(0), 'x'));
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+
+  size_t next = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(page.getSlotId(keys[next]));
+    next = next + 1 < keys.size() ? next + 1 : 0;
+  }
+
+  state.counters["records"] = static_cast<double>(keys.size());
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DataPageGetSlotId)->ArgName("length")->Arg(16)->Arg(128);
+
+static void BM_DataPageCompact(benchmark::State &state) {
+  // A full page with every other record deleted, so half the record space is dead.
+  DataPage fragmented(1);
+  const std::vector<uint32_t> keys = fill(fragmented, std::string(state.range(0), 'x'));
+  for (size_t i = 0; i < keys.size(); i += 2) {
+    fragmented.deleteRecord(*fragmented.getSlotId(keys[i]));
+  }
+
+  DataPage page(1);
+  for (auto _ : state) {
+    // Restoring the image is a page copy, far below the cost of compacting it.
+    page.copyFrom(fragmented);
+    benchmark::DoNotOptimize(page.compact());
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * Page::PAGE_SIZE);
+}
+BENCHMARK(BM_DataPageCompact)->ArgName("length")->Arg(16)->Arg(128)->Arg(1024);
@@ -0,0 +1,81 @@
+/**
+ * @file benchmarks/pulsedb/storage/bench_disk_manager.cpp
+ * @brief Benchmarks for DiskManager class.
+ */
+
+#include "../bench_database.hpp"
+#include "pulsedb/cache/frame_arena.hpp"
+#include "pulsedb/storage/data_page.hpp"
+#include "pulsedb/storage/disk_manager.hpp"
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+using namespace pulse::storage;
+using pulse::bench::PAGE_COUNT;
+
+namespace {
+  /**
+   * @brief Get the page IDs to access, in file order or at random.
+   */
+  std::vector<uint32_t> pageOrder(bool random) {
+    std::vector<uint32_t> pageIds(PAGE_COUNT);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<uint32_t> pick(0, PAGE_COUNT - 1);
+
+    for (uint32_t i = 0; i < PAGE_COUNT; i++) {
+      pageIds[i] = random ? pick(rng) : i;
+    }
+
+    return pageIds;
+  }
+} // namespace
+
+static void BM_DiskManagerRead(benchmark::State &state) {
+  DiskManager disk(pulse::bench::database());
+  const std::vector<uint32_t> pageIds = pageOrder(state.range(0) != 0);
+
+  // Read into one arena slot, as the pool reads into a frame.
+  pulse::cache::FrameArena arena(1);
+  size_t next = 0;
+
+  for (auto _ : state) {
+    if (!disk.readPageAsync(pageIds[next], arena.slot(0)).get()) {
+      state.SkipWithError("failed to read a page");
+      break;
+    }
+
+    next = next + 1 < pageIds.size() ? next + 1 : 0;
+  }
+
+  const DiskStats stats = disk.stats();
+  state.counters["read_p99_us"] = static_cast<double>(stats.readLatency.percentile(0.99)) / 1e3;
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * Page::PAGE_SIZE);
+}
+BENCHMARK(BM_DiskManagerRead)->ArgName("random")->Arg(0)->Arg(1);
+
+static void BM_DiskManagerWrite(benchmark::State &state) {
+  DiskManager disk(pulse::bench::database());
+  const std::vector<uint32_t> pageIds = pageOrder(state.range(0) != 0);
+
+  // Pages are rebuilt in one arena slot, formatting is cheap next to the write.
+  pulse::cache::FrameArena arena(1);
+  size_t next = 0;
+
+  for (auto _ : state) {
+    const DataPage page(arena.slot(0), pageIds[next]);
+    if (!disk.flushPage(page)) {
+      state.SkipWithError("failed to write a page");
+      break;
+    }
+
+    next = next + 1 < pageIds.size() ? next + 1 : 0;
+  }
+
+  const DiskStats stats = disk.stats();
+  state.counters["write_p99_us"] = static_cast<double>(stats.writeLatency.percentile(0.99)) / 1e3;
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * Page::PAGE_SIZE);
+}
+BENCHMARK(BM_DiskManagerWrite)->ArgName("random")->Arg(0)->Arg(1);
@@ -0,0 +1,105 @@
+/**
+ * @file benchmarks/pulsedb/storage/bench_index_page.cpp
+ * @brief Benchmarks for IndexPage class.
+ */
+
+#include "pulsedb/storage/index_page.hpp"
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace pulse::storage;
+
+namespace {
+  /**
+   * @brief Get the keys 0 to count - 1, spaced by a stride, in random order.
+   */
+  std::vector<uint64_t> shuffledKeys(size_t count, uint64_t stride) {
+    std::vector<uint64_t> keys(count);
+    for (size_t i = 0; i < count; i++) {
+      keys[i] = i * stride;
+    }
+
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+    return keys;
+  }
+
+  /**
+   * @brief Fill a leaf until it's full.
+   * @return The keys inserted.
+   */
+  std::vector<uint64_t> fill(IndexPage &page, uint64_t stride) {
+    std::vector<uint64_t> keys;
+    for (uint64_t key : shuffledKeys(IndexPage::maxEntries(), stride)) {
+      if (!page.insertKey(key, static_cast<uint32_t>(key / stride) + 1)) {
+        break;
+      }
+
+      keys.push_back(key);
+    }
+
+    return keys;
+  }
+} // namespace
+
+static void BM_IndexPageLookup(benchmark::State &state) {
+  IndexPage page(1, true);
+  std::vector<uint64_t> keys = fill(page, state.range(0));
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+
+  size_t next = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(page.lookup(keys[next]));
+    next = next + 1 < keys.size() ? next + 1 : 0;
+  }
+
+  state.counters["entries"] = static_cast<double>(page.itemCount());
+  state.SetItemsProcessed(state.iterations());
+}
+// Small strides keep the keys in narrow packed widths, large ones force full width.
+BENCHMARK(BM_IndexPageLookup)->ArgName("stride")->Arg(1)->Arg(1 << 20)->Arg(int64_t{1} << 40);
+
+static void BM_IndexPageInsertKey(benchmark::State &state) {
+  const std::vector<uint64_t> keys = shuffledKeys(IndexPage::maxEntries(), state.range(0));
+
+  std::vector<uint8_t> buffer(Page::PAGE_SIZE);
+  IndexPage page(buffer.data(), 1, true);
+  size_t next = 0;
+
+  for (auto _ : state) {
+    // Every iteration is one insert, a full page is swapped for an empty one untimed.
+    const uint32_t pageId = static_cast<uint32_t>(next) + 1;
+    if (next == keys.size() || !page.insertKey(keys[next], pageId)) {
+      state.PauseTiming();
+      page = IndexPage(buffer.data(), 1, true);
+      next = 0;
+      state.ResumeTiming();
+
+      benchmark::DoNotOptimize(page.insertKey(keys[next], 1));
+    }
+
+    next++;
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_IndexPageInsertKey)->ArgName("stride")->Arg(1)->Arg(int64_t{1} << 40);
+
+static void BM_IndexPageSplit(benchmark::State &state) {
+  IndexPage full(1, true);
+  fill(full, state.range(0));
+
+  IndexPage page(1, true);
+  std::vector<uint8_t> buffer(Page::PAGE_SIZE);
+  for (auto _ : state) {
+    // Restoring the image is a page copy, far below the cost of splitting it.
+    page.copyFrom(full);
+    IndexPage sibling(buffer.data(), 2, true);
+    benchmark::DoNotOptimize(page.split(sibling));
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_IndexPageSplit)->ArgName("stride")->Arg(1)->Arg(int64_t{1} << 40);
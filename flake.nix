@@ -33,6 +33,7 @@
               clang-tools
               cmake
               doxygen
+              gbenchmark
               zlib
               gcc
               gnumake
@@ -55,6 +56,13 @@
               cmake --build build
               ./build/tests/pulsedb-tests
             '';
+
+            scripts.bench-pulsedb.exec = ''
+              cmake -S . -B build -DBUILD_BENCHMARKS=true
+              cmake --build build
+              ./build/benchmarks/pulsedb-benchmarks --benchmark_out=build/benchmarks.json \
+                --benchmark_out_format=json "$@"
+            '';
           }
         ];
       };
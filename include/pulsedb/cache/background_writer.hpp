@@ -0,0 +1,117 @@
+/**
+ * @file include/pulsedb/cache/background_writer.hpp
+ * @brief The BackgroundWriter class used in the cache system. Flushes dirty pages ahead of
+ * eviction, and compacts fragmented data pages on the way.
+ */
+
+#ifndef PULSEDB_CACHE_BACKGROUND_WRITER_HPP
+#define PULSEDB_CACHE_BACKGROUND_WRITER_HPP
+
+#include "pulsedb/cache/buffer_pool.hpp"
+#include "pulsedb/utils/logger.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/**
+ * @namespace pulse::cache
+ * @brief The namespace for the cache system.
+ */
+namespace pulse::cache {
+  /**
+   * @struct WriterConfig
+   * @brief Tunables of the background writer.
+   */
+  struct WriterConfig {
+    double lowRatio = 0.1;                  /**< Dirty ratio at which eager flushing stops. */
+    double highRatio = 0.3;                 /**< Dirty ratio at which eager flushing starts. */
+    size_t lookahead = 8;                   /**< Eviction candidates per shard kept clean. */
+    size_t batchSize = 64;                  /**< Most pages written per round. */
+    size_t maxPagesPerSecond = 4096;        /**< Write rate limit, zero for none. */
+    size_t compactBatch = 16;               /**< Most pages compacted per round, zero for none. */
+    std::chrono::milliseconds interval{50}; /**< Pause between rounds. */
+
+    /** @brief Time between checkpoints of the pool's log, zero for none. */
+    std::chrono::milliseconds checkpointInterval{0};
+  };
+
+  /**
+   * @class BackgroundWriter
+   * @brief Thread that keeps eviction candidates clean, so eviction rarely has to write.
+   *
+   * Every round writes back the dirty pages the replacer would evict next. When the dirty ratio
+   * of the pool crosses the high watermark, it writes back any dirty unpinned page until the
+   * ratio drops below the low watermark. Writes are batched and rate limited.
+   *
+   * Before writing, every round compacts the resident data pages whose deleted records hold
+   * more than a quarter of their used space, so those pages reach the disk compacted.
+   *
+   * Given a checkpoint interval, the writer also checkpoints the pool's log that often, which
+   * bounds the log a restart has to redo.
+   */
+  class BackgroundWriter {
+  public:
+    /**
+     * @brief Starts the writer thread.
+     * @param pool The buffer pool to write back, must outlive the writer.
+     * @param config The writer tunables.
+     */
+    explicit BackgroundWriter(BufferPool &pool, WriterConfig config = {});
+
+    /**
+     * @brief Stops the writer thread.
+     */
+    ~BackgroundWriter() noexcept;
+
+    // Disable copy operations.
+    BackgroundWriter(const BackgroundWriter &) = delete;
+    BackgroundWriter &operator=(const BackgroundWriter &) = delete;
+
+    /**
+     * @brief Stop the writer, waiting for the current round to finish.
+     */
+    void stop() noexcept;
+
+    /**
+     * @brief Get the number of pages written so far.
+     * @return Pages written.
+     */
+    [[nodiscard]] size_t pagesWritten() const noexcept { return written; }
+
+    /**
+     * @brief Get the number of pages compacted so far.
+     * @return Pages compacted.
+     */
+    [[nodiscard]] size_t pagesCompacted() const noexcept { return compacted; }
+
+    /**
+     * @brief Get the number of checkpoints taken so far.
+     * @return Checkpoints taken.
+     */
+    [[nodiscard]] size_t checkpointsTaken() const noexcept { return checkpoints; }
+
+  private:
+    /**
+     * @brief Writer loop, runs rounds until stopped.
+     */
+    void run();
+
+    BufferPool &pool;    /**< The pool to write back. */
+    WriterConfig config; /**< The writer tunables. */
+
+    std::atomic<size_t> written;     /**< Pages written so far. */
+    std::atomic<size_t> compacted;   /**< Pages compacted so far. */
+    std::atomic<size_t> checkpoints; /**< Checkpoints taken so far. */
+    bool stopping;                   /**< Whether the writer was asked to stop. */
+    std::mutex mutex;                /**< Guards stopping. */
+    std::condition_variable wake;    /**< Signalled on stop. */
+    std::thread thread;              /**< The writer thread. */
+
+    utils::Logger logger; /**< Logger instance. */
+  };
+} // namespace pulse::cache
+
+#endif // PULSEDB_CACHE_BACKGROUND_WRITER_HPP
@@ -1,21 +1,52 @@
 /**
  * @file include/pulsedb/cache/buffer_pool.hpp
- * @brief The BufferPool class used in the cache system. Manages caching and eviction with LRU
- * policy.
+ * @brief The BufferPool class used in the cache system. Manages caching and eviction with a
+ * configurable replacement policy.
+ *
+ * The pool is split into shards. A page ID always hashes to the same shard, and each shard owns
+ * its frames, page table, replacer and lock, so operations on pages in different shards never
+ * contend with each other.
+ *
+ * Hits and unpins don't take the shard lock at all. They look the page up in the lock-free page
+ * table and pin the frame with a single atomic increment, only misses and evictions serialize.
+ *
+ * Every frame's buffer is a slot in one arena mapped up front. Misses read straight into the
+ * victim frame's slot and new pages are built in place, so the pool never allocates a page.
+ *
+ * On a NUMA machine the pool can be partitioned by node. Each node then has an arena bound to its
+ * memory and shards of its own, replacers included, and a page is held by whichever node's
+ * thread faulted it in. A page ID picks the same shard within every node, and lookups try the
+ * calling thread's node first, so hits on pages a node brought in itself stay local. Misses on a
+ * page are serialized across nodes by a lock per shard index, so no page is ever held twice.
+ *
+ * The pool counts hits, misses, evictions, write-backs and waits in striped counters, so hits
+ * stay an uncontended increment. Only misses and flushes are timed.
+ *
+ * A pool can save the pages it holds, coldest first, and a restarted pool can load them back
+ * in batched reads in page order, instead of warming up one random miss at a time.
  */
 
 #ifndef PULSEDB_CACHE_BUFFER_POOL_HPP
 #define PULSEDB_CACHE_BUFFER_POOL_HPP
 
 #include "pulsedb/cache/frame.hpp"
-#include "pulsedb/cache/policies/lru_replacer.hpp"
+#include "pulsedb/cache/frame_arena.hpp"
+#include "pulsedb/cache/page_guard.hpp"
+#include "pulsedb/cache/page_table.hpp"
+#include "pulsedb/cache/replacer.hpp"
 #include "pulsedb/storage/disk_manager.hpp"
 #include "pulsedb/storage/page.hpp"
 #include "pulsedb/utils/logger.hpp"
+#include "pulsedb/utils/metrics.hpp"
+#include "pulsedb/utils/numa.hpp"
+#include "pulsedb/wal/log_manager.hpp"
 
+#include <condition_variable>
+#include <filesystem>
 #include <memory>
 #include <mutex>
-#include <unordered_map>
+#include <span>
+#include <string>
 #include <vector>
 
 /**
@@ -23,19 +54,81 @@
  * @brief The namespace for the cache system.
  */
 namespace pulse::cache {
+  /**
+   * @struct PoolStats
+   * @brief Counters of a buffer pool.
+   */
+  struct PoolStats {
+    uint64_t hits = 0;                     /**< Fetches of resident pages. */
+    uint64_t misses = 0;                   /**< Fetches that read the page from disk. */
+    uint64_t evictions = 0;                /**< Pages evicted to make room. */
+    uint64_t dirtyEvictions = 0;           /**< Evictions that had to write the page first. */
+    uint64_t writeBacks = 0;               /**< Pages written back ahead of eviction. */
+    uint64_t pinWaits = 0;                 /**< Waits for a page being read or written. */
+    uint64_t latchWaits = 0;               /**< Latches that weren't granted at once. */
+    uint64_t remoteHits = 0;               /**< Hits on pages held by another NUMA node. */
+    utils::HistogramSnapshot fetchLatency; /**< Time to fetch a missed page. */
+    utils::HistogramSnapshot flushLatency; /**< Time to flush a page or a batch. */
+    ReplacerStats replacer;                /**< Counters of every shard's replacer, summed. */
+
+    /**
+     * @brief Write the counters as Prometheus metrics.
+     * @param writer The writer to add them to.
+     */
+    void report(utils::PrometheusWriter &writer) const;
+  };
+
+  /**
+   * @struct OptimisticRead
+   * @brief A read of a resident page that took no pin and no latch.
+   * @note The bytes can change or be replaced at any time, nothing read from them is to be
+   * trusted until valid() says so.
+   */
+  struct OptimisticRead {
+    const Frame *frame;   /**< Frame the page was found in. */
+    const uint8_t *bytes; /**< The frame's buffer, PAGE_SIZE bytes. */
+    uint64_t version;     /**< Version of the frame when the read started. */
+
+    /**
+     * @brief Check that the page hasn't changed since the read started.
+     * @return True if everything read from the bytes so far is consistent.
+     */
+    [[nodiscard]] bool valid() const noexcept { return frame->validate(version); }
+
+    /**
+     * @brief Count the read as an access, so the page ages like one that was pinned.
+     * @note Only meant for reads that validated, a failed one may have seen another page.
+     */
+    void touch() const noexcept { frame->touch(); }
+  };
+
   /**
    * @class BufferPool
    * @brief Manages a pool of memory frames for caching pages.
    */
   class BufferPool {
   public:
+    static constexpr size_t ALL_NODES = 0;      /**< Node count partitioning over every node. */
+    static constexpr size_t WARMUP_BATCH = 256; /**< Pages read ahead together by warmUp(). */
+
     /**
      * @brief Constructs a new buffer pool.
      * @param diskManager The disk manager to use.
      * @param poolSize Size of pool in frames.
+     * @param shardCount Number of independently locked shards the frames are split across.
+     * @param policy Page replacement policy used by every shard.
+     * @param nodeCount Number of NUMA nodes the frames are partitioned over, ALL_NODES for every
+     * node of the machine. Each node gets an equal share of the frames and of the shards.
      * @note Default pool size is 1024 frames. 4MB of memory (1024 * 4KB)
+     * @note Nodes the machine doesn't have still get partitions, only their memory isn't bound.
      */
-    explicit BufferPool(storage::DiskManager &diskManager, size_t poolSize = 1024) noexcept;
+    explicit BufferPool(
+        storage::DiskManager &diskManager,
+        size_t poolSize = 1024,
+        size_t shardCount = 1,
+        ReplacerPolicy policy = ReplacerPolicy::LRU,
+        size_t nodeCount = 1
+    ) noexcept;
 
     /**
      * @brief Clean up resources.
@@ -50,9 +143,52 @@ namespace pulse::cache {
      * @brief Fetch page into buffer pool.
      * @param pageId The ID of the page to fetch.
      * @return Pointer to the page in memory or nullptr.
+     * @note The pool lock is released while a miss is read from disk.
+     * @note The caller has to unpin the page, readPage and writePage return guards that do.
      */
     [[nodiscard]] storage::Page *fetchPage(uint32_t pageId);
 
+    /**
+     * @brief Start an optimistic read of a resident page, without pinning or latching it.
+     * @param pageId The ID of the page.
+     * @param swip The reference the page was reached through, if any. A swip still naming the
+     * page's frame skips the page table, otherwise it's pointed at the frame found there.
+     * @return The read, nullopt if the page isn't resident or is being changed.
+     * @note Nothing but the swip is written to shared memory, not even the replacer, so readers
+     * on many cores don't contend on the page. Pages only read this way age out of the pool.
+     */
+    [[nodiscard]] std::optional<OptimisticRead>
+    readOptimistic(uint32_t pageId, Swip *swip = nullptr) const noexcept;
+
+    /**
+     * @brief Start reading pages that will be fetched soon, without taking a frame for them.
+     * @param pageIds IDs of the pages.
+     * @return Number of pages handed to the disk manager, resident pages are skipped.
+     * @note The reads land in the kernel's page cache, so the fetches that follow miss the pool
+     * but not the disk.
+     */
+    size_t prefetch(std::span<const uint32_t> pageIds);
+
+    /**
+     * @brief Save the resident page IDs in replacer order, so a restarted pool can warm up.
+     * @param path File to write, replaced as a whole.
+     * @return True if saved, false otherwise.
+     * @note Shards are merged by where each page stands in its own replacer, pinned pages count
+     * as the hottest.
+     */
+    bool saveWarmup(const std::filesystem::path &path) const;
+
+    /**
+     * @brief Load the pages of a warm-up snapshot and seed the replacers with its order.
+     * @param path Snapshot written by saveWarmup().
+     * @param threads Threads fetching pages, 0 for one per core.
+     * @return Number of pages loaded, 0 if there's no valid snapshot.
+     * @note Only the hottest pages the pool has room for are loaded. They're fetched in page ID
+     * order, each batch of WARMUP_BATCH read ahead as a whole, then touched coldest first so the
+     * replacers end up in the saved order. Meant for startup, before the pool is busy.
+     */
+    size_t warmUp(const std::filesystem::path &path, size_t threads = 0);
+
     /**
      * @brief Create a new page in the buffer pool.
      * @param type The type of page to create.
@@ -63,6 +199,18 @@ namespace pulse::cache {
     [[nodiscard]] storage::Page *
     createPage(storage::PageType type, bool isLeaf = true, uint16_t level = 0);
 
+    /**
+     * @brief Create a new page in a page ID the caller allocated, such as a page of an extent.
+     * @param pageId The allocated page ID, not yet holding a page.
+     * @param type The type of page to create.
+     * @param isLeaf Whether the page is a leaf node or not.
+     * @param level The level of the page in the B+ tree.
+     * @return Pointer to the new page.
+     */
+    [[nodiscard]] storage::Page *createPage(
+        uint32_t pageId, storage::PageType type, bool isLeaf = true, uint16_t level = 0
+    );
+
     /**
      * @brief Delete a page from the buffer pool and disk.
      * @param pageId The ID of the page to delete.
@@ -70,6 +218,14 @@ namespace pulse::cache {
      */
     bool deletePage(uint32_t pageId);
 
+    /**
+     * @brief Delete a page, or free it once its last pin drops if it is still pinned.
+     * @param pageId The ID of the page to delete.
+     * @return True if deleted or left to be freed, false if the disk refused to free it.
+     * @note For pages nothing reaches anymore, whose stray pins are only on their way out.
+     */
+    bool retirePage(uint32_t pageId);
+
     /**
      * @brief Unpin a page from the buffer pool.
      * @param pageId The ID of the page to unpin.
@@ -78,6 +234,57 @@ namespace pulse::cache {
      */
     bool unpinPage(uint32_t pageId, bool dirty);
 
+    /**
+     * @brief Latch a pinned page, blocking until the latch is granted.
+     * @param pageId The ID of the pinned page.
+     * @param exclusive Whether to latch for writing, otherwise the latch is shared.
+     * @return True if latched, false if the page is not in the pool.
+     */
+    bool latchPage(uint32_t pageId, bool exclusive);
+
+    /**
+     * @brief Release the latch on a pinned page.
+     * @param pageId The ID of the pinned page.
+     * @param exclusive Whether the latch was taken for writing.
+     * @return True if released, false if the page is not in the pool.
+     */
+    bool unlatchPage(uint32_t pageId, bool exclusive);
+
+    /**
+     * @brief Fetch a page and latch it for reading.
+     * @tparam T The page class, Page for any type.
+     * @param pageId The ID of the page to fetch.
+     * @return Guard over the page, empty if it can't be fetched or isn't a T.
+     */
+    template <typename T = storage::Page>
+    [[nodiscard]] ReadPageGuard<T> readPage(uint32_t pageId) {
+      return guard<T, false>(fetchPage(pageId), false);
+    }
+
+    /**
+     * @brief Fetch a page and latch it for writing.
+     * @tparam T The page class, Page for any type.
+     * @param pageId The ID of the page to fetch.
+     * @return Guard over the page, empty if it can't be fetched or isn't a T.
+     */
+    template <typename T = storage::Page>
+    [[nodiscard]] WritePageGuard<T> writePage(uint32_t pageId) {
+      return guard<T, true>(fetchPage(pageId), false);
+    }
+
+    /**
+     * @brief Create a page and latch it for writing.
+     * @tparam T The page class, DataPage or IndexPage.
+     * @param isLeaf Whether an index page is a leaf.
+     * @param level Level of an index page in the tree.
+     * @return Guard over the dirty page, empty if the pool ran out of frames.
+     */
+    template <typename T>
+    [[nodiscard]] WritePageGuard<T> newPage(bool isLeaf = true, uint16_t level = 0) {
+      static_assert(pageTypeOf<T>().has_value(), "New pages need a concrete page class");
+      return guard<T, true>(createPage(*pageTypeOf<T>(), isLeaf, level), true);
+    }
+
     /**
      * @brief Flush a specific page to the disk.
      * @param pageId The ID of the page to flush.
@@ -90,33 +297,341 @@ namespace pulse::cache {
      */
     void flushAll();
 
+    /**
+     * @brief Write dirty unpinned frames back ahead of eviction, as one batch.
+     * @param limit Maximum number of pages to write.
+     * @param lookahead Number of eviction candidates per shard to keep clean.
+     * @param eager Also write dirty frames that aren't eviction candidates yet.
+     * @return Number of pages written.
+     * @note Pages are copied under the shard lock, the writes happen without it.
+     */
+    size_t writeBack(size_t limit, size_t lookahead, bool eager);
+
+    /**
+     * @brief Compact resident data pages that deleted records fragmented.
+     * @param limit Maximum number of pages to compact.
+     * @return Number of pages compacted.
+     * @note Only dirty unpinned frames are compacted, under the shard lock. A pinned page may
+     * have its latch or record pointers held, it is left for a later call.
+     */
+    size_t compact(size_t limit);
+
+    /**
+     * @brief Attach a write-ahead log that has to cover a page before the page is written.
+     * @param log The log, or nullptr to write pages without one.
+     * @note Call before the pool is shared between threads.
+     */
+    void attachLog(wal::LogManager *log) noexcept { this->log = log; }
+
+    /**
+     * @brief Snapshot the dirty page table without stopping writers.
+     * @return Pages that may be newer than on disk, with the LSN their records are on disk up to.
+     * @note Pinned and locked frames are listed even if clean, they may be changed and logged
+     * before they're marked.
+     */
+    [[nodiscard]] std::vector<wal::DirtyPage> dirtyPages() const;
+
+    /**
+     * @brief Take a fuzzy checkpoint into the attached log, so recovery starts from it.
+     * @return The LSN of the checkpoint record, 0 if there's no log or it couldn't be written.
+     */
+    uint64_t checkpoint();
+
+    /**
+     * @brief Get the fraction of frames holding dirty pages.
+     * @return Dirty frames over total frames.
+     */
+    [[nodiscard]] double dirtyRatio() const noexcept;
+
     /**
      * @brief Get the number of frames in use.
      * @return Number of frames currently holding pages.
      */
-    [[nodiscard]] size_t size() const noexcept { return pageTable.size(); }
+    [[nodiscard]] size_t size() const noexcept;
+
+    /**
+     * @brief Get the disk manager the pool reads and writes pages with.
+     * @return The disk manager.
+     */
+    [[nodiscard]] storage::DiskManager &disk() const noexcept { return diskManager; }
+
+    /**
+     * @brief Get the number of shards in the pool.
+     * @return Number of shards.
+     */
+    [[nodiscard]] size_t shardCount() const noexcept { return shards.size(); }
+
+    /**
+     * @brief Get the number of NUMA nodes the pool is partitioned over.
+     * @return Number of nodes, 1 if not partitioned.
+     */
+    [[nodiscard]] size_t nodeCount() const noexcept { return nodes; }
+
+    /**
+     * @brief Get the NUMA node holding a page.
+     * @param pageId The ID of the page.
+     * @return The node, nullopt if the page isn't resident.
+     */
+    [[nodiscard]] std::optional<size_t> nodeOf(uint32_t pageId) const noexcept;
+
+    /**
+     * @brief Get the counters of the pool.
+     * @return A snapshot of the counters.
+     */
+    [[nodiscard]] PoolStats stats() const noexcept;
+
+    /**
+     * @brief Dump the counters of the pool and its disk manager.
+     * @return The metrics in the Prometheus text exposition format.
+     */
+    [[nodiscard]] std::string prometheus() const;
 
   private:
     /**
-     * @brief Find a frame to evict.
+     * @struct Metrics
+     * @brief The counters behind PoolStats.
+     */
+    struct Metrics {
+      utils::Counter hits;           /**< Fetches of resident pages. */
+      utils::Counter misses;         /**< Fetches that read the page from disk. */
+      utils::Counter evictions;      /**< Pages evicted to make room. */
+      utils::Counter dirtyEvictions; /**< Evictions that had to write the page first. */
+      utils::Counter writeBacks;     /**< Pages written back ahead of eviction. */
+      utils::Counter pinWaits;       /**< Waits for a page being read or written. */
+      utils::Counter latchWaits;     /**< Latches that weren't granted at once. */
+      utils::Counter remoteHits;     /**< Hits on pages held by another NUMA node. */
+      utils::Histogram fetchLatency; /**< Time to fetch a missed page. */
+      utils::Histogram flushLatency; /**< Time to flush a page or a batch. */
+    };
+
+    /**
+     * @struct Shard
+     * @brief An independently locked partition of the pool.
+     */
+    struct Shard {
+      /**
+       * @brief Constructs a new shard.
+       * @param frameCount Number of frames owned by the shard.
+       * @param policy Page replacement policy of the shard.
+       * @param buffers The first of frameCount consecutive arena slots for the frames.
+       */
+      Shard(size_t frameCount, ReplacerPolicy policy, uint8_t *buffers)
+          : frames(frameCount), pageTable(frameCount),
+            replacer(Replacer::create(policy, frameCount)) {
+        for (size_t i = 0; i < frameCount; i++) {
+          frames[i].bind(buffers + i * storage::Page::PAGE_SIZE);
+        }
+      }
+
+      std::vector<Frame> frames;          /**< Pool of frames. */
+      PageTable pageTable;                /**< Page IDs to frames, written under the lock. */
+      std::unique_ptr<Replacer> replacer; /**< Page replacement policy. */
+      std::vector<uint32_t> retired;      /**< Pages deleted while pinned, freed once unpinned. */
+
+      mutable std::mutex mutex;       /**< Mutex for thread safety. */
+      std::condition_variable loaded; /**< Signalled when an in-flight read or write completes. */
+    };
+
+    /**
+     * @brief Get the node of the calling thread, as a partition of the pool.
+     * @return Index of the node's partition.
+     */
+    [[nodiscard]] size_t localNode() const noexcept {
+      return nodes == 1 ? 0 : utils::currentNode() % nodes;
+    }
+
+    /**
+     * @brief Get the shard of a node that a page would be held in.
+     * @param node Index of the node's partition.
+     * @param pageId The ID of the page.
+     * @return The shard.
+     */
+    [[nodiscard]] Shard &shardAt(size_t node, uint32_t pageId) noexcept {
+      return *shards[node * columns + pageId % columns];
+    }
+
+    /**
+     * @brief Get the shard of a node that a page would be held in.
+     * @param node Index of the node's partition.
+     * @param pageId The ID of the page.
+     * @return The shard.
+     */
+    [[nodiscard]] const Shard &shardAt(size_t node, uint32_t pageId) const noexcept {
+      return *shards[node * columns + pageId % columns];
+    }
+
+    /**
+     * @brief Get the shard a page is loaded into when the calling thread faults it in.
+     * @param pageId The ID of the page.
+     * @return The shard of the calling thread's node.
+     */
+    [[nodiscard]] Shard &shardOf(uint32_t pageId) noexcept {
+      return shardAt(localNode(), pageId);
+    }
+
+    /**
+     * @brief Find the shard holding a page, on the calling thread's node first.
+     * @param pageId The ID of the page.
+     * @return The shard, nullptr if no node has the page in its table.
+     * @note Lock-free, a page that is moving in or out of a shard can be missed.
+     */
+    [[nodiscard]] const Shard *residentShard(uint32_t pageId) const noexcept;
+
+    /**
+     * @brief Find the shard holding a page, on the calling thread's node first.
+     * @param pageId The ID of the page.
+     * @return The shard, nullptr if no node holds the page.
+     * @note Looks again under each shard's lock if the lock-free lookups miss, so a pinned page
+     * is always found.
+     */
+    [[nodiscard]] Shard *holderOf(uint32_t pageId);
+
+    /**
+     * @brief Pin a resident page without taking the shard lock.
+     * @param shard The shard owning the page.
+     * @param pageId The ID of the page.
+     * @return The frame holding the page, or nullopt if it could not be pinned this way.
+     */
+    [[nodiscard]] std::optional<size_t> tryPin(Shard &shard, uint32_t pageId) noexcept;
+
+    /**
+     * @brief Pin a resident page without taking any lock, on the calling thread's node first.
+     * @param pageId The ID of the page.
+     * @return The pinned page, or nullptr if it could not be pinned this way.
+     */
+    [[nodiscard]] storage::Page *tryHit(uint32_t pageId) noexcept;
+
+    /**
+     * @brief Pin a page held by some node, waiting out a read of it in flight.
+     * @param pageId The ID of the page.
+     * @param place The held placement lock of the page, released while waiting.
+     * @param waited Set if the lock was released, in which case nothing is pinned.
+     * @return The pinned page, nullptr if no node holds the page.
+     */
+    [[nodiscard]] storage::Page *
+    pinHeld(uint32_t pageId, std::unique_lock<std::mutex> &place, bool &waited);
+
+    /**
+     * @brief Find the frame of a pinned page.
+     * @param pageId The ID of the page.
+     * @return The frame holding the page, or nullptr if not resident.
+     */
+    [[nodiscard]] Frame *pinnedFrame(uint32_t pageId);
+
+    /**
+     * @brief Latch a pinned page and wrap it in a guard, checking its type.
+     * @tparam T The page class the guard hands out.
+     * @tparam Exclusive Whether to latch for writing.
+     * @param page The pinned page, or nullptr.
+     * @param dirty Whether the page is dirty from the start.
+     * @return Guard over the page, empty and unpinned if it's no T.
+     */
+    template <typename T, bool Exclusive>
+    [[nodiscard]] BasicPageGuard<T, Exclusive> guard(storage::Page *page, bool dirty) {
+      if (!page) {
+        return {};
+      }
+
+      // The type is checked under the latch, a writer may be replacing the page.
+      const uint32_t pageId = page->id();
+      latchPage(pageId, Exclusive);
+
+      constexpr auto type = pageTypeOf<T>();
+      if (type && page->type() != *type) {
+        logger.error("page {} is not of the guarded type", pageId);
+        unlatchPage(pageId, Exclusive);
+        unpinPage(pageId, false);
+        return {};
+      }
+
+      return BasicPageGuard<T, Exclusive>(*this, static_cast<T *>(page), dirty);
+    }
+
+    /**
+     * @brief Drop a pin, handing the frame to the replacer once nothing holds it.
+     * @param shard The shard owning the frame.
+     * @param frameId The ID of the pinned frame.
+     */
+    void release(Shard &shard, size_t frameId);
+
+    /**
+     * @brief Delete a page from a shard, with the shard locked.
+     * @param shard The shard the page is in, if resident.
+     * @param lock The held lock of the shard, released while waiting out a write-back.
+     * @param pageId The ID of the page to delete.
+     * @param defer Whether a pinned page is left to be freed once unpinned, or refused.
+     * @return True if deleted or deferred, false otherwise.
+     */
+    bool removePage(
+        Shard &shard, std::unique_lock<std::mutex> &lock, uint32_t pageId, bool defer
+    );
+
+    /**
+     * @brief Free the retired pages of a shard that nothing pins anymore.
+     * @param shard The shard, locked by the caller.
+     */
+    void reclaim(Shard &shard);
+
+    /**
+     * @brief Find a frame to evict and lock it.
+     * @param shard The shard to search.
+     * @param lock The held lock of the shard, released while waiting out a write-back.
      * @return Frame ID if found, nullopt if none available.
      */
-    [[nodiscard]] std::optional<size_t> findVictim();
+    [[nodiscard]] std::optional<size_t>
+    findVictim(Shard &shard, std::unique_lock<std::mutex> &lock);
 
     /**
      * @brief Evict a page from the given frame.
+     * @param shard The shard owning the frame, must be locked. The frame must be locked too.
      * @param frameId The ID of the frame to evict.
      * @return True if evicted, otherwise false.
      */
-    bool evictFrame(size_t frameId);
+    bool evictFrame(Shard &shard, size_t frameId);
+
+    /**
+     * @brief Make the log durable up to the pages about to be written.
+     * @param lsn The highest LSN of the pages.
+     * @return True if the pages may be written, false if the log could not be flushed.
+     */
+    bool logged(uint64_t lsn);
+
+    /**
+     * @brief Get the end of the attached log, taken before a page is read or written.
+     * @return The log's current LSN, 0 without a log.
+     */
+    [[nodiscard]] uint64_t logEnd() const noexcept { return log ? log->currentLsn() : 0; }
+
+    /**
+     * @brief Copy a dirty page out of its frame and clear the frame's dirty flag.
+     * @param frame The frame, in a shard locked by the caller.
+     * @param copy The page to copy into.
+     * @return True if copied, false if a writer holds the page's latch.
+     * @note A change made after the copy marks the frame dirty again, so it's never lost.
+     */
+    bool snapshot(Frame &frame, storage::Page &copy);
+
+    /**
+     * @brief Flush every dirty page of a shard as one batch.
+     * @param shard The shard to flush, must be locked.
+     */
+    void flushShard(Shard &shard);
+
+    std::vector<FrameArena> arenas;             /**< Buffers of every node's frames. */
+    std::vector<std::unique_ptr<Shard>> shards; /**< Partitions of the pool, node by node. */
+    size_t nodes;                               /**< NUMA nodes the shards are split across. */
+    size_t columns;                             /**< Shards per node. */
+    std::unique_ptr<std::mutex[]> placements;   /**< Per shard index, serializes misses. */
+    size_t totalFrames;                         /**< Total number of frames. */
 
-    std::vector<Frame> frames;                      /**< Pool of frames. */
-    std::unordered_map<uint32_t, size_t> pageTable; /**< Page IDs to frames. */
-    LRUReplacer replacer;                           /**< Page replacement policy. */
+    std::mutex writeMutex; /**< Keeps write-backs and explicit flushes of a page ordered. */
+    size_t writeCursor;    /**< Shard the next write-back starts from. */
+    FrameArena snapshots;  /**< Buffers flushes copy pages into, under the write mutex. */
 
     utils::Logger logger;              /**< Logger instance. */
     storage::DiskManager &diskManager; /**< Disk manager instance. */
-    mutable std::mutex mutex;          /**< Mutex for thread safety. */
+    wal::LogManager *log;              /**< Write-ahead log, if attached. */
+    Metrics metrics;                   /**< Counters of the pool. */
   };
 } // namespace pulse::cache
 
@@ -7,47 +7,235 @@
 #ifndef PULSEDB_CACHE_FRAME_HPP
 #define PULSEDB_CACHE_FRAME_HPP
 
+#include "pulsedb/storage/data_page.hpp"
+#include "pulsedb/storage/index_page.hpp"
 #include "pulsedb/storage/page.hpp"
 #include <atomic>
+#include <cstdint>
+#include <new>
+#include <shared_mutex>
+#include <variant>
 
 /**
  * @namespace pulse::cache
  * @brief The namespace for the cache system.
  */
 namespace pulse::cache {
+  class Frame;
+
+  /**
+   * @brief A reference to a page that remembers the frame the page was last found in.
+   * @note Only a hint, the frame is checked to still hold the page before it's used.
+   */
+  using Swip = std::atomic<const Frame *>;
+
   /**
    * @class Frame
    * @brief A frame in the buffer pool that holds a page and its metadata.
+   *
+   * The top bit of the pin count is an exclusive lock taken while the frame is evicted or loaded.
+   * Pinning never blocks, tryPin() backs off if the lock is held and the lock can only be taken
+   * when nothing is pinned. The page and page ID are only replaced while the lock is held, so a
+   * pin keeps them stable without any other synchronization.
+   *
+   * The pin only keeps the page in memory. Threads sharing a page coordinate access to its
+   * contents through the frame's latch, which is only ever taken while the frame is pinned.
+   *
+   * A frame is bound to one buffer for its whole life, and the page it holds is a view over that
+   * buffer kept inside the frame. Replacing the page only rewrites the bytes and the view.
+   *
+   * The frame's version is odd while its contents change, under the exclusive lock or an
+   * exclusive latch, and moves on once they have. Optimistic readers read the buffer without a
+   * pin or a latch, and trust what they read only if the version was even before and is the same
+   * after. The buffer is never freed while the pool lives, so such reads are always safe to make.
+   *
+   * A frame holding an inner index node keeps a swip for each of the node's children, so
+   * descents go from frame to frame without looking the children up in the page table. The
+   * swips live beside the page, never in its bytes, so writing the page back needs no
+   * unswizzling. They're dropped when the frame is given another page.
    */
   class Frame {
   public:
     /**
      * @brief Constructs a new frame.
      */
-    explicit Frame() noexcept : page(nullptr), pageId(0), pinCount(0), dirty(false) {}
+    explicit Frame() noexcept
+        : buffer(nullptr), page(nullptr), pageId(0), pinCount(0), stamp(0), cleanLsn(0),
+          dirty(false), loading(false), writing(false), touched(false),
+          retired(false), children(nullptr) {}
+
+    /**
+     * @brief Frees the frame's swips.
+     */
+    ~Frame() noexcept { delete[] children.load(std::memory_order_relaxed); }
+
+    // Disable copy operations, swips point at frames.
+    Frame(const Frame &) = delete;
+    Frame &operator=(const Frame &) = delete;
+
+    /**
+     * @brief Bind the frame to the buffer its pages are held in.
+     * @param slot PAGE_SIZE bytes, 64-byte aligned, that outlive the frame.
+     * @note Only done once, before the frame holds any page.
+     */
+    void bind(uint8_t *slot) noexcept { buffer = slot; }
+
+    /**
+     * @brief Reset the frame with a new, empty page built in its buffer.
+     * @tparam T The page class, DataPage or IndexPage.
+     * @param newPageId The ID of the new page.
+     * @param args The rest of the page's constructor arguments.
+     * @return The new page.
+     * @note The pin count is left alone, frames are only reset while nothing holds them.
+     */
+    template <typename T, typename... Args>
+    T &create(uint32_t newPageId, Args &&...args) noexcept {
+      T &typed = view.emplace<T>(buffer, newPageId, std::forward<Args>(args)...);
+      hold(&typed);
+      return typed;
+    }
+
+    /**
+     * @brief Reset the frame with the page whose bytes were read into its buffer.
+     * @return True if the frame holds the page, false if the page type is invalid.
+     */
+    bool adopt() noexcept {
+      switch (reinterpret_cast<const storage::PageHeader *>(buffer)->type) {
+        case storage::PageType::DATA:
+          hold(&view.emplace<storage::DataPage>(storage::VIEW, buffer));
+          return true;
+
+        case storage::PageType::INDEX:
+          hold(&view.emplace<storage::IndexPage>(storage::VIEW, buffer));
+          return true;
+
+        default:
+          reset();
+          return false;
+      }
+    }
+
+    /**
+     * @brief Reset the frame to hold nothing.
+     */
+    void reset() noexcept {
+      view.emplace<std::monostate>();
+      hold(nullptr);
+    }
 
     /**
-     * @brief Reset the frame with a new page.
-     * @param newPage Unique pointer to the new page.
+     * @brief Reserve the frame for a page whose read is still in flight.
+     * @param id The ID of the page being loaded.
      */
-    void reset(std::unique_ptr<storage::Page> newPage) noexcept {
-      page = std::move(newPage);
-      pageId = page ? page->id() : 0;
-      pinCount = 0;
+    void load(uint32_t id) noexcept {
+      view.emplace<std::monostate>();
+      unswizzle();
+      page.store(nullptr, std::memory_order_relaxed);
+      pageId.store(id, std::memory_order_relaxed);
       dirty = false;
+      loading = true;
+      retired = false;
+      touched.store(false, std::memory_order_relaxed);
     }
 
     /**
      * @brief Pin the frame.
      * @return The new pin count.
      */
-    size_t pin() noexcept { return ++pinCount; }
+    size_t pin() noexcept { return (pinCount.fetch_add(1, std::memory_order_acquire) + 1) & PINS; }
+
+    /**
+     * @brief Pin the frame unless it is locked.
+     * @return True if pinned, false if the frame is being evicted or loaded.
+     */
+    bool tryPin() noexcept {
+      if (pinCount.fetch_add(1, std::memory_order_acquire) & LOCKED) {
+        pinCount.fetch_sub(1, std::memory_order_relaxed);
+        return false;
+      }
+
+      return true;
+    }
 
     /**
      * @brief Unpin the frame.
      * @return The new pin count.
      */
-    size_t unpin() noexcept { return pinCount > 0 ? --pinCount : 0; }
+    size_t unpin() noexcept {
+      uint32_t current = pinCount.load(std::memory_order_relaxed);
+      do {
+        if ((current & PINS) == 0) {
+          return 0;
+        }
+      } while (!pinCount.compare_exchange_weak(current, current - 1, std::memory_order_release));
+
+      return (current - 1) & PINS;
+    }
+
+    /**
+     * @brief Take the frame's exclusive lock.
+     * @return True if locked, false if the frame is pinned or already locked.
+     */
+    bool tryLock() noexcept {
+      uint32_t expected = 0;
+      if (!pinCount.compare_exchange_strong(expected, LOCKED, std::memory_order_acquire)) {
+        return false;
+      }
+
+      beginWrite();
+      return true;
+    }
+
+    /**
+     * @brief Release the frame's exclusive lock.
+     */
+    void unlock() noexcept {
+      endWrite();
+      pinCount.fetch_sub(LOCKED, std::memory_order_release);
+    }
+
+    /**
+     * @brief Record an access that didn't pin the frame, for the replacer to see at eviction.
+     * @note Only stores if the mark is clear, so hot frames don't bounce their cache line.
+     */
+    void touch() const noexcept {
+      if (!touched.load(std::memory_order_relaxed)) {
+        touched.store(true, std::memory_order_relaxed);
+      }
+    }
+
+    /**
+     * @brief Take and clear the mark left by touch().
+     * @return True if the frame was touched since the mark was last taken.
+     */
+    bool takeTouch() noexcept {
+      return touched.load(std::memory_order_relaxed) &&
+             touched.exchange(false, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Make the version odd, before the contents are changed.
+     * @note Only one thread changes the contents at a time, under the lock or the latch.
+     */
+    void beginWrite() noexcept {
+      stamp.fetch_add(1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    /**
+     * @brief Make the version even again, once the contents are changed.
+     */
+    void endWrite() noexcept { stamp.fetch_add(1, std::memory_order_release); }
+
+    /**
+     * @brief Check that nothing changed the contents since an optimistic read started.
+     * @param seen The version the read started at, from version().
+     * @return True if what was read is consistent.
+     */
+    [[nodiscard]] bool validate(uint64_t seen) const noexcept {
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return stamp.load(std::memory_order_relaxed) == seen;
+    }
 
     /**
      * @brief Getters for the frame class.
@@ -58,13 +246,63 @@ namespace pulse::cache {
      * @brief Get the page ID of the frame.
      * @return The page ID of the frame.
      */
-    [[nodiscard]] uint32_t id() const noexcept { return pageId; }
+    [[nodiscard]] uint32_t id() const noexcept { return pageId.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Check if the frame holds a page, without pinning it.
+     * @param id The ID of the page.
+     * @return True if the frame holds the page.
+     * @note Only trustworthy for as long as the frame's version doesn't move.
+     */
+    [[nodiscard]] bool holds(uint32_t id) const noexcept {
+      return page.load(std::memory_order_relaxed) && pageId.load(std::memory_order_relaxed) == id;
+    }
+
+    /**
+     * @brief Get the swip of a child of the inner node in the frame.
+     * @param slot Index of the child's entry in the node.
+     * @return The swip, nullptr if there's no memory for them or the slot is past any node.
+     */
+    [[nodiscard]] Swip *swip(size_t slot) const noexcept {
+      Swip *swips = children.load(std::memory_order_acquire);
+      if (!swips) {
+        // Racing readers can each make a table, the first one in is kept.
+        auto *made = new (std::nothrow) Swip[SWIP_SLOTS]();
+        if (!made) {
+          return nullptr;
+        }
+
+        if (children.compare_exchange_strong(swips, made, std::memory_order_acq_rel)) {
+          swips = made;
+        }
+
+        else {
+          delete[] made;
+        }
+      }
+
+      return slot < SWIP_SLOTS ? &swips[slot] : nullptr;
+    }
+
+    /**
+     * @brief Get the version of the frame's contents, to start an optimistic read at.
+     * @return The version, odd while the contents are being changed.
+     */
+    [[nodiscard]] uint64_t version() const noexcept {
+      return stamp.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Get the buffer the frame holds its pages in.
+     * @return The frame's buffer, nullptr if unbound.
+     */
+    [[nodiscard]] const uint8_t *getBuffer() const noexcept { return buffer; }
 
     /**
      * @brief Get the pin count of the frame.
      * @return The pin count of the frame.
      */
-    [[nodiscard]] size_t pins() const noexcept { return pinCount; }
+    [[nodiscard]] size_t pins() const noexcept { return pinCount & PINS; }
 
     /**
      * @brief Check if the frame is dirty.
@@ -76,21 +314,71 @@ namespace pulse::cache {
      * @brief Get the page in the frame.
      * @return The page in the frame.
      */
-    [[nodiscard]] storage::Page *getPage() noexcept { return page ? page.get() : nullptr; }
+    [[nodiscard]] storage::Page *getPage() noexcept {
+      return page.load(std::memory_order_relaxed);
+    }
 
     /**
      * @brief Get the page in the frame.
      * @return The page in the frame.
      */
     [[nodiscard]] const storage::Page *getPage() const noexcept {
-      return page ? page.get() : nullptr;
+      return page.load(std::memory_order_relaxed);
     }
 
+    /**
+     * @brief Get the buffer the frame holds its pages in.
+     * @return The frame's buffer, nullptr if unbound.
+     */
+    [[nodiscard]] uint8_t *getBuffer() noexcept { return buffer; }
+
+    /**
+     * @brief Get the latch guarding the contents of the page.
+     * @return The latch of the frame.
+     */
+    [[nodiscard]] std::shared_mutex &getLatch() noexcept { return latch; }
+
     /**
      * @brief Check if the frame is unpinned.
      * @return True if the frame is unpinned, false otherwise.
      */
-    [[nodiscard]] bool isUnpinned() const noexcept { return pinCount == 0; }
+    [[nodiscard]] bool isUnpinned() const noexcept { return pins() == 0; }
+
+    /**
+     * @brief Check if the frame's exclusive lock is held.
+     * @return True if the frame is locked, false otherwise.
+     */
+    [[nodiscard]] bool isLocked() const noexcept { return pinCount & LOCKED; }
+
+    /**
+     * @brief Check if the frame is waiting on a read to complete.
+     * @return True if the frame is loading, false otherwise.
+     */
+    [[nodiscard]] bool isLoading() const noexcept { return loading; }
+
+    /**
+     * @brief Check if the frame holds nothing and is not reserved.
+     * @return True if the frame is free, false otherwise.
+     */
+    [[nodiscard]] bool isEmpty() const noexcept { return !getPage() && !loading; }
+
+    /**
+     * @brief Check if a background write-back of the frame is in flight.
+     * @return True if the frame is being written, false otherwise.
+     */
+    [[nodiscard]] bool isWriting() const noexcept { return writing; }
+
+    /**
+     * @brief Check if the page was deleted while pinned and is freed once unpinned.
+     * @return True if the page is waiting to be freed, false otherwise.
+     */
+    [[nodiscard]] bool isRetired() const noexcept { return retired; }
+
+    /**
+     * @brief Get the LSN the page's records are on disk up to.
+     * @return The log end when the page last matched the disk, 0 if unknown.
+     */
+    [[nodiscard]] uint64_t recLsn() const noexcept { return cleanLsn; }
 
     /** @} */
 
@@ -109,13 +397,76 @@ namespace pulse::cache {
      */
     void unmark() noexcept { dirty = false; }
 
+    /**
+     * @brief Flag or clear a background write-back in flight.
+     * @param value Whether the frame is being written.
+     */
+    void setWriting(bool value) noexcept { writing = value; }
+
+    /**
+     * @brief Flag the page as deleted, to be freed once the last pin drops.
+     */
+    void retire() noexcept { retired = true; }
+
+    /**
+     * @brief Record that the page's records are on disk up to an LSN.
+     * @param lsn The log end taken before the page was read or written.
+     */
+    void setRecLsn(uint64_t lsn) noexcept { cleanLsn = lsn; }
+
     /** @} */
 
   private:
-    std::unique_ptr<storage::Page> page; /**< The page in the frame. */
-    uint32_t pageId;                     /**< The page ID. */
-    std::atomic<uint32_t> pinCount;      /**< The pin count. */
-    std::atomic<bool> dirty;             /**< Whether the page is dirty or not. */
+    /**
+     * @brief Point the frame at the page now held in its view.
+     * @param held The page, or nullptr if empty.
+     */
+    void hold(storage::Page *held) noexcept {
+      unswizzle();
+      page.store(held, std::memory_order_relaxed);
+      pageId.store(held ? held->id() : 0, std::memory_order_relaxed);
+      dirty = false;
+      loading = false;
+      retired = false;
+      touched.store(false, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Drop the swips of the page leaving the frame.
+     */
+    void unswizzle() noexcept {
+      if (Swip *swips = children.load(std::memory_order_relaxed)) {
+        for (size_t slot = 0; slot < SWIP_SLOTS; slot++) {
+          swips[slot].store(nullptr, std::memory_order_relaxed);
+        }
+      }
+    }
+
+    static constexpr uint32_t LOCKED = 1u << 31; /**< Pin count bit of the exclusive lock. */
+    static constexpr uint32_t PINS = LOCKED - 1; /**< Pin count bits of the pins. */
+
+    /** @brief Swips per frame, one per child of the fullest node, whatever its entry widths. */
+    static constexpr size_t SWIP_SLOTS = storage::IndexPage::maxEntries();
+
+    /**
+     * @brief The typed page over the buffer, if any.
+     */
+    using View = std::variant<std::monostate, storage::DataPage, storage::IndexPage>;
+
+    uint8_t *buffer;                      /**< The buffer pages are held in. */
+    View view;                            /**< The page held in the buffer. */
+    std::atomic<storage::Page *> page;    /**< The page in the frame, points into the view. */
+    std::atomic<uint32_t> pageId;         /**< The page ID. */
+    std::atomic<uint32_t> pinCount;       /**< The pin count. */
+    std::atomic<uint64_t> stamp;          /**< Version of the contents, odd while they change. */
+    std::atomic<uint64_t> cleanLsn;       /**< Log end when the page last matched the disk. */
+    std::atomic<bool> dirty;              /**< Whether the page is dirty or not. */
+    std::atomic<bool> loading;            /**< Whether a read into the frame is in flight. */
+    std::atomic<bool> writing;            /**< Whether a write-back of the frame is in flight. */
+    mutable std::atomic<bool> touched;    /**< Whether an unpinned read touched the frame. */
+    std::atomic<bool> retired;            /**< Whether the page is freed once unpinned. */
+    std::shared_mutex latch;              /**< Reader-writer latch over the page contents. */
+    mutable std::atomic<Swip *> children; /**< Swips of the node's children, made on first use. */
   };
 } // namespace pulse::cache
 
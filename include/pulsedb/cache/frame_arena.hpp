@@ -0,0 +1,114 @@
+/**
+ * @file include/pulsedb/cache/frame_arena.hpp
+ * @brief The FrameArena class used in the cache system. Holds the page buffers of every frame in
+ * one contiguous allocation.
+ *
+ * The arena is mapped once when the pool is built and never grows or shrinks. Each frame is bound
+ * to a fixed slot, and pages loaded into the frame are views over that slot, so misses and
+ * evictions never allocate. The mapping is asked for huge pages, which keeps a large pool from
+ * costing one TLB entry per 4KB page.
+ *
+ * An arena can be bound to a NUMA node before any of it is touched, so its slots are faulted in
+ * from that node's memory whichever thread touches them first.
+ */
+
+#ifndef PULSEDB_CACHE_FRAME_ARENA_HPP
+#define PULSEDB_CACHE_FRAME_ARENA_HPP
+
+#include "pulsedb/storage/page.hpp"
+#include "pulsedb/utils/logger.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+/**
+ * @namespace pulse::cache
+ * @brief The namespace for the cache system.
+ */
+namespace pulse::cache {
+  /**
+   * @class FrameArena
+   * @brief A fixed number of page-sized, page-aligned slots in a single mapping.
+   */
+  class FrameArena {
+  public:
+    static constexpr size_t HUGE_PAGE_SIZE = 2 << 20; /**< Size the mapping is rounded up to. */
+
+    /**
+     * @brief Maps the slots, zero filled.
+     * @param slotCount Number of page slots.
+     * @param node NUMA node to place the slots on, if any.
+     * @note Falls back to the heap if the mapping fails, heap slots aren't bound.
+     */
+    explicit FrameArena(size_t slotCount = 0, std::optional<size_t> node = std::nullopt);
+
+    /**
+     * @brief Unmaps the slots.
+     */
+    ~FrameArena() noexcept;
+
+    // Disable copy operations.
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    // Allow move operations.
+    FrameArena(FrameArena &&other) noexcept;
+    FrameArena &operator=(FrameArena &&other) noexcept;
+
+    /**
+     * @brief Get a slot of the arena.
+     * @param index Index of the slot, below the slot count.
+     * @return PAGE_SIZE bytes aligned to at least 64 bytes.
+     */
+    [[nodiscard]] uint8_t *slot(size_t index) noexcept {
+      return base + index * storage::Page::PAGE_SIZE;
+    }
+
+    /**
+     * @brief Getters for the frame arena class.
+     * @{
+     */
+
+    /**
+     * @brief Get the number of slots.
+     * @return The slot count.
+     */
+    [[nodiscard]] size_t slotCount() const noexcept { return slots; }
+
+    /**
+     * @brief Get the number of bytes reserved for the slots.
+     * @return The size of the mapping.
+     */
+    [[nodiscard]] size_t bytes() const noexcept { return length; }
+
+    /**
+     * @brief Check if the slots are mapped, rather than taken from the heap.
+     * @return True if mapped, false otherwise.
+     */
+    [[nodiscard]] bool isMapped() const noexcept { return mapped; }
+
+    /**
+     * @brief Check if the slots are bound to a NUMA node.
+     * @return True if bound, false otherwise.
+     */
+    [[nodiscard]] bool isBound() const noexcept { return bound; }
+
+    /** @} */
+
+  private:
+    /**
+     * @brief Give the slots back.
+     */
+    void unmap() noexcept;
+
+    uint8_t *base;        /**< The first slot. */
+    size_t slots;         /**< Number of slots. */
+    size_t length;        /**< Bytes reserved for the slots. */
+    bool mapped;          /**< Whether the slots came from mmap or the heap. */
+    bool bound;           /**< Whether the slots are bound to a NUMA node. */
+    utils::Logger logger; /**< Logger instance. */
+  };
+} // namespace pulse::cache
+
+#endif // PULSEDB_CACHE_FRAME_ARENA_HPP
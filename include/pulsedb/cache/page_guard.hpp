@@ -0,0 +1,200 @@
+/**
+ * @file include/pulsedb/cache/page_guard.hpp
+ * @brief The page guard classes used in the cache system. Guards own the pin and the latch of a
+ * page in the buffer pool and give them back when they go out of scope.
+ *
+ * A ReadPageGuard holds a shared latch and only hands out const access. A WritePageGuard holds
+ * the exclusive latch, and any mutable access marks the page dirty so it's unpinned as such.
+ * Both point straight into the frame, nothing is copied, and the page type is checked once when
+ * the guard is made so the typed pointer needs no casting at the call site.
+ */
+
+#ifndef PULSEDB_CACHE_PAGE_GUARD_HPP
+#define PULSEDB_CACHE_PAGE_GUARD_HPP
+
+#include "pulsedb/storage/data_page.hpp"
+#include "pulsedb/storage/disk_manager.hpp"
+#include "pulsedb/storage/index_page.hpp"
+#include "pulsedb/storage/page.hpp"
+
+#include <optional>
+#include <type_traits>
+
+/**
+ * @namespace pulse::cache
+ * @brief The namespace for the cache system.
+ */
+namespace pulse::cache {
+  class BufferPool;
+
+  /**
+   * @brief Get the page type a page class is stored as.
+   * @tparam T The page class.
+   * @return The page type, nullopt if the class takes pages of any type.
+   */
+  template <typename T> [[nodiscard]] constexpr std::optional<storage::PageType> pageTypeOf() {
+    static_assert(std::is_base_of_v<storage::Page, T>, "Guarded type must inherit from Page");
+
+    if constexpr (std::is_same_v<T, storage::DataPage>) {
+      return storage::PageType::DATA;
+    }
+
+    else if constexpr (std::is_same_v<T, storage::IndexPage>) {
+      return storage::PageType::INDEX;
+    }
+
+    else {
+      return std::nullopt;
+    }
+  }
+
+  /**
+   * @class PageGuardBase
+   * @brief The untyped part of a page guard, releasing the pin and latch it owns.
+   */
+  class PageGuardBase {
+  public:
+    // Disable copy operations, a pin is released exactly once.
+    PageGuardBase(const PageGuardBase &) = delete;
+    PageGuardBase &operator=(const PageGuardBase &) = delete;
+
+    /**
+     * @brief Check if the guard holds a page.
+     * @return True if it holds a page, false if empty or released.
+     */
+    [[nodiscard]] explicit operator bool() const noexcept { return page != nullptr; }
+
+    /**
+     * @brief Get the ID of the guarded page.
+     * @return The page ID, INVALID_PAGE_ID if the guard is empty.
+     */
+    [[nodiscard]] uint32_t pageId() const noexcept {
+      return page ? page->id() : storage::DiskManager::INVALID_PAGE_ID;
+    }
+
+    /**
+     * @brief Unlatch and unpin the page early, leaving the guard empty.
+     */
+    void release() noexcept;
+
+  protected:
+    /**
+     * @brief Construct an empty guard.
+     */
+    PageGuardBase() noexcept : pool(nullptr), page(nullptr), exclusive(false), dirty(false) {}
+
+    /**
+     * @brief Adopt a page that is already pinned and latched.
+     * @param pool The pool holding the page.
+     * @param page The page.
+     * @param exclusive Whether the latch is exclusive.
+     * @param dirty Whether the page is dirty from the start.
+     */
+    PageGuardBase(BufferPool &pool, storage::Page *page, bool exclusive, bool dirty) noexcept
+        : pool(&pool), page(page), exclusive(exclusive), dirty(dirty) {}
+
+    /**
+     * @brief Release the page if still held.
+     */
+    ~PageGuardBase() noexcept { release(); }
+
+    // Allow move operations.
+    PageGuardBase(PageGuardBase &&other) noexcept;
+    PageGuardBase &operator=(PageGuardBase &&other) noexcept;
+
+    BufferPool *pool;    /**< The pool holding the page. */
+    storage::Page *page; /**< The guarded page, nullptr if empty. */
+    bool exclusive;      /**< Whether the latch is exclusive. */
+    bool dirty;          /**< Whether to unpin the page as dirty. */
+  };
+
+  /**
+   * @class BasicPageGuard
+   * @brief A typed page guard.
+   * @tparam T The page class.
+   * @tparam Exclusive Whether the guard holds the exclusive latch.
+   */
+  template <typename T, bool Exclusive> class BasicPageGuard : public PageGuardBase {
+    friend class BufferPool; // Allow the buffer pool to make guards.
+
+  public:
+    /**
+     * @brief Construct an empty guard.
+     */
+    BasicPageGuard() noexcept = default;
+
+    // Allow move operations.
+    BasicPageGuard(BasicPageGuard &&) noexcept = default;
+    BasicPageGuard &operator=(BasicPageGuard &&) noexcept = default;
+
+    /**
+     * @brief Get const access to the page.
+     * @return The page, nullptr if the guard is empty.
+     */
+    [[nodiscard]] const T *get() const noexcept { return static_cast<const T *>(page); }
+
+    /**
+     * @brief Get mutable access to the page, marking it dirty.
+     * @return The page, nullptr if the guard is empty.
+     */
+    [[nodiscard]] T *getMut() noexcept
+      requires Exclusive
+    {
+      dirty = true;
+      return static_cast<T *>(page);
+    }
+
+    /**
+     * @brief Access members of the page, mutable write guards mark it dirty.
+     * @return The page.
+     */
+    [[nodiscard]] auto *operator->() noexcept {
+      if constexpr (Exclusive) {
+        return getMut();
+      }
+
+      else {
+        return get();
+      }
+    }
+
+    /**
+     * @brief Access members of the page without marking it dirty.
+     * @return The page.
+     */
+    [[nodiscard]] const T *operator->() const noexcept { return get(); }
+
+    /**
+     * @brief Mark the page dirty without touching it, e.g. after writing through a kept pointer.
+     */
+    void markDirty() noexcept
+      requires Exclusive
+    {
+      dirty = true;
+    }
+
+  private:
+    /**
+     * @brief Adopt a page that is already pinned and latched.
+     * @param pool The pool holding the page.
+     * @param page The page.
+     * @param dirty Whether the page is dirty from the start.
+     */
+    BasicPageGuard(BufferPool &pool, T *page, bool dirty) noexcept
+        : PageGuardBase(pool, page, Exclusive, dirty) {}
+  };
+
+  /**
+   * @brief A guard holding a shared latch.
+   * @tparam T The page class, Page for any type.
+   */
+  template <typename T = storage::Page> using ReadPageGuard = BasicPageGuard<T, false>;
+
+  /**
+   * @brief A guard holding the exclusive latch.
+   * @tparam T The page class, Page for any type.
+   */
+  template <typename T = storage::Page> using WritePageGuard = BasicPageGuard<T, true>;
+} // namespace pulse::cache
+
+#endif // PULSEDB_CACHE_PAGE_GUARD_HPP
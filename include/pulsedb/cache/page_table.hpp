@@ -0,0 +1,136 @@
+/**
+ * @file include/pulsedb/cache/page_table.hpp
+ * @brief The PageTable class used in the cache system. Maps page IDs to frame indices.
+ */
+
+#ifndef PULSEDB_CACHE_PAGE_TABLE_HPP
+#define PULSEDB_CACHE_PAGE_TABLE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+/**
+ * @namespace pulse::cache
+ * @brief The namespace for the cache system.
+ */
+namespace pulse::cache {
+  /**
+   * @class PageTable
+   * @brief Open addressing hash table from page IDs to frame indices.
+   *
+   * Lookups never lock. Inserts and erases must be serialized by the caller. A writer can move an
+   * entry while a lookup probes past it, so a lookup may miss a page that is present. It never
+   * reports a mapping that was not there at some point. Callers treat a miss as a hint to retry
+   * under their lock, and check a hit against the frame.
+   */
+  class PageTable {
+  public:
+    /**
+     * @brief Constructs a new page table.
+     * @param capacity Maximum number of entries, the table is sized to stay at most half full.
+     */
+    explicit PageTable(size_t capacity);
+
+    // Disable copy operations.
+    PageTable(const PageTable &) = delete;
+    PageTable &operator=(const PageTable &) = delete;
+
+    /**
+     * @brief Look up the frame holding a page.
+     * @param pageId The ID of the page.
+     * @return The frame index, or nullopt if not found.
+     */
+    [[nodiscard]] std::optional<size_t> find(uint32_t pageId) const noexcept;
+
+    /**
+     * @brief Insert or update the frame for a page.
+     * @param pageId The ID of the page.
+     * @param frameId The frame holding the page.
+     * @return True if inserted or updated, false if the table is full.
+     */
+    bool insert(uint32_t pageId, size_t frameId) noexcept;
+
+    /**
+     * @brief Remove a page from the table.
+     * @param pageId The ID of the page.
+     * @return True if the page was found and removed, otherwise false.
+     */
+    bool erase(uint32_t pageId) noexcept;
+
+    /**
+     * @brief Get the number of entries.
+     * @return Number of pages in the table.
+     * @note Only exact when read by a writer.
+     */
+    [[nodiscard]] size_t size() const noexcept { return count.load(std::memory_order_relaxed); }
+
+  private:
+    static constexpr uint64_t EMPTY = UINT64_MAX; /**< Marks an unused slot. */
+    static constexpr size_t SLOTS_PER_BUCKET = 8; /**< Slots sharing one cache line. */
+
+    /**
+     * @struct Bucket
+     * @brief A cache line of slots, probed together.
+     */
+    struct alignas(64) Bucket {
+      std::atomic<uint64_t> slots[SLOTS_PER_BUCKET]; /**< Packed page ID and frame index. */
+    };
+
+    /**
+     * @brief Get the slot at a probe position.
+     * @param index The slot index.
+     * @return The slot.
+     */
+    [[nodiscard]] std::atomic<uint64_t> &slot(size_t index) const noexcept {
+      return buckets[index / SLOTS_PER_BUCKET].slots[index % SLOTS_PER_BUCKET];
+    }
+
+    /**
+     * @brief Get the first slot a page probes.
+     * @param pageId The ID of the page.
+     * @return The home slot index.
+     */
+    [[nodiscard]] size_t home(uint32_t pageId) const noexcept;
+
+    /**
+     * @brief Find the slot holding a page.
+     * @param pageId The ID of the page.
+     * @return The slot index, or nullopt if not found.
+     */
+    [[nodiscard]] std::optional<size_t> locate(uint32_t pageId) const noexcept;
+
+    /**
+     * @brief Pack a page ID and frame index into a slot value.
+     * @param pageId The ID of the page.
+     * @param frameId The frame holding the page.
+     * @return The slot value.
+     */
+    static uint64_t pack(uint32_t pageId, size_t frameId) noexcept {
+      return (static_cast<uint64_t>(pageId) << 32) | static_cast<uint32_t>(frameId);
+    }
+
+    /**
+     * @brief Get the page ID of a slot value.
+     * @param entry The slot value.
+     * @return The page ID.
+     */
+    static uint32_t keyOf(uint64_t entry) noexcept { return static_cast<uint32_t>(entry >> 32); }
+
+    /**
+     * @brief Get the frame index of a slot value.
+     * @param entry The slot value.
+     * @return The frame index.
+     */
+    static size_t valueOf(uint64_t entry) noexcept { return static_cast<uint32_t>(entry); }
+
+    std::unique_ptr<Bucket[]> buckets; /**< Slot storage, one cache line per bucket. */
+    size_t mask;                       /**< Slot count minus one. */
+    unsigned shift;                    /**< Hash shift to keep the top bits. */
+    std::atomic<size_t> count;         /**< Number of entries. */
+  };
+} // namespace pulse::cache
+
+#endif // PULSEDB_CACHE_PAGE_TABLE_HPP
@@ -0,0 +1,70 @@
+/**
+ * @file include/pulsedb/cache/policies/clock_replacer.hpp
+ * @brief The ClockReplacer class for buffer pool page replacement.
+ */
+
+#ifndef PULSEDB_CACHE_POLICIES_CLOCK_REPLACER_HPP
+#define PULSEDB_CACHE_POLICIES_CLOCK_REPLACER_HPP
+
+#include "pulsedb/cache/replacer.hpp"
+
+#include <atomic>
+#include <memory>
+
+/**
+ * @namespace pulse::cache
+ * @brief The namespace for the cache system.
+ */
+namespace pulse::cache {
+  /**
+   * @class ClockReplacer
+   * @brief CLOCK (second chance) page replacement implementation.
+   *
+   * Each frame has a state byte in a flat array, so pin and unpin are a single atomic store and
+   * never allocate or lock. Only the sweep in victim() is serialized.
+   */
+  class ClockReplacer : public Replacer {
+  public:
+    /**
+     * @brief Constructs a new CLOCK replacer.
+     * @param capacity Number of frames tracked, larger frame IDs are ignored.
+     */
+    explicit ClockReplacer(size_t capacity);
+
+    /**
+     * @brief Remove a frame from replacement consideration.
+     * @param frameId The ID of the frame to remove.
+     */
+    void pin(size_t frameId) override;
+
+    /**
+     * @brief Record a frame access, setting its reference bit.
+     * @param frameId The ID of the frame that was accessed.
+     */
+    void unpin(size_t frameId) override;
+
+    /**
+     * @brief Sweep the clock hand to the first unreferenced frame, clearing references on the way.
+     * @return The ID of the victim frame, or nullopt if no frames available.
+     */
+    [[nodiscard]] std::optional<size_t> victim() override;
+
+    /**
+     * @brief Peek at the frames that would be evicted next.
+     * @param count Maximum number of frames to return.
+     * @return Frame IDs, next victim first.
+     */
+    [[nodiscard]] std::vector<size_t> candidates(size_t count) const override;
+
+  private:
+    static constexpr uint8_t EVICTABLE = 1 << 0;  /**< Frame is a replacement candidate. */
+    static constexpr uint8_t REFERENCED = 1 << 1; /**< Frame was accessed since the last sweep. */
+
+    std::unique_ptr<std::atomic<uint8_t>[]> states; /**< Per-frame state bits. */
+    size_t capacity;                                /**< Number of frames tracked. */
+    size_t hand;                                    /**< Current clock hand position. */
+    mutable std::mutex mutex;                       /**< Serializes the sweep. */
+  };
+} // namespace pulse::cache
+
+#endif // PULSEDB_CACHE_POLICIES_CLOCK_REPLACER_HPP
@@ -42,6 +42,13 @@ namespace pulse::cache {
      */
     [[nodiscard]] std::optional<size_t> victim() override;
 
+    /**
+     * @brief Peek at the frames that would be evicted next.
+     * @param count Maximum number of frames to return.
+     * @return Frame IDs, next victim first.
+     */
+    [[nodiscard]] std::vector<size_t> candidates(size_t count) const override;
+
   private:
     mutable std::mutex mutex;    /**< Mutex for thread safety. */
     std::list<size_t> frameList; /**< List of frame IDs in LRU order. */
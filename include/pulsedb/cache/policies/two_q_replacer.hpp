@@ -0,0 +1,117 @@
+/**
+ * @file include/pulsedb/cache/policies/two_q_replacer.hpp
+ * @brief The TwoQReplacer class for buffer pool page replacement.
+ */
+
+#ifndef PULSEDB_CACHE_POLICIES_TWO_Q_REPLACER_HPP
+#define PULSEDB_CACHE_POLICIES_TWO_Q_REPLACER_HPP
+
+#include "pulsedb/cache/replacer.hpp"
+
+#include <vector>
+
+/**
+ * @namespace pulse::cache
+ * @brief The namespace for the cache system.
+ */
+namespace pulse::cache {
+  /**
+   * @class TwoQReplacer
+   * @brief Scan resistant 2Q page replacement implementation.
+   *
+   * A frame seen once sits in a FIFO probation queue, and only moves to the LRU main queue when
+   * it is accessed again. Victims come from the probation queue first while it holds more than a
+   * quarter of the frames, so a sequential scan only ever evicts pages of the same scan. Both
+   * queues are intrusive lists over flat arrays, nothing is allocated after construction.
+   */
+  class TwoQReplacer : public Replacer {
+  public:
+    /**
+     * @brief Constructs a new 2Q replacer.
+     * @param capacity Number of frames tracked, larger frame IDs are ignored.
+     */
+    explicit TwoQReplacer(size_t capacity);
+
+    /**
+     * @brief Remove a frame from replacement consideration, forgetting its history.
+     * @param frameId The ID of the frame to remove.
+     */
+    void pin(size_t frameId) override;
+
+    /**
+     * @brief Record a frame access, promoting frames seen before to the main queue.
+     * @param frameId The ID of the frame that was accessed.
+     */
+    void unpin(size_t frameId) override;
+
+    /**
+     * @brief Get the oldest probation frame, or the least recently used main frame.
+     * @return The ID of the victim frame, or nullopt if no frames available.
+     */
+    [[nodiscard]] std::optional<size_t> victim() override;
+
+    /**
+     * @brief Peek at the frames that would be evicted next.
+     * @param count Maximum number of frames to return.
+     * @return Frame IDs, next victim first.
+     */
+    [[nodiscard]] std::vector<size_t> candidates(size_t count) const override;
+
+  private:
+    static constexpr size_t NONE = SIZE_MAX; /**< Null link. */
+
+    /**
+     * @enum Queue
+     * @brief The queue a frame is on.
+     */
+    enum class Queue : uint8_t {
+      NONE,      /**< Not tracked. */
+      PROBATION, /**< Seen once, FIFO. */
+      MAIN       /**< Seen more than once, LRU. */
+    };
+
+    /**
+     * @struct List
+     * @brief Head, tail and length of an intrusive list, newest at the head.
+     */
+    struct List {
+      size_t head = NONE; /**< Most recently inserted frame. */
+      size_t tail = NONE; /**< Least recently inserted frame. */
+      size_t size = 0;    /**< Number of frames. */
+    };
+
+    /**
+     * @brief Get the list of a queue.
+     * @param queue The queue.
+     * @return The list holding the queue.
+     */
+    [[nodiscard]] List &listOf(Queue queue) noexcept {
+      return queue == Queue::MAIN ? main : probation;
+    }
+
+    /**
+     * @brief Push a frame at the head of a queue.
+     * @param frameId The ID of the frame.
+     * @param queue The queue to push to.
+     */
+    void push(size_t frameId, Queue queue) noexcept;
+
+    /**
+     * @brief Unlink a frame from the queue it is on.
+     * @param frameId The ID of the frame.
+     */
+    void unlink(size_t frameId) noexcept;
+
+    std::vector<size_t> prev;  /**< Links towards the head. */
+    std::vector<size_t> next;  /**< Links towards the tail. */
+    std::vector<Queue> queues; /**< Queue of each frame. */
+
+    List probation;         /**< Frames seen once. */
+    List main;              /**< Frames seen more than once. */
+    size_t probationTarget; /**< Probation size victims are taken from first. */
+
+    mutable std::mutex mutex; /**< Mutex for thread safety. */
+  };
+} // namespace pulse::cache
+
+#endif // PULSEDB_CACHE_POLICIES_TWO_Q_REPLACER_HPP
@@ -6,16 +6,39 @@
 #ifndef PULSEDB_CACHE_REPLACER_HPP
 #define PULSEDB_CACHE_REPLACER_HPP
 
+#include "pulsedb/utils/metrics.hpp"
+
 #include <list>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <unordered_map>
+#include <vector>
 
 /**
  * @namespace pulse::cache
  * @brief The namespace for the cache system.
  */
 namespace pulse::cache {
+  /**
+   * @enum ReplacerPolicy
+   * @brief The page replacement policies a buffer pool can use.
+   */
+  enum class ReplacerPolicy {
+    LRU,   /**< Least recently used. */
+    CLOCK, /**< Second chance sweep over per-frame reference bits. */
+    TWO_Q  /**< Scan resistant 2Q with probation and main queues. */
+  };
+
+  /**
+   * @struct ReplacerStats
+   * @brief Counters of a replacer.
+   */
+  struct ReplacerStats {
+    uint64_t victims = 0;   /**< Frames handed out for eviction. */
+    uint64_t exhausted = 0; /**< Victim requests with no frame to hand out. */
+  };
+
   /**
    * @class Replacer
    * @brief Abstract interface for page replacement policies.
@@ -41,6 +64,44 @@ namespace pulse::cache {
      * @return The frame ID to evict, or nullopt if no frames are available.
      */
     [[nodiscard]] virtual std::optional<size_t> victim() = 0;
+
+    /**
+     * @brief Peek at the frames that would be evicted next, without removing them.
+     * @param count Maximum number of frames to return.
+     * @return Frame IDs, next victim first.
+     */
+    [[nodiscard]] virtual std::vector<size_t> candidates(size_t count) const = 0;
+
+    /**
+     * @brief Get the counters of the replacer.
+     * @return A snapshot of the counters.
+     */
+    [[nodiscard]] ReplacerStats stats() const noexcept {
+      return {victims.value(), exhausted.value()};
+    }
+
+    /**
+     * @brief Create a replacer for the given policy.
+     * @param policy The replacement policy.
+     * @param capacity Number of frames the replacer has to track.
+     * @return The replacer.
+     */
+    static std::unique_ptr<Replacer> create(ReplacerPolicy policy, size_t capacity);
+
+  protected:
+    /**
+     * @brief Count the outcome of a victim request.
+     * @param victimId The frame handed out, nullopt if none.
+     * @return The victim ID, unchanged.
+     */
+    std::optional<size_t> counted(std::optional<size_t> victimId) noexcept {
+      (victimId ? victims : exhausted).add();
+      return victimId;
+    }
+
+  private:
+    utils::Counter victims;   /**< Frames handed out for eviction. */
+    utils::Counter exhausted; /**< Victim requests with no frame to hand out. */
   };
 } // namespace pulse::cache
 
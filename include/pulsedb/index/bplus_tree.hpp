@@ -0,0 +1,295 @@
+/**
+ * @file include/pulsedb/index/bplus_tree.hpp
+ * @brief The BPlusTree class used in the index system. A concurrent B+ tree of index pages kept
+ * in the buffer pool.
+ *
+ * Internal entries hold the lowest key routed to their child, leaves hold the key and the value.
+ * The root never moves: when it splits its entries move into two new children, and when it is
+ * left with a single child that child is pulled back up into it. Parent pointers aren't kept,
+ * every operation remembers the path it descended instead.
+ *
+ * Descents first go down optimistically: internal nodes are read with no pin and no latch and
+ * validated against their frame's version, and only the leaf is latched, once its parent is
+ * known to still route to it. Lookups read the leaf the same way, so a reader of a resident tree
+ * writes to no shared cache line at all. A descent that meets a writer a few times in a row, or
+ * a node that isn't resident, falls back to latch coupling.
+ *
+ * Optimistic descents follow swips, from the tree to the root's frame and from each internal
+ * node's frame to its children's, so a hot tree is walked without touching the page table. A
+ * swip left behind by an eviction is found out by the frame it names and pointed at the page's
+ * new frame.
+ *
+ * Latches are crabbed from the root down and from left to right along a level, so no two
+ * operations ever wait on each other in opposite orders. Writers first descend optimistically,
+ * with an exclusive latch only on the leaf. Only when the leaf would split or merge do they
+ * start over, latching exclusively and holding on to the ancestors a structural change could
+ * reach.
+ *
+ * Leaves are allocated from extents of their own, so the leaves split off one another lie next
+ * to each other on disk and a range scan over them reads ahead sequentially.
+ */
+
+#ifndef PULSEDB_INDEX_BPLUS_TREE_HPP
+#define PULSEDB_INDEX_BPLUS_TREE_HPP
+
+#include "pulsedb/cache/buffer_pool.hpp"
+#include "pulsedb/storage/extent_allocator.hpp"
+#include "pulsedb/storage/index_page.hpp"
+#include "pulsedb/utils/logger.hpp"
+#include "pulsedb/wal/log_manager.hpp"
+
+#include <optional>
+#include <vector>
+
+/**
+ * @namespace pulse::index
+ * @brief The namespace for the index system.
+ */
+namespace pulse::index {
+  /**
+   * @class BPlusTree
+   * @brief A B+ tree mapping unique keys to page IDs.
+   * @note Page ID 0 means "no sibling" in index pages, so only the root may live in page 0.
+   */
+  class BPlusTree {
+    friend class BulkLoader; // Allow the bulk loader to install the root it built.
+    friend class RangeScan;  // Allow range scans to walk the leaves themselves.
+
+  public:
+    /**
+     * @brief Opens an existing tree or creates an empty one.
+     * @param pool The buffer pool holding the tree's pages.
+     * @param rootPageId The root of an existing tree, or nullopt to create a new tree.
+     * @param log Write-ahead log to log changed pages to, or nullptr.
+     * @throws std::runtime_error if the root can't be created or isn't an index page.
+     */
+    explicit BPlusTree(
+        cache::BufferPool &pool,
+        std::optional<uint32_t> rootPageId = std::nullopt,
+        wal::LogManager *log = nullptr
+    );
+
+    // Disable copy operations.
+    BPlusTree(const BPlusTree &) = delete;
+    BPlusTree &operator=(const BPlusTree &) = delete;
+
+    /**
+     * @brief Look up a key.
+     * @param key Key to look up.
+     * @return Page ID associated with the key, nullopt if not found.
+     */
+    [[nodiscard]] std::optional<uint32_t> lookup(uint64_t key);
+
+    /**
+     * @brief Insert a new key.
+     * @param key Key to insert.
+     * @param pageId Page ID to associate with the key.
+     * @return True if inserted, false if the key exists or the pool ran out of frames.
+     */
+    bool insert(uint64_t key, uint32_t pageId);
+
+    /**
+     * @brief Remove a key.
+     * @param key Key to remove.
+     * @return True if removed, false if not found.
+     */
+    bool remove(uint64_t key);
+
+    /**
+     * @brief Get the page IDs of all keys in a range.
+     * @param startKey Start of range (inclusive).
+     * @param endKey End of range (inclusive).
+     * @return Vector of page IDs in key order.
+     * @note Use a RangeScan to stream large ranges instead of collecting them.
+     */
+    [[nodiscard]] std::vector<uint32_t> range(uint64_t startKey, uint64_t endKey);
+
+    /**
+     * @brief Getters for the tree class.
+     * @{
+     */
+
+    /**
+     * @brief Get the root page ID of the tree, used to reopen it.
+     * @return The root page ID.
+     */
+    [[nodiscard]] uint32_t rootPageId() const noexcept { return rootId; }
+
+    /**
+     * @brief Get the height of the tree.
+     * @return Number of levels, 1 while the root is a leaf.
+     */
+    [[nodiscard]] uint16_t height();
+
+    /** @} */
+
+  private:
+    static constexpr int OPTIMISTIC_ATTEMPTS = 4; /**< Optimistic descents before latching. */
+
+    /**
+     * @struct Node
+     * @brief A pinned and latched tree page.
+     */
+    struct Node {
+      uint32_t id;              /**< The page ID. */
+      storage::IndexPage *page; /**< The page in the pool. */
+      bool exclusive;           /**< Whether the latch is exclusive. */
+      bool dirty;               /**< Whether the page was modified. */
+    };
+
+    /**
+     * @struct Descent
+     * @brief Where an optimistic descent got to.
+     */
+    struct Descent {
+      uint32_t leafId;                             /**< The leaf that could hold the key. */
+      std::optional<cache::OptimisticRead> parent; /**< Read of its parent, none for the root. */
+      cache::Swip *swip;                           /**< Swip of the leaf, if any. */
+    };
+
+    /**
+     * @brief Pin and latch a page of the tree.
+     * @param pageId The ID of the page.
+     * @param exclusive Whether to latch for writing.
+     * @return The latched node, or nullopt if the page can't be fetched.
+     */
+    std::optional<Node> acquire(uint32_t pageId, bool exclusive);
+
+    /**
+     * @brief Create, pin and exclusively latch a new tree page.
+     * @param isLeaf Whether the page is a leaf.
+     * @param level Level of the page in the tree.
+     * @return The latched node, or nullopt if the pool ran out of frames.
+     */
+    std::optional<Node> create(bool isLeaf, uint16_t level);
+
+    /**
+     * @brief Unlatch and unpin a node, logging it first if it was modified.
+     * @param node The node to release.
+     */
+    void release(Node &node);
+
+    /**
+     * @brief Release every node of a path, top-down.
+     * @param path The nodes to release.
+     */
+    void release(std::vector<Node> &path);
+
+    /**
+     * @brief Descend from the root to the leaf that could hold a key.
+     * @param key The key to look for.
+     * @param exclusiveLeaf Whether to latch the leaf exclusively, internal nodes are shared.
+     * @return The latched leaf, or nullopt if a page can't be fetched.
+     */
+    std::optional<Node> findLeaf(uint64_t key, bool exclusiveLeaf);
+
+    /**
+     * @brief Descend to the leaf that could hold a key, without pinning or latching any node.
+     * @param key The key to look for.
+     * @return The leaf and the read of its parent, still to be validated once the leaf is read
+     * or latched. Nullopt if a node was changing or isn't resident.
+     */
+    [[nodiscard]] std::optional<Descent> descend(uint64_t key) const;
+
+    /**
+     * @brief Find the leaves following the one that could hold a key, from their parents.
+     * @param key The key to look for.
+     * @param endKey The last key of interest, leaves holding only larger keys are left out.
+     * @param count Maximum number of leaves to find.
+     * @return Up to count leaf page IDs in key order, fewer near the end of the tree.
+     */
+    [[nodiscard]] std::vector<uint32_t> leavesAfter(uint64_t key, uint64_t endKey, size_t count);
+
+    /**
+     * @brief Descend exclusively, keeping every ancestor a change to the leaf could reach.
+     * @param key The key to look for.
+     * @param safe Tells whether a node absorbs the change without touching its parent.
+     * @return The latched path, the leaf last. Empty if a page can't be fetched.
+     */
+    template <typename Safe> std::vector<Node> findPath(uint64_t key, Safe &&safe);
+
+    /**
+     * @brief Insert with exclusive latches, splitting nodes along the path.
+     * @param key Key to insert.
+     * @param pageId Page ID to associate with the key.
+     * @return True if inserted, otherwise false.
+     */
+    bool insertPessimistic(uint64_t key, uint32_t pageId);
+
+    /**
+     * @brief Remove with exclusive latches, merging nodes along the path.
+     * @param key Key to remove.
+     * @return True if removed, otherwise false.
+     */
+    bool removePessimistic(uint64_t key);
+
+    /**
+     * @brief Split a full node, moving its upper half into a new right sibling.
+     * @param node The full node.
+     * @param pending An entry the node had no room for, inserted into the half it belongs to.
+     * @return The separator key and ID of the new sibling, or nullopt if it can't be created.
+     */
+    std::optional<std::pair<uint64_t, uint32_t>>
+    split(Node &node, std::optional<std::pair<uint64_t, uint32_t>> pending = std::nullopt);
+
+    /**
+     * @brief Split the full root into two new children.
+     * @param root The full root.
+     * @param pending An entry the root had no room for, inserted into the child it belongs to.
+     * @return True if split, otherwise false.
+     */
+    bool
+    splitRoot(Node &root, std::optional<std::pair<uint64_t, uint32_t>> pending = std::nullopt);
+
+    /**
+     * @brief Merge an under-full node with its right sibling under the same parent.
+     * @param parent The parent of the node.
+     * @param node The under-full node.
+     * @return True if merged, false if there's no sibling or the entries don't fit.
+     */
+    bool mergeRight(Node &parent, Node &node);
+
+    /**
+     * @brief Pull the only child of the root up into the root.
+     * @param path The latched path, starting at the root which holds a single entry.
+     * @return True if collapsed, otherwise false.
+     */
+    bool collapseRoot(std::vector<Node> &path);
+
+    /**
+     * @brief Point the back link of a node's right sibling at the node.
+     * @param node The node, latched exclusively.
+     * @return True if relinked or there's no right sibling, otherwise false.
+     */
+    bool relinkNext(Node &node);
+
+    /**
+     * @brief Check if a node takes one more entry without splitting.
+     * @param page The node's page.
+     * @return True if safe, otherwise false.
+     * @note The entry isn't known yet, only a node below what the widest encoding holds takes
+     * any entry.
+     */
+    [[nodiscard]] static bool safeForInsert(const storage::IndexPage &page) noexcept {
+      return page.itemCount() + 1u < storage::IndexPage::minCapacity();
+    }
+
+    /**
+     * @brief Check if a node loses one entry without under-flowing.
+     * @param page The node's page.
+     * @return True if safe, otherwise false.
+     */
+    [[nodiscard]] static bool safeForRemove(const storage::IndexPage &page) noexcept {
+      return page.itemCount() > storage::IndexPage::minEntries() + 1;
+    }
+
+    cache::BufferPool &pool;         /**< Buffer pool holding the pages. */
+    wal::LogManager *log;            /**< Write-ahead log, if any. */
+    uint32_t rootId;                 /**< The root page, never moves. */
+    mutable cache::Swip rootSwip;    /**< Swip of the root page. */
+    storage::ExtentAllocator leaves; /**< Extents the leaves are allocated from. */
+    utils::Logger logger;            /**< Logger instance. */
+  };
+} // namespace pulse::index
+
+#endif // PULSEDB_INDEX_BPLUS_TREE_HPP
@@ -0,0 +1,173 @@
+/**
+ * @file include/pulsedb/index/bulk_loader.hpp
+ * @brief The BulkLoader class used in the index system. Loads a sorted stream of records into
+ * data pages and builds the B+ tree over them bottom-up.
+ *
+ * Records are packed into data pages until each is full, and every record's key goes into the
+ * leaf being filled. A full leaf is sealed and its first key is pushed into the level above, so
+ * every level is built left to right without a single split. Only one page per level is open at
+ * a time.
+ *
+ * Sealed pages bypass the buffer pool and the log. They are collected and written in batches,
+ * with runs of consecutive pages coalesced into single writes, and synced before the finished
+ * top level is copied into the tree's root. Pages are allocated from extents, so each batch is
+ * consecutive even when the database has free pages scattered about.
+ */
+
+#ifndef PULSEDB_INDEX_BULK_LOADER_HPP
+#define PULSEDB_INDEX_BULK_LOADER_HPP
+
+#include "pulsedb/index/bplus_tree.hpp"
+#include "pulsedb/storage/data_page.hpp"
+#include "pulsedb/storage/disk_manager.hpp"
+#include "pulsedb/storage/extent_allocator.hpp"
+#include "pulsedb/utils/logger.hpp"
+
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+/**
+ * @namespace pulse::index
+ * @brief The namespace for the index system.
+ */
+namespace pulse::index {
+  /**
+   * @class BulkLoader
+   * @brief Loads records in key order into an empty tree.
+   * @note The tree must not be used by anyone else until the load is finished.
+   */
+  class BulkLoader {
+  public:
+    static constexpr double DEFAULT_FILL_FACTOR = 0.9; /**< Share of a tree node to fill. */
+    static constexpr size_t DEFAULT_BATCH_PAGES = 256; /**< Sealed pages per write batch. */
+
+    /**
+     * @brief Prepares a load into an empty tree.
+     * @param diskManager The disk manager of the tree's buffer pool.
+     * @param tree The tree to load into, must be empty.
+     * @param fillFactor Share of each tree node to fill, leaving room for later inserts.
+     * @param batchPages Number of sealed pages to collect before writing them.
+     * @throws std::runtime_error if the tree isn't empty.
+     */
+    BulkLoader(
+        storage::DiskManager &diskManager,
+        BPlusTree &tree,
+        double fillFactor = DEFAULT_FILL_FACTOR,
+        size_t batchPages = DEFAULT_BATCH_PAGES
+    );
+
+    // Disable copy operations.
+    BulkLoader(const BulkLoader &) = delete;
+    BulkLoader &operator=(const BulkLoader &) = delete;
+
+    /**
+     * @brief Add the next records of the stream.
+     * @param records Records with strictly increasing keys, all above the keys added before.
+     * @return True if added, false if the keys are out of order, a record doesn't fit an empty
+     * page, a write fails or the load is finished. Nothing is added when the keys are rejected.
+     */
+    bool add(std::span<const storage::BulkRecord> records);
+
+    /**
+     * @brief Write every open page and install the tree's new root.
+     * @return True if finished, false if a write fails or the load was already finished.
+     */
+    bool finish();
+
+    /**
+     * @brief Getters for the bulk loader class.
+     * @{
+     */
+
+    /**
+     * @brief Get the number of records added so far.
+     * @return The record count.
+     */
+    [[nodiscard]] size_t recordCount() const noexcept { return recordsAdded; }
+
+    /**
+     * @brief Get the number of pages written so far.
+     * @return The page count.
+     */
+    [[nodiscard]] size_t pageCount() const noexcept { return pagesWritten; }
+
+    /** @} */
+
+  private:
+    /**
+     * @struct Level
+     * @brief The node being filled on one level of the tree.
+     */
+    struct Level {
+      std::unique_ptr<storage::IndexPage> page; /**< The open node. */
+      size_t sealed;                            /**< Nodes of the level sealed so far. */
+    };
+
+    /**
+     * @brief Add an entry to the open node of a level, sealing the node first if it's full.
+     * @param level The level, 0 for the leaves.
+     * @param key The entry's key.
+     * @param pageId The entry's page ID.
+     * @return True if added, false if a write fails.
+     */
+    bool push(size_t level, uint64_t key, uint32_t pageId);
+
+    /**
+     * @brief Get the entries to fill an open node with, once it takes an entry.
+     * @param page The open node.
+     * @param key The entry's key.
+     * @param pageId The entry's page ID.
+     * @return Entries to seal the node at, its capacity depends on how its entries pack.
+     */
+    [[nodiscard]] size_t
+    nodeEntries(const storage::IndexPage &page, uint64_t key, uint32_t pageId) const noexcept;
+
+    /**
+     * @brief Seal the open node of a level, handing its first key to the level above.
+     * @param level The level.
+     * @param nextId The page of the level's next node, or 0 if it's the last.
+     * @return True if sealed, false if a write fails.
+     */
+    bool seal(size_t level, uint32_t nextId);
+
+    /**
+     * @brief Seal the open data page and add its keys to the leaves.
+     * @return True if sealed, false if a write fails.
+     */
+    bool sealData();
+
+    /**
+     * @brief Queue a sealed page for writing, writing the batch once it's full.
+     * @param page The sealed page.
+     * @return True if queued, false if a write fails.
+     */
+    bool write(std::unique_ptr<storage::Page> page);
+
+    /**
+     * @brief Write every queued page.
+     * @return True if written, false if a write fails.
+     */
+    bool writeBatch();
+
+    storage::DiskManager &diskManager; /**< Disk manager to allocate and write pages with. */
+    BPlusTree &tree;                   /**< The tree being loaded. */
+    double fillFactor;                 /**< Share of each tree node to fill. */
+    size_t batchPages;                 /**< Sealed pages per write batch. */
+    storage::ExtentAllocator pages;    /**< Extents the loaded pages are allocated from. */
+
+    std::unique_ptr<storage::DataPage> dataPage;       /**< The open data page, if any. */
+    std::vector<uint32_t> dataKeys;                    /**< Keys in the open data page. */
+    std::vector<Level> levels;                         /**< The open node of each level. */
+    std::vector<std::unique_ptr<storage::Page>> batch; /**< Sealed pages waiting to be written. */
+
+    std::optional<uint32_t> lastKey; /**< The highest key added. */
+    size_t recordsAdded;             /**< Records added. */
+    size_t pagesWritten;             /**< Pages written. */
+    bool finished;                   /**< Whether the root is installed. */
+    utils::Logger logger;            /**< Logger instance. */
+  };
+} // namespace pulse::index
+
+#endif // PULSEDB_INDEX_BULK_LOADER_HPP
@@ -0,0 +1,137 @@
+/**
+ * @file include/pulsedb/index/range_scan.hpp
+ * @brief The RangeScan class used in the index system. Streams the entries of a key range by
+ * walking the leaf chain of a B+ tree.
+ *
+ * The scan copies the matching entries of one leaf at a time and lets go of the leaf's latch
+ * before handing them out, so a slow consumer never holds up writers. It keeps only a pin on the
+ * last leaf, and moves on by latching it again and coupling into its right sibling, unless keys
+ * were merged into it in the meantime. A leaf that was merged away is noticed by the sibling's
+ * back link no longer pointing at it, and the scan descends again from the last key it copied.
+ *
+ * Leaves coming up are looked up in their parents and handed to the buffer pool for read-ahead,
+ * so the kernel reads them while the current ones are consumed. Once records are read through
+ * the scan, the data pages of every new batch of entries are read ahead as well.
+ */
+
+#ifndef PULSEDB_INDEX_RANGE_SCAN_HPP
+#define PULSEDB_INDEX_RANGE_SCAN_HPP
+
+#include "pulsedb/cache/page_guard.hpp"
+#include "pulsedb/index/bplus_tree.hpp"
+#include "pulsedb/storage/data_page.hpp"
+#include "pulsedb/utils/logger.hpp"
+
+#include <optional>
+#include <utility>
+#include <vector>
+
+/**
+ * @namespace pulse::index
+ * @brief The namespace for the index system.
+ */
+namespace pulse::index {
+  /**
+   * @struct ScanEntry
+   * @brief A key and the page ID it maps to.
+   */
+  struct ScanEntry {
+    uint64_t key;    /**< The key. */
+    uint32_t pageId; /**< The page ID stored with the key. */
+  };
+
+  /**
+   * @class RangeScan
+   * @brief A forward iterator over the keys of a tree within a range.
+   * @note Keys inserted or removed during the scan may or may not be seen, every key is returned
+   * at most once and in increasing order.
+   */
+  class RangeScan {
+  public:
+    static constexpr size_t DEFAULT_READ_AHEAD = 8; /**< Leaves to read ahead of the scan. */
+
+    /**
+     * @brief Prepares a scan, nothing is read until the first entry is asked for.
+     * @param tree The tree to scan, must outlive the scan.
+     * @param startKey Start of range (inclusive).
+     * @param endKey End of range (inclusive).
+     * @param readAhead Number of leaves to read ahead, 0 to disable read-ahead.
+     */
+    RangeScan(
+        BPlusTree &tree, uint64_t startKey, uint64_t endKey, size_t readAhead = DEFAULT_READ_AHEAD
+    );
+
+    /**
+     * @brief Unpins the pages still held.
+     */
+    ~RangeScan() noexcept;
+
+    // Disable copy operations.
+    RangeScan(const RangeScan &) = delete;
+    RangeScan &operator=(const RangeScan &) = delete;
+
+    /**
+     * @brief Get the next entry of the range.
+     * @return The entry, or nullopt once the range is exhausted or a page can't be fetched.
+     */
+    [[nodiscard]] std::optional<ScanEntry> next();
+
+    /**
+     * @brief Read the record of the entry last returned by next() from its data page.
+     * @return The record and its length, valid until next() is called. nullopt if there's no
+     * entry, the page isn't a data page or it holds no record for the key.
+     * @note The data page stays latched for reading until next() is called.
+     */
+    [[nodiscard]] std::optional<std::pair<const void *, uint16_t>> record();
+
+  private:
+    /**
+     * @brief Move on to the next leaf and copy its entries within the range.
+     * @return True if a leaf was read, false if the scan is finished.
+     */
+    bool advance();
+
+    /**
+     * @brief Latch the kept leaf again, moving on to its right sibling once it holds nothing new.
+     * @return The latched leaf, or nullopt at the end of the tree or if the scan has to descend.
+     */
+    std::optional<BPlusTree::Node> step();
+
+    /**
+     * @brief Copy the entries of a latched leaf that are within the range and not returned yet.
+     * @param leaf The leaf.
+     * @return True if later leaves may hold more of the range, otherwise false.
+     */
+    bool collect(const BPlusTree::Node &leaf);
+
+    /**
+     * @brief Read ahead the leaves following the current one, if the last window runs low.
+     */
+    void readAheadLeaves();
+
+    /**
+     * @brief Read ahead the data pages of the entries not returned yet.
+     * @param from Index of the first entry to read ahead for.
+     */
+    void readAheadRecords(size_t from);
+
+    BPlusTree &tree;                              /**< The tree being scanned. */
+    uint64_t startKey;                            /**< Start of range (inclusive). */
+    uint64_t endKey;                              /**< End of range (inclusive). */
+    size_t readAhead;                             /**< Number of leaves to read ahead. */
+    size_t leavesAhead;                           /**< Leaves read ahead past the current one. */
+    bool lastWindow;                              /**< Whether read-ahead reached the end. */
+    bool finished;                                /**< Whether the last leaf was read. */
+    bool readingRecords;                          /**< Whether to read data pages ahead. */
+    bool found;                                   /**< Whether the kept leaf came from the root. */
+    std::optional<uint64_t> lastKey;              /**< The largest key copied so far. */
+    std::optional<BPlusTree::Node> leaf;          /**< The last leaf read, pinned, not latched. */
+    std::vector<ScanEntry> entries;               /**< Entries of the last leaf read. */
+    size_t position;                              /**< Index of the next entry to return. */
+    std::optional<ScanEntry> current;             /**< The entry last returned. */
+    cache::ReadPageGuard<storage::DataPage> data; /**< Data page of the current record. */
+    utils::Logger logger;                         /**< Logger instance. */
+  };
+} // namespace pulse::index
+
+#endif // PULSEDB_INDEX_RANGE_SCAN_HPP
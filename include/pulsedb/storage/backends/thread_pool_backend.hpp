@@ -0,0 +1,69 @@
+/**
+ * @file include/pulsedb/storage/backends/thread_pool_backend.hpp
+ * @brief The ThreadPoolBackend class, a portable IOBackend built on pread/pwrite workers.
+ */
+
+#ifndef PULSEDB_STORAGE_BACKENDS_THREAD_POOL_BACKEND_HPP
+#define PULSEDB_STORAGE_BACKENDS_THREAD_POOL_BACKEND_HPP
+
+#include "pulsedb/storage/io_backend.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @namespace pulse::storage
+ * @brief The namespace for the storage system.
+ */
+namespace pulse::storage {
+  /**
+   * @class ThreadPoolBackend
+   * @brief Runs blocking positional I/O on a fixed set of worker threads.
+   */
+  class ThreadPoolBackend : public IOBackend {
+  public:
+    /**
+     * @brief Constructs a new thread pool backend.
+     * @param threads Number of worker threads.
+     */
+    explicit ThreadPoolBackend(size_t threads = 4);
+
+    /**
+     * @brief Drains queued requests and joins the workers.
+     */
+    ~ThreadPoolBackend() noexcept override;
+
+    // Disable copy operations.
+    ThreadPoolBackend(const ThreadPoolBackend &) = delete;
+    ThreadPoolBackend &operator=(const ThreadPoolBackend &) = delete;
+
+    /**
+     * @brief Queue a batch of requests under a single lock acquisition.
+     * @param requests The requests to submit.
+     */
+    void submit(std::span<IORequest> requests) override;
+
+    /**
+     * @brief Get the name of the backend.
+     * @return "thread-pool".
+     */
+    [[nodiscard]] const char *name() const noexcept override { return "thread-pool"; }
+
+  private:
+    /**
+     * @brief Worker loop, pops and executes requests until stopped.
+     */
+    void run();
+
+    std::vector<std::thread> workers; /**< Worker threads. */
+    std::deque<IORequest> queue;      /**< Pending requests. */
+    std::mutex mutex;                 /**< Guards the queue and stop flag. */
+    std::condition_variable ready;    /**< Signalled when work arrives. */
+    bool stopping;                    /**< Whether workers should exit once drained. */
+  };
+} // namespace pulse::storage
+
+#endif // PULSEDB_STORAGE_BACKENDS_THREAD_POOL_BACKEND_HPP
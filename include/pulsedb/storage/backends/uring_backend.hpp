@@ -0,0 +1,112 @@
+/**
+ * @file include/pulsedb/storage/backends/uring_backend.hpp
+ * @brief The UringBackend class, an IOBackend built directly on the Linux io_uring syscalls.
+ */
+
+#ifndef PULSEDB_STORAGE_BACKENDS_URING_BACKEND_HPP
+#define PULSEDB_STORAGE_BACKENDS_URING_BACKEND_HPP
+
+#ifdef PULSEDB_HAVE_IO_URING
+
+#  include "pulsedb/storage/io_backend.hpp"
+#  include "pulsedb/utils/logger.hpp"
+
+#  include <mutex>
+#  include <semaphore>
+#  include <thread>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+/**
+ * @namespace pulse::storage
+ * @brief The namespace for the storage system.
+ */
+namespace pulse::storage {
+  /**
+   * @class UringBackend
+   * @brief Submits batches of reads and writes through one io_uring_enter call.
+   */
+  class UringBackend : public IOBackend {
+  public:
+    /**
+     * @brief Sets up the submission and completion rings.
+     * @param queueDepth Number of submission queue entries.
+     * @throws std::runtime_error if io_uring is unavailable.
+     */
+    explicit UringBackend(uint32_t queueDepth = 128);
+
+    /**
+     * @brief Waits for in-flight requests and tears down the rings.
+     */
+    ~UringBackend() noexcept override;
+
+    // Disable copy operations.
+    UringBackend(const UringBackend &) = delete;
+    UringBackend &operator=(const UringBackend &) = delete;
+
+    /**
+     * @brief Queue the requests on the submission ring and enter the kernel once per chunk.
+     * @param requests The requests to submit.
+     */
+    void submit(std::span<IORequest> requests) override;
+
+    /**
+     * @brief Get the name of the backend.
+     * @return "io_uring".
+     */
+    [[nodiscard]] const char *name() const noexcept override { return "io_uring"; }
+
+  private:
+    struct Pending; // A request that has been handed to the kernel.
+
+    /**
+     * @brief Write a submission queue entry for the pending request.
+     * @param pending The request to prepare.
+     * @note Caller must hold the submit mutex.
+     */
+    void prepare(Pending *pending) noexcept;
+
+    /**
+     * @brief Submit the given number of prepared entries to the kernel.
+     * @param count Number of entries to submit.
+     * @note Caller must hold the submit mutex.
+     */
+    void enter(uint32_t count) noexcept;
+
+    /**
+     * @brief Completion loop, runs callbacks until the shutdown sentinel is seen.
+     */
+    void reap();
+
+    int ringFd; /**< The io_uring file descriptor. */
+
+    void *sqRing;      /**< Mapped submission ring. */
+    size_t sqRingSize; /**< Size of the submission ring mapping. */
+    uint32_t *sqHead;  /**< Submission ring head, advanced by the kernel. */
+    uint32_t *sqTail;  /**< Submission ring tail, advanced by us. */
+    uint32_t *sqMask;  /**< Submission ring index mask. */
+    uint32_t *sqArray; /**< Submission ring index array. */
+    uint32_t sqCount;  /**< Number of submission entries. */
+
+    io_uring_sqe *sqes; /**< Mapped submission queue entries. */
+    size_t sqesSize;    /**< Size of the entries mapping. */
+
+    void *cqRing;       /**< Mapped completion ring. */
+    size_t cqRingSize;  /**< Size of the completion ring mapping. */
+    uint32_t *cqHead;   /**< Completion ring head, advanced by us. */
+    uint32_t *cqTail;   /**< Completion ring tail, advanced by the kernel. */
+    uint32_t *cqMask;   /**< Completion ring index mask. */
+    io_uring_cqe *cqes; /**< Completion queue entries. */
+    uint32_t cqCount;   /**< Number of completion entries. */
+
+    std::mutex submitMutex;          /**< Serializes access to the submission ring. */
+    std::counting_semaphore<> slots; /**< Bounds requests in flight to the completion ring. */
+    std::thread reaper;              /**< Completion thread. */
+    utils::Logger logger;            /**< Logger instance. */
+  };
+} // namespace pulse::storage
+
+#endif // PULSEDB_HAVE_IO_URING
+
+#endif // PULSEDB_STORAGE_BACKENDS_URING_BACKEND_HPP
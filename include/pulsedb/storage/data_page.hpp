@@ -4,15 +4,16 @@
  *
  * Data Page Layout (Slotted page):
  * +---------------------------------+ 0x0000
- * | DataHeader (23 bytes)           |
- * |   [Base PageHeader]             | -- First 13 bytes.
- * |   freeSpaceOffset: uint16_t     | -- Start of free space.
+ * | DataHeader (29 bytes)           |
+ * |   [Base PageHeader]             | -- First 17 bytes.
+ * |   freeSpaceOffset: PageOffset   | -- Start of free space.
  * |   firstSlotOffset: uint16_t     | -- First slot location.
  * |   firstFreeSlot:   uint16_t     | -- First deleted slot.
  * |   slotCount:       uint16_t     | -- Total number of slots.
  * |   directoryCount:  uint16_t     | -- Number of dir entries.
- * +---------------------------------+ 0x0017
- * | SlotPair Directory              | -- Maps keys to slots.
+ * |   deadBytes:       uint16_t     | -- Bytes of deleted records.
+ * +---------------------------------+ 0x001D
+ * | SlotPair Directory              | -- Maps keys to slots, sorted by key.
  * |   [Variable number of pairs:]   |
  * |   struct SlotPair {             |
  * |     key:    uint32_t            | -- Record key.
@@ -42,6 +43,7 @@
 
 #include "pulsedb/storage/page.hpp"
 #include <optional>
+#include <span>
 
 /**
  * @namespace pulse::storage
@@ -54,11 +56,12 @@ namespace pulse::storage {
    * @brief Extended header for data pages.
    */
   struct DataHeader : public PageHeader {
-    uint16_t freeSpaceOffset; /**< Offset to start of free space. */
-    uint16_t firstSlotOffset; /**< Offset to start of free slot directory. */
-    uint16_t firstFreeSlot;   /**< Index of first free slot. */
-    uint16_t slotCount;       /**< Total number of slots. */
-    uint16_t directoryCount;  /**< Total number of directory entries. */
+    PageOffset freeSpaceOffset; /**< Offset to start of free space, the page size if none. */
+    uint16_t firstSlotOffset;   /**< Offset to start of free slot directory. */
+    uint16_t firstFreeSlot;     /**< Index of first free slot. */
+    uint16_t slotCount;         /**< Total number of slots. */
+    uint16_t directoryCount;    /**< Total number of directory entries. */
+    uint16_t deadBytes;         /**< Record bytes of deleted slots, given back by compaction. */
   };
 
   /**
@@ -89,6 +92,17 @@ namespace pulse::storage {
     uint16_t type;   /**< Record type identifier. */
   };
 #pragma pack(pop)
+
+  /**
+   * @struct BulkRecord
+   * @brief A record to insert in a batch, the data isn't owned.
+   */
+  struct BulkRecord {
+    uint32_t key;     /**< The key paired with the record. */
+    const void *data; /**< The record data. */
+    uint16_t length;  /**< The length of the record data. */
+    uint16_t type;    /**< The record type. */
+  };
 } // namespace pulse::storage
 
 namespace pulse::storage {
@@ -161,7 +175,21 @@ namespace pulse::storage {
     explicit DataPage(uint32_t pageId) noexcept;
 
     /**
-     * @brief Insert a record into the page.
+     * @brief Constructs a new data page with the given ID in a buffer owned by the caller.
+     * @param buffer PAGE_SIZE bytes, 64-byte aligned, that outlive the page.
+     * @param pageId The ID of the page.
+     */
+    DataPage(uint8_t *buffer, uint32_t pageId) noexcept;
+
+    /**
+     * @brief Constructs a view over a data page already held in a buffer owned by the caller.
+     * @param buffer PAGE_SIZE bytes, 64-byte aligned, that outlive the page.
+     */
+    DataPage(ViewTag, uint8_t *buffer) noexcept : Page(VIEW, buffer) {}
+
+    /**
+     * @brief Insert a record into the page, compacting it first if only deleted records are in
+     * the way.
      * @param key The key paired with the record.
      * @param data The record data.
      * @param length The length of the record data.
@@ -170,6 +198,17 @@ namespace pulse::storage {
     [[nodiscard]] std::optional<uint16_t>
     insertRecord(uint32_t key, const void *data, uint16_t length, uint16_t type);
 
+    /**
+     * @brief Insert records until the page is full.
+     *
+     * An empty page takes records sorted by key in a single pass, laying out the directory, the
+     * slots and the data without shifting anything. Other pages insert them one by one.
+     *
+     * @param records The records to insert.
+     * @return Number of leading records inserted.
+     */
+    size_t insertRecords(std::span<const BulkRecord> records);
+
     /**
      * @brief Delete the record at the given slot ID.
      * @param slotId The slot of the ID to delete.
@@ -216,14 +255,20 @@ namespace pulse::storage {
     bool clearFlag(uint16_t slotId, uint16_t flag) noexcept;
 
     /**
-     * @brief Compact the page by removing deleted records.
+     * @brief Compact the page in place by removing deleted records.
+     *
+     * Live records slide up to the end of the page, highest first, so each one only moves over
+     * space already given up. Deleted slots at the end of the slot array are dropped, the others
+     * keep their IDs and stay on the free slot list.
+     *
      * @return Number of bytes freed.
+     * @note Record pointers handed out before are invalidated.
      */
     uint16_t compact();
 
     /**
-     * @brief Check if compaction needed.
-     * @return True if fragmentation exceeds threshold.
+     * @brief Check if compaction needed, from the dead byte count alone.
+     * @return True if deleted records hold more than a quarter of the space in use.
      */
     [[nodiscard]] bool needsCompact() const noexcept;
 
@@ -243,14 +288,14 @@ namespace pulse::storage {
     [[nodiscard]] std::optional<uint16_t> findFreeSlot() noexcept;
 
     /**
-     * @brief Get slot ID from key.
+     * @brief Get slot ID from key, searching the sorted directory.
      * @param key Key to search for.
-     * @return Slot ID if found, nullopt if not.
+     * @return Slot ID if found, nullopt if not. The oldest one if the key was inserted twice.
      */
     [[nodiscard]] std::optional<uint16_t> getSlotId(uint32_t key) const;
 
     /**
-     * @brief Insert key to slot ID pair.
+     * @brief Insert key to slot ID pair, keeping the directory sorted.
      * @param key Key to insert.
      * @param slotId Slot ID to insert.
      * @return True if inserted, false if full.
@@ -258,13 +303,11 @@ namespace pulse::storage {
     bool insertPair(uint32_t key, uint16_t slotId);
 
     /**
-     * @brief Remove the last key to slot pair.
+     * @brief Remove the key to slot pair pointing at a slot.
+     * @param slotId Slot ID to remove the pair of.
+     * @return True if removed, false if no pair points at the slot.
      */
-    void removeLastPair() {
-      if (dataHeader()->directoryCount > 0) {
-        dataHeader()->directoryCount--;
-      }
-    }
+    bool removePair(uint16_t slotId);
 
     /**
      * @brief Getters for the data page class.
@@ -283,9 +326,20 @@ namespace pulse::storage {
      */
     [[nodiscard]] uint16_t directoryCount() const noexcept { return dataHeader()->directoryCount; }
 
+    /**
+     * @brief Get the bytes held by deleted records.
+     * @return The dead byte count.
+     */
+    [[nodiscard]] uint16_t deadBytes() const noexcept { return dataHeader()->deadBytes; }
+
     /** @} */
 
   private:
+    /**
+     * @brief Initialize the data header of an empty page.
+     */
+    void format() noexcept;
+
     /**
      * @brief Allocate space for record.
      * @param size Bytes needed.
@@ -293,6 +347,22 @@ namespace pulse::storage {
      */
     [[nodiscard]] std::optional<uint16_t> allocateSpace(uint16_t size) noexcept;
 
+    /**
+     * @brief Find the first directory position whose key isn't less than the given key.
+     * @param key Key to search for.
+     * @return Position in the directory, the directory count if all keys are less.
+     */
+    [[nodiscard]] uint16_t findPair(uint32_t key) const noexcept;
+
+    /**
+     * @brief Get the end of the slot array, where free space may start.
+     * @return Offset just past the last slot.
+     */
+    [[nodiscard]] uint16_t slotsEnd() const noexcept {
+      return DATA_HEADER_SIZE + (dataHeader()->directoryCount * PAIR_SIZE) +
+             (dataHeader()->slotCount * SLOT_SIZE);
+    }
+
     /**
      * @brief Const & non-const getters for data page header.
      * @{
@@ -1,14 +1,48 @@
 /**
  * @file include/pulsedb/storage/disk_manager.hpp
  * @brief The DiskManager class used in the storage system. This class manages physical page I/O.
+ *
+ * A database can be created compressed. Every page is then compressed on its own and stored in a
+ * slot that fits it, alongside a map of where each page lives. Reads decompress straight into the
+ * caller's buffer, so the rest of the system only ever sees whole pages. Slots move when a page
+ * outgrows its own, and the map is written anew on every sync that follows.
+ *
+ * A database that never changes can be opened read-only. The whole file is then mapped and
+ * prefaulted once, and pages are fetched as views straight into the mapping, with no read and no
+ * copy. Once the OS page cache is warm, reopening the file does no I/O at all.
+ *
+ * Every page written is recorded in a free space map, along with the room it has left if it's a
+ * data page. Inserts find a data page with room from the map alone, and deallocated pages go on
+ * its free list. The map is kept in special pages written on sync, so the free list survives a
+ * restart. Writing a page takes it off the free list, which keeps pages that recovery redoes from
+ * being handed out again.
+ *
+ * A new uncompressed database can be segmented: its pages then go to segment files spread over
+ * several directories, see SegmentSet, and the file only holds the header. Every directory gets
+ * an I/O queue of its own, so pages on different devices are read and written in parallel.
+ *
+ * The file grows an extent at a time: once pages are handed out past the space reserved, the
+ * next EXTENT_PAGES pages are reserved with fallocate, without changing the file's length. Pages
+ * that belong together can also be allocated as one run, see allocateExtent and ExtentAllocator,
+ * which keeps them next to each other on disk for coalesced writes and sequential readahead.
  */
 
 #ifndef PULSEDB_STORAGE_DISK_MANAGER_HPP
 #define PULSEDB_STORAGE_DISK_MANAGER_HPP
 
+#include "pulsedb/storage/free_space_map.hpp"
+#include "pulsedb/storage/io_backend.hpp"
 #include "pulsedb/storage/page.hpp"
+#include "pulsedb/storage/page_codec.hpp"
+#include "pulsedb/storage/page_map.hpp"
+#include "pulsedb/storage/segment_set.hpp"
 #include "pulsedb/utils/logger.hpp"
+#include "pulsedb/utils/metrics.hpp"
 #include <filesystem>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <vector>
 
 /**
  * @namespace pulse::storage
@@ -21,15 +55,48 @@ namespace pulse::storage {
    * @brief Header information for the database file.
    */
   struct DatabaseHeader {
-    uint32_t magic;         /**< Magic number to identify database file. */
-    uint32_t version;       /**< Database format version. */
-    uint32_t pageSize;      /**< Size of each page. */
-    uint32_t pageCount;     /**< Total number of pages. */
-    uint32_t firstFreePage; /**< First free page ID. */
-    uint64_t lastLsn;       /**< Last log sequence number. */
+    uint32_t magic;          /**< Magic number to identify database file. */
+    uint32_t version;        /**< Database format version. */
+    uint32_t pageSize;       /**< Size of each page. */
+    uint32_t pageCount;      /**< Total number of pages. */
+    uint32_t freeSpaceMap;   /**< First page of the free space map, invalid if not written. */
+    uint64_t lastLsn;        /**< Last log sequence number. */
+    Compression compression; /**< How pages are stored. */
+    uint64_t mapOffset;      /**< Offset of the page map if compressed, 0 if not written yet. */
+    uint32_t mapLength;      /**< Size of the page map in bytes. */
+    uint32_t segmentPages;   /**< Pages per segment file, 0 if the pages are in this file. */
   };
 #pragma pack(pop)
 
+  /**
+   * @enum AccessMode
+   * @brief How a database file is accessed.
+   */
+  enum class AccessMode : uint8_t {
+    READ_WRITE = 0, /**< Pages are read and written through the I/O backend. */
+    READ_ONLY = 1   /**< The file is mapped and pages are views into the mapping. */
+  };
+
+  /**
+   * @struct DiskStats
+   * @brief Counters of a disk manager.
+   */
+  struct DiskStats {
+    uint64_t pagesRead = 0;                /**< Pages read from the file. */
+    uint64_t pagesWritten = 0;             /**< Pages written to the file. */
+    uint64_t bytesRead = 0;                /**< Bytes read, pages and metadata. */
+    uint64_t bytesWritten = 0;             /**< Bytes written, pages and metadata. */
+    uint64_t syncs = 0;                    /**< Syncs of the file. */
+    utils::HistogramSnapshot readLatency;  /**< Time to read a page. */
+    utils::HistogramSnapshot writeLatency; /**< Time to write a page, or a batch at once. */
+
+    /**
+     * @brief Write the counters as Prometheus metrics.
+     * @param writer The writer to add them to.
+     */
+    void report(utils::PrometheusWriter &writer) const;
+  };
+
   /**
    * @class DiskManager
    * @brief Manages physical page I/O and database file operations.
@@ -37,15 +104,28 @@ namespace pulse::storage {
   class DiskManager {
   public:
     static const uint32_t DB_MAGIC = 0x504442; /**< "PDB" magic number for database files. */
-    static const uint32_t DB_VERSION = 1;      /**< Current database version. */
+    static const uint32_t DB_VERSION = 9;      /**< Current database version. */
     static const uint32_t INVALID_PAGE_ID = 0xDEADBEEF; /**< Invalid page ID. */
+    static constexpr uint32_t EXTENT_PAGES = 64; /**< Pages the file is reserved ahead by. */
 
     /**
      * @brief Constructs a new disk manager using the given file path.
      * @param path Path to database file.
      * @param create Whether to create a new database or use an existing one.
+     * @param mode Whether to write the database or map it read-only.
+     * @param compression How to store the pages of a new database, existing ones keep theirs.
+     * @param layout How to split a new database into segments, existing ones keep their segment
+     * size. The directories have to be given again to reopen a segmented database.
+     * @throws std::runtime_error if the database can't be opened, is created read-only, uses
+     * a codec that wasn't compiled in, or is segmented and compressed or read-only.
      */
-    explicit DiskManager(const std::filesystem::path &path, bool create = false);
+    explicit DiskManager(
+        const std::filesystem::path &path,
+        bool create = false,
+        AccessMode mode = AccessMode::READ_WRITE,
+        Compression compression = Compression::NONE,
+        const SegmentLayout &layout = {}
+    );
 
     /**
      * @brief Closes database and syncs pending writes.
@@ -61,27 +141,89 @@ namespace pulse::storage {
     DiskManager &operator=(DiskManager &&) noexcept;
 
     /**
-     * @brief Allocates a new page. If there are free pages, one is popped off the stack.
-     * @return New page ID or INVALID_PAGE_ID if allocation fails.
+     * @brief Allocates a new page. If there are free pages, one is taken off the free list.
+     * @return New page ID or INVALID_PAGE_ID if allocation fails or the database is read-only.
      */
     [[nodiscard]] uint32_t allocatePage();
 
+    /**
+     * @brief Allocates a run of new pages that follow each other on disk.
+     * @param count Number of pages in the run.
+     * @return ID of the run's first page, or INVALID_PAGE_ID if count is 0, the page IDs ran out
+     * or the database is read-only.
+     * @note The run always comes from the end of the file, the free list is left alone.
+     */
+    [[nodiscard]] uint32_t allocateExtent(uint32_t count = EXTENT_PAGES);
+
     /**
      * @brief Deallocates a page.
      * @param pageId ID of page to deallocate.
-     * @return True if successful, false if failed.
+     * @return True if successful, false if the page is invalid or already free.
      */
     bool deallocatePage(uint32_t pageId);
 
+    /**
+     * @brief Finds a data page with room for a number of bytes, without reading any page.
+     * @param bytes Number of bytes needed, the record and its directory entry.
+     * @return The fullest data page known to fit them, nullopt if none does.
+     * @note The room is as of the page's last write, an insert can still find it too full.
+     */
+    [[nodiscard]] std::optional<uint32_t> findPageWithSpace(size_t bytes);
+
+    /**
+     * @brief Grows the page count to cover pages that exist in the log but not in the header.
+     * @param count The page count to grow to, smaller counts are ignored.
+     */
+    void extendTo(uint32_t count);
+
+    /**
+     * @brief Records the log sequence number every page on disk is known to be current with.
+     * @param lsn The log sequence number, written with the header on the next sync.
+     */
+    void setLastLsn(uint64_t lsn);
+
     /**
      * @brief Reads a page from the disk.
      * @param pageId ID of page to read.
      * @return Unique pointer to page or nullptr if read fails.
+     * @note A read-only database returns views into its mapping, they must not be modified and
+     * must not outlive the disk manager.
      */
     [[nodiscard]] std::unique_ptr<Page> fetchPage(uint32_t pageId);
 
     /**
-     * @brief Forces all pending writes to disk.
+     * @brief Reads a page from the disk without blocking the caller.
+     * @param pageId ID of page to read.
+     * @return Future resolving to the page, or nullptr if the read fails.
+     */
+    [[nodiscard]] std::future<std::unique_ptr<Page>> fetchPageAsync(uint32_t pageId);
+
+    /**
+     * @brief Reads several pages, handing all reads to the I/O backend in one submission.
+     * @param pageIds IDs of pages to read.
+     * @return One future per page ID, in the same order.
+     */
+    [[nodiscard]] std::vector<std::future<std::unique_ptr<Page>>>
+    fetchPagesAsync(std::span<const uint32_t> pageIds);
+
+    /**
+     * @brief Reads a page into a buffer owned by the caller, without blocking the caller.
+     * @param pageId ID of page to read.
+     * @param buffer PAGE_SIZE bytes to read into, must stay valid until the future is ready.
+     * @return Future resolving to whether a page of a valid type was read.
+     */
+    [[nodiscard]] std::future<bool> readPageAsync(uint32_t pageId, uint8_t *buffer);
+
+    /**
+     * @brief Asks the kernel to start reading pages in the background, ahead of their fetches.
+     * @param pageIds IDs of pages that will be read soon, in any order.
+     * @return Number of pages advised, IDs past the end are skipped.
+     * @note Only a hint, runs of consecutive page IDs are advised as one range.
+     */
+    size_t prefetch(std::span<const uint32_t> pageIds);
+
+    /**
+     * @brief Forces all pending writes to disk with fdatasync.
      * @return True if successful, false if sync fails.
      */
     bool sync();
@@ -93,6 +235,28 @@ namespace pulse::storage {
      */
     bool flushPage(const Page &page);
 
+    /**
+     * @brief Writes a page to the disk without blocking the caller.
+     * @param page Page to write, must stay alive until the future is ready.
+     * @return Future resolving to whether the write succeeded.
+     */
+    [[nodiscard]] std::future<bool> flushPageAsync(const Page &page);
+
+    /**
+     * @brief Writes several pages, handing all writes to the I/O backend in one submission.
+     * @param pages Pages to write, must stay alive until the futures are ready.
+     * @return One future per page, in the same order.
+     */
+    [[nodiscard]] std::vector<std::future<bool>>
+    flushPagesAsync(std::span<const Page *const> pages);
+
+    /**
+     * @brief Writes several pages, coalescing runs of consecutive page IDs into single writes.
+     * @param pages Pages to write, in any order.
+     * @return True if successful, false if a write fails.
+     */
+    bool writePages(std::span<const Page *const> pages);
+
     /**
      * @brief Getters for the disk manager class.
      * @{
@@ -102,17 +266,267 @@ namespace pulse::storage {
      * @brief Gets the total number of pages.
      * @return Total page count.
      */
-    [[nodiscard]] uint32_t pageCount() const noexcept { return header.pageCount; }
+    [[nodiscard]] uint32_t pageCount() const noexcept;
+
+    /**
+     * @brief Gets the number of deallocated pages waiting to be reused.
+     * @return Free page count.
+     */
+    [[nodiscard]] uint32_t freePageCount() const noexcept;
+
+    /**
+     * @brief Gets the log sequence number every page on disk is current with.
+     * @return Last recorded log sequence number.
+     */
+    [[nodiscard]] uint64_t lastLsn() const noexcept;
 
     /**
-     * @brief Gets the current database file size.
-     * @return File size in bytes.
+     * @brief Gets the current database size.
+     * @return Size in bytes of the file and every open segment.
      */
     [[nodiscard]] uint64_t fileSize() const noexcept;
 
+    /**
+     * @brief Gets the name of the asynchronous I/O backend in use.
+     * @return Backend name.
+     */
+    [[nodiscard]] const char *ioBackend() const noexcept {
+      return queues.empty() ? "none" : queues.front()->name();
+    }
+
+    /**
+     * @brief Gets the number of I/O queues, one per segment directory.
+     * @return Queue count, 0 if the database is read-only.
+     */
+    [[nodiscard]] size_t queueCount() const noexcept { return queues.size(); }
+
+    /**
+     * @brief Checks if the pages are spread over segment files.
+     * @return True if segmented, false if the pages are in the database file.
+     */
+    [[nodiscard]] bool isSegmented() const noexcept { return segments != nullptr; }
+
+    /**
+     * @brief Checks if the database is mapped read-only.
+     * @return True if read-only, false otherwise.
+     */
+    [[nodiscard]] bool isReadOnly() const noexcept { return mode == AccessMode::READ_ONLY; }
+
+    /**
+     * @brief Gets how the pages are stored.
+     * @return The codec the pages are compressed with, NONE if they aren't.
+     */
+    [[nodiscard]] Compression compression() const noexcept { return header.compression; }
+
+    /**
+     * @brief Gets the I/O counters.
+     * @return A snapshot of the counters.
+     */
+    [[nodiscard]] DiskStats stats() const noexcept;
+
     /** @} */
 
   private:
+    /**
+     * @struct Metrics
+     * @brief The I/O counters, shared with the callbacks of requests in flight.
+     */
+    struct Metrics {
+      utils::Counter pagesRead;      /**< Pages read from the file. */
+      utils::Counter pagesWritten;   /**< Pages written to the file. */
+      utils::Counter bytesRead;      /**< Bytes read. */
+      utils::Counter bytesWritten;   /**< Bytes written. */
+      utils::Counter syncs;          /**< Syncs of the file. */
+      utils::Histogram readLatency;  /**< Time to read a page. */
+      utils::Histogram writeLatency; /**< Time to write a page or a batch. */
+    };
+
+    /**
+     * @struct StoredPage
+     * @brief A page encoded for a compressed database, and the slot it goes to.
+     */
+    struct StoredPage {
+      uint32_t pageId;            /**< ID of the page. */
+      uint64_t offset;            /**< Offset of the slot. */
+      std::vector<uint8_t> bytes; /**< Contents of the whole slot. */
+    };
+
+    /**
+     * @brief Checks if pages are compressed.
+     * @return True if compressed, false if stored at fixed offsets.
+     */
+    [[nodiscard]] bool isCompressed() const noexcept {
+      return header.compression != Compression::NONE;
+    }
+
+    /**
+     * @brief Finds the slot of a page in a compressed database.
+     * @param pageId ID of page to find.
+     * @return The slot, or nullopt if the page ID is invalid or the page was never written.
+     */
+    [[nodiscard]] std::optional<PageLocation> locate(uint32_t pageId) const;
+
+    /**
+     * @brief Compresses a page and finds the slot it goes to.
+     * @param page Page to store.
+     * @return The encoded page, stored uncompressed if compressing doesn't save a sector.
+     */
+    [[nodiscard]] StoredPage store(const Page &page);
+
+    /**
+     * @brief Compresses a page for a compressed database.
+     * @param page Page to encode.
+     * @return The encoded page, its slot not found yet.
+     */
+    [[nodiscard]] StoredPage encode(const Page &page) const;
+
+    /**
+     * @brief Finds the slot an encoded page goes to.
+     * @param stored The encoded page, its offset is set.
+     * @note Called with the mutex held.
+     */
+    void place(StoredPage &stored);
+
+    /**
+     * @brief Records the pages about to be written in the free space map.
+     * @param pages Pages being written.
+     */
+    void track(std::span<const Page *const> pages);
+
+    /**
+     * @brief Decodes a slot of a compressed database into a page.
+     * @param compression The codec of the database.
+     * @param slot Contents of the slot.
+     * @param capacity Size of the slot.
+     * @param buffer PAGE_SIZE bytes to decode into.
+     * @return True if decoded, false if the slot is corrupt.
+     */
+    [[nodiscard]] static bool decode(
+        Compression compression, const uint8_t *slot, size_t capacity, uint8_t *buffer
+    ) noexcept;
+
+    /**
+     * @brief Reads a page into a buffer, decompressing it if needed.
+     * @param pageId ID of page to read, already validated.
+     * @param buffer PAGE_SIZE bytes to read into.
+     * @return True if read, false otherwise.
+     */
+    bool readStored(uint32_t pageId, uint8_t *buffer) const;
+
+    /**
+     * @brief Writes the page map to new space and points the header at it.
+     * @return True if the map is durable, false if a write fails.
+     * @note Called with the mutex held.
+     */
+    bool writeMap();
+
+    /**
+     * @brief Writes the free space map to its pages, adding pages until it covers them all.
+     * @return True if written, false if a write fails.
+     * @note Called with the mutex held.
+     */
+    bool writeFreeSpaceMap();
+
+    /**
+     * @brief Reads the free space map from the pages chained from the header.
+     * @note Pages of the chain that can't be read are left out, their pages are never reused.
+     */
+    void readFreeSpaceMap();
+
+    /**
+     * @brief Finds a page in the mapping of a read-only database.
+     * @param pageId ID of page to find.
+     * @return The page's bytes, or nullptr if the page ID or type is invalid.
+     */
+    [[nodiscard]] uint8_t *mapped(uint32_t pageId) const noexcept;
+
+    /**
+     * @brief Makes a view over a page in the mapping of a read-only database.
+     * @param pageId ID of page to view.
+     * @return Typed view, or nullptr if the page ID or type is invalid.
+     */
+    [[nodiscard]] std::unique_ptr<Page> mappedPage(uint32_t pageId) const;
+
+    /**
+     * @brief Checks that writes are allowed, logging an error otherwise.
+     * @param operation What is being attempted, for the log.
+     * @return True if writable, false if the database is read-only.
+     */
+    [[nodiscard]] bool writable(const char *operation) const noexcept;
+
+    /**
+     * @brief Maps the whole file read-only and prefaults it.
+     * @throws std::runtime_error if the file can't be mapped.
+     */
+    void mapFile();
+
+    /**
+     * @brief Turns a raw page buffer into a page of the type recorded in its header.
+     * @param raw Page holding the bytes read from disk, its buffer is taken.
+     * @return Typed page, or nullptr if the page type is invalid.
+     */
+    [[nodiscard]] static std::unique_ptr<Page> materialize(Page &raw);
+
+    /**
+     * @brief Finds where an uncompressed page lives, in the file or its segment.
+     * @param pageId ID of the page.
+     * @return The descriptor and offset, nullopt if the page's segment can't be opened.
+     */
+    [[nodiscard]] std::optional<SegmentLocation> where(uint32_t pageId) const;
+
+    /**
+     * @brief Gets the I/O queue of the device a page is on.
+     * @param pageId ID of the page.
+     * @return Index into the queues.
+     */
+    [[nodiscard]] size_t queueOf(uint32_t pageId) const noexcept {
+      return segments ? segments->deviceOf(pageId) : 0;
+    }
+
+    /**
+     * @brief Checks if two pages follow each other on disk, and so can be written as one.
+     * @param pageId ID of the first page.
+     * @param nextId ID of the second page.
+     * @return True if nextId comes right after pageId in the same file.
+     */
+    [[nodiscard]] bool adjacent(uint32_t pageId, uint32_t nextId) const noexcept {
+      return segments ? segments->adjacent(pageId, nextId) : nextId == pageId + 1;
+    }
+
+    /**
+     * @brief Hands requests to the queues of the devices they go to.
+     * @param requests The requests, consumed by the call.
+     * @param devices The queue of each request.
+     */
+    void submit(std::span<IORequest> requests, std::span<const size_t> devices);
+
+    /**
+     * @brief Sets up the segment files once the header gave their size.
+     * @param directories Directories the segments are dealt to.
+     * @param create Whether the database is new.
+     * @throws std::runtime_error if the database is read-only or the segments are too small.
+     */
+    void openSegments(const std::vector<std::filesystem::path> &directories, bool create);
+
+    /**
+     * @brief Builds the asynchronous read request for a page.
+     * @param pageId ID of page to read.
+     * @param buffer PAGE_SIZE bytes to read into.
+     * @param done Invoked once with whether a page of a valid type was read.
+     * @return The request to submit, without a callback if the page ID is invalid.
+     */
+    [[nodiscard]] IORequest
+    readRequest(uint32_t pageId, uint8_t *buffer, std::function<void(bool)> done);
+
+    /**
+     * @brief Builds the asynchronous read request for a page in a buffer of its own.
+     * @param pageId ID of page to read.
+     * @param future Receives the future for the read result.
+     * @return The request to submit.
+     */
+    [[nodiscard]] IORequest
+    fetchRequest(uint32_t pageId, std::future<std::unique_ptr<Page>> &future);
+
     /**
      * @brief Reads the database header.
      * @throws std::runtime_error if header is invalid.
@@ -132,7 +546,40 @@ namespace pulse::storage {
     void initializeDatabase();
 
     /**
-     * @brief Calculates the file offset for a page.
+     * @brief Reserves room in the file for the pages below a page count, an extent at a time.
+     * @param count The page count to cover.
+     * @note Called with the mutex held. Compressed pages aren't placed by ID and segments are
+     * reserved whole, so only an uncompressed single-file database is reserved.
+     */
+    void reserve(uint32_t count) noexcept;
+
+    /**
+     * @brief Reads exactly size bytes at the given offset, retrying short reads.
+     * @param file Descriptor of the database file or a segment.
+     * @param buffer Destination buffer.
+     * @param size Number of bytes to read.
+     * @param offset Offset in bytes from start of file.
+     * @return True if all bytes were read, false otherwise.
+     */
+    bool readAt(int file, void *buffer, size_t size, uint64_t offset) const noexcept;
+
+    /**
+     * @brief Writes exactly size bytes at the given offset, retrying short writes.
+     * @param file Descriptor of the database file or a segment.
+     * @param buffer Source buffer.
+     * @param size Number of bytes to write.
+     * @param offset Offset in bytes from start of file.
+     * @return True if all bytes were written, false otherwise.
+     */
+    bool writeAt(int file, const void *buffer, size_t size, uint64_t offset) noexcept;
+
+    /**
+     * @brief Closes the database file descriptor, segments and mapping if open.
+     */
+    void close() noexcept;
+
+    /**
+     * @brief Calculates the file offset for a page of an unsegmented database.
      * @param pageId Page ID to calculate offset for.
      * @return Offset in bytes from start of file.
      */
@@ -140,12 +587,22 @@ namespace pulse::storage {
       return sizeof(DatabaseHeader) + static_cast<uint64_t>(pageId) * Page::PAGE_SIZE;
     }
 
-    bool dirty;                      /**< Whether header needs to be written. */
-    DatabaseHeader header;           /**< In-memory copy of database header. */
-    std::filesystem::path path;      /**< Path to database file. */
-    std::vector<uint32_t> freePages; /**< Stack of free page IDs. */
-    uint32_t nextPageId;             /**< Next page ID to allocate. */
-    utils::Logger logger;            /**< Logger instance. */
+    int fd;                           /**< Database file descriptor, open for the lifetime. */
+    AccessMode mode;                  /**< Whether the file is written or mapped read-only. */
+    uint8_t *mapping;                 /**< The mapped file if read-only, nullptr otherwise. */
+    size_t mappingSize;               /**< Size of the mapping in bytes. */
+    bool dirty;                       /**< Whether header needs to be written. */
+    DatabaseHeader header;            /**< In-memory copy of database header. */
+    std::filesystem::path path;       /**< Path to database file. */
+    FreeSpaceMap freeSpaceMap;        /**< Room left in each page, and the free list. */
+    uint32_t nextPageId;              /**< Next page ID to allocate. */
+    uint32_t reservedPages;           /**< Pages the file has room for without growing. */
+    utils::Logger logger;             /**< Logger instance. */
+    PageMap pageMap;                  /**< Slots of the pages if compressed. */
+    std::unique_ptr<SegmentSet> segments; /**< Segment files if segmented, nullptr otherwise. */
+    std::vector<std::unique_ptr<IOBackend>> queues; /**< I/O queue of every segment directory. */
+    std::shared_ptr<Metrics> metrics; /**< I/O counters, outlive a move. */
+    mutable std::mutex mutex;         /**< Guards the header, both maps and the free list. */
   };
 } // namespace pulse::storage
 
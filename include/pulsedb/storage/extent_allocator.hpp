@@ -0,0 +1,81 @@
+/**
+ * @file include/pulsedb/storage/extent_allocator.hpp
+ * @brief The ExtentAllocator class used in the storage system. Hands out pages one at a time
+ * from runs allocated together.
+ *
+ * Pages allocated one by one go wherever the free list or the end of the file has room, so
+ * pages created together end up scattered once the file has holes. An extent allocator takes
+ * a whole run from the disk manager at once and hands its pages out in order, so a caller that
+ * creates related pages, such as the leaves of a tree or the pages of a bulk load, gets them
+ * next to each other on disk. Pages of the last run that were never handed out go back to the
+ * free list when the allocator is released.
+ */
+
+#ifndef PULSEDB_STORAGE_EXTENT_ALLOCATOR_HPP
+#define PULSEDB_STORAGE_EXTENT_ALLOCATOR_HPP
+
+#include "pulsedb/storage/disk_manager.hpp"
+#include "pulsedb/utils/logger.hpp"
+
+#include <cstdint>
+#include <mutex>
+
+/**
+ * @namespace pulse::storage
+ * @brief The namespace for the storage system.
+ */
+namespace pulse::storage {
+  /**
+   * @class ExtentAllocator
+   * @brief Allocates pages from runs of consecutive pages.
+   * @note Thread-safe, pages handed out to different threads still come from the same run.
+   */
+  class ExtentAllocator {
+  public:
+    /**
+     * @brief Constructs an allocator, no run is taken until the first page is asked for.
+     * @param diskManager The disk manager to take runs from.
+     * @param extentPages Pages per run.
+     */
+    explicit ExtentAllocator(
+        DiskManager &diskManager, uint32_t extentPages = DiskManager::EXTENT_PAGES
+    ) noexcept;
+
+    /**
+     * @brief Hands the pages left in the run back.
+     */
+    ~ExtentAllocator() noexcept;
+
+    // Disable copy operations, the run belongs to one allocator.
+    ExtentAllocator(const ExtentAllocator &) = delete;
+    ExtentAllocator &operator=(const ExtentAllocator &) = delete;
+
+    /**
+     * @brief Allocate the next page of the run, taking a new run once it's used up.
+     * @return The page ID, or INVALID_PAGE_ID if no run can be allocated.
+     */
+    [[nodiscard]] uint32_t allocate();
+
+    /**
+     * @brief Hand the pages left in the run back to the disk manager's free list.
+     * @note The next allocation takes a new run.
+     */
+    void release();
+
+    /**
+     * @brief Get the number of pages left in the run.
+     * @return Pages that can be handed out without taking a new run.
+     */
+    [[nodiscard]] uint32_t remaining() const;
+
+  private:
+    DiskManager &diskManager; /**< Disk manager the runs are taken from. */
+    uint32_t extentPages;     /**< Pages per run. */
+    uint32_t next;            /**< Next page of the run to hand out. */
+    uint32_t end;             /**< One past the last page of the run. */
+    mutable std::mutex mutex; /**< Guards the run. */
+    utils::Logger logger;     /**< Logger instance. */
+  };
+} // namespace pulse::storage
+
+#endif // PULSEDB_STORAGE_EXTENT_ALLOCATOR_HPP
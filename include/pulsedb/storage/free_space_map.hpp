@@ -0,0 +1,274 @@
+/**
+ * @file include/pulsedb/storage/free_space_map.hpp
+ * @brief The FreeSpaceMap class used in the storage system. Tracks how much room every page has
+ * left, and which pages are free.
+ *
+ * Every page gets one byte, its category: the free space of a data page in steps of
+ * PAGE_SIZE / 256 bytes, rounded down, so a category promises at least that much room. Other pages
+ * are category 0, deallocated pages are FREE. Finding a page with room for a record checks one
+ * candidate list per category from the smallest that fits upwards, reading no page at all. Lists
+ * are updated lazily: pages that moved to another category are dropped when they're met.
+ *
+ * The map is stored in special pages chained from the database header, and written on sync, so
+ * the free list survives restarts. It is only a hint for room: a page can have less than its
+ * category after a crash, inserts that don't fit go to another page.
+ *
+ * Free Space Page Layout:
+ * +---------------------------------+ 0x0000
+ * | FreeSpaceHeader (25 bytes)      |
+ * |   [Base PageHeader]             | -- First 17 bytes, itemCount is the number of entries.
+ * |   firstPage: uint32_t           | -- Page ID of the first entry.
+ * |   nextPage:  uint32_t           | -- Next page of the map, END if last.
+ * +---------------------------------+ 0x0019
+ * | Categories                      | -- One uint8_t per page, in page ID order.
+ * +---------------------------------+ 0x1000
+ */
+
+#ifndef PULSEDB_STORAGE_FREE_SPACE_MAP_HPP
+#define PULSEDB_STORAGE_FREE_SPACE_MAP_HPP
+
+#include "pulsedb/storage/page.hpp"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+/**
+ * @namespace pulse::storage
+ * @brief The namespace for the storage system.
+ */
+namespace pulse::storage {
+#pragma pack(push, 1)
+  /**
+   * @struct FreeSpaceHeader
+   * @brief Extended header for free space map pages.
+   */
+  struct FreeSpaceHeader : public PageHeader {
+    uint32_t firstPage; /**< Page ID of the first entry. */
+    uint32_t nextPage;  /**< Next page of the map, END if last. */
+  };
+#pragma pack(pop)
+
+  /**
+   * @class FreeSpacePage
+   * @brief A page holding part of the free space map.
+   */
+  class FreeSpacePage : public Page {
+  public:
+    static constexpr uint32_t FREE_SPACE_HEADER_SIZE =
+        sizeof(FreeSpaceHeader); /**< The size of the map page header. */
+    static constexpr uint32_t CAPACITY =
+        PAGE_SIZE - FREE_SPACE_HEADER_SIZE;     /**< Entries per map page. */
+    static constexpr uint32_t END = 0xDEADBEEF; /**< Next page of the last map page. */
+
+    /**
+     * @brief Construct an empty map page.
+     * @param pageId The ID of the page.
+     * @param firstPage Page ID of the first entry.
+     */
+    FreeSpacePage(uint32_t pageId, uint32_t firstPage) noexcept;
+
+    /**
+     * @brief Construct a view over a map page already held in a buffer.
+     * @param buffer PAGE_SIZE bytes holding a map page, that outlive the page.
+     */
+    FreeSpacePage(ViewTag, uint8_t *buffer) noexcept : Page(VIEW, buffer) {}
+
+    /**
+     * @brief Get the page ID of the first entry.
+     * @return The first page covered.
+     */
+    [[nodiscard]] uint32_t firstPage() const noexcept {
+      return header<FreeSpaceHeader>()->firstPage;
+    }
+
+    /**
+     * @brief Get the next page of the map.
+     * @return The next page ID, END if this is the last page.
+     */
+    [[nodiscard]] uint32_t nextPage() const noexcept {
+      return header<FreeSpaceHeader>()->nextPage;
+    }
+
+    /**
+     * @brief Set the next page of the map.
+     * @param pageId The next page ID, END if this is the last page.
+     */
+    void setNextPage(uint32_t pageId) noexcept { header<FreeSpaceHeader>()->nextPage = pageId; }
+
+    /**
+     * @brief Get the entries of the page.
+     * @return One category per page, itemCount() of them.
+     */
+    [[nodiscard]] std::span<const uint8_t> entries() const noexcept {
+      return {data + FREE_SPACE_HEADER_SIZE, itemCount()};
+    }
+
+    /**
+     * @brief Replace the entries of the page.
+     * @param entries At most CAPACITY categories.
+     */
+    void setEntries(std::span<const uint8_t> entries) noexcept;
+  };
+
+  /**
+   * @class FreeSpaceMap
+   * @brief Records the free space category of every page and keeps the free list.
+   * @note Not thread-safe, the disk manager guards it with its own mutex.
+   */
+  class FreeSpaceMap {
+  public:
+    static constexpr uint32_t CATEGORY_SIZE = Page::PAGE_SIZE / 256; /**< Bytes per category. */
+    static constexpr uint8_t FREE = 0xFF; /**< Category of a deallocated page. */
+
+    /**
+     * @brief Constructs an empty map, covering no pages.
+     */
+    FreeSpaceMap() noexcept;
+
+    /**
+     * @brief Cover every page up to a page count, new pages have no room.
+     * @param pageCount Number of pages, smaller counts are ignored.
+     */
+    void grow(uint32_t pageCount);
+
+    /**
+     * @brief Record the free space a page has, taking it off the free list if it's there.
+     * @param pageId ID of the page.
+     * @param freeBytes Free space of the page, 0 for pages that don't take records.
+     */
+    void update(uint32_t pageId, size_t freeBytes);
+
+    /**
+     * @brief Find the page with the least room that still fits a number of bytes.
+     * @param bytes Number of bytes needed.
+     * @return The page ID, nullopt if no page is known to have the room.
+     */
+    [[nodiscard]] std::optional<uint32_t> find(size_t bytes);
+
+    /**
+     * @brief Put a deallocated page on the free list.
+     * @param pageId ID of the page.
+     * @return True if released, false if the page is already free or not covered.
+     */
+    bool release(uint32_t pageId);
+
+    /**
+     * @brief Take a page off the free list.
+     * @return The page ID, nullopt if no page is free.
+     */
+    [[nodiscard]] std::optional<uint32_t> takeFree();
+
+    /**
+     * @brief Add a page to hold the map itself.
+     * @param pageId ID of the page.
+     */
+    void addMapPage(uint32_t pageId);
+
+    /**
+     * @brief Serialize the map into its pages.
+     * @return One page per map page, chained in order.
+     */
+    [[nodiscard]] std::vector<std::unique_ptr<FreeSpacePage>> serialize() const;
+
+    /**
+     * @brief Append the entries of a map page read from disk.
+     * @param page The page, the next one in the chain.
+     * @return True if loaded, false if the page doesn't continue the entries loaded so far.
+     */
+    bool load(const FreeSpacePage &page);
+
+    /**
+     * @brief Mark the map clean, once it is durable.
+     */
+    void commit() noexcept { dirty = false; }
+
+    /**
+     * @brief Get the category that promises a number of free bytes.
+     * @param freeBytes Free space of a page.
+     * @return The category, below FREE.
+     */
+    [[nodiscard]] static uint8_t categoryOf(size_t freeBytes) noexcept;
+
+    /**
+     * @brief Getters for the free space map class.
+     * @{
+     */
+
+    /**
+     * @brief Get the category of a page.
+     * @param pageId ID of the page.
+     * @return The category, 0 if the page isn't covered.
+     */
+    [[nodiscard]] uint8_t category(uint32_t pageId) const noexcept {
+      return pageId < categories.size() ? categories[pageId] : 0;
+    }
+
+    /**
+     * @brief Get the number of pages covered.
+     * @return Number of entries.
+     */
+    [[nodiscard]] uint32_t pageCount() const noexcept {
+      return static_cast<uint32_t>(categories.size());
+    }
+
+    /**
+     * @brief Get the number of free pages.
+     * @return Pages on the free list.
+     */
+    [[nodiscard]] uint32_t freeCount() const noexcept { return freeTotal; }
+
+    /**
+     * @brief Get the pages the map is stored in.
+     * @return Page IDs, in chain order.
+     */
+    [[nodiscard]] const std::vector<uint32_t> &mapPages() const noexcept { return mapPageIds; }
+
+    /**
+     * @brief Get the number of map pages needed to cover every page.
+     * @return Number of map pages.
+     */
+    [[nodiscard]] size_t mapPagesNeeded() const noexcept {
+      return (categories.size() + FreeSpacePage::CAPACITY - 1) / FreeSpacePage::CAPACITY;
+    }
+
+    /**
+     * @brief Check if the map changed since it was last committed.
+     * @return True if the map has to be written, false otherwise.
+     */
+    [[nodiscard]] bool isDirty() const noexcept { return dirty; }
+
+    /** @} */
+
+  private:
+    /**
+     * @brief Set the category of a page, queueing it as a candidate of its new category.
+     * @param pageId ID of the page, covered.
+     * @param value The new category.
+     */
+    void set(uint32_t pageId, uint8_t value);
+
+    /**
+     * @brief Queue a page in the list of its category, if it has one.
+     * @param pageId ID of the page, covered.
+     */
+    void enqueue(uint32_t pageId);
+
+    /**
+     * @brief Rebuild the candidate lists and the free list from the categories.
+     */
+    void rebuild();
+
+    std::vector<uint8_t> categories;                    /**< Category of each page ID. */
+    std::array<std::vector<uint32_t>, FREE> candidates; /**< Pages by category, maybe stale. */
+    std::vector<uint32_t> freePages;                    /**< Free list, maybe stale. */
+    std::vector<uint32_t> mapPageIds;                   /**< Pages holding the map. */
+    size_t queued;                                      /**< Entries in the candidate lists. */
+    uint32_t freeTotal;                                 /**< Number of free pages. */
+    bool dirty;                                         /**< Whether categories changed. */
+  };
+} // namespace pulse::storage
+
+#endif // PULSEDB_STORAGE_FREE_SPACE_MAP_HPP
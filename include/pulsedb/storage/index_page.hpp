@@ -5,29 +5,42 @@
  *
  * Index Page Layout (B+ tree node):
  * +---------------------------------+ 0x0000
- * | IndexHeader (28 bytes)          |
- * |   [Base PageHeader]             | -- First 13 bytes (0x0D).
- * |   isLeaf:     bool              | -- Leaf node indicator.
- * |   nextPageId: uint32_t          | -- Next sibling page.
- * |   prevPageId: uint32_t          | -- Previous sibling page.
- * |   parentId:   uint32_t          | -- Parent node page.
- * |   level:      uint16_t          | -- Tree level (0 for leaf).
- * +---------------------------------+ 0x001C
- * | IndexEntry Array                | -- Sorted key-pageId pairs.
- * |   [Variable number of entries:] |
- * |   struct IndexEntry {           |
- * |     key:    uint64_t            | -- Index key.
- * |     pageId: uint32_t            | -- Child page ID.
- * |     offset: uint16_t            | -- Variable-length data offset.
- * |   }                             |
+ * | IndexHeader (46 bytes)          |
+ * |   [Base PageHeader]             | -- First 17 bytes (0x11).
+ * |   isLeaf:      bool             | -- Leaf node indicator.
+ * |   nextPageId:  uint32_t         | -- Next sibling page.
+ * |   prevPageId:  uint32_t         | -- Previous sibling page.
+ * |   parentId:    uint32_t         | -- Parent node page.
+ * |   level:       uint16_t         | -- Tree level (0 for leaf).
+ * |   baseKey:     uint64_t         | -- Frame of reference of the keys.
+ * |   basePageId:  uint32_t         | -- Frame of reference of the page IDs.
+ * |   keyWidth:    uint8_t          | -- Bytes per packed key.
+ * |   pageIdWidth: uint8_t          | -- Bytes per packed page ID.
+ * +---------------------------------+ 0x0030
+ * | Key Array (capacity x width)    | -- Sorted key offsets, contiguous for search.
+ * +---------------------------------+ 8-byte aligned
+ * | Page ID Array (capacity x width)| -- Child page ID offset of each key.
+ * +---------------------------------+
+ * | Unused                          |
  * +---------------------------------+ 0x1000
+ *
+ * Entry i is spread over the i-th slot of each array, so searches only touch the keys.
+ *
+ * Keys and page IDs are stored frame-of-reference encoded: each is the offset from the page's
+ * base, packed with the fewest bytes (1, 2, 4 or 8) that fit the page's range. Nearby keys, such
+ * as timestamps, pack into one or two bytes, which more than doubles the fanout over full-width
+ * entries and keeps the tree shallower. The arrays are re-encoded when an entry falls outside
+ * the page's range, so the capacity of a page depends on its encoding. It is capped so that half
+ * a full page always takes one more entry of any width, which keeps splits simple.
  */
 
 #ifndef PULSEDB_STORAGE_INDEX_PAGE_HPP
 #define PULSEDB_STORAGE_INDEX_PAGE_HPP
 
+#include "pulsedb/storage/key_search.hpp"
 #include "pulsedb/storage/page.hpp"
 #include <optional>
+#include <utility>
 #include <vector>
 
 /**
@@ -46,16 +59,10 @@ namespace pulse::storage {
     uint32_t prevPageId; /**< Previous sibling for leaf nodes (0 if none) */
     uint32_t parentId;   /**< Parent node ID (0 if root) */
     uint16_t level;      /**< Level in tree (0 for leaf) */
-  };
-
-  /**
-   * @struct IndexEntry
-   * @brief Represents a key-pageId pair in the entry array.
-   */
-  struct IndexEntry {
-    uint64_t key;    /**< Index key. */
-    uint32_t pageId; /**< Child page ID. */
-    uint16_t offset; /**< Offset to variable length data if any. */
+    uint64_t baseKey;    /**< Key every packed key is an offset from. */
+    uint32_t basePageId; /**< Page ID every packed page ID is an offset from. */
+    uint8_t keyWidth;    /**< Bytes per packed key: 1, 2, 4 or 8. */
+    uint8_t pageIdWidth; /**< Bytes per packed page ID: 1, 2 or 4. */
   };
 #pragma pack(pop)
 } // namespace pulse::storage
@@ -67,9 +74,30 @@ namespace pulse::storage {
    */
   class IndexPage : public Page {
   public:
+    /**
+     * @struct Probe
+     * @brief What a node said about a key while it may have been changing.
+     * @note Only to be trusted once the read it came from is validated.
+     */
+    struct Probe {
+      uint32_t pageId;               /**< ID the node's header claims. */
+      uint16_t level;                /**< Level of the node. */
+      bool isLeaf;                   /**< Whether the node is a leaf. */
+      std::optional<uint32_t> value; /**< What lookup() returns for the key. */
+      size_t slot;                   /**< Index of the entry the value comes from. */
+    };
+
     static const uint32_t INDEX_HEADER_SIZE = sizeof(IndexHeader); /**< Size of index header. */
-    static const uint32_t MAX_FREE_SPACE =
-        PAGE_SIZE - INDEX_HEADER_SIZE; /**< Maximum free space. */
+    static constexpr uint32_t ENTRIES_OFFSET = 48; /**< Start of the entry arrays. */
+    static constexpr uint32_t ENTRY_SPACE =
+        PAGE_SIZE - ENTRIES_OFFSET; /**< Space for the entry arrays. */
+
+    static_assert(INDEX_HEADER_SIZE <= ENTRIES_OFFSET, "Index header overlaps the entries");
+
+    static constexpr size_t WIDE_CAPACITY =
+        ENTRY_SPACE / (sizeof(uint64_t) + sizeof(uint32_t)); /**< Entries at full width. */
+    static constexpr size_t MAX_ENTRIES =
+        2 * (WIDE_CAPACITY - 1); /**< Entries at any width, half of it takes a full-width entry. */
 
   public:
     /**
@@ -80,6 +108,21 @@ namespace pulse::storage {
      */
     explicit IndexPage(uint32_t pageId, bool isLeaf, uint16_t level = 0) noexcept;
 
+    /**
+     * @brief Construct a new index page with the given ID in a buffer owned by the caller.
+     * @param buffer PAGE_SIZE bytes, 64-byte aligned, that outlive the page.
+     * @param pageId Page ID.
+     * @param isLeaf Whether the page is a leaf node.
+     * @param level Level in the tree.
+     */
+    IndexPage(uint8_t *buffer, uint32_t pageId, bool isLeaf, uint16_t level = 0) noexcept;
+
+    /**
+     * @brief Construct a view over an index page already held in a buffer owned by the caller.
+     * @param buffer PAGE_SIZE bytes, 64-byte aligned, that outlive the page.
+     */
+    IndexPage(ViewTag, uint8_t *buffer) noexcept : Page(VIEW, buffer) {}
+
     /**
      * @brief Looks up the key in the index page.
      * @param key Key to look up.
@@ -87,6 +130,16 @@ namespace pulse::storage {
      */
     [[nodiscard]] std::optional<uint32_t> lookup(uint64_t key) const noexcept;
 
+    /**
+     * @brief Look up a key in a node that a writer may be changing at the same time.
+     * @param buffer The node's PAGE_SIZE bytes.
+     * @param key Key to look up.
+     * @return The node's header fields and what lookup() would return, nullopt if the bytes
+     * aren't a consistent index page.
+     * @note The header is read once and checked, so no read leaves the buffer whatever it holds.
+     */
+    [[nodiscard]] static std::optional<Probe> probe(const uint8_t *buffer, uint64_t key) noexcept;
+
     /**
      * @brief Insert new key-pageId pair.
      * @param key Key to insert.
@@ -146,18 +199,74 @@ namespace pulse::storage {
     [[nodiscard]] uint16_t level() const noexcept { return indexHeader()->level; }
 
     /**
-     * @brief Get the maximum entries a node can hold.
-     * @return Maximum entry count.
+     * @brief Get the key of an entry.
+     * @param index Index of the entry, must be below the item count.
+     * @return The key of the entry.
+     */
+    [[nodiscard]] uint64_t keyAt(size_t index) const noexcept {
+      return indexHeader()->baseKey + load(keys(), index, indexHeader()->keyWidth);
+    }
+
+    /**
+     * @brief Get the page ID of an entry.
+     * @param index Index of the entry, must be below the item count.
+     * @return The page ID of the entry.
      */
-    [[nodiscard]] static constexpr size_t maxEntries() noexcept {
-      return MAX_FREE_SPACE / sizeof(IndexEntry);
+    [[nodiscard]] uint32_t pageIdAt(size_t index) const noexcept {
+      return indexHeader()->basePageId +
+             static_cast<uint32_t>(load(pageIds(), index, indexHeader()->pageIdWidth));
     }
 
+    /**
+     * @brief Get the maximum entries a node can hold, with the narrowest encoding.
+     * @return Maximum entry count.
+     */
+    [[nodiscard]] static constexpr size_t maxEntries() noexcept { return MAX_ENTRIES; }
+
+    /**
+     * @brief Get the entries every node can hold, whatever its keys and page IDs.
+     * @return Entry count of the widest encoding.
+     */
+    [[nodiscard]] static constexpr size_t minCapacity() noexcept { return WIDE_CAPACITY; }
+
     /**
      * @brief Get the minimum entries for non-root node.
-     * @return Minimum entry count.
+     * @return Minimum entry count, half of what the widest encoding holds.
+     */
+    [[nodiscard]] static constexpr size_t minEntries() noexcept { return minCapacity() / 2; }
+
+    /**
+     * @brief Get the entries the node holds with its current encoding.
+     * @return Capacity of the node.
+     */
+    [[nodiscard]] size_t capacity() const noexcept {
+      return capacityOf(indexHeader()->keyWidth, indexHeader()->pageIdWidth);
+    }
+
+    /**
+     * @brief Get the capacity the node has once an entry is inserted.
+     * @param key Key of the entry.
+     * @param pageId Page ID of the entry.
+     * @return Capacity with the encoding the insert uses.
      */
-    [[nodiscard]] static constexpr size_t minEntries() noexcept { return maxEntries() / 2; }
+    [[nodiscard]] size_t capacityWith(uint64_t key, uint32_t pageId) const noexcept;
+
+    /**
+     * @brief Check if an entry can be inserted without filling the node.
+     * @param key Key of the entry.
+     * @param pageId Page ID of the entry.
+     * @return True if the node has room to spare after the insert, otherwise false.
+     */
+    [[nodiscard]] bool hasRoomFor(uint64_t key, uint32_t pageId) const noexcept {
+      return itemCount() + 1u < capacityWith(key, pageId);
+    }
+
+    /**
+     * @brief Check if the node takes the entries of its right sibling with room to spare.
+     * @param rightSibling The right sibling.
+     * @return True if a merge leaves room for one more entry, otherwise false.
+     */
+    [[nodiscard]] bool canMerge(const IndexPage &rightSibling) const noexcept;
 
     /** @} */
 
@@ -184,13 +293,30 @@ namespace pulse::storage {
      */
     void setParentPage(uint32_t pageId) noexcept { indexHeader()->parentId = pageId; }
 
+    /**
+     * @brief Set whether the node is a leaf.
+     * @param isLeaf Whether the node is a leaf.
+     */
+    void setLeaf(bool isLeaf) noexcept { indexHeader()->isLeaf = isLeaf; }
+
+    /**
+     * @brief Set the level in the tree.
+     * @param level Level in the tree.
+     */
+    void setLevel(uint16_t level) noexcept { indexHeader()->level = level; }
+
     /** @} */
 
+    /**
+     * @brief Remove every entry from the node.
+     */
+    void clear() noexcept;
+
     /**
      * @brief Check if the node needs splitting.
      * @return True if overflow, otherwise false.
      */
-    [[nodiscard]] bool isOverflow() const noexcept { return itemCount() >= maxEntries(); }
+    [[nodiscard]] bool isOverflow() const noexcept { return itemCount() >= capacity(); }
 
     /**
      * @brief Check if the node is under-utilized.
@@ -208,17 +334,141 @@ namespace pulse::storage {
     /**
      * @brief Merge with the right sibling.
      * @param rightSibling The right sibling to merge with.
-     * @return True if merged, false if not.
+     * @return True if merged, false if the entries don't fit.
      */
     bool merge(IndexPage &rightSibling);
 
   private:
     /**
-     * @brief Find insertion position for key.
-     * @param key Key to insert.
-     * @return Iterator to insertion position.
+     * @struct Encoding
+     * @brief How the entries of a page are packed.
+     */
+    struct Encoding {
+      uint64_t baseKey;    /**< Key every packed key is an offset from. */
+      uint32_t basePageId; /**< Page ID every packed page ID is an offset from. */
+      uint8_t keyWidth;    /**< Bytes per packed key. */
+      uint8_t pageIdWidth; /**< Bytes per packed page ID. */
+    };
+
+    /**
+     * @brief Initialize the index header of an empty page.
+     * @param isLeaf Whether the page is a leaf node.
+     * @param level Level in the tree.
+     */
+    void format(bool isLeaf, uint16_t level) noexcept;
+
+    /**
+     * @brief Get the entries an encoding holds.
+     * @param keyWidth Bytes per packed key.
+     * @param pageIdWidth Bytes per packed page ID.
+     * @return Capacity of the encoding.
+     */
+    [[nodiscard]] static constexpr size_t capacityOf(size_t keyWidth, size_t pageIdWidth) {
+      // The page ID array starts 8-byte aligned after the keys.
+      size_t capacity = ENTRY_SPACE / (keyWidth + pageIdWidth);
+      while ((capacity * keyWidth + 7) / 8 * 8 + capacity * pageIdWidth > ENTRY_SPACE) {
+        capacity--;
+      }
+
+      return capacity < MAX_ENTRIES ? capacity : MAX_ENTRIES;
+    }
+
+    /**
+     * @brief Get the narrowest encoding of a range of keys and page IDs.
+     * @param minKey Smallest key.
+     * @param maxKey Largest key.
+     * @param minPageId Smallest page ID.
+     * @param maxPageId Largest page ID.
+     * @return The encoding.
+     */
+    [[nodiscard]] static Encoding
+    encodingFor(uint64_t minKey, uint64_t maxKey, uint32_t minPageId, uint32_t maxPageId) noexcept;
+
+    /**
+     * @brief Get the narrowest encoding of the node's entries together with others.
+     * @param other Page holding the other entries.
+     * @param from Index of the first other entry.
+     * @param count Number of other entries.
+     * @param extra An extra entry, if any.
+     * @return The encoding.
+     */
+    [[nodiscard]] Encoding encodingWith(
+        const IndexPage &other, size_t from, size_t count,
+        std::optional<std::pair<uint64_t, uint32_t>> extra = std::nullopt
+    ) const noexcept;
+
+    /**
+     * @brief Check if an entry can be packed with the current encoding.
+     * @param key Key of the entry.
+     * @param pageId Page ID of the entry.
+     * @return True if both are within the encoding's range, otherwise false.
+     */
+    [[nodiscard]] bool fits(uint64_t key, uint32_t pageId) const noexcept;
+
+    /**
+     * @brief Re-encode the node's entries.
+     * @param encoding The new encoding, which must hold every entry.
+     */
+    void encode(const Encoding &encoding) noexcept;
+
+    /**
+     * @brief Append entries of another page, re-encoding the node to hold them.
+     * @param other The page to copy from.
+     * @param from Index of the first entry to copy.
+     * @param count Number of entries.
+     * @return True if appended, false if the entries don't fit.
      */
-    [[nodiscard]] IndexEntry *findInsertPosition(uint64_t key) noexcept;
+    bool append(const IndexPage &other, size_t from, size_t count) noexcept;
+
+    /**
+     * @brief Pack an entry into its slot.
+     * @param index Index of the slot.
+     * @param key Key of the entry.
+     * @param pageId Page ID of the entry.
+     */
+    void store(size_t index, uint64_t key, uint32_t pageId) noexcept;
+
+    /**
+     * @brief Update the free space for the item count and encoding.
+     */
+    void updateFreeSpace() noexcept;
+
+    /**
+     * @brief Find the position of the first key not less than the given key.
+     * @param key Key to search for.
+     * @return Index of the position, the item count if all keys are less.
+     */
+    [[nodiscard]] size_t findPosition(uint64_t key) const noexcept;
+
+    /**
+     * @brief Find the position of the first key not less than the given key in a key array.
+     * @param keys The packed keys.
+     * @param count Number of keys.
+     * @param baseKey Key every packed key is an offset from.
+     * @param keyWidth Bytes per packed key.
+     * @param key Key to search for.
+     * @return Index of the position, count if all keys are less.
+     */
+    [[nodiscard]] static size_t position(
+        const uint8_t *keys, size_t count, uint64_t baseKey, uint8_t keyWidth, uint64_t key
+    ) noexcept;
+
+    /**
+     * @brief Move entries within the page.
+     * @param to Index to move to.
+     * @param from Index to move from.
+     * @param count Number of entries.
+     */
+    void moveEntries(size_t to, size_t from, size_t count) noexcept;
+
+    /**
+     * @brief Read a packed value without assuming it's aligned.
+     * @param array The packed array.
+     * @param index Index of the value.
+     * @param width Bytes per value.
+     * @return The value.
+     */
+    [[nodiscard]] static uint64_t load(const uint8_t *array, size_t index, size_t width) noexcept;
 
     /**
      * @brief Const & non-const getters for index page header.
@@ -240,24 +490,40 @@ namespace pulse::storage {
     /** @} */
 
     /**
-     * @brief Const & non-const getters for entries array.
+     * @brief Const & non-const getters for the entry arrays.
      * @{
      */
 
     /**
-     * @brief Get pointer to entries array.
-     * @return Pointer to entries.
+     * @brief Get pointer to the key array.
+     * @return Pointer to the packed keys.
      */
-    [[nodiscard]] IndexEntry *entries() noexcept {
-      return reinterpret_cast<IndexEntry *>(data + INDEX_HEADER_SIZE);
-    }
+    [[nodiscard]] uint8_t *keys() noexcept { return data + ENTRIES_OFFSET; }
+
+    /**
+     * @brief Get const pointer to the key array.
+     * @return Const pointer to the packed keys.
+     */
+    [[nodiscard]] const uint8_t *keys() const noexcept { return data + ENTRIES_OFFSET; }
+
+    /**
+     * @brief Get pointer to the page ID array.
+     * @return Pointer to the packed page IDs.
+     */
+    [[nodiscard]] uint8_t *pageIds() noexcept { return keys() + keyArraySize(); }
+
+    /**
+     * @brief Get const pointer to the page ID array.
+     * @return Const pointer to the packed page IDs.
+     */
+    [[nodiscard]] const uint8_t *pageIds() const noexcept { return keys() + keyArraySize(); }
 
     /**
-     * @brief Get const pointer to entries array.
-     * @return Const pointer to entries.
+     * @brief Get the size of the key array, up to where the page ID array starts.
+     * @return Size in bytes.
      */
-    [[nodiscard]] const IndexEntry *entries() const noexcept {
-      return reinterpret_cast<const IndexEntry *>(data + INDEX_HEADER_SIZE);
+    [[nodiscard]] size_t keyArraySize() const noexcept {
+      return (capacity() * indexHeader()->keyWidth + 7) / 8 * 8;
     }
 
     /** @} */
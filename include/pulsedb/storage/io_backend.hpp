@@ -0,0 +1,73 @@
+/**
+ * @file include/pulsedb/storage/io_backend.hpp
+ * @brief The IOBackend interface for asynchronous positional file I/O.
+ */
+
+#ifndef PULSEDB_STORAGE_IO_BACKEND_HPP
+#define PULSEDB_STORAGE_IO_BACKEND_HPP
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+
+/**
+ * @namespace pulse::storage
+ * @brief The namespace for the storage system.
+ */
+namespace pulse::storage {
+  /**
+   * @enum IOOp
+   * @brief The kind of operation an I/O request performs.
+   */
+  enum class IOOp : uint8_t {
+    READ = 0, /**< Positional read into the buffer. */
+    WRITE = 1 /**< Positional write from the buffer. */
+  };
+
+  /**
+   * @struct IORequest
+   * @brief A single positional read or write submitted to a backend.
+   * @note The buffer must stay valid until the callback runs.
+   */
+  struct IORequest {
+    IOOp op;                            /**< The operation to perform. */
+    int fd;                             /**< File descriptor to operate on. */
+    void *buffer;                       /**< Source or destination buffer. */
+    uint32_t size;                      /**< Number of bytes to transfer. */
+    uint64_t offset;                    /**< Offset in bytes from start of file. */
+    std::function<void(bool)> callback; /**< Invoked once with whether all bytes moved. */
+  };
+
+  /**
+   * @class IOBackend
+   * @brief Abstract interface for asynchronous I/O engines.
+   */
+  class IOBackend {
+  public:
+    virtual ~IOBackend() = default;
+
+    /**
+     * @brief Submit a batch of requests. Callbacks run on a backend owned thread.
+     * @param requests The requests to submit, consumed by the call.
+     */
+    virtual void submit(std::span<IORequest> requests) = 0;
+
+    /**
+     * @brief Get the name of the backend.
+     * @return The backend name.
+     */
+    [[nodiscard]] virtual const char *name() const noexcept = 0;
+
+    /**
+     * @brief Create the best backend available on this platform.
+     * @param queueDepth Maximum number of requests in flight.
+     * @param threads Number of worker threads used by the thread pool fallback.
+     * @return An io_uring backend if supported, otherwise a thread pool backend.
+     */
+    [[nodiscard]] static std::unique_ptr<IOBackend>
+    create(uint32_t queueDepth = 128, size_t threads = 4);
+  };
+} // namespace pulse::storage
+
+#endif // PULSEDB_STORAGE_IO_BACKEND_HPP
@@ -0,0 +1,49 @@
+/**
+ * @file include/pulsedb/storage/key_search.hpp
+ * @brief Vectorized search over sorted key arrays, used by index pages.
+ *
+ * Keys are searched at the width they are stored with, so narrower keys fit more per vector.
+ *
+ * The implementation is chosen at compile time: AVX2 on x86-64, NEON on AArch64 and a portable
+ * scalar loop otherwise. Build with PULSEDB_NATIVE to enable the instruction set of the host.
+ */
+
+#ifndef PULSEDB_STORAGE_KEY_SEARCH_HPP
+#define PULSEDB_STORAGE_KEY_SEARCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @namespace pulse::storage
+ * @brief The namespace for the storage system.
+ */
+namespace pulse::storage {
+  /**
+   * @brief Find the first key that is not less than the given key.
+   * @param keys Sorted array of keys.
+   * @param count Number of keys.
+   * @param key Key to search for.
+   * @return Index of the first key not less than the given key, or count if there is none.
+   */
+  [[nodiscard]] size_t lowerBound(const uint64_t *keys, size_t count, uint64_t key) noexcept;
+
+  /**
+   * @brief Find the first narrow key that is not less than the given key.
+   * @param keys Sorted array of keys.
+   * @param count Number of keys.
+   * @param key Key to search for.
+   * @return Index of the first key not less than the given key, or count if there is none.
+   * @note Defined for uint8_t, uint16_t and uint32_t keys, the packed widths of index pages.
+   */
+  template <typename Key>
+  [[nodiscard]] size_t lowerBound(const Key *keys, size_t count, Key key) noexcept;
+
+  /**
+   * @brief Get the name of the search implementation compiled in.
+   * @return "avx2", "neon" or "scalar".
+   */
+  [[nodiscard]] const char *keySearchBackend() noexcept;
+} // namespace pulse::storage
+
+#endif // PULSEDB_STORAGE_KEY_SEARCH_HPP
@@ -2,19 +2,28 @@
  * @file include/pulsedb/storage/page.hpp
  * @brief The base Page class used in the storage system.
  *
- * All pages are fixed to 4096 bytes and are 64-byte aligned. Each page type builds upon
- * the base PageHeader structure with additional fields specific to its purpose.
+ * All pages have the same size, 4096 bytes unless the build sets PULSEDB_PAGE_SIZE to 8192,
+ * 16384, 32768 or 65536, and are 64-byte aligned. Larger pages hold more entries per index node,
+ * so lookups take fewer I/Os. Sizes that can reach the page size itself, like the end of a data
+ * page's free space or a logged page image, are PageOffset, which only widens past 16 bits for
+ * 64K pages. Each page type builds upon the base PageHeader structure with additional fields
+ * specific to its purpose.
  *
- * Base Page Layout (4096 bytes total):
+ * A page either owns its buffer or is a view over a buffer owned by someone else, such as a
+ * frame slot of the buffer pool. Views never allocate or free, so a frame can be reused for
+ * another page without touching the heap. Views into a read-only mapping of the database file
+ * are only as aligned as the page's file offset.
+ *
+ * Base Page Layout (4096 bytes total, offsets of the default page size):
  * +---------------------------------+ 0x0000
- * | PageHeader (13 bytes)           |
+ * | PageHeader (17 bytes)           |
  * |   type:      uint8_t            | -- Page type identifier.
  * |   pageId:    uint32_t           | -- Unique page identifier.
- * |   lsn:       uint32_t           | -- Log sequence number.
+ * |   lsn:       uint64_t           | -- Log sequence number.
  * |   freeSpace: uint16_t           | -- Available free space.
  * |   itemCount: uint16_t           | -- Number of items in page.
- * +---------------------------------+ 0x000D
- * | Page Specific Data (4083 bytes) | -- Type-specific content.
+ * +---------------------------------+ 0x0011
+ * | Page Specific Data (4079 bytes) | -- Type-specific content.
  * +---------------------------------+ 0x1000
  */
 
@@ -23,6 +32,17 @@
 
 #include <cstdint>
 #include <memory>
+#include <type_traits>
+
+#ifndef PULSEDB_PAGE_SIZE
+#  define PULSEDB_PAGE_SIZE 4096
+#endif
+
+static_assert(
+    PULSEDB_PAGE_SIZE >= 4096 && PULSEDB_PAGE_SIZE <= 65536 &&
+        (PULSEDB_PAGE_SIZE & (PULSEDB_PAGE_SIZE - 1)) == 0,
+    "PULSEDB_PAGE_SIZE must be a power of two from 4096 to 65536"
+);
 
 /**
  * @namespace pulse::storage
@@ -40,6 +60,11 @@ namespace pulse::storage {
     SPECIAL = 3  /**< Special page. */
   };
 
+  /**
+   * @brief An offset or size within a page, wide enough to hold the page size itself.
+   */
+  using PageOffset = std::conditional_t<(PULSEDB_PAGE_SIZE > UINT16_MAX), uint32_t, uint16_t>;
+
 // Packing struct so that there is no padding.
 #pragma pack(push, 1)
   /**
@@ -49,27 +74,42 @@ namespace pulse::storage {
   struct PageHeader {
     PageType type;      /**< The type of the page. */
     uint32_t pageId;    /**< The id of the page. */
-    uint32_t lsn;       /**< The log sequence number of the page. */
+    uint64_t lsn;       /**< The log sequence number of the page. */
     uint16_t freeSpace; /**< The free space in the page. */
     uint16_t itemCount; /**< The number of items in the page. */
   };
 #pragma pack(pop)
+
+  /**
+   * @struct ViewTag
+   * @brief Selects the page constructors that view a page already held in a buffer.
+   */
+  struct ViewTag {};
+
+  inline constexpr ViewTag VIEW{}; /**< Tag value for viewing a page. */
 } // namespace pulse::storage
 
+namespace pulse::wal {
+  class LogManager;
+} // namespace pulse::wal
+
 namespace pulse::storage {
   /**
    * @class Page
    * @brief The base class for all pages.
    */
   class Page {
-    friend class DiskManager; // Allow the disk manager to access the page.
+    friend class DiskManager;     // Allow the disk manager to access the page.
+    friend class wal::LogManager; // Allow the log manager to log and redo page bytes.
 
   public:
-    static const uint32_t PAGE_SIZE = 4096;                 /**< The size of a page. */
+    static const uint32_t PAGE_SIZE = PULSEDB_PAGE_SIZE;    /**< The size of a page. */
     static const uint32_t HEADER_SIZE = sizeof(PageHeader); /**< The size of the header. */
     static const uint32_t MAX_FREE_SPACE =
         PAGE_SIZE - HEADER_SIZE; /**< The maximum free space in a page. */
 
+    static_assert(MAX_FREE_SPACE <= UINT16_MAX, "Free space must fit the page header");
+
   public:
     /**
      * @brief Construct a new page with the given ID.
@@ -79,7 +119,21 @@ namespace pulse::storage {
     explicit Page(uint32_t pageId, PageType type) noexcept;
 
     /**
-     * @brief Cleans up resources.
+     * @brief Construct a new page with the given ID in a buffer owned by the caller.
+     * @param buffer PAGE_SIZE bytes, 64-byte aligned, that outlive the page.
+     * @param pageId the ID of the page.
+     * @param type the type of the page.
+     */
+    Page(uint8_t *buffer, uint32_t pageId, PageType type) noexcept;
+
+    /**
+     * @brief Construct a view over a page already held in a buffer owned by the caller.
+     * @param buffer PAGE_SIZE bytes, 64-byte aligned, that outlive the page.
+     */
+    Page(ViewTag, uint8_t *buffer) noexcept : data(buffer), owned(false) {}
+
+    /**
+     * @brief Cleans up resources, views leave their buffer alone.
      */
     virtual ~Page() noexcept;
 
@@ -91,6 +145,12 @@ namespace pulse::storage {
     Page(Page &&) noexcept;
     Page &operator=(Page &&) noexcept;
 
+    /**
+     * @brief Overwrite this page with the raw bytes of another page.
+     * @param other The page to copy.
+     */
+    void copyFrom(const Page &other) noexcept;
+
     /**
      * @brief Check if the page has enough free space.
      * @param size the size to check for.
@@ -119,7 +179,7 @@ namespace pulse::storage {
      * @brief Get the log sequence number of the page.
      * @return The log sequence number of the page.
      */
-    [[nodiscard]] uint32_t lsn() const noexcept { return header()->lsn; }
+    [[nodiscard]] uint64_t lsn() const noexcept { return header()->lsn; }
 
     /**
      * @brief Get the free space in the page.
@@ -133,8 +193,20 @@ namespace pulse::storage {
      */
     [[nodiscard]] uint16_t itemCount() const noexcept { return header()->itemCount; }
 
+    /**
+     * @brief Check if the page owns its buffer.
+     * @return True if the buffer is freed with the page, false if the page is a view.
+     */
+    [[nodiscard]] bool ownsBuffer() const noexcept { return owned; }
+
     /** @} */
 
+    /**
+     * @brief Set the log sequence number of the last change to the page.
+     * @param lsn The log sequence number.
+     */
+    void setLsn(uint64_t lsn) noexcept { header()->lsn = lsn; }
+
   protected:
     /**
      * @brief Const & non-const getters for page header.
@@ -183,6 +255,7 @@ namespace pulse::storage {
     /** @} */
 
     uint8_t *data; /**< The data of the page. */
+    bool owned;    /**< Whether the data is freed with the page. */
   };
 } // namespace pulse::storage
 
@@ -0,0 +1,70 @@
+/**
+ * @file include/pulsedb/storage/page_codec.hpp
+ * @brief Compression of whole pages for the compressed database format.
+ *
+ * Pages are compressed one at a time, so any page can be read back on its own. The codecs
+ * available depend on the libraries found at build time: deflate needs zlib, which defines
+ * PULSEDB_HAVE_ZLIB.
+ */
+
+#ifndef PULSEDB_STORAGE_PAGE_CODEC_HPP
+#define PULSEDB_STORAGE_PAGE_CODEC_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+/**
+ * @namespace pulse::storage
+ * @brief The namespace for the storage system.
+ */
+namespace pulse::storage {
+  /**
+   * @enum Compression
+   * @brief How pages are stored in the database file.
+   */
+  enum class Compression : uint8_t {
+    NONE = 0,   /**< Pages are stored as is, at fixed offsets. */
+    DEFLATE = 1 /**< Pages are deflated into variable-size slots. */
+  };
+
+  /**
+   * @brief Compress a page.
+   * @param compression The codec to use, not NONE.
+   * @param page The PAGE_SIZE bytes of the page.
+   * @param out Buffer for the compressed bytes.
+   * @param capacity Size of the buffer.
+   * @return Number of compressed bytes, or nullopt if they don't fit the buffer.
+   */
+  [[nodiscard]] std::optional<size_t> compressPage(
+      Compression compression, const uint8_t *page, uint8_t *out, size_t capacity
+  ) noexcept;
+
+  /**
+   * @brief Decompress a page.
+   * @param compression The codec the page was compressed with, not NONE.
+   * @param in The compressed bytes.
+   * @param length Number of compressed bytes.
+   * @param page Buffer for the PAGE_SIZE bytes of the page.
+   * @return True if a whole page was decompressed, false if the bytes are corrupt.
+   */
+  [[nodiscard]] bool decompressPage(
+      Compression compression, const uint8_t *in, size_t length, uint8_t *page
+  ) noexcept;
+
+  /**
+   * @brief Check if a codec was compiled in.
+   * @param compression The codec.
+   * @return True if pages can be stored with it, NONE always can.
+   */
+  [[nodiscard]] bool isCompressionAvailable(Compression compression) noexcept;
+
+  /**
+   * @brief Get the name of a codec.
+   * @param compression The codec.
+   * @return "none", "deflate" or "unknown".
+   */
+  [[nodiscard]] const char *compressionName(Compression compression) noexcept;
+} // namespace pulse::storage
+
+#endif // PULSEDB_STORAGE_PAGE_CODEC_HPP
@@ -0,0 +1,170 @@
+/**
+ * @file include/pulsedb/storage/page_map.hpp
+ * @brief The PageMap class used in the storage system. Tracks where each page of a compressed
+ * database lives in the file.
+ *
+ * Compressed pages don't have a fixed offset. Each page is stored in a slot of whole sectors
+ * that fits its compressed size, and the map records the offset and size of every page's slot.
+ * A page that still fits its slot is rewritten in place, otherwise it moves to a new slot. Free
+ * slots are kept in one list per size, larger slots are split when no exact fit is free, and
+ * the file only grows once no free slot is large enough.
+ *
+ * A slot that is given up can't be reused right away: the map on disk still points at it until
+ * the next sync. Given up slots are retired and only become free once the map that no longer
+ * references them is durable. The free lists themselves aren't stored, after a restart every
+ * gap between the slots in use is free.
+ */
+
+#ifndef PULSEDB_STORAGE_PAGE_MAP_HPP
+#define PULSEDB_STORAGE_PAGE_MAP_HPP
+
+#include "pulsedb/storage/page.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+/**
+ * @namespace pulse::storage
+ * @brief The namespace for the storage system.
+ */
+namespace pulse::storage {
+#pragma pack(push, 1)
+  /**
+   * @struct PageLocation
+   * @brief The slot a page is stored in, as kept on disk.
+   */
+  struct PageLocation {
+    uint64_t offset;   /**< Offset of the slot in the file, 0 if the page was never written. */
+    uint32_t capacity; /**< Size of the slot, PAGE_SIZE if the page is stored uncompressed. */
+  };
+#pragma pack(pop)
+
+  /**
+   * @class PageMap
+   * @brief Maps page IDs to slots and allocates the slots.
+   * @note Not thread-safe, the disk manager guards it with its own mutex.
+   */
+  class PageMap {
+  public:
+    static constexpr uint32_t SECTOR_SIZE = 512; /**< Slots are whole multiples of a sector. */
+
+    /**
+     * @brief Constructs an empty map, with no slot in use.
+     */
+    PageMap() noexcept;
+
+    /**
+     * @brief Find the slot of a page.
+     * @param pageId ID of the page.
+     * @return The page's slot, nullopt if the page was never written.
+     */
+    [[nodiscard]] std::optional<PageLocation> find(uint32_t pageId) const noexcept;
+
+    /**
+     * @brief Find a slot to write a page to, keeping its current slot if it still fits.
+     * @param pageId ID of the page.
+     * @param bytes Number of bytes to store, PAGE_SIZE to store the page uncompressed.
+     * @return The slot to write the page to.
+     */
+    [[nodiscard]] PageLocation place(uint32_t pageId, size_t bytes);
+
+    /**
+     * @brief Give up the slot of a deallocated page.
+     * @param pageId ID of the page.
+     */
+    void release(uint32_t pageId);
+
+    /**
+     * @brief Reserve space for a copy of the map itself.
+     * @param bytes Size of the serialized map.
+     * @return Offset to write the map to.
+     */
+    [[nodiscard]] uint64_t reserve(size_t bytes);
+
+    /**
+     * @brief Give up space once the map on disk stops referencing it.
+     * @param offset Offset of the space.
+     * @param bytes Size of the space.
+     */
+    void retire(uint64_t offset, size_t bytes);
+
+    /**
+     * @brief Free every retired slot and mark the map clean, once the map on disk is current.
+     */
+    void commit();
+
+    /**
+     * @brief Serialize the map to be written to disk.
+     * @return One PageLocation per page.
+     */
+    [[nodiscard]] std::vector<uint8_t> serialize() const;
+
+    /**
+     * @brief Replace the map with one read from disk, freeing every gap between the used slots.
+     * @param bytes The serialized map.
+     * @param mapOffset Offset the serialized map itself is stored at.
+     * @return True if loaded, false if the size isn't a whole number of locations.
+     */
+    bool load(std::span<const uint8_t> bytes, uint64_t mapOffset);
+
+    /**
+     * @brief Get the slot size that holds a number of bytes.
+     * @param bytes Number of bytes.
+     * @return The bytes rounded up to whole sectors.
+     */
+    [[nodiscard]] static uint64_t slotSize(uint64_t bytes) noexcept {
+      return (bytes + SECTOR_SIZE - 1) / SECTOR_SIZE * SECTOR_SIZE;
+    }
+
+    /**
+     * @brief Getters for the page map class.
+     * @{
+     */
+
+    /**
+     * @brief Check if slots moved since the map was last committed.
+     * @return True if the map has to be written, false otherwise.
+     */
+    [[nodiscard]] bool isDirty() const noexcept { return dirty; }
+
+    /**
+     * @brief Get the end of the space used for slots.
+     * @return Offset after the last slot.
+     */
+    [[nodiscard]] uint64_t end() const noexcept { return fileEnd; }
+
+    /**
+     * @brief Get the space in free slots, not counting retired ones.
+     * @return Number of free bytes.
+     */
+    [[nodiscard]] uint64_t freeBytes() const noexcept;
+
+    /** @} */
+
+  private:
+    /**
+     * @brief Take a free slot of a size, splitting a larger one or growing the file if needed.
+     * @param capacity Size of the slot.
+     * @return Offset of the slot.
+     */
+    [[nodiscard]] uint64_t take(uint64_t capacity);
+
+    /**
+     * @brief Add space to the free lists, cut into slots of at most a page.
+     * @param offset Offset of the space.
+     * @param bytes Size of the space, whole sectors.
+     */
+    void free(uint64_t offset, uint64_t bytes);
+
+    std::vector<PageLocation> locations;                /**< Slot of each page ID. */
+    std::vector<std::vector<uint64_t>> freeSlots;       /**< Free slot offsets by sector count. */
+    std::vector<std::pair<uint64_t, uint64_t>> retired; /**< Space freed on the next commit. */
+    uint64_t fileEnd;                                   /**< Offset after the last slot. */
+    bool dirty;                                         /**< Whether slots moved. */
+  };
+} // namespace pulse::storage
+
+#endif // PULSEDB_STORAGE_PAGE_MAP_HPP
@@ -0,0 +1,163 @@
+/**
+ * @file include/pulsedb/storage/segment_set.hpp
+ * @brief The SegmentSet class used in the storage system. Spreads the pages of a database over
+ * several segment files.
+ *
+ * A segmented database keeps only its header in the database file. Its pages go to segment
+ * files of a fixed number of pages each, page N to segment N / pagesPerSegment, and segments
+ * are dealt round robin to the directories they're configured with. Given one directory per
+ * mount point, consecutive segments land on different devices, and each device gets an I/O
+ * queue of its own.
+ *
+ * Segment files are opened on first use. A new segment has its whole size reserved up front
+ * without changing its length, so it isn't fragmented by growing a page at a time and reads past
+ * the last written page still hit EOF.
+ */
+
+#ifndef PULSEDB_STORAGE_SEGMENT_SET_HPP
+#define PULSEDB_STORAGE_SEGMENT_SET_HPP
+
+#include "pulsedb/storage/page.hpp"
+#include "pulsedb/utils/logger.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <shared_mutex>
+#include <vector>
+
+/**
+ * @namespace pulse::storage
+ * @brief The namespace for the storage system.
+ */
+namespace pulse::storage {
+  /**
+   * @struct SegmentLayout
+   * @brief How the pages of a database are split into segment files.
+   * @note Segments go next to the database file when no directory is given.
+   */
+  struct SegmentLayout {
+    uint32_t pagesPerSegment = 0;                   /**< Pages per segment, 0 for one file. */
+    std::vector<std::filesystem::path> directories; /**< Directories dealt segments in turn. */
+  };
+
+  /**
+   * @struct SegmentLocation
+   * @brief Where a page lives in a segment.
+   */
+  struct SegmentLocation {
+    int fd;          /**< Descriptor of the segment file. */
+    uint64_t offset; /**< Offset of the page in the segment. */
+  };
+
+  /**
+   * @class SegmentSet
+   * @brief Maps page IDs to segment files and owns their descriptors.
+   */
+  class SegmentSet {
+  public:
+    static constexpr uint32_t MIN_PAGES = 16; /**< Smallest segment allowed. */
+
+    /**
+     * @brief Constructs a set with no segment open yet.
+     * @param database Path to the database file, segments are named after it.
+     * @param pagesPerSegment Pages per segment.
+     * @param directories Directories the segments are dealt to, next to the database if empty.
+     * @param create Whether the database is new, segments left over from an old one are emptied.
+     * @throws std::runtime_error if pagesPerSegment is below MIN_PAGES.
+     */
+    SegmentSet(
+        const std::filesystem::path &database,
+        uint32_t pagesPerSegment,
+        std::vector<std::filesystem::path> directories,
+        bool create
+    );
+
+    /**
+     * @brief Closes every segment.
+     */
+    ~SegmentSet() noexcept;
+
+    // Disable copy operations, the set owns descriptors.
+    SegmentSet(const SegmentSet &) = delete;
+    SegmentSet &operator=(const SegmentSet &) = delete;
+
+    /**
+     * @brief Find where a page lives, opening its segment on first use.
+     * @param pageId ID of the page.
+     * @return The segment and offset, nullopt if the segment can't be opened.
+     */
+    [[nodiscard]] std::optional<SegmentLocation> locate(uint32_t pageId);
+
+    /**
+     * @brief Forces the writes of every open segment to disk.
+     * @return True if every segment synced, otherwise false.
+     */
+    bool sync();
+
+    /**
+     * @brief Get the bytes the segments take up.
+     * @return Total length of the open segments.
+     */
+    [[nodiscard]] uint64_t size() const;
+
+    /**
+     * @brief Get the path of a segment.
+     * @param segment Index of the segment.
+     * @return Path of the segment file.
+     */
+    [[nodiscard]] std::filesystem::path pathOf(size_t segment) const;
+
+    /**
+     * @brief Get the device a page's segment is on.
+     * @param pageId ID of the page.
+     * @return Index of the segment's directory.
+     */
+    [[nodiscard]] size_t deviceOf(uint32_t pageId) const noexcept {
+      return (pageId / pages) % deviceCount();
+    }
+
+    /**
+     * @brief Check if two pages follow each other in the same segment.
+     * @param pageId ID of the first page.
+     * @param nextId ID of the second page.
+     * @return True if nextId comes right after pageId in its segment.
+     */
+    [[nodiscard]] bool adjacent(uint32_t pageId, uint32_t nextId) const noexcept {
+      return nextId == pageId + 1 && nextId % pages != 0;
+    }
+
+    /**
+     * @brief Get the number of directories the segments are dealt to.
+     * @return Directory count, at least 1.
+     */
+    [[nodiscard]] size_t deviceCount() const noexcept {
+      return directories.empty() ? 1 : directories.size();
+    }
+
+    /**
+     * @brief Get the number of pages per segment.
+     * @return Pages per segment.
+     */
+    [[nodiscard]] uint32_t pagesPerSegment() const noexcept { return pages; }
+
+  private:
+    /**
+     * @brief Open a segment, creating it and reserving its space if it's new.
+     * @param segment Index of the segment.
+     * @return The descriptor, -1 if it can't be opened.
+     * @note Called with the mutex held exclusively.
+     */
+    int open(size_t segment);
+
+    std::filesystem::path database;                 /**< Path to the database file. */
+    uint32_t pages;                                 /**< Pages per segment. */
+    std::vector<std::filesystem::path> directories; /**< Directories segments are dealt to. */
+    bool create;                                    /**< Whether old segments are emptied. */
+    std::vector<int> files;                         /**< Segment descriptors, -1 if not open. */
+    mutable std::shared_mutex mutex;                /**< Guards files, shared for lookups. */
+    utils::Logger logger;                           /**< Logger instance. */
+  };
+} // namespace pulse::storage
+
+#endif // PULSEDB_STORAGE_SEGMENT_SET_HPP
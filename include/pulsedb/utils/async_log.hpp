@@ -0,0 +1,198 @@
+/**
+ * @file include/pulsedb/utils/async_log.hpp
+ * @brief The AsyncLog class used for logging messages. Takes log messages off the threads that
+ * log them.
+ *
+ * Every thread that logs gets a ring buffer of its own, which only that thread writes and only
+ * the drain thread reads, so pushing a message is a formatting into the ring and a release
+ * store. The drain thread writes the messages out, formatting each distinct second's timestamp
+ * once. Messages of one thread stay in order, messages of different threads may interleave.
+ */
+
+#ifndef PULSEDB_UTILS_ASYNC_LOG_HPP
+#define PULSEDB_UTILS_ASYNC_LOG_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/**
+ * @namespace pulse::utils
+ * @brief The namespace for utility functions.
+ */
+namespace pulse::utils {
+  enum class LogLevel : uint8_t;
+
+  /**
+   * @struct LogEntry
+   * @brief A formatted message waiting in a ring buffer.
+   */
+  struct LogEntry {
+    static constexpr size_t NAME_SIZE = 32;     /**< Longest logger name kept. */
+    static constexpr size_t MESSAGE_SIZE = 432; /**< Longest message kept, longer ones are cut. */
+
+    std::ostream *output;                   /**< The stream to write the message to. */
+    std::chrono::sys_seconds time;          /**< When the message was logged. */
+    LogLevel level;                         /**< The level of the message. */
+    uint8_t nameLength;                     /**< Length of the logger name. */
+    uint16_t length;                        /**< Length of the message. */
+    std::array<char, NAME_SIZE> name;       /**< The logger name. */
+    std::array<char, MESSAGE_SIZE> message; /**< The formatted message. */
+  };
+
+  /**
+   * @class LogRing
+   * @brief Single producer, single consumer ring of log entries.
+   */
+  class LogRing {
+  public:
+    static constexpr size_t CAPACITY = 256; /**< Entries per ring, a power of two. */
+
+    /**
+     * @brief Constructs an empty ring.
+     */
+    LogRing() noexcept : head(0), tail(0), retired(false) {}
+
+    /**
+     * @brief Get the entry the producer writes next, waiting for room if the ring is full.
+     * @param wake Signalled once the ring is half full, so the drain thread catches up.
+     * @return The entry, published by commit().
+     */
+    [[nodiscard]] LogEntry &reserve(std::condition_variable &wake) noexcept;
+
+    /**
+     * @brief Publish the entry handed out by reserve().
+     */
+    void commit() noexcept {
+      head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Write out every published entry.
+     * @return Number of entries written.
+     * @note Only one thread drains a ring at a time.
+     */
+    size_t drain();
+
+    /**
+     * @brief Mark the ring as given up by its thread, it is dropped once drained.
+     */
+    void retire() noexcept { retired.store(true, std::memory_order_release); }
+
+    /**
+     * @brief Check if the ring is given up and has nothing left to write.
+     * @return True if the ring can be dropped.
+     */
+    [[nodiscard]] bool isDone() const noexcept {
+      return retired.load(std::memory_order_acquire) &&
+             tail.load(std::memory_order_relaxed) == head.load(std::memory_order_acquire);
+    }
+
+  private:
+    std::array<LogEntry, CAPACITY> entries; /**< The entries, indexed modulo the capacity. */
+    alignas(64) std::atomic<size_t> head;   /**< Entries published, written by the producer. */
+    alignas(64) std::atomic<size_t> tail;   /**< Entries drained, written by the consumer. */
+    std::atomic<bool> retired;              /**< Whether the producer thread has exited. */
+  };
+
+  /**
+   * @class AsyncLog
+   * @brief Collects log messages from per-thread rings and writes them on a drain thread.
+   * @note Logs nothing itself, it is the logger's backend.
+   */
+  class AsyncLog {
+  public:
+    /**
+     * @brief Get the log, starting the drain thread on first use.
+     * @return The process wide log.
+     */
+    [[nodiscard]] static AsyncLog &instance();
+
+    /**
+     * @brief Stops the drain thread, writing whatever is still queued.
+     */
+    ~AsyncLog() noexcept;
+
+    // Disable copy operations.
+    AsyncLog(const AsyncLog &) = delete;
+    AsyncLog &operator=(const AsyncLog &) = delete;
+
+    /**
+     * @brief Format a message into the calling thread's ring.
+     * @tparam Args The argument types.
+     * @param output The stream to write the message to, must outlive the write.
+     * @param level The log level.
+     * @param name The name of the logger, cut to NAME_SIZE.
+     * @param fmt The format string.
+     * @param args The arguments to format.
+     */
+    template <typename... Args>
+    void push(
+        std::ostream &output, LogLevel level, std::string_view name,
+        std::format_string<Args...> fmt, Args &&...args
+    ) {
+      LogRing &ring = local();
+      LogEntry &entry = ring.reserve(wake);
+
+      entry.output = &output;
+      entry.time = std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now());
+      entry.level = level;
+
+      entry.nameLength = static_cast<uint8_t>(std::min(name.size(), LogEntry::NAME_SIZE));
+      std::copy_n(name.data(), entry.nameLength, entry.name.data());
+
+      const auto result = std::format_to_n(
+          entry.message.data(), LogEntry::MESSAGE_SIZE, fmt, std::forward<Args>(args)...
+      );
+      entry.length = static_cast<uint16_t>(std::min<size_t>(result.size, LogEntry::MESSAGE_SIZE));
+
+      ring.commit();
+    }
+
+    /**
+     * @brief Write out every message pushed so far, on the calling thread.
+     */
+    void flush();
+
+  private:
+    /**
+     * @brief Starts the drain thread.
+     */
+    AsyncLog();
+
+    /**
+     * @brief Get the ring of the calling thread, registering it on first use.
+     * @return The ring.
+     */
+    [[nodiscard]] LogRing &local();
+
+    /**
+     * @brief Drain every ring once, dropping the ones given up.
+     * @return Number of entries written.
+     */
+    size_t drainAll();
+
+    /**
+     * @brief Drain loop, runs until stopped.
+     */
+    void run();
+
+    std::vector<std::shared_ptr<LogRing>> rings; /**< Rings of the threads that logged. */
+    std::mutex mutex;                            /**< Guards rings and draining. */
+    std::condition_variable wake;                /**< Signalled by full rings and on stop. */
+    bool stopping;                               /**< Whether the log was asked to stop. */
+    std::thread thread;                          /**< The drain thread. */
+  };
+} // namespace pulse::utils
+
+#endif // PULSEDB_UTILS_ASYNC_LOG_HPP
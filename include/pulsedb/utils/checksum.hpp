@@ -0,0 +1,60 @@
+/**
+ * @file include/pulsedb/utils/checksum.hpp
+ * @brief CRC-32 checksums for detecting torn or corrupted on-disk data.
+ */
+
+#ifndef PULSEDB_UTILS_CHECKSUM_HPP
+#define PULSEDB_UTILS_CHECKSUM_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @namespace pulse::utils
+ * @brief The namespace for utility functions.
+ */
+namespace pulse::utils {
+  namespace detail {
+    /**
+     * @brief Build the lookup table for the reflected CRC-32 polynomial.
+     * @return The table.
+     */
+    constexpr std::array<uint32_t, 256> crc32Table() noexcept {
+      std::array<uint32_t, 256> table{};
+
+      for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+          crc = (crc >> 1) ^ (crc & 1 ? 0xEDB88320u : 0u);
+        }
+
+        table[i] = crc;
+      }
+
+      return table;
+    }
+
+    inline constexpr auto CRC32_TABLE = crc32Table(); /**< CRC-32 lookup table. */
+  } // namespace detail
+
+  /**
+   * @brief Compute or continue a CRC-32 (the zlib/IEEE variant) over a buffer.
+   * @param data The bytes to checksum.
+   * @param size Number of bytes.
+   * @param crc Checksum of the preceding bytes, zero to start.
+   * @return The checksum.
+   */
+  inline uint32_t crc32(const void *data, size_t size, uint32_t crc = 0) noexcept {
+    const auto *bytes = static_cast<const uint8_t *>(data);
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+      crc = detail::CRC32_TABLE[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+
+    return ~crc;
+  }
+} // namespace pulse::utils
+
+#endif // PULSEDB_UTILS_CHECKSUM_HPP
@@ -1,14 +1,30 @@
 /**
  * @file include/pulsedb/utils/logger.hpp
  * @brief The Logger class used for logging messages.
+ *
+ * Levels below PULSEDB_LOG_LEVEL are compiled out: their calls are empty inline functions, so
+ * nothing is formatted. The PULSEDB_LOG_* macros also skip evaluating the arguments, of levels
+ * compiled out or filtered at runtime, so calls whose arguments build strings or make syscalls
+ * use them. Messages are written straight to the logger's stream, or handed to the AsyncLog
+ * once logging::setAsync() is on.
  */
 
 #ifndef PULSEDB_UTILS_LOGGER_HPP
 #define PULSEDB_UTILS_LOGGER_HPP
 
+#include "pulsedb/utils/async_log.hpp"
+#include <atomic>
 #include <chrono>
 #include <iostream>
 
+/**
+ * @def PULSEDB_LOG_LEVEL
+ * @brief The least severe level compiled in, DEBUG, INFO, WARN, ERROR or NONE.
+ */
+#ifndef PULSEDB_LOG_LEVEL
+#define PULSEDB_LOG_LEVEL DEBUG
+#endif
+
 /**
  * @namespace pulse::utils
  * @brief The namespace for utility functions.
@@ -54,7 +70,7 @@ namespace pulse::utils {
 
     /**
      * @brief Sets the global log level.
-     * @param level The LogLevel to set as global.
+     * @param level The least severe level shown, NONE to show nothing.
      */
     constexpr void setLevel(LogLevel level) noexcept { globalLevel = level; }
 
@@ -63,6 +79,88 @@ namespace pulse::utils {
      * @return The global log level.
      */
     [[nodiscard]] inline LogLevel getLevel() noexcept { return globalLevel; }
+
+    /**
+     * @brief Get how severe a level is, DEBUG being the least and NONE above every level.
+     * @param level The level.
+     * @return The severity rank.
+     */
+    [[nodiscard]] constexpr uint8_t severity(LogLevel level) noexcept {
+      switch (level) {
+        case LogLevel::DEBUG:
+          return 0;
+
+        case LogLevel::INFO:
+          return 1;
+
+        case LogLevel::WARN:
+          return 2;
+
+        case LogLevel::ERROR:
+          return 3;
+
+        default:
+          return 4;
+      }
+    }
+
+    /**
+     * @brief The least severe level compiled in.
+     */
+    inline constexpr LogLevel COMPILED_LEVEL = LogLevel::PULSEDB_LOG_LEVEL;
+
+    /**
+     * @brief Check if messages of a level are compiled in.
+     * @param level The level.
+     * @return True if the level is at least as severe as COMPILED_LEVEL.
+     */
+    [[nodiscard]] constexpr bool isCompiled(LogLevel level) noexcept {
+      return level != LogLevel::NONE && severity(level) >= severity(COMPILED_LEVEL);
+    }
+
+    /**
+     * @brief Check if messages of a level are logged, at compile time and at runtime.
+     * @param level The level.
+     * @return True if the level is compiled in and at least as severe as the global level.
+     */
+    [[nodiscard]] inline bool isEnabled(LogLevel level) noexcept {
+      return isCompiled(level) && severity(level) >= severity(getLevel());
+    }
+
+    /**
+     * @brief Whether messages go through the AsyncLog.
+     */
+    inline std::atomic<bool> asyncOutput = false;
+
+    /**
+     * @brief Hand messages to the AsyncLog, or write them on the logging thread again.
+     * @param async True for asynchronous output.
+     * @note Turning it off first writes out whatever is still queued.
+     */
+    inline void setAsync(bool async) {
+      if (!async && asyncOutput.exchange(false)) {
+        AsyncLog::instance().flush();
+      }
+
+      asyncOutput = async;
+    }
+
+    /**
+     * @brief Check if messages go through the AsyncLog.
+     * @return True for asynchronous output.
+     */
+    [[nodiscard]] inline bool isAsync() noexcept {
+      return asyncOutput.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Write out every message queued so far, if output is asynchronous.
+     */
+    inline void flush() {
+      if (isAsync()) {
+        AsyncLog::instance().flush();
+      }
+    }
   } // namespace logging
 } // namespace pulse::utils
 
@@ -94,7 +192,7 @@ namespace pulse::utils {
      *  supports the `<<` operator.
      */
     template <OutputStream Stream>
-    explicit constexpr Logger(const std::string &name, Stream &stream) noexcept
+    explicit constexpr Logger(std::string_view name, Stream &stream) noexcept
         : name(name), output(stream) {}
 
     /**
@@ -104,7 +202,9 @@ namespace pulse::utils {
      * @param args The arguments to format.
      */
     template <typename... Args> void info(std::format_string<Args...> fmt, Args &&...args) const {
-      log(LogLevel::INFO, fmt, std::forward<Args>(args)...);
+      if constexpr (logging::isCompiled(LogLevel::INFO)) {
+        log(LogLevel::INFO, fmt, std::forward<Args>(args)...);
+      }
     }
 
     /**
@@ -114,7 +214,9 @@ namespace pulse::utils {
      * @param args The arguments to format.
      */
     template <typename... Args> void debug(std::format_string<Args...> fmt, Args &&...args) const {
-      log(LogLevel::DEBUG, fmt, std::forward<Args>(args)...);
+      if constexpr (logging::isCompiled(LogLevel::DEBUG)) {
+        log(LogLevel::DEBUG, fmt, std::forward<Args>(args)...);
+      }
     }
 
     /**
@@ -124,7 +226,9 @@ namespace pulse::utils {
      * @param args The arguments to format.
      */
     template <typename... Args> void warn(std::format_string<Args...> fmt, Args &&...args) const {
-      log(LogLevel::WARN, fmt, std::forward<Args>(args)...);
+      if constexpr (logging::isCompiled(LogLevel::WARN)) {
+        log(LogLevel::WARN, fmt, std::forward<Args>(args)...);
+      }
     }
 
     /**
@@ -134,7 +238,9 @@ namespace pulse::utils {
      * @param args The arguments to format.
      */
     template <typename... Args> void error(std::format_string<Args...> fmt, Args &&...args) const {
-      log(LogLevel::ERROR, fmt, std::forward<Args>(args)...);
+      if constexpr (logging::isCompiled(LogLevel::ERROR)) {
+        log(LogLevel::ERROR, fmt, std::forward<Args>(args)...);
+      }
     }
 
   private:
@@ -145,35 +251,36 @@ namespace pulse::utils {
      * @param fmt The format string.
      * @param args The arguments to format.
      */
-    // clang-format off
     template <typename... Args>
     void log(LogLevel level, std::format_string<Args...> fmt, Args &&...args) const {
-      // If the global log level is less than the specified level, return.
-      if (logging::getLevel() < level)
+      // Messages less severe than the global level aren't shown.
+      if (!logging::isEnabled(level)) {
+        return;
+      }
+
+      if (logging::isAsync()) {
+        AsyncLog::instance().push(output, level, name, fmt, std::forward<Args>(args)...);
         return;
+      }
 
-      // Get the current timestamp & format.
-      const auto time = std::chrono::current_zone()->to_local(
-          std::chrono::system_clock::now());
-
-      const std::string timestamp =
-          std::format("{:%Y-%m-%d %H:%M:%S}",
-                      std::chrono::floor<std::chrono::seconds>(time));
-
-      const auto &[code, prefix] = LEVEL_DATA[static_cast<uint8_t>(level)];
-      
-      // Send the formatted log message to the output stream.
-      output << std::format(
-        "[{}]{}[{}:{}]: \x1B[0m{}\n",
-        timestamp,
-        code,
-        name,
-        prefix,
-        std::format(fmt, std::forward<Args>(args)...)
-      );
-      // clang-format on
+      const auto time = std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now());
+      write(output, level, name, time, std::format(fmt, std::forward<Args>(args)...));
     }
 
+    /**
+     * @brief Write a formatted message to a stream, with its timestamp and level.
+     * @param output The output stream.
+     * @param level The log level.
+     * @param name The name of the logger.
+     * @param time When the message was logged.
+     * @param message The formatted message.
+     * @note The timestamp is formatted once per second and thread.
+     */
+    static void write(
+        std::ostream &output, LogLevel level, std::string_view name,
+        std::chrono::sys_seconds time, std::string_view message
+    );
+
     /**
      * @brief The data for each log level.
      */
@@ -186,7 +293,34 @@ namespace pulse::utils {
 
     std::string_view name; /**< The name of the logger. */
     std::ostream &output;  /**< The output stream for the logger. */
+
+    friend class LogRing;
   };
 } // namespace pulse::utils
 
+/**
+ * @def PULSEDB_LOG_AT
+ * @brief Log through a logger method, evaluating the arguments only if the level is enabled.
+ */
+#define PULSEDB_LOG_AT(level, method, logger, ...)                                              \
+  do {                                                                                          \
+    if constexpr (::pulse::utils::logging::isCompiled(::pulse::utils::LogLevel::level)) {       \
+      if (::pulse::utils::logging::isEnabled(::pulse::utils::LogLevel::level)) {                \
+        (logger).method(__VA_ARGS__);                                                           \
+      }                                                                                         \
+    }                                                                                           \
+  } while (false)
+
+/** @def PULSEDB_LOG_DEBUG @brief Log at DEBUG, arguments are only evaluated if shown. */
+#define PULSEDB_LOG_DEBUG(logger, ...) PULSEDB_LOG_AT(DEBUG, debug, logger, __VA_ARGS__)
+
+/** @def PULSEDB_LOG_INFO @brief Log at INFO, arguments are only evaluated if shown. */
+#define PULSEDB_LOG_INFO(logger, ...) PULSEDB_LOG_AT(INFO, info, logger, __VA_ARGS__)
+
+/** @def PULSEDB_LOG_WARN @brief Log at WARN, arguments are only evaluated if shown. */
+#define PULSEDB_LOG_WARN(logger, ...) PULSEDB_LOG_AT(WARN, warn, logger, __VA_ARGS__)
+
+/** @def PULSEDB_LOG_ERROR @brief Log at ERROR, arguments are only evaluated if shown. */
+#define PULSEDB_LOG_ERROR(logger, ...) PULSEDB_LOG_AT(ERROR, error, logger, __VA_ARGS__)
+
 #endif // PULSEDB_UTILS_LOGGER_HPP
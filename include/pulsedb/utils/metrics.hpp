@@ -0,0 +1,201 @@
+/**
+ * @file include/pulsedb/utils/metrics.hpp
+ * @brief The Counter and Histogram classes used for metrics, and their Prometheus text output.
+ *
+ * Counters are striped: every thread adds to one of a fixed number of cache-line sized stripes,
+ * picked once per thread, and reading a counter sums them. Threads updating the same counter
+ * mostly touch different lines, so counting stays a relaxed increment on a line the thread owns.
+ *
+ * Histograms count latencies in power of two buckets of nanoseconds, striped the same way.
+ */
+
+#ifndef PULSEDB_UTILS_METRICS_HPP
+#define PULSEDB_UTILS_METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * @namespace pulse::utils
+ * @brief The namespace for utility functions.
+ */
+namespace pulse::utils {
+  inline constexpr size_t CACHE_LINE_SIZE = 64; /**< Alignment that keeps stripes apart. */
+  inline constexpr size_t STRIPE_COUNT = 16;    /**< Stripes per counter, a power of two. */
+
+  /**
+   * @brief Get the stripe of the calling thread.
+   * @return A stripe index below STRIPE_COUNT, the same for every call of a thread.
+   */
+  [[nodiscard]] size_t threadStripe() noexcept;
+
+  /**
+   * @class Counter
+   * @brief A monotonic counter, striped over cache lines.
+   */
+  class Counter {
+  public:
+    /**
+     * @brief Add to the counter.
+     * @param count The amount to add.
+     */
+    void add(uint64_t count = 1) noexcept {
+      stripes[threadStripe()].value.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the counter value.
+     * @return The sum of every stripe.
+     */
+    [[nodiscard]] uint64_t value() const noexcept;
+
+  private:
+    /**
+     * @struct Stripe
+     * @brief The part of the counter some threads add to, on a line of its own.
+     */
+    struct alignas(CACHE_LINE_SIZE) Stripe {
+      std::atomic<uint64_t> value{0}; /**< The stripe's count. */
+    };
+
+    std::array<Stripe, STRIPE_COUNT> stripes; /**< The stripes of the counter. */
+  };
+
+  /**
+   * @struct HistogramSnapshot
+   * @brief The bucket counts of a histogram at one point in time.
+   */
+  struct HistogramSnapshot {
+    static constexpr size_t BUCKETS = 32; /**< Bucket i holds values below 2^i nanoseconds. */
+
+    std::array<uint64_t, BUCKETS> buckets{}; /**< Count of each bucket, the last one unbounded. */
+    uint64_t count = 0;                      /**< Total number of values. */
+    uint64_t sum = 0;                        /**< Sum of the values, in nanoseconds. */
+
+    /**
+     * @brief Get the upper bound of a bucket.
+     * @param bucket The bucket, below BUCKETS - 1.
+     * @return The bound in nanoseconds, values in the bucket are below it.
+     */
+    [[nodiscard]] static constexpr uint64_t upperBound(size_t bucket) noexcept {
+      return uint64_t{1} << bucket;
+    }
+
+    /**
+     * @brief Estimate a quantile from the buckets.
+     * @param quantile The quantile, between 0 and 1.
+     * @return The upper bound of the bucket holding it in nanoseconds, 0 if there are no values.
+     */
+    [[nodiscard]] uint64_t percentile(double quantile) const noexcept;
+
+    /**
+     * @brief Add another snapshot's counts to this one.
+     * @param other The snapshot to add.
+     */
+    void merge(const HistogramSnapshot &other) noexcept;
+  };
+
+  /**
+   * @class Histogram
+   * @brief A latency histogram with power of two buckets, striped over cache lines.
+   */
+  class Histogram {
+  public:
+    /**
+     * @brief Record a value.
+     * @param nanos The value in nanoseconds.
+     */
+    void record(uint64_t nanos) noexcept;
+
+    /**
+     * @brief Record the time passed since a start time.
+     * @param start When the measured operation started.
+     */
+    void since(std::chrono::steady_clock::time_point start) noexcept {
+      const auto elapsed = std::chrono::steady_clock::now() - start;
+      record(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+
+    /**
+     * @brief Take a snapshot of the buckets.
+     * @return The counts summed over every stripe.
+     */
+    [[nodiscard]] HistogramSnapshot snapshot() const noexcept;
+
+  private:
+    /**
+     * @struct Stripe
+     * @brief The buckets some threads record into, on lines of their own.
+     */
+    struct alignas(CACHE_LINE_SIZE) Stripe {
+      std::array<std::atomic<uint64_t>, HistogramSnapshot::BUCKETS> buckets{}; /**< Counts. */
+      std::atomic<uint64_t> sum{0}; /**< Sum of the values recorded. */
+    };
+
+    std::array<Stripe, STRIPE_COUNT> stripes; /**< The stripes of the histogram. */
+  };
+
+  /**
+   * @class PrometheusWriter
+   * @brief Builds metrics in the Prometheus text exposition format.
+   */
+  class PrometheusWriter {
+  public:
+    /**
+     * @brief Constructs an empty writer.
+     * @param prefix Prepended to every metric name, with an underscore.
+     */
+    explicit PrometheusWriter(std::string_view prefix = "pulsedb") : prefix(prefix) {}
+
+    /**
+     * @brief Write a counter.
+     * @param name The metric name, without the prefix.
+     * @param help The help text.
+     * @param value The counter value.
+     */
+    void counter(std::string_view name, std::string_view help, uint64_t value);
+
+    /**
+     * @brief Write a gauge.
+     * @param name The metric name, without the prefix.
+     * @param help The help text.
+     * @param value The gauge value.
+     */
+    void gauge(std::string_view name, std::string_view help, double value);
+
+    /**
+     * @brief Write a histogram of latencies, in seconds.
+     * @param name The metric name, without the prefix, ending in _seconds.
+     * @param help The help text.
+     * @param histogram The histogram snapshot.
+     */
+    void histogram(
+        std::string_view name, std::string_view help, const HistogramSnapshot &histogram
+    );
+
+    /**
+     * @brief Get the text written so far.
+     * @return The metrics, one sample per line.
+     */
+    [[nodiscard]] const std::string &text() const noexcept { return output; }
+
+  private:
+    /**
+     * @brief Write the help and type lines of a metric.
+     * @param name The metric name, without the prefix.
+     * @param help The help text.
+     * @param type The metric type.
+     */
+    void describe(std::string_view name, std::string_view help, std::string_view type);
+
+    std::string prefix; /**< Prefix of every metric name. */
+    std::string output; /**< The text written so far. */
+  };
+} // namespace pulse::utils
+
+#endif // PULSEDB_UTILS_METRICS_HPP
@@ -0,0 +1,54 @@
+/**
+ * @file include/pulsedb/utils/numa.hpp
+ * @brief NUMA topology of the machine: how many memory nodes it has, which one a thread runs on
+ * and binding memory to one of them.
+ *
+ * Talks to the kernel directly, through sysfs, getcpu and mbind, so nothing links against
+ * libnuma. A machine without NUMA support reads as a single node everything is local to.
+ */
+
+#ifndef PULSEDB_UTILS_NUMA_HPP
+#define PULSEDB_UTILS_NUMA_HPP
+
+#include <cstddef>
+
+/**
+ * @namespace pulse::utils
+ * @brief The namespace for utility functions.
+ */
+namespace pulse::utils {
+  /**
+   * @brief Get the number of NUMA nodes of the machine.
+   * @return Highest online node plus one, at least 1.
+   * @note Read once, nodes coming online later aren't seen.
+   */
+  [[nodiscard]] size_t numaNodes() noexcept;
+
+  /**
+   * @brief Get the node the calling thread runs on.
+   * @return The node set with setThreadNode(), otherwise the node of the CPU it's running on.
+   * @note A thread that isn't pinned can be moved to another node at any time after the call.
+   */
+  [[nodiscard]] size_t currentNode() noexcept;
+
+  /**
+   * @brief Tell the callers of currentNode() which node the calling thread belongs to.
+   * @param node The node, for threads their owner keeps on that node's CPUs.
+   * @note Saves asking the kernel on every call, and lets a thread act as if it ran elsewhere.
+   */
+  void setThreadNode(size_t node) noexcept;
+
+  /**
+   * @brief Ask for memory to be placed on a node.
+   * @param memory Start of the memory, page aligned and not touched yet.
+   * @param length Number of bytes.
+   * @param node The node to place it on.
+   * @return True if bound, false on a single node, for a node that doesn't exist or if the
+   * kernel refused.
+   * @note The node is preferred rather than required, memory spills to other nodes once it's
+   * full instead of failing the fault.
+   */
+  bool bindToNode(void *memory, size_t length, size_t node) noexcept;
+} // namespace pulse::utils
+
+#endif // PULSEDB_UTILS_NUMA_HPP
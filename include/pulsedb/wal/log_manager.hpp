@@ -0,0 +1,225 @@
+/**
+ * @file include/pulsedb/wal/log_manager.hpp
+ * @brief The LogManager class used by the write-ahead log. Appends redo records and group
+ * commits them.
+ */
+
+#ifndef PULSEDB_WAL_LOG_MANAGER_HPP
+#define PULSEDB_WAL_LOG_MANAGER_HPP
+
+#include "pulsedb/storage/disk_manager.hpp"
+#include "pulsedb/storage/page.hpp"
+#include "pulsedb/utils/logger.hpp"
+#include "pulsedb/wal/log_record.hpp"
+
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+
+/**
+ * @namespace pulse::wal
+ * @brief The namespace for the write-ahead log.
+ */
+namespace pulse::wal {
+  /**
+   * @class LogManager
+   * @brief Appends redo records to a sequential log file and makes them durable.
+   *
+   * Records are appended to an in-memory buffer and stamp the page they describe with their LSN.
+   * flush() makes everything up to an LSN durable. The first caller to find the log behind
+   * becomes the leader and writes and syncs the whole buffer. Callers arriving meanwhile wait for
+   * it, then one of them carries everything appended in the meantime with the next sync. Many
+   * concurrent commits therefore share one fdatasync.
+   *
+   * The first change to a page after it is created should be logged with logPage(), so redo has a
+   * full image to apply later updates to.
+   *
+   * checkpoint() records which pages the database may be missing changes to, so recovery only
+   * reads the log from the oldest of those. Redo is split by page ID over worker threads, each
+   * replaying its pages' records in log order.
+   */
+  class LogManager {
+  public:
+    static constexpr uint32_t LOG_MAGIC = 0x50574C; /**< "PWL" magic number. */
+    static constexpr uint32_t LOG_VERSION = 2;      /**< Current log version. */
+    static constexpr uint32_t FILE_HEADER_SIZE =
+        sizeof(LogFileHeader); /**< Size of file header. */
+    static constexpr uint32_t RECORD_HEADER_SIZE =
+        sizeof(LogRecordHeader); /**< Size of record header. */
+    static constexpr size_t ALL_CORES = 0; /**< Recover with a redo worker per core. */
+
+    /**
+     * @brief Opens or creates the log at the given path.
+     * @param path Path to the log file.
+     * @param create Whether to create a new log or use an existing one.
+     * @throws std::runtime_error if the log can't be opened or is invalid.
+     */
+    explicit LogManager(const std::filesystem::path &path, bool create = false);
+
+    /**
+     * @brief Flushes buffered records and closes the log.
+     */
+    ~LogManager() noexcept;
+
+    // Disable copy operations.
+    LogManager(const LogManager &) = delete;
+    LogManager &operator=(const LogManager &) = delete;
+
+    /**
+     * @brief Log the after-image of a byte range of a page and stamp the page's LSN.
+     * @param page The modified page.
+     * @param offset Offset of the modified bytes.
+     * @param length Number of modified bytes.
+     * @return The LSN of the record, or 0 if the range is out of bounds.
+     */
+    uint64_t logUpdate(
+        storage::Page &page, storage::PageOffset offset, storage::PageOffset length
+    );
+
+    /**
+     * @brief Log the after-image of a whole page and stamp the page's LSN.
+     * @param page The modified page.
+     * @return The LSN of the record.
+     */
+    uint64_t logPage(storage::Page &page);
+
+    /**
+     * @brief Append a commit record and wait until it is durable.
+     * @return The LSN of the commit record, or 0 if the log could not be synced.
+     */
+    uint64_t commit();
+
+    /**
+     * @brief Make every record up to the given LSN durable, sharing the sync with other callers.
+     * @param lsn The LSN that has to be durable.
+     * @return True if durable, false if writing or syncing the log failed.
+     */
+    bool flush(uint64_t lsn);
+
+    /**
+     * @brief Log a checkpoint and point the log header at it once it's durable.
+     * @param beginLsn The log end before the dirty pages were collected.
+     * @param dirtyPages Pages that may have changes the disk is missing, with their recLsn.
+     * @return The LSN of the checkpoint record, or 0 if it couldn't be made durable.
+     * @note Every page left out must have all its records up to beginLsn on disk already.
+     */
+    uint64_t checkpoint(uint64_t beginLsn, std::span<const DirtyPage> dirtyPages);
+
+    /**
+     * @brief Replay the log onto the database, redoing changes pages on disk are missing.
+     * @param diskManager The database to recover.
+     * @param workers Redo threads, ALL_CORES for one per core.
+     * @return Number of records applied.
+     * @note Starts at the last checkpoint. A torn record at the end of the log is cut off.
+     */
+    size_t recover(storage::DiskManager &diskManager, size_t workers = ALL_CORES);
+
+    /**
+     * @brief Getters for the log manager class.
+     * @{
+     */
+
+    /**
+     * @brief Get the LSN of the last appended record.
+     * @return The current LSN.
+     */
+    [[nodiscard]] uint64_t currentLsn() const noexcept;
+
+    /**
+     * @brief Get the LSN up to which the log is durable.
+     * @return The flushed LSN.
+     */
+    [[nodiscard]] uint64_t flushedLsn() const noexcept;
+
+    /**
+     * @brief Get the number of log syncs performed.
+     * @return Number of fdatasync calls.
+     */
+    [[nodiscard]] size_t syncCount() const noexcept;
+
+    /**
+     * @brief Get the LSN of the last durable checkpoint.
+     * @return The checkpoint record's LSN, 0 if there's none.
+     */
+    [[nodiscard]] uint64_t checkpointLsn() const noexcept;
+
+    /** @} */
+
+  private:
+    /**
+     * @brief Append a record to the buffer.
+     * @param type The record type.
+     * @param pageId The page the record applies to.
+     * @param offset Offset of the payload in the page.
+     * @param payload The payload bytes.
+     * @param length Length of the payload.
+     * @return The LSN of the record.
+     * @note Caller must hold the mutex.
+     */
+    uint64_t append(
+        LogRecordType type,
+        uint32_t pageId,
+        storage::PageOffset offset,
+        const void *payload,
+        storage::PageOffset length
+    );
+
+    /**
+     * @brief Read the log, keeping the records up to the first torn or corrupt one.
+     * @param from File offset of the first record to read.
+     * @return The valid records, headers followed by their payloads.
+     */
+    std::vector<uint8_t> readRecords(uint64_t from);
+
+    /**
+     * @brief Read a checkpoint record.
+     * @param lsn The LSN of the record.
+     * @return The checkpoint, nullopt if there's no intact checkpoint record there.
+     */
+    std::optional<CheckpointRecord> readCheckpoint(uint64_t lsn);
+
+    /**
+     * @brief Check the record at the start of a buffer.
+     * @param bytes The record's bytes.
+     * @param available Bytes readable from there.
+     * @param offset File offset of the record.
+     * @return The record's size, 0 if it's torn or doesn't belong there.
+     */
+    static size_t intact(const uint8_t *bytes, size_t available, uint64_t offset) noexcept;
+
+    /** @brief Size of a CHECKPOINT record. */
+    static constexpr size_t CHECKPOINT_SIZE = RECORD_HEADER_SIZE + sizeof(CheckpointRecord);
+
+    /** @brief Dirty page table entries per DIRTY_PAGES record, a page's worth. */
+    static constexpr size_t DIRTY_PER_RECORD = storage::Page::PAGE_SIZE / sizeof(DirtyPage);
+
+    /**
+     * @brief Write a whole buffer to the log file.
+     * @param buffer Bytes to write.
+     * @param offset File offset to write at.
+     * @return True if written, false otherwise.
+     */
+    bool writeAt(const std::vector<uint8_t> &buffer, uint64_t offset) noexcept;
+
+    int fd;                     /**< Log file descriptor. */
+    std::filesystem::path path; /**< Path to the log file. */
+
+    std::vector<uint8_t> buffer; /**< Records appended but not yet written. */
+    uint64_t nextLsn;            /**< LSN the next record ends past, i.e. the buffer end. */
+    uint64_t bufferStart;        /**< File offset of the first buffered byte. */
+    uint64_t durableLsn;         /**< Everything before this offset is synced. */
+    bool flushing;               /**< Whether a leader is writing right now. */
+    size_t syncs;                /**< Number of syncs performed. */
+    uint64_t lastCheckpoint;     /**< LSN of the checkpoint the header points at. */
+
+    mutable std::mutex mutex;        /**< Guards the buffer and the LSNs. */
+    std::condition_variable flushed; /**< Signalled when a leader finishes. */
+
+    utils::Logger logger; /**< Logger instance. */
+  };
+} // namespace pulse::wal
+
+#endif // PULSEDB_WAL_LOG_MANAGER_HPP
@@ -0,0 +1,104 @@
+/**
+ * @file include/pulsedb/wal/log_record.hpp
+ * @brief The on-disk format of write-ahead log records.
+ *
+ * Log File Layout:
+ * +---------------------------------+ 0x0000
+ * | LogFileHeader (16 bytes)        |
+ * |   magic:     uint32_t           | -- Identifies a log file.
+ * |   version:   uint32_t           | -- Log format version.
+ * |   checkpoint: uint64_t          | -- LSN of the last checkpoint.
+ * +---------------------------------+ 0x0010
+ * | Log Records                     | -- Appended back to back.
+ * |   [Each record:]                |
+ * |   struct LogRecordHeader {      |
+ * |     size:     uint32_t          | -- Header plus payload.
+ * |     checksum: uint32_t          | -- CRC-32 of the record.
+ * |     lsn:      uint64_t          | -- File offset of the record end.
+ * |     type:     uint8_t           | -- Record type.
+ * |     pageId:   uint32_t          | -- Page the record applies to.
+ * |     offset:   PageOffset        | -- Offset of the bytes in the page.
+ * |     length:   PageOffset        | -- Length of the payload.
+ * |   }                             |
+ * |   [Payload]                     | -- After-image of the bytes.
+ * +---------------------------------+ <- VARIES
+ *
+ * A checkpoint is a run of DIRTY_PAGES records, the pages that may be newer in the pool than on
+ * disk with the LSN redo of each has to start after, ended by a CHECKPOINT record. The header
+ * points at the last CHECKPOINT record once it's durable, so restart reads the log from there.
+ *
+ * A record's LSN is the file offset just past it. A page stamped with LSN n is durable in the log
+ * once everything before offset n has been synced. Offsets and lengths are as wide as the build's
+ * page size needs, so a log is only read by builds with the same page size as its database.
+ */
+
+#ifndef PULSEDB_WAL_LOG_RECORD_HPP
+#define PULSEDB_WAL_LOG_RECORD_HPP
+
+#include "pulsedb/storage/page.hpp"
+#include <cstdint>
+
+/**
+ * @namespace pulse::wal
+ * @brief The namespace for the write-ahead log.
+ */
+namespace pulse::wal {
+  /**
+   * @enum LogRecordType
+   * @brief Represents the type of a log record.
+   */
+  enum class LogRecordType : uint8_t {
+    INVALID = 0,     /**< Invalid record. */
+    UPDATE = 1,      /**< After-image of a byte range of a page. */
+    PAGE = 2,        /**< After-image of a whole page. */
+    COMMIT = 3,      /**< Commit point, carries no payload. */
+    DIRTY_PAGES = 4, /**< Part of a checkpoint's dirty page table. */
+    CHECKPOINT = 5   /**< End of a checkpoint, where redo starts. */
+  };
+
+#pragma pack(push, 1)
+  /**
+   * @struct LogFileHeader
+   * @brief Header of the log file.
+   */
+  struct LogFileHeader {
+    uint32_t magic;      /**< Magic number to identify log files. */
+    uint32_t version;    /**< Log format version. */
+    uint64_t checkpoint; /**< LSN of the last checkpoint record, 0 if there's none. */
+  };
+
+  /**
+   * @struct LogRecordHeader
+   * @brief Header preceding the payload of every log record.
+   */
+  struct LogRecordHeader {
+    uint32_t size;              /**< Size of the header plus the payload. */
+    uint32_t checksum;          /**< CRC-32 of the record with this field zeroed. */
+    uint64_t lsn;               /**< Log sequence number, the file offset past the record. */
+    LogRecordType type;         /**< The type of the record. */
+    uint32_t pageId;            /**< The page the record applies to. */
+    storage::PageOffset offset; /**< Offset of the payload bytes in the page. */
+    storage::PageOffset length; /**< Length of the payload. */
+  };
+
+  /**
+   * @struct DirtyPage
+   * @brief An entry of a checkpoint's dirty page table.
+   */
+  struct DirtyPage {
+    uint32_t pageId; /**< The page. */
+    uint64_t recLsn; /**< Records of the page up to this LSN are on disk. */
+  };
+
+  /**
+   * @struct CheckpointRecord
+   * @brief Payload of a CHECKPOINT record.
+   */
+  struct CheckpointRecord {
+    uint64_t beginLsn; /**< Log end when the checkpoint began. */
+    uint64_t redoLsn;  /**< Records up to this LSN never need redo. */
+  };
+#pragma pack(pop)
+} // namespace pulse::wal
+
+#endif // PULSEDB_WAL_LOG_RECORD_HPP
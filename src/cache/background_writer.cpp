@@ -0,0 +1,100 @@
+/**
+ * @file src/cache/background_writer.cpp
+ * @brief Implements the background writer class.
+ */
+
+#include "pulsedb/cache/background_writer.hpp"
+#include <algorithm>
+
+namespace pulse::cache {
+  BackgroundWriter::BackgroundWriter(BufferPool &pool, WriterConfig config)
+      : pool(pool), config(config), written(0), compacted(0), checkpoints(0), stopping(false),
+        logger("background-writer") {
+    thread = std::thread([this] { run(); });
+    logger.info("started background writer");
+  }
+
+  BackgroundWriter::~BackgroundWriter() noexcept { stop(); }
+
+  void BackgroundWriter::stop() noexcept {
+    {
+      std::lock_guard lock(mutex);
+      stopping = true;
+    }
+
+    wake.notify_all();
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+
+  void BackgroundWriter::run() {
+    using clock = std::chrono::steady_clock;
+
+    // Token bucket holding at most one second worth of writes.
+    const auto rate = static_cast<double>(config.maxPagesPerSecond);
+    double tokens = rate;
+    auto last = clock::now();
+    auto checkpointed = last;
+
+    bool eager = false;
+    bool busy = false;
+
+    std::unique_lock lock(mutex);
+    while (!stopping) {
+      // Keep going without a pause while there is a backlog to work off.
+      if (!busy) {
+        wake.wait_for(lock, config.interval, [this] { return stopping; });
+        if (stopping) {
+          break;
+        }
+      }
+
+      lock.unlock();
+
+      // Compacted pages stay dirty, so they are written below like any other.
+      if (config.compactBatch > 0) {
+        compacted += pool.compact(config.compactBatch);
+      }
+
+      const double ratio = pool.dirtyRatio();
+      if (ratio >= config.highRatio) {
+        eager = true;
+      }
+
+      else if (ratio <= config.lowRatio) {
+        eager = false;
+      }
+
+      size_t limit = config.batchSize;
+      if (config.maxPagesPerSecond > 0) {
+        const auto now = clock::now();
+        tokens = std::min(rate, tokens + rate * std::chrono::duration<double>(now - last).count());
+        last = now;
+
+        limit = std::min(limit, static_cast<size_t>(tokens));
+      }
+
+      const size_t count = limit > 0 ? pool.writeBack(limit, config.lookahead, eager) : 0;
+      tokens -= static_cast<double>(count);
+      written += count;
+      busy = eager && count == limit && count > 0;
+
+      if (count > 0) {
+        logger.debug("wrote back {} pages, dirty ratio {}", count, ratio);
+      }
+
+      // Checkpoint after writing, so the pages just written drop out of the dirty page table.
+      const auto now = clock::now();
+      const auto every = config.checkpointInterval;
+      if (every.count() > 0 && now - checkpointed >= every) {
+        checkpointed = now;
+        if (pool.checkpoint() > 0) {
+          checkpoints++;
+        }
+      }
+
+      lock.lock();
+    }
+  }
+} // namespace pulse::cache
@@ -6,70 +6,436 @@
 #include "pulsedb/cache/buffer_pool.hpp"
 #include "pulsedb/storage/data_page.hpp"
 #include "pulsedb/storage/index_page.hpp"
+#include "pulsedb/utils/checksum.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <thread>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+  /** @brief Magic number of warm-up snapshots, "PWU". */
+  constexpr uint32_t WARMUP_MAGIC = 0x505755;
+
+  /**
+   * @struct WarmupHeader
+   * @brief Header of a warm-up snapshot, followed by its page IDs coldest first.
+   */
+  struct WarmupHeader {
+    uint32_t magic;    /**< Identifies a snapshot. */
+    uint32_t count;    /**< Number of page IDs. */
+    uint32_t checksum; /**< CRC-32 of the page IDs. */
+  };
+
+  /**
+   * @brief Write a whole buffer to a file.
+   * @return True if written, false otherwise.
+   */
+  bool writeAll(int fd, const void *data, size_t size) noexcept {
+    const auto *in = static_cast<const uint8_t *>(data);
+    while (size > 0) {
+      const ssize_t n = ::write(fd, in, size);
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+
+      if (n <= 0) {
+        return false;
+      }
+
+      in += n;
+      size -= n;
+    }
+
+    return true;
+  }
+
+  /**
+   * @brief Read a whole buffer from a file.
+   * @return True if read, false if the file ended first or the read failed.
+   */
+  bool readAll(int fd, void *data, size_t size) noexcept {
+    auto *out = static_cast<uint8_t *>(data);
+    while (size > 0) {
+      const ssize_t n = ::read(fd, out, size);
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+
+      if (n <= 0) {
+        return false;
+      }
+
+      out += n;
+      size -= n;
+    }
+
+    return true;
+  }
+} // namespace
 
 namespace pulse::cache {
-  BufferPool::BufferPool(storage::DiskManager &diskManager, size_t poolSize) noexcept
-      : frames(poolSize), diskManager(diskManager), logger("buffer-pool") {
-    logger.info("initialized buffer pool with {} frames", poolSize);
+  void PoolStats::report(utils::PrometheusWriter &writer) const {
+    writer.counter("pool_hits_total", "Fetches of resident pages.", hits);
+    writer.counter("pool_misses_total", "Fetches that read the page from disk.", misses);
+    writer.counter("pool_evictions_total", "Pages evicted to make room.", evictions);
+    writer.counter(
+        "pool_dirty_evictions_total", "Evictions that had to write the page first.",
+        dirtyEvictions
+    );
+    writer.counter("pool_write_backs_total", "Pages written back ahead of eviction.", writeBacks);
+    writer.counter("pool_pin_waits_total", "Waits for a page being read or written.", pinWaits);
+    writer.counter("pool_latch_waits_total", "Latches that weren't granted at once.", latchWaits);
+    writer.counter("pool_remote_hits_total", "Hits on pages held by another node.", remoteHits);
+    writer.counter("replacer_victims_total", "Frames handed out for eviction.", replacer.victims);
+    writer.counter(
+        "replacer_exhausted_total", "Victim requests with no frame to hand out.",
+        replacer.exhausted
+    );
+    writer.histogram("pool_fetch_seconds", "Time to fetch a missed page.", fetchLatency);
+    writer.histogram("pool_flush_seconds", "Time to flush a page or a batch.", flushLatency);
+  }
+
+  BufferPool::BufferPool(
+      storage::DiskManager &diskManager, size_t poolSize, size_t shardCount, ReplacerPolicy policy,
+      size_t nodeCount
+  ) noexcept
+      : nodes(1), columns(1), totalFrames(poolSize), writeCursor(0), logger("buffer-pool"),
+        diskManager(diskManager), log(nullptr) {
+    // Every node gets at least one frame and the same number of shards.
+    nodes = nodeCount == ALL_NODES ? utils::numaNodes() : nodeCount;
+    nodes = std::clamp<size_t>(nodes, 1, std::max<size_t>(poolSize, 1));
+    columns = std::clamp<size_t>(shardCount / nodes, 1, std::max<size_t>(poolSize / nodes, 1));
+
+    placements = std::make_unique<std::mutex[]>(columns);
+    arenas.reserve(nodes);
+    shards.reserve(nodes * columns);
+
+    // Spread the frames evenly, the first nodes and shards take the remainder.
+    for (size_t node = 0; node < nodes; node++) {
+      const size_t nodeFrames = poolSize / nodes + (node < poolSize % nodes ? 1 : 0);
+      FrameArena &arena = arenas.emplace_back(
+          nodeFrames, nodes == 1 ? std::nullopt : std::optional<size_t>(node)
+      );
+
+      size_t firstSlot = 0;
+      for (size_t i = 0; i < columns; i++) {
+        const size_t frameCount = nodeFrames / columns + (i < nodeFrames % columns ? 1 : 0);
+        shards.push_back(std::make_unique<Shard>(frameCount, policy, arena.slot(firstSlot)));
+        firstSlot += frameCount;
+      }
+    }
+
+    logger.info(
+        "initialized buffer pool with {} frames in {} shards over {} nodes", poolSize,
+        shards.size(), nodes
+    );
   }
 
   BufferPool::~BufferPool() noexcept {
     try {
       flushAll();
     } catch (const std::exception &e) {
-      logger.error("error during destruction: {}", e.what());
+      PULSEDB_LOG_ERROR(logger, "error during destruction: {}", e.what());
     }
   }
 
   storage::Page *BufferPool::fetchPage(uint32_t pageId) {
-    std::lock_guard lock(mutex);
+    // Hits pin the frame without locking, the replacer catches up when it is unpinned.
+    if (auto *page = tryHit(pageId)) {
+      return page;
+    }
 
-    // Check if page is already in pool.
-    auto it = pageTable.find(pageId);
-    if (it != pageTable.end()) {
-      Frame &frame = frames[it->second];
-      frame.pin();
-      replacer.pin(it->second);
+    // Nothing else can bring the page in while its placement lock is held, on any node.
+    const auto start = std::chrono::steady_clock::now();
+    std::unique_lock place(placements[pageId % columns]);
 
-      logger.debug("hit on page {} in frame {}", pageId, it->second);
-      return frame.getPage();
+    // Check again under the locks, waiting out any read in flight for the page.
+    for (bool waited = true; waited;) {
+      if (auto *page = pinHeld(pageId, place, waited)) {
+        return page;
+      }
     }
 
-    // Find a frame for the new page.
-    auto victimId = findVictim();
-    if (!victimId) {
-      logger.error("no frames available for page {}", pageId);
+    // Don't evict anything for a page that can't exist.
+    if (pageId >= diskManager.pageCount()) {
+      logger.error("failed to fetch page {} from disk", pageId);
       return nullptr;
     }
 
-    // Load page from disk.
-    auto page = diskManager.fetchPage(pageId);
-    if (!page) {
-      logger.error("failed to fetch page {} from disk", pageId);
+    // Find a frame for the page on the faulting thread's node.
+    Shard &shard = shardOf(pageId);
+    std::unique_lock lock(shard.mutex);
+
+    auto victimId = findVictim(shard, lock);
+    if (!victimId) {
+      logger.error("no frames available for page {}", pageId);
       return nullptr;
     }
 
     // If the victim frame is occupied, evict it.
-    if (!evictFrame(*victimId)) {
+    if (!evictFrame(shard, *victimId)) {
       logger.error("failed to evict frame {} for page {}", *victimId, pageId);
       return nullptr;
     }
 
-    // Insert page into frame.
-    Frame &frame = frames[*victimId];
-    frame.reset(std::move(page));
-    frame.pin();
+    // Reserve the frame so concurrent fetches of this page wait instead of reading it twice. It
+    // stays locked, so lock-free hits back off until the page is in place.
+    Frame &frame = shard.frames[*victimId];
+    frame.load(pageId);
+    shard.pageTable.insert(pageId, *victimId);
+    place.unlock();
+
+    // Read the page into the frame's buffer without holding the lock, so hits can proceed
+    // meanwhile. The frame stays locked, nothing else touches the buffer until it's adopted.
+    metrics.misses.add();
+    lock.unlock();
+    const uint64_t clean = logEnd();
+    const bool read = diskManager.readPageAsync(pageId, frame.getBuffer()).get();
+    lock.lock();
+
+    if (!read || !frame.adopt()) {
+      logger.error("failed to fetch page {} from disk", pageId);
 
-    pageTable[pageId] = *victimId;
-    replacer.pin(*victimId);
+      shard.pageTable.erase(pageId);
+      frame.reset();
+      frame.unlock();
+      shard.loaded.notify_all();
+      return nullptr;
+    }
+
+    // The page is in place.
+    frame.setRecLsn(clean);
+    frame.pin();
+    frame.unlock();
+    shard.replacer->pin(*victimId);
+    shard.loaded.notify_all();
+    metrics.fetchLatency.since(start);
 
-    logger.info("loaded page {} into frame {}", pageId, *victimId);
+    logger.debug("loaded page {} into frame {}", pageId, *victimId);
     return frame.getPage();
   }
 
-  storage::Page *BufferPool::createPage(storage::PageType type, bool isLeaf, uint16_t level) {
-    std::lock_guard lock(mutex);
+  std::optional<OptimisticRead>
+  BufferPool::readOptimistic(uint32_t pageId, Swip *swip) const noexcept {
+    if (const Frame *frame = swip ? swip->load(std::memory_order_acquire) : nullptr) {
+      // A frame only takes another page under its lock, so if it holds the page at an even
+      // version it still does for as long as the version stays put.
+      const uint64_t version = frame->version();
+      if (!(version & 1) && frame->holds(pageId)) {
+        return OptimisticRead{frame, frame->getBuffer(), version};
+      }
+    }
+
+    const Shard *shard = residentShard(pageId);
+    if (!shard) {
+      return std::nullopt;
+    }
+
+    auto frameId = shard->pageTable.find(pageId);
+    if (!frameId) {
+      return std::nullopt;
+    }
+
+    const Frame &frame = shard->frames[*frameId];
+    const uint64_t version = frame.version();
+    if (version & 1) {
+      return std::nullopt;
+    }
+
+    // The frame may have been evicted between the lookup and the version. Evicting erases the
+    // table entry under the frame's lock, so if the entry is still there the frame holds the page.
+    if (shard->pageTable.find(pageId) != frameId) {
+      return std::nullopt;
+    }
+
+    if (swip) {
+      swip->store(&frame, std::memory_order_release);
+    }
+
+    return OptimisticRead{&frame, frame.getBuffer(), version};
+  }
+
+  size_t BufferPool::prefetch(std::span<const uint32_t> pageIds) {
+    std::vector<uint32_t> missing;
+    missing.reserve(pageIds.size());
+
+    for (uint32_t pageId : pageIds) {
+      if (!residentShard(pageId)) {
+        missing.push_back(pageId);
+      }
+    }
+
+    return missing.empty() ? 0 : diskManager.prefetch(missing);
+  }
+
+  bool BufferPool::saveWarmup(const fs::path &path) const {
+    std::vector<std::pair<double, uint32_t>> ranked;
+
+    for (const auto &shard : shards) {
+      std::lock_guard lock(shard->mutex);
+
+      // Shards hold different numbers of pages, so a page ranks by where it is in its own.
+      const auto order = shard->replacer->candidates(shard->frames.size());
+      for (size_t i = 0; i < order.size(); i++) {
+        const Frame &frame = shard->frames[order[i]];
+        if (frame.getPage() && frame.isUnpinned()) {
+          ranked.emplace_back(static_cast<double>(i + 1) / (order.size() + 1), frame.id());
+        }
+      }
+
+      for (const Frame &frame : shard->frames) {
+        if (frame.getPage() && !frame.isUnpinned()) {
+          ranked.emplace_back(1.0, frame.id());
+        }
+      }
+    }
+
+    std::stable_sort(ranked.begin(), ranked.end(), [](const auto &a, const auto &b) {
+      return a.first < b.first;
+    });
+
+    std::vector<uint32_t> pageIds;
+    pageIds.reserve(ranked.size());
+    for (const auto &[rank, pageId] : ranked) {
+      pageIds.push_back(pageId);
+    }
+
+    const WarmupHeader header{
+        WARMUP_MAGIC, static_cast<uint32_t>(pageIds.size()),
+        utils::crc32(pageIds.data(), pageIds.size() * sizeof(uint32_t))
+    };
+
+    // Write beside the old snapshot and swap it in, so a crash never leaves half of one.
+    const fs::path temp = fs::path(path).concat(".tmp");
+    const int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+      PULSEDB_LOG_ERROR(
+          logger, "failed to open warm-up snapshot {}: {}", temp.string(), std::strerror(errno)
+      );
+      return false;
+    }
+
+    const bool written = writeAll(fd, &header, sizeof(header)) &&
+                         writeAll(fd, pageIds.data(), pageIds.size() * sizeof(uint32_t)) &&
+                         ::fdatasync(fd) == 0;
+    ::close(fd);
+
+    std::error_code error;
+    if (written) {
+      fs::rename(temp, path, error);
+    }
+
+    if (!written || error) {
+      PULSEDB_LOG_ERROR(logger, "failed to write warm-up snapshot {}", path.string());
+      fs::remove(temp, error);
+      return false;
+    }
+
+    PULSEDB_LOG_INFO(logger, "saved {} resident pages to {}", pageIds.size(), path.string());
+    return true;
+  }
+
+  size_t BufferPool::warmUp(const fs::path &path, size_t threads) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      PULSEDB_LOG_INFO(logger, "no warm-up snapshot at {}", path.string());
+      return 0;
+    }
+
+    WarmupHeader header{};
+    std::vector<uint32_t> order;
+    bool valid = readAll(fd, &header, sizeof(header)) && header.magic == WARMUP_MAGIC;
+    if (valid) {
+      order.resize(header.count);
+      valid = readAll(fd, order.data(), order.size() * sizeof(uint32_t)) &&
+              utils::crc32(order.data(), order.size() * sizeof(uint32_t)) == header.checksum;
+    }
+
+    ::close(fd);
+    if (!valid) {
+      PULSEDB_LOG_WARN(logger, "ignoring invalid warm-up snapshot {}", path.string());
+      return 0;
+    }
+
+    // Keep the hottest pages there's room for, of those the database still has.
+    const uint32_t pageCount = diskManager.pageCount();
+    std::erase_if(order, [pageCount](uint32_t pageId) { return pageId >= pageCount; });
+    if (order.size() > totalFrames) {
+      order.erase(order.begin(), order.end() - static_cast<std::ptrdiff_t>(totalFrames));
+    }
+
+    std::vector<uint32_t> sorted = order;
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+    // Whoever reaches the start of a batch reads the next one ahead, so runs of consecutive
+    // pages are read as one while the threads fetch the batch in between.
+    auto batch = [&sorted](size_t start) {
+      return std::span(sorted).subspan(start, std::min(WARMUP_BATCH, sorted.size() - start));
+    };
+
+    if (!sorted.empty()) {
+      prefetch(batch(0));
+    }
+
+    std::atomic<size_t> next = 0;
+    std::atomic<size_t> loaded = 0;
+    auto load = [&] {
+      for (size_t i = next++; i < sorted.size(); i = next++) {
+        if (i % WARMUP_BATCH == 0 && i + WARMUP_BATCH < sorted.size()) {
+          prefetch(batch(i + WARMUP_BATCH));
+        }
 
+        if (fetchPage(sorted[i])) {
+          unpinPage(sorted[i], false);
+          loaded++;
+        }
+      }
+    };
+
+    if (threads == 0) {
+      threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < std::min(threads, sorted.size()); t++) {
+      workers.emplace_back(load);
+    }
+
+    load();
+    for (auto &worker : workers) {
+      worker.join();
+    }
+
+    // Touch the pages coldest first, so the hottest end up last to be evicted.
+    for (uint32_t pageId : order) {
+      Shard *shard = holderOf(pageId);
+      if (!shard) {
+        continue;
+      }
+
+      std::lock_guard lock(shard->mutex);
+      auto frameId = shard->pageTable.find(pageId);
+      if (frameId && shard->frames[*frameId].isUnpinned()) {
+        shard->replacer->pin(*frameId);
+        shard->replacer->unpin(*frameId);
+      }
+    }
+
+    PULSEDB_LOG_INFO(
+        logger, "warmed up {} of {} pages from {} with {} threads", loaded.load(), order.size(),
+        path.string(), workers.size() + 1
+    );
+
+    return loaded;
+  }
+
+  storage::Page *BufferPool::createPage(storage::PageType type, bool isLeaf, uint16_t level) {
     // Allocate a new page ID from the disk manager.
     uint32_t newPageId = diskManager.allocatePage();
     if (newPageId == storage::DiskManager::INVALID_PAGE_ID) {
@@ -77,43 +443,57 @@ namespace pulse::cache {
       return nullptr;
     }
 
+    return createPage(newPageId, type, isLeaf, level);
+  }
+
+  storage::Page *BufferPool::createPage(
+      uint32_t newPageId, storage::PageType type, bool isLeaf, uint16_t level
+  ) {
+    if (newPageId == storage::DiskManager::INVALID_PAGE_ID) {
+      logger.error("cannot create a page without a page ID");
+      return nullptr;
+    }
+
+    Shard &shard = shardOf(newPageId);
+    std::unique_lock lock(shard.mutex);
+
     // Find a frame for the new page.
-    auto victimId = findVictim();
+    auto victimId = findVictim(shard, lock);
     if (!victimId) {
       logger.error("no frames available for new page");
       return nullptr;
     }
 
     // If the victim frame is occupied, evict it.
-    if (!evictFrame(*victimId)) {
+    if (!evictFrame(shard, *victimId)) {
       logger.error("failed to evict frame {} for new page", *victimId);
       return nullptr;
     }
 
-    // Create the appropriate page type.
-    std::unique_ptr<storage::Page> page;
+    // Build the appropriate page type in the frame's buffer.
+    Frame &frame = shard.frames[*victimId];
     switch (type) {
       case storage::PageType::INDEX:
-        page = std::make_unique<storage::IndexPage>(newPageId, isLeaf, level);
+        frame.create<storage::IndexPage>(newPageId, isLeaf, level);
         break;
 
       case storage::PageType::DATA:
-        page = std::make_unique<storage::DataPage>(newPageId);
+        frame.create<storage::DataPage>(newPageId);
         break;
 
       default:
         logger.error("invalid page type: {}", static_cast<int>(type));
+        frame.unlock();
         return nullptr;
     }
 
-    // Insert page into frame.
-    Frame &frame = frames[*victimId];
-    frame.reset(std::move(page));
+    frame.setRecLsn(logEnd());
     frame.pin();
     frame.mark(); // New pages are dirty.
+    frame.unlock();
 
-    pageTable[newPageId] = *victimId;
-    replacer.pin(*victimId);
+    shard.pageTable.insert(newPageId, *victimId);
+    shard.replacer->pin(*victimId);
     logger.info(
         "created new {} page {} in frame {}", static_cast<int>(type), newPageId, *victimId
     );
@@ -122,23 +502,54 @@ namespace pulse::cache {
   }
 
   bool BufferPool::deletePage(uint32_t pageId) {
-    std::lock_guard lock(mutex);
+    Shard *holder = holderOf(pageId);
+    Shard &shard = holder ? *holder : shardOf(pageId);
+    std::unique_lock lock(shard.mutex);
+
+    return removePage(shard, lock, pageId, false);
+  }
+
+  bool BufferPool::retirePage(uint32_t pageId) {
+    Shard *holder = holderOf(pageId);
+    Shard &shard = holder ? *holder : shardOf(pageId);
+    std::unique_lock lock(shard.mutex);
+
+    return removePage(shard, lock, pageId, true);
+  }
+
+  bool BufferPool::removePage(
+      Shard &shard, std::unique_lock<std::mutex> &lock, uint32_t pageId, bool defer
+  ) {
+    // A background write-back holds a pin, it isn't one of ours to refuse on.
+    auto frameId = shard.pageTable.find(pageId);
+    while (frameId && shard.frames[*frameId].isWriting()) {
+      metrics.pinWaits.add();
+      shard.loaded.wait(lock);
+      frameId = shard.pageTable.find(pageId);
+    }
 
     // Check if page is in pool.
-    auto it = pageTable.find(pageId);
-    if (it != pageTable.end()) {
-      Frame &frame = frames[it->second];
+    if (frameId) {
+      Frame &frame = shard.frames[*frameId];
 
-      // Cannot delete a pinned page.
-      if (!frame.isUnpinned()) {
-        logger.error("cannot delete pinned page {}", pageId);
-        return false;
+      // Cannot delete a pinned page, or one still being read in, only free it once unpinned.
+      if (frame.isLoading() || !frame.tryLock()) {
+        if (!defer) {
+          logger.error("cannot delete pinned page {}", pageId);
+          return false;
+        }
+
+        frame.retire();
+        shard.retired.push_back(pageId);
+        logger.debug("page {} is pinned, freeing it once unpinned", pageId);
+        return true;
       }
 
       // Reset the frame.
-      frame.reset(nullptr);
-      pageTable.erase(it);
-      replacer.pin(it->second);
+      shard.pageTable.erase(pageId);
+      frame.reset();
+      frame.unlock();
+      shard.replacer->pin(*frameId);
     }
 
     // Delete from disk.
@@ -152,50 +563,137 @@ namespace pulse::cache {
   }
 
   bool BufferPool::unpinPage(uint32_t pageId, bool isDirty) {
-    std::lock_guard lock(mutex);
-
-    // Find page in pool.
-    auto it = pageTable.find(pageId);
-    if (it == pageTable.end()) {
+    Shard *holder = holderOf(pageId);
+    if (!holder) {
       logger.error("cannot unpin page {}, not found", pageId);
       return false;
     }
 
-    Frame &frame = frames[it->second];
-    frame.unpin();
+    Shard &shard = *holder;
+
+    // Hold a pin of our own while touching the frame, so it can't be evicted underneath us.
+    auto frameId = tryPin(shard, pageId);
+    if (!frameId) {
+      std::lock_guard lock(shard.mutex);
+
+      auto found = shard.pageTable.find(pageId);
+      if (!found || shard.frames[*found].isLoading()) {
+        logger.error("cannot unpin page {}, not found", pageId);
+        return false;
+      }
+
+      shard.frames[*found].pin();
+      frameId = found;
+    }
+
+    Frame &frame = shard.frames[*frameId];
     if (isDirty) {
       frame.mark();
     }
 
-    // If completely unpinned, make available for replacement.
-    if (frame.isUnpinned()) {
-      replacer.unpin(it->second);
+    // Drop the caller's pin, if there was one, then ours.
+    if (frame.pins() > 1) {
+      frame.unpin();
+    }
+
+    release(shard, *frameId);
+
+    // The last pin of a retired page frees it.
+    if (frame.isRetired() && frame.pins() == 0) {
+      std::lock_guard lock(shard.mutex);
+      reclaim(shard);
     }
 
     logger.debug("unpinned page {} (dirty: {})", pageId, isDirty);
     return true;
   }
 
+  bool BufferPool::latchPage(uint32_t pageId, bool exclusive) {
+    Frame *frame = pinnedFrame(pageId);
+    if (!frame) {
+      logger.error("cannot latch page {}, not found", pageId);
+      return false;
+    }
+
+    // Try first, so only latches that have to wait are counted.
+    auto &latch = frame->getLatch();
+    if (exclusive) {
+      if (!latch.try_lock()) {
+        metrics.latchWaits.add();
+        latch.lock();
+      }
+
+      // Optimistic readers of the page start over from here on.
+      frame->beginWrite();
+    }
+
+    else {
+      if (!latch.try_lock_shared()) {
+        metrics.latchWaits.add();
+        latch.lock_shared();
+      }
+    }
+
+    return true;
+  }
+
+  bool BufferPool::unlatchPage(uint32_t pageId, bool exclusive) {
+    Frame *frame = pinnedFrame(pageId);
+    if (!frame) {
+      logger.error("cannot unlatch page {}, not found", pageId);
+      return false;
+    }
+
+    if (exclusive) {
+      frame->endWrite();
+      frame->getLatch().unlock();
+    }
+
+    else {
+      frame->getLatch().unlock_shared();
+    }
+
+    return true;
+  }
+
   bool BufferPool::flushPage(uint32_t pageId) {
-    std::lock_guard lock(mutex);
+    std::lock_guard writeLock(writeMutex);
+
+    Shard *holder = holderOf(pageId);
+    Shard &shard = holder ? *holder : shardOf(pageId);
+    std::lock_guard lock(shard.mutex);
 
     // Find page in pool.
-    auto it = pageTable.find(pageId);
-    if (it == pageTable.end()) {
+    auto frameId = shard.pageTable.find(pageId);
+    if (!frameId) {
       logger.error("cannot flush page {}, not found", pageId);
       return false;
     }
 
-    Frame &frame = frames[it->second];
+    Frame &frame = shard.frames[*frameId];
 
-    // Only flush if dirty.
-    if (frame.isDirty()) {
-      if (!diskManager.flushPage(*frame.getPage())) {
+    // Only flush if dirty, from a copy so writers can't change the page under the write.
+    if (frame.getPage() && frame.isDirty()) {
+      if (snapshots.slotCount() == 0) {
+        snapshots = FrameArena(1);
+      }
+
+      const auto start = std::chrono::steady_clock::now();
+      const uint64_t clean = logEnd();
+      storage::Page copy(storage::VIEW, snapshots.slot(0));
+      if (!snapshot(frame, copy)) {
+        logger.error("cannot flush page {}, a writer holds it", pageId);
+        return false;
+      }
+
+      if (!logged(copy.lsn()) || !diskManager.flushPage(copy)) {
         logger.error("failed to flush page {} to the disk", pageId);
+        frame.mark();
         return false;
       }
 
-      frame.unmark();
+      frame.setRecLsn(clean);
+      metrics.flushLatency.since(start);
     }
 
     logger.debug("flushed page {}", pageId);
@@ -203,54 +701,601 @@ namespace pulse::cache {
   }
 
   void BufferPool::flushAll() {
-    std::lock_guard lock(mutex);
+    std::lock_guard writeLock(writeMutex);
 
-    for (const auto &entry : pageTable) {
-      Frame &frame = frames[entry.second];
-      if (frame.isDirty()) {
-        if (!diskManager.flushPage(*frame.getPage())) {
-          logger.error("failed to flush page {} to the disk", entry.first);
-          continue;
+    for (auto &shard : shards) {
+      std::lock_guard lock(shard->mutex);
+      reclaim(*shard);
+      flushShard(*shard);
+    }
+
+    logger.info("flushed all pages");
+  }
+
+  size_t BufferPool::writeBack(size_t limit, size_t lookahead, bool eager) {
+    std::lock_guard writeLock(writeMutex);
+
+    /**
+     * @struct Pending
+     * @brief A frame whose snapshot is being written.
+     */
+    struct Pending {
+      Shard *shard;       /**< Shard owning the frame. */
+      size_t frameId;     /**< The frame, pinned until the write completes. */
+      storage::Page copy; /**< Snapshot of the page, a view over a snapshot buffer. */
+    };
+
+    // Snapshots go into buffers kept across calls, there's never more than a frame's worth.
+    limit = std::min(limit, totalFrames);
+    if (snapshots.slotCount() < limit) {
+      snapshots = FrameArena(limit);
+    }
+
+    // Snapshots taken from here on hold every record logged so far.
+    const uint64_t clean = logEnd();
+    std::vector<Pending> batch;
+    batch.reserve(limit);
+    for (size_t n = 0; n < shards.size() && batch.size() < limit; n++) {
+      Shard &shard = *shards[(writeCursor + n) % shards.size()];
+      std::lock_guard lock(shard.mutex);
+
+      auto take = [this, &shard, &batch, limit](size_t frameId) {
+        Frame &frame = shard.frames[frameId];
+        if (batch.size() >= limit || !frame.isDirty() || !frame.getPage()) {
+          return;
+        }
+
+        // Only unpinned frames, locking keeps writers out while the snapshot is taken.
+        if (!frame.tryLock()) {
+          return;
         }
 
+        storage::Page copy(storage::VIEW, snapshots.slot(batch.size()));
+        copy.copyFrom(*frame.getPage());
         frame.unmark();
+
+        // The pin keeps the frame from being evicted, and so the page from being read back,
+        // until the write lands.
+        frame.setWriting(true);
+        frame.pin();
+        frame.unlock();
+
+        batch.push_back({&shard, frameId, std::move(copy)});
+      };
+
+      for (size_t frameId : shard.replacer->candidates(lookahead)) {
+        take(frameId);
+      }
+
+      for (size_t frameId = 0; eager && frameId < shard.frames.size(); frameId++) {
+        take(frameId);
       }
     }
 
-    logger.info("flushed all pages");
+    writeCursor = (writeCursor + 1) % shards.size();
+    if (batch.empty()) {
+      return 0;
+    }
+
+    std::vector<const storage::Page *> pages;
+    pages.reserve(batch.size());
+
+    uint64_t lsn = 0;
+    for (const auto &pending : batch) {
+      pages.push_back(&pending.copy);
+      lsn = std::max(lsn, pending.copy.lsn());
+    }
+
+    // Without the log records the pages must not reach the disk, so fail the whole batch.
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::future<bool>> results;
+    if (logged(lsn)) {
+      results = diskManager.flushPagesAsync(pages);
+    }
+
+    size_t written = 0;
+    for (size_t i = 0; i < batch.size(); i++) {
+      Shard &shard = *batch[i].shard;
+      Frame &frame = shard.frames[batch[i].frameId];
+      const bool ok = !results.empty() && results[i].get();
+
+      std::lock_guard lock(shard.mutex);
+      if (!ok) {
+        logger.error("failed to write back page {}", frame.id());
+        frame.mark();
+      }
+
+      else {
+        frame.setRecLsn(clean);
+        written++;
+      }
+
+      // Leave the replacer alone, this is not an access.
+      frame.setWriting(false);
+      frame.unpin();
+      shard.loaded.notify_all();
+    }
+
+    metrics.writeBacks.add(written);
+    metrics.flushLatency.since(start);
+
+    logger.debug("wrote back {} pages", written);
+    return written;
   }
 
-  std::optional<size_t> BufferPool::findVictim() {
-    // First try to find an unused frame.
-    for (size_t i = 0; i < frames.size(); i++) {
-      if (frames[i].getPage() == nullptr) {
-        return i;
+  size_t BufferPool::compact(size_t limit) {
+    size_t compacted = 0;
+
+    for (auto &shard : shards) {
+      std::lock_guard lock(shard->mutex);
+
+      for (Frame &frame : shard->frames) {
+        if (compacted >= limit) {
+          return compacted;
+        }
+
+        // Deletes leave a page dirty, clean pages have nothing to give back.
+        if (!frame.isDirty() || !frame.getPage()) {
+          continue;
+        }
+
+        // Locking keeps fetches out, and only works if nobody holds the page.
+        if (!frame.tryLock()) {
+          continue;
+        }
+
+        auto *page = frame.getPage();
+        if (page->type() == storage::PageType::DATA) {
+          auto *dataPage = static_cast<storage::DataPage *>(page);
+
+          if (dataPage->needsCompact()) {
+            const uint16_t freed = dataPage->compact();
+            if (log) {
+              log->logPage(*dataPage);
+            }
+
+            logger.debug("compacted page {}, freed {} bytes", dataPage->id(), freed);
+            compacted++;
+          }
+        }
+
+        frame.unlock();
+      }
+    }
+
+    return compacted;
+  }
+
+  double BufferPool::dirtyRatio() const noexcept {
+    if (totalFrames == 0) {
+      return 0.0;
+    }
+
+    size_t dirty = 0;
+    for (const auto &shard : shards) {
+      for (const Frame &frame : shard->frames) {
+        dirty += frame.isDirty() ? 1 : 0;
+      }
+    }
+
+    return static_cast<double>(dirty) / static_cast<double>(totalFrames);
+  }
+
+  size_t BufferPool::size() const noexcept {
+    size_t total = 0;
+    for (const auto &shard : shards) {
+      std::lock_guard lock(shard->mutex);
+      total += shard->pageTable.size();
+    }
+
+    return total;
+  }
+
+  PoolStats BufferPool::stats() const noexcept {
+    PoolStats result{
+        metrics.hits.value(),
+        metrics.misses.value(),
+        metrics.evictions.value(),
+        metrics.dirtyEvictions.value(),
+        metrics.writeBacks.value(),
+        metrics.pinWaits.value(),
+        metrics.latchWaits.value(),
+        metrics.remoteHits.value(),
+        metrics.fetchLatency.snapshot(),
+        metrics.flushLatency.snapshot(),
+        {},
+    };
+
+    // The replacers count on their own, under their shard's lock.
+    for (const auto &shard : shards) {
+      const ReplacerStats replacer = shard->replacer->stats();
+      result.replacer.victims += replacer.victims;
+      result.replacer.exhausted += replacer.exhausted;
+    }
+
+    return result;
+  }
+
+  std::string BufferPool::prometheus() const {
+    utils::PrometheusWriter writer;
+    stats().report(writer);
+    diskManager.stats().report(writer);
+
+    return writer.text();
+  }
+
+  std::optional<size_t> BufferPool::nodeOf(uint32_t pageId) const noexcept {
+    for (size_t node = 0; node < nodes; node++) {
+      if (shardAt(node, pageId).pageTable.find(pageId)) {
+        return node;
+      }
+    }
+
+    return std::nullopt;
+  }
+
+  const BufferPool::Shard *BufferPool::residentShard(uint32_t pageId) const noexcept {
+    const size_t local = localNode();
+    for (size_t i = 0; i < nodes; i++) {
+      const Shard &shard = shardAt((local + i) % nodes, pageId);
+      if (shard.pageTable.find(pageId)) {
+        return &shard;
+      }
+    }
+
+    return nullptr;
+  }
+
+  BufferPool::Shard *BufferPool::holderOf(uint32_t pageId) {
+    if (const Shard *shard = residentShard(pageId)) {
+      return const_cast<Shard *>(shard);
+    }
+
+    // The lock-free lookups can miss a page that is there, the locked ones can't.
+    const size_t local = localNode();
+    for (size_t i = 0; i < nodes; i++) {
+      Shard &shard = shardAt((local + i) % nodes, pageId);
+      std::lock_guard lock(shard.mutex);
+
+      if (shard.pageTable.find(pageId)) {
+        return &shard;
       }
     }
 
-    // Otherwise use the replacement policy.
-    return replacer.victim();
+    return nullptr;
   }
 
-  bool BufferPool::evictFrame(size_t frameId) {
-    Frame &frame = frames[frameId];
-    if (frame.getPage() == nullptr) {
+  storage::Page *BufferPool::tryHit(uint32_t pageId) noexcept {
+    const size_t local = localNode();
+    for (size_t i = 0; i < nodes; i++) {
+      Shard &shard = shardAt((local + i) % nodes, pageId);
+      if (auto frameId = tryPin(shard, pageId)) {
+        metrics.hits.add();
+        if (i != 0) {
+          metrics.remoteHits.add();
+        }
+
+        logger.debug("hit on page {} in frame {}", pageId, *frameId);
+        return shard.frames[*frameId].getPage();
+      }
+    }
+
+    return nullptr;
+  }
+
+  storage::Page *
+  BufferPool::pinHeld(uint32_t pageId, std::unique_lock<std::mutex> &place, bool &waited) {
+    const size_t local = localNode();
+    waited = false;
+
+    for (size_t i = 0; i < nodes; i++) {
+      Shard &shard = shardAt((local + i) % nodes, pageId);
+      std::unique_lock lock(shard.mutex);
+
+      auto frameId = shard.pageTable.find(pageId);
+      if (!frameId) {
+        continue;
+      }
+
+      // Other misses of the page wait on the read too, so let go of the placement lock. It's
+      // taken before any shard lock, so take it back only once the shard's is released.
+      Frame &frame = shard.frames[*frameId];
+      if (frame.isLoading()) {
+        place.unlock();
+        metrics.pinWaits.add();
+        shard.loaded.wait(lock);
+
+        lock.unlock();
+        place.lock();
+        waited = true;
+        return nullptr;
+      }
+
+      frame.pin();
+      metrics.hits.add();
+      if (i != 0) {
+        metrics.remoteHits.add();
+      }
+
+      logger.debug("hit on page {} in frame {}", pageId, *frameId);
+      return frame.getPage();
+    }
+
+    return nullptr;
+  }
+
+  std::optional<size_t> BufferPool::tryPin(Shard &shard, uint32_t pageId) noexcept {
+    auto frameId = shard.pageTable.find(pageId);
+    if (!frameId) {
+      return std::nullopt;
+    }
+
+    Frame &frame = shard.frames[*frameId];
+    if (!frame.tryPin()) {
+      return std::nullopt;
+    }
+
+    // The table entry may be stale, the pin makes the frame's contents safe to check.
+    if (!frame.getPage() || frame.id() != pageId) {
+      release(shard, *frameId);
+      return std::nullopt;
+    }
+
+    return frameId;
+  }
+
+  Frame *BufferPool::pinnedFrame(uint32_t pageId) {
+    Shard *holder = holderOf(pageId);
+    if (!holder) {
+      return nullptr;
+    }
+
+    // A pinned page can't move, but the lock-free lookup can still miss it.
+    Shard &shard = *holder;
+    auto frameId = shard.pageTable.find(pageId);
+    if (!frameId) {
+      std::lock_guard lock(shard.mutex);
+      frameId = shard.pageTable.find(pageId);
+    }
+
+    if (!frameId || shard.frames[*frameId].id() != pageId || !shard.frames[*frameId].getPage()) {
+      return nullptr;
+    }
+
+    return &shard.frames[*frameId];
+  }
+
+  void BufferPool::release(Shard &shard, size_t frameId) {
+    Frame &frame = shard.frames[frameId];
+    const bool resident = frame.getPage() != nullptr;
+
+    // Once unpinned the frame can be evicted at any time, so decide beforehand. Retired pages
+    // stay out of the replacer, they are freed rather than evicted.
+    if (frame.unpin() == 0 && resident && !frame.isRetired()) {
+      shard.replacer->unpin(frameId);
+    }
+  }
+
+  void BufferPool::reclaim(Shard &shard) {
+    std::erase_if(shard.retired, [&](uint32_t pageId) {
+      // Still pinned, being read in or being written, the next unpin or sweep tries again.
+      if (auto frameId = shard.pageTable.find(pageId)) {
+        Frame &frame = shard.frames[*frameId];
+        if (frame.isLoading() || frame.isWriting() || !frame.tryLock()) {
+          return false;
+        }
+
+        shard.pageTable.erase(pageId);
+        frame.reset();
+        frame.unlock();
+        shard.replacer->pin(*frameId);
+      }
+
+      if (!diskManager.deallocatePage(pageId)) {
+        logger.error("failed to deallocate retired page {} from the disk", pageId);
+      }
+
+      else {
+        logger.info("deleted retired page {}", pageId);
+      }
+
       return true;
+    });
+  }
+
+  std::optional<size_t>
+  BufferPool::findVictim(Shard &shard, std::unique_lock<std::mutex> &lock) {
+    // First try to find an unused frame.
+    for (size_t i = 0; i < shard.frames.size(); i++) {
+      if (shard.frames[i].isEmpty() && shard.frames[i].tryLock()) {
+        return i;
+      }
     }
 
-    if (!frame.isUnpinned()) {
-      return false;
+    // Otherwise use the replacement policy. Hits don't tell the replacer about their pins, so
+    // skip frames that turn out to be pinned, they come back once they are unpinned.
+    // Optimistic reads don't pin either, they touch the frame instead. A touched frame goes back
+    // to the replacer as if just unpinned, at most once per frame so the search always ends.
+    size_t chances = shard.frames.size();
+    while (auto victimId = shard.replacer->victim()) {
+      Frame &frame = shard.frames[*victimId];
+      if (chances > 0 && frame.takeTouch()) {
+        chances--;
+        shard.replacer->unpin(*victimId);
+        continue;
+      }
+
+      // A frame being written back is about to be clean, which makes it the best victim.
+      if (frame.isWriting()) {
+        metrics.pinWaits.add();
+        shard.loaded.wait(lock, [&frame] { return !frame.isWriting(); });
+      }
+
+      if (frame.tryLock()) {
+        return victimId;
+      }
+    }
+
+    return std::nullopt;
+  }
+
+  bool BufferPool::evictFrame(Shard &shard, size_t frameId) {
+    Frame &frame = shard.frames[frameId];
+    if (frame.isEmpty()) {
+      return true;
     }
 
     if (frame.isDirty()) {
-      if (!diskManager.flushPage(*frame.getPage())) {
+      if (!logged(frame.getPage()->lsn()) || !diskManager.flushPage(*frame.getPage())) {
+        frame.unlock();
+        shard.replacer->unpin(frameId);
         return false;
       }
+
+      metrics.dirtyEvictions.add();
     }
 
-    pageTable.erase(frame.id());
-    frame.reset(nullptr);
+    shard.pageTable.erase(frame.id());
+    frame.reset();
+    metrics.evictions.add();
 
     return true;
   }
+
+  std::vector<wal::DirtyPage> BufferPool::dirtyPages() const {
+    std::vector<wal::DirtyPage> dirty;
+
+    for (const auto &shard : shards) {
+      for (const Frame &frame : shard->frames) {
+        // A change is logged before its frame is marked, but always while the frame is pinned or
+        // locked. Checking the pins first, a frame found clean after them had nothing in flight.
+        const bool busy = frame.pins() > 0 || frame.isLocked();
+        if ((!busy && !frame.isDirty()) || frame.isEmpty()) {
+          continue;
+        }
+
+        dirty.push_back({frame.id(), frame.recLsn()});
+      }
+    }
+
+    return dirty;
+  }
+
+  uint64_t BufferPool::checkpoint() {
+    if (!log) {
+      logger.error("cannot checkpoint without a log");
+      return 0;
+    }
+
+    // Retired pages whose pins have since dropped without an unpin freeing them go now.
+    for (auto &shard : shards) {
+      std::lock_guard lock(shard->mutex);
+      reclaim(*shard);
+    }
+
+    // Records logged after this are redone whatever the snapshot finds.
+    const uint64_t begin = log->currentLsn();
+    const std::vector<wal::DirtyPage> dirty = dirtyPages();
+
+    // Pages left out were written before the snapshot, make sure those writes are durable.
+    if (!diskManager.sync()) {
+      logger.error("failed to sync the database for a checkpoint");
+      return 0;
+    }
+
+    return log->checkpoint(begin, dirty);
+  }
+
+  bool BufferPool::logged(uint64_t lsn) {
+    if (log && !log->flush(lsn)) {
+      logger.error("failed to flush the log up to lsn {}", lsn);
+      return false;
+    }
+
+    return true;
+  }
+
+  bool BufferPool::snapshot(Frame &frame, storage::Page &copy) {
+    // Unpinned frames are locked, which keeps everyone out while the page is copied.
+    if (frame.tryLock()) {
+      copy.copyFrom(*frame.getPage());
+      frame.unmark();
+      frame.unlock();
+      return true;
+    }
+
+    // Pinned ones are latched for reading, without waiting, the writer holding the latch may be
+    // waiting for the shard lock held here. That lock also keeps the page in the frame.
+    std::shared_mutex &latch = frame.getLatch();
+    if (!latch.try_lock_shared()) {
+      return false;
+    }
+
+    copy.copyFrom(*frame.getPage());
+    frame.unmark();
+    latch.unlock_shared();
+    return true;
+  }
+
+  void BufferPool::flushShard(Shard &shard) {
+    // Snapshots go into buffers kept across calls, a shard never has more dirty pages to copy.
+    if (snapshots.slotCount() < shard.frames.size()) {
+      snapshots = FrameArena(shard.frames.size());
+    }
+
+    std::vector<Frame *> dirtyFrames;
+    std::vector<storage::Page> copies;
+    copies.reserve(shard.frames.size());
+    const uint64_t clean = logEnd();
+    uint64_t lsn = 0;
+
+    // The LSN that matters is the one of the copy, the page may have moved on since.
+    for (Frame &frame : shard.frames) {
+      if (!frame.getPage() || !frame.isDirty()) {
+        continue;
+      }
+
+      storage::Page copy(storage::VIEW, snapshots.slot(copies.size()));
+      if (!snapshot(frame, copy)) {
+        logger.debug("skipping page {}, a writer holds it", frame.id());
+        continue;
+      }
+
+      lsn = std::max(lsn, copy.lsn());
+      dirtyFrames.push_back(&frame);
+      copies.push_back(std::move(copy));
+    }
+
+    std::vector<const storage::Page *> pages;
+    pages.reserve(copies.size());
+    for (const auto &copy : copies) {
+      pages.push_back(&copy);
+    }
+
+    if (!logged(lsn)) {
+      logger.error("failed to flush the log, leaving {} pages dirty", pages.size());
+      for (Frame *frame : dirtyFrames) {
+        frame->mark();
+      }
+
+      return;
+    }
+
+    // Submit every write at once and wait for the batch.
+    const auto start = std::chrono::steady_clock::now();
+    auto results = diskManager.flushPagesAsync(pages);
+    for (size_t i = 0; i < results.size(); i++) {
+      if (!results[i].get()) {
+        logger.error("failed to flush page {} to the disk", dirtyFrames[i]->id());
+        dirtyFrames[i]->mark();
+        continue;
+      }
+
+      dirtyFrames[i]->setRecLsn(clean);
+    }
+
+    if (!pages.empty()) {
+      metrics.flushLatency.since(start);
+    }
+  }
 } // namespace pulse::cache
@@ -0,0 +1,97 @@
+/**
+ * @file src/cache/frame_arena.cpp
+ * @brief Implements the frame arena class.
+ */
+
+#include "pulsedb/cache/frame_arena.hpp"
+#include "pulsedb/utils/numa.hpp"
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <sys/mman.h>
+#include <utility>
+
+namespace pulse::cache {
+  FrameArena::FrameArena(size_t slotCount, std::optional<size_t> node)
+      : base(nullptr), slots(slotCount), length(0), mapped(false), bound(false),
+        logger("frame-arena") {
+    if (slots == 0) {
+      return;
+    }
+
+    // Pools smaller than a huge page aren't worth rounding up to one.
+    const size_t size = slots * storage::Page::PAGE_SIZE;
+    const size_t granule = size >= HUGE_PAGE_SIZE ? HUGE_PAGE_SIZE : storage::Page::PAGE_SIZE;
+    length = (size + granule - 1) / granule * granule;
+
+    void *memory =
+        ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (memory != MAP_FAILED) {
+      base = static_cast<uint8_t *>(memory);
+      mapped = true;
+
+      // Nothing is faulted in yet, so every slot comes from the node once it's first touched.
+      if (node) {
+        bound = utils::bindToNode(memory, length, *node);
+        if (!bound) {
+          logger.debug("slots not bound to node {}", *node);
+        }
+      }
+
+#ifdef MADV_HUGEPAGE
+      // Only a hint, the kernel may not have transparent huge pages enabled.
+      if (granule == HUGE_PAGE_SIZE && ::madvise(memory, length, MADV_HUGEPAGE) != 0) {
+        PULSEDB_LOG_DEBUG(logger, "huge pages unavailable: {}", std::strerror(errno));
+      }
+#endif
+    }
+
+    else {
+      PULSEDB_LOG_WARN(
+          logger, "failed to map {} bytes, using the heap: {}", length, std::strerror(errno)
+      );
+      base = static_cast<uint8_t *>(::operator new(length, std::align_val_t{64}));
+      std::memset(base, 0, length);
+    }
+
+    logger.info("reserved {} frame slots in {} bytes", slots, length);
+  }
+
+  FrameArena::~FrameArena() noexcept { unmap(); }
+
+  FrameArena::FrameArena(FrameArena &&other) noexcept
+      : base(std::exchange(other.base, nullptr)), slots(std::exchange(other.slots, 0)),
+        length(std::exchange(other.length, 0)), mapped(std::exchange(other.mapped, false)),
+        bound(std::exchange(other.bound, false)), logger(other.logger) {}
+
+  FrameArena &FrameArena::operator=(FrameArena &&other) noexcept {
+    if (this != &other) {
+      unmap();
+
+      base = std::exchange(other.base, nullptr);
+      slots = std::exchange(other.slots, 0);
+      length = std::exchange(other.length, 0);
+      mapped = std::exchange(other.mapped, false);
+      bound = std::exchange(other.bound, false);
+    }
+
+    return *this;
+  }
+
+  void FrameArena::unmap() noexcept {
+    if (!base) {
+      return;
+    }
+
+    if (mapped) {
+      ::munmap(base, length);
+    }
+
+    else {
+      ::operator delete(base, std::align_val_t{64});
+    }
+
+    base = nullptr;
+  }
+} // namespace pulse::cache
@@ -0,0 +1,45 @@
+/**
+ * @file src/cache/page_guard.cpp
+ * @brief Implements the page guard classes.
+ */
+
+#include "pulsedb/cache/page_guard.hpp"
+#include "pulsedb/cache/buffer_pool.hpp"
+
+namespace pulse::cache {
+  PageGuardBase::PageGuardBase(PageGuardBase &&other) noexcept
+      : pool(other.pool), page(other.page), exclusive(other.exclusive), dirty(other.dirty) {
+    other.page = nullptr;
+    other.dirty = false;
+  }
+
+  PageGuardBase &PageGuardBase::operator=(PageGuardBase &&other) noexcept {
+    if (this != &other) {
+      release();
+
+      pool = other.pool;
+      page = other.page;
+      exclusive = other.exclusive;
+      dirty = other.dirty;
+
+      other.page = nullptr;
+      other.dirty = false;
+    }
+
+    return *this;
+  }
+
+  void PageGuardBase::release() noexcept {
+    if (!page) {
+      return;
+    }
+
+    // Unlatch first, once unpinned the frame may be reused.
+    const uint32_t pageId = page->id();
+    pool->unlatchPage(pageId, exclusive);
+    pool->unpinPage(pageId, dirty);
+
+    page = nullptr;
+    dirty = false;
+  }
+} // namespace pulse::cache
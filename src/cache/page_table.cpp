@@ -0,0 +1,107 @@
+/**
+ * @file src/cache/page_table.cpp
+ * @brief Implements the page table class.
+ */
+
+#include "pulsedb/cache/page_table.hpp"
+#include <algorithm>
+#include <bit>
+
+namespace pulse::cache {
+  PageTable::PageTable(size_t capacity) : count(0) {
+    const size_t slots = std::bit_ceil(std::max<size_t>(capacity * 2, SLOTS_PER_BUCKET));
+    buckets = std::make_unique<Bucket[]>(slots / SLOTS_PER_BUCKET);
+    mask = slots - 1;
+    shift = 64 - std::countr_zero(slots);
+
+    for (size_t i = 0; i < slots; i++) {
+      slot(i).store(EMPTY, std::memory_order_relaxed);
+    }
+  }
+
+  std::optional<size_t> PageTable::find(uint32_t pageId) const noexcept {
+    for (size_t i = home(pageId), probes = 0; probes <= mask; i = (i + 1) & mask, probes++) {
+      const uint64_t entry = slot(i).load(std::memory_order_acquire);
+      if (entry == EMPTY) {
+        return std::nullopt;
+      }
+
+      if (keyOf(entry) == pageId) {
+        return valueOf(entry);
+      }
+    }
+
+    return std::nullopt;
+  }
+
+  bool PageTable::insert(uint32_t pageId, size_t frameId) noexcept {
+    const uint64_t entry = pack(pageId, frameId);
+
+    for (size_t i = home(pageId), probes = 0; probes <= mask; i = (i + 1) & mask, probes++) {
+      const uint64_t current = slot(i).load(std::memory_order_relaxed);
+      if (current == EMPTY) {
+        slot(i).store(entry, std::memory_order_release);
+        count.fetch_add(1, std::memory_order_relaxed);
+        return true;
+      }
+
+      if (keyOf(current) == pageId) {
+        slot(i).store(entry, std::memory_order_release);
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  bool PageTable::erase(uint32_t pageId) noexcept {
+    auto found = locate(pageId);
+    if (!found) {
+      return false;
+    }
+
+    // Shift later entries of the probe run back into the hole, so lookups need no tombstones.
+    size_t hole = *found;
+    for (size_t i = (hole + 1) & mask;; i = (i + 1) & mask) {
+      const uint64_t entry = slot(i).load(std::memory_order_relaxed);
+      if (entry == EMPTY) {
+        break;
+      }
+
+      // Entries whose home lies cyclically in (hole, i] are still reachable where they are.
+      const size_t start = home(keyOf(entry));
+      const bool reachable =
+          hole <= i ? (hole < start && start <= i) : (hole < start || start <= i);
+      if (reachable) {
+        continue;
+      }
+
+      slot(hole).store(entry, std::memory_order_release);
+      hole = i;
+    }
+
+    slot(hole).store(EMPTY, std::memory_order_release);
+    count.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  size_t PageTable::home(uint32_t pageId) const noexcept {
+    // Fibonacci hashing, so the striding IDs of a shard still spread over the table.
+    return static_cast<size_t>((pageId * 0x9E3779B97F4A7C15ull) >> shift) & mask;
+  }
+
+  std::optional<size_t> PageTable::locate(uint32_t pageId) const noexcept {
+    for (size_t i = home(pageId), probes = 0; probes <= mask; i = (i + 1) & mask, probes++) {
+      const uint64_t entry = slot(i).load(std::memory_order_acquire);
+      if (entry == EMPTY) {
+        return std::nullopt;
+      }
+
+      if (keyOf(entry) == pageId) {
+        return i;
+      }
+    }
+
+    return std::nullopt;
+  }
+} // namespace pulse::cache
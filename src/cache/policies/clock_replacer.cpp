@@ -0,0 +1,68 @@
+/**
+ * @file src/cache/policies/clock_replacer.cpp
+ * @brief Implements the ClockReplacer class for buffer pool page replacement.
+ */
+
+#include "pulsedb/cache/policies/clock_replacer.hpp"
+
+namespace pulse::cache {
+  ClockReplacer::ClockReplacer(size_t capacity)
+      : states(std::make_unique<std::atomic<uint8_t>[]>(capacity)), capacity(capacity), hand(0) {}
+
+  void ClockReplacer::pin(size_t frameId) {
+    if (frameId < capacity) {
+      states[frameId].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  void ClockReplacer::unpin(size_t frameId) {
+    if (frameId < capacity) {
+      states[frameId].store(EVICTABLE | REFERENCED, std::memory_order_relaxed);
+    }
+  }
+
+  [[nodiscard]] std::optional<size_t> ClockReplacer::victim() {
+    std::lock_guard lock(mutex);
+
+    // Two full turns are enough, the first clears every reference bit.
+    for (size_t step = 0; step < 2 * capacity; step++) {
+      const size_t frameId = hand;
+      hand = (hand + 1) % capacity;
+
+      uint8_t state = states[frameId].load(std::memory_order_relaxed);
+      if (!(state & EVICTABLE)) {
+        continue;
+      }
+
+      // Give referenced frames a second chance.
+      if (state & REFERENCED) {
+        states[frameId].compare_exchange_strong(state, EVICTABLE, std::memory_order_relaxed);
+        continue;
+      }
+
+      // Lose the race to a concurrent pin or unpin and the frame just stays.
+      if (states[frameId].compare_exchange_strong(state, 0, std::memory_order_relaxed)) {
+        return counted(frameId);
+      }
+    }
+
+    return counted(std::nullopt);
+  }
+
+  [[nodiscard]] std::vector<size_t> ClockReplacer::candidates(size_t count) const {
+    std::lock_guard lock(mutex);
+    std::vector<size_t> result;
+
+    // Unreferenced frames go before referenced ones, each in hand order.
+    for (const uint8_t wanted : {EVICTABLE, static_cast<uint8_t>(EVICTABLE | REFERENCED)}) {
+      for (size_t step = 0; step < capacity && result.size() < count; step++) {
+        const size_t frameId = (hand + step) % capacity;
+        if (states[frameId].load(std::memory_order_relaxed) == wanted) {
+          result.push_back(frameId);
+        }
+      }
+    }
+
+    return result;
+  }
+} // namespace pulse::cache
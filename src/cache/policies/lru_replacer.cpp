@@ -35,7 +35,7 @@ namespace pulse::cache {
     std::lock_guard lock(mutex);
 
     if (frameList.empty()) {
-      return std::nullopt;
+      return counted(std::nullopt);
     }
 
     // Get victim from back of list.
@@ -43,6 +43,17 @@ namespace pulse::cache {
     frameList.pop_back();
     frameMap.erase(victimId);
 
-    return victimId;
+    return counted(victimId);
+  }
+
+  [[nodiscard]] std::vector<size_t> LRUReplacer::candidates(size_t count) const {
+    std::lock_guard lock(mutex);
+
+    std::vector<size_t> result;
+    for (auto it = frameList.rbegin(); it != frameList.rend() && result.size() < count; it++) {
+      result.push_back(*it);
+    }
+
+    return result;
   }
 } // namespace pulse::cache
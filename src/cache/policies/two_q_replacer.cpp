@@ -0,0 +1,121 @@
+/**
+ * @file src/cache/policies/two_q_replacer.cpp
+ * @brief Implements the TwoQReplacer class for buffer pool page replacement.
+ */
+
+#include "pulsedb/cache/policies/two_q_replacer.hpp"
+#include <algorithm>
+
+namespace pulse::cache {
+  TwoQReplacer::TwoQReplacer(size_t capacity)
+      : prev(capacity, NONE), next(capacity, NONE), queues(capacity, Queue::NONE),
+        probationTarget(std::max<size_t>(capacity / 4, 1)) {}
+
+  void TwoQReplacer::pin(size_t frameId) {
+    std::lock_guard lock(mutex);
+
+    if (frameId < queues.size() && queues[frameId] != Queue::NONE) {
+      unlink(frameId);
+    }
+  }
+
+  void TwoQReplacer::unpin(size_t frameId) {
+    std::lock_guard lock(mutex);
+
+    if (frameId >= queues.size()) {
+      return;
+    }
+
+    // First access goes on probation, any later one moves the frame to the front of main.
+    const Queue queue = queues[frameId];
+    if (queue != Queue::NONE) {
+      unlink(frameId);
+    }
+
+    push(frameId, queue == Queue::NONE ? Queue::PROBATION : Queue::MAIN);
+  }
+
+  [[nodiscard]] std::optional<size_t> TwoQReplacer::victim() {
+    std::lock_guard lock(mutex);
+
+    // Prefer pages only seen once, unless probation has shrunk below its share.
+    List *from = probation.size > probationTarget || main.size == 0 ? &probation : &main;
+    if (from->size == 0) {
+      return counted(std::nullopt);
+    }
+
+    const size_t victimId = from->tail;
+    unlink(victimId);
+
+    return counted(victimId);
+  }
+
+  [[nodiscard]] std::vector<size_t> TwoQReplacer::candidates(size_t count) const {
+    std::lock_guard lock(mutex);
+    std::vector<size_t> result;
+
+    // Walk both tails the way repeated victim() calls would.
+    size_t fromProbation = probation.tail;
+    size_t fromMain = main.tail;
+    size_t probationSize = probation.size;
+    size_t mainSize = main.size;
+
+    while (result.size() < count && probationSize + mainSize > 0) {
+      if (probationSize > probationTarget || mainSize == 0) {
+        result.push_back(fromProbation);
+        fromProbation = prev[fromProbation];
+        probationSize--;
+      }
+
+      else {
+        result.push_back(fromMain);
+        fromMain = prev[fromMain];
+        mainSize--;
+      }
+    }
+
+    return result;
+  }
+
+  void TwoQReplacer::push(size_t frameId, Queue queue) noexcept {
+    List &list = listOf(queue);
+
+    prev[frameId] = NONE;
+    next[frameId] = list.head;
+    if (list.head != NONE) {
+      prev[list.head] = frameId;
+    }
+
+    else {
+      list.tail = frameId;
+    }
+
+    list.head = frameId;
+    list.size++;
+    queues[frameId] = queue;
+  }
+
+  void TwoQReplacer::unlink(size_t frameId) noexcept {
+    List &list = listOf(queues[frameId]);
+
+    if (prev[frameId] != NONE) {
+      next[prev[frameId]] = next[frameId];
+    }
+
+    else {
+      list.head = next[frameId];
+    }
+
+    if (next[frameId] != NONE) {
+      prev[next[frameId]] = prev[frameId];
+    }
+
+    else {
+      list.tail = prev[frameId];
+    }
+
+    prev[frameId] = next[frameId] = NONE;
+    list.size--;
+    queues[frameId] = Queue::NONE;
+  }
+} // namespace pulse::cache
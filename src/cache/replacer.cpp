@@ -0,0 +1,25 @@
+/**
+ * @file src/cache/replacer.cpp
+ * @brief Implements replacer selection by policy.
+ */
+
+#include "pulsedb/cache/replacer.hpp"
+#include "pulsedb/cache/policies/clock_replacer.hpp"
+#include "pulsedb/cache/policies/lru_replacer.hpp"
+#include "pulsedb/cache/policies/two_q_replacer.hpp"
+
+namespace pulse::cache {
+  std::unique_ptr<Replacer> Replacer::create(ReplacerPolicy policy, size_t capacity) {
+    switch (policy) {
+      case ReplacerPolicy::CLOCK:
+        return std::make_unique<ClockReplacer>(capacity);
+
+      case ReplacerPolicy::TWO_Q:
+        return std::make_unique<TwoQReplacer>(capacity);
+
+      case ReplacerPolicy::LRU:
+      default:
+        return std::make_unique<LRUReplacer>();
+    }
+  }
+} // namespace pulse::cache
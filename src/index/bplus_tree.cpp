@@ -0,0 +1,620 @@
+/**
+ * @file src/index/bplus_tree.cpp
+ * @brief Implements the B+ tree class.
+ */
+
+#include "pulsedb/index/bplus_tree.hpp"
+#include "pulsedb/index/range_scan.hpp"
+#include <stdexcept>
+
+namespace pulse::index {
+  BPlusTree::BPlusTree(
+      cache::BufferPool &pool, std::optional<uint32_t> rootPageId, wal::LogManager *log
+  )
+      : pool(pool), log(log), rootId(0), rootSwip(nullptr), leaves(pool.disk()),
+        logger("bplus-tree") {
+    auto root = rootPageId ? acquire(*rootPageId, false) : create(true, 0);
+    if (!root) {
+      throw std::runtime_error("Failed to open the root page.");
+    }
+
+    rootId = root->id;
+    release(*root);
+
+    logger.info("opened tree with root page {}", rootId);
+  }
+
+  std::optional<uint32_t> BPlusTree::lookup(uint64_t key) {
+    for (int attempt = 0; attempt < OPTIMISTIC_ATTEMPTS; attempt++) {
+      auto descent = descend(key);
+      if (!descent) {
+        continue;
+      }
+
+      // A leaf that isn't resident has to be read in, which leaves it to the latched path.
+      auto read = pool.readOptimistic(descent->leafId, descent->swip);
+      if (!read) {
+        break;
+      }
+
+      auto probe = storage::IndexPage::probe(read->bytes, key);
+      if (probe && probe->isLeaf && probe->pageId == descent->leafId && read->valid() &&
+          (!descent->parent || descent->parent->valid())) {
+        read->touch();
+        return probe->value;
+      }
+    }
+
+    auto leaf = findLeaf(key, false);
+    if (!leaf) {
+      return std::nullopt;
+    }
+
+    auto pageId = leaf->page->lookup(key);
+    release(*leaf);
+
+    return pageId;
+  }
+
+  bool BPlusTree::insert(uint64_t key, uint32_t pageId) {
+    auto leaf = findLeaf(key, true);
+    if (!leaf) {
+      return false;
+    }
+
+    if (leaf->page->lookup(key)) {
+      release(*leaf);
+      return false;
+    }
+
+    // Most inserts fit the leaf and never touch the rest of the tree.
+    if (leaf->page->hasRoomFor(key, pageId)) {
+      leaf->page->insertKey(key, pageId);
+      leaf->dirty = true;
+
+      release(*leaf);
+      return true;
+    }
+
+    release(*leaf);
+    return insertPessimistic(key, pageId);
+  }
+
+  bool BPlusTree::remove(uint64_t key) {
+    auto leaf = findLeaf(key, true);
+    if (!leaf) {
+      return false;
+    }
+
+    if (!leaf->page->lookup(key)) {
+      release(*leaf);
+      return false;
+    }
+
+    // A root leaf has no one to merge with.
+    if (leaf->id == rootId || safeForRemove(*leaf->page)) {
+      leaf->page->removeKey(key);
+      leaf->dirty = true;
+
+      release(*leaf);
+      return true;
+    }
+
+    release(*leaf);
+    return removePessimistic(key);
+  }
+
+  std::vector<uint32_t> BPlusTree::range(uint64_t startKey, uint64_t endKey) {
+    std::vector<uint32_t> results;
+    RangeScan scan(*this, startKey, endKey);
+
+    while (auto entry = scan.next()) {
+      results.push_back(entry->pageId);
+    }
+
+    return results;
+  }
+
+  uint16_t BPlusTree::height() {
+    auto root = acquire(rootId, false);
+    if (!root) {
+      return 0;
+    }
+
+    const uint16_t levels = root->page->level() + 1;
+    release(*root);
+
+    return levels;
+  }
+
+  std::optional<BPlusTree::Node> BPlusTree::acquire(uint32_t pageId, bool exclusive) {
+    auto *page = pool.fetchPage(pageId);
+    if (!page) {
+      logger.error("failed to fetch page {}", pageId);
+      return std::nullopt;
+    }
+
+    pool.latchPage(pageId, exclusive);
+    if (page->type() != storage::PageType::INDEX) {
+      logger.error("page {} is not an index page", pageId);
+      pool.unlatchPage(pageId, exclusive);
+      pool.unpinPage(pageId, false);
+      return std::nullopt;
+    }
+
+    return Node{pageId, static_cast<storage::IndexPage *>(page), exclusive, false};
+  }
+
+  std::optional<BPlusTree::Node> BPlusTree::create(bool isLeaf, uint16_t level) {
+    // Leaves come from their extent, so a leaf and the ones split off it stay together on disk.
+    auto *page = isLeaf ? pool.createPage(leaves.allocate(), storage::PageType::INDEX, true, level)
+                        : pool.createPage(storage::PageType::INDEX, false, level);
+    if (!page) {
+      logger.error("failed to create index page");
+      return std::nullopt;
+    }
+
+    pool.latchPage(page->id(), true);
+    return Node{page->id(), static_cast<storage::IndexPage *>(page), true, true};
+  }
+
+  void BPlusTree::release(Node &node) {
+    if (node.dirty && log) {
+      log->logPage(*node.page);
+    }
+
+    // Unlatch first, once unpinned the frame may be reused.
+    pool.unlatchPage(node.id, node.exclusive);
+    pool.unpinPage(node.id, node.dirty);
+  }
+
+  void BPlusTree::release(std::vector<Node> &path) {
+    for (Node &node : path) {
+      release(node);
+    }
+
+    path.clear();
+  }
+
+  std::optional<BPlusTree::Node> BPlusTree::findLeaf(uint64_t key, bool exclusiveLeaf) {
+    for (int attempt = 0; attempt < OPTIMISTIC_ATTEMPTS; attempt++) {
+      auto descent = descend(key);
+      if (!descent) {
+        continue;
+      }
+
+      auto leaf = acquire(descent->leafId, exclusiveLeaf);
+      if (!leaf) {
+        continue;
+      }
+
+      // Splits and merges of the leaf change its parent, an unchanged parent still routes here.
+      if (leaf->page->isLeaf() && (!descent->parent || descent->parent->valid())) {
+        return leaf;
+      }
+
+      release(*leaf);
+    }
+
+    while (true) {
+      auto node = acquire(rootId, false);
+      if (!node) {
+        return std::nullopt;
+      }
+
+      if (exclusiveLeaf && node->page->isLeaf()) {
+        release(*node);
+
+        node = acquire(rootId, true);
+        if (!node || node->page->isLeaf()) {
+          return node;
+        }
+
+        // The root split while it wasn't latched.
+        release(*node);
+        continue;
+      }
+
+      while (!node->page->isLeaf()) {
+        // Only the root changes between leaf and internal, so level 1 always has leaf children.
+        const bool exclusive = exclusiveLeaf && node->page->level() == 1;
+
+        auto child = acquire(*node->page->lookup(key), exclusive);
+        release(*node);
+
+        if (!child) {
+          return std::nullopt;
+        }
+
+        node = child;
+      }
+
+      return node;
+    }
+  }
+
+  std::optional<BPlusTree::Descent> BPlusTree::descend(uint64_t key) const {
+    uint32_t pageId = rootId;
+    cache::Swip *swip = &rootSwip;
+    auto read = pool.readOptimistic(pageId, swip);
+    std::optional<cache::OptimisticRead> parent;
+
+    while (read) {
+      const auto probe = storage::IndexPage::probe(read->bytes, key);
+      if (!probe || probe->pageId != pageId || !read->valid()) {
+        return std::nullopt;
+      }
+
+      // Nothing here pins, so count the visit for the replacer or hot nodes age as if unread.
+      read->touch();
+      if (probe->isLeaf) {
+        return Descent{pageId, parent, swip};
+      }
+
+      // Level 1 routes to leaves, the caller reads or latches them itself.
+      swip = read->frame->swip(probe->slot);
+      if (probe->level == 1) {
+        return Descent{*probe->value, read, swip};
+      }
+
+      // The child's version is only meaningful if the node still routed to it once it was taken.
+      auto child = pool.readOptimistic(*probe->value, swip);
+      if (!child || !read->valid()) {
+        return std::nullopt;
+      }
+
+      pageId = *probe->value;
+      parent = read;
+      read = child;
+    }
+
+    return std::nullopt;
+  }
+
+  std::vector<uint32_t> BPlusTree::leavesAfter(uint64_t key, uint64_t endKey, size_t count) {
+    std::vector<uint32_t> leaves;
+
+    auto node = acquire(rootId, false);
+    if (!node || node->page->isLeaf()) {
+      // A root leaf has no siblings.
+      if (node) {
+        release(*node);
+      }
+
+      return leaves;
+    }
+
+    while (node->page->level() > 1) {
+      auto child = acquire(*node->page->lookup(key), false);
+      release(*node);
+
+      if (!child) {
+        return leaves;
+      }
+
+      node = child;
+    }
+
+    // Start right after the leaf covering the key, then carry on into the parent's siblings.
+    const uint32_t leafId = *node->page->lookup(key);
+    size_t index = 0;
+    while (index < node->page->itemCount() && node->page->pageIdAt(index) != leafId) {
+      index++;
+    }
+
+    index++;
+    while (leaves.size() < count) {
+      if (index < node->page->itemCount()) {
+        if (node->page->keyAt(index) > endKey) {
+          break;
+        }
+
+        leaves.push_back(node->page->pageIdAt(index++));
+        continue;
+      }
+
+      const uint32_t nextId = node->page->nextPage();
+      if (nextId == 0) {
+        break;
+      }
+
+      auto next = acquire(nextId, false);
+      release(*node);
+
+      if (!next) {
+        return leaves;
+      }
+
+      node = next;
+      index = 0;
+    }
+
+    release(*node);
+    return leaves;
+  }
+
+  template <typename Safe>
+  std::vector<BPlusTree::Node> BPlusTree::findPath(uint64_t key, Safe &&safe) {
+    std::vector<Node> path;
+
+    auto root = acquire(rootId, true);
+    if (!root) {
+      return path;
+    }
+
+    path.push_back(*root);
+    while (!path.back().page->isLeaf()) {
+      auto child = acquire(*path.back().page->lookup(key), true);
+      if (!child) {
+        release(path);
+        return path;
+      }
+
+      // No change can get past a safe node, so its ancestors are free to go.
+      if (safe(*child->page)) {
+        release(path);
+      }
+
+      path.push_back(*child);
+    }
+
+    return path;
+  }
+
+  bool BPlusTree::insertPessimistic(uint64_t key, uint32_t pageId) {
+    auto path = findPath(key, safeForInsert);
+    if (path.empty()) {
+      return false;
+    }
+
+    if (path.back().page->lookup(key)) {
+      release(path);
+      return false;
+    }
+
+    // Insert bottom-up, splitting full nodes. Every split adds an entry to the parent.
+    std::optional<std::pair<uint64_t, uint32_t>> entry = std::pair{key, pageId};
+    bool inserted = true;
+
+    for (size_t i = path.size(); i-- > 0 && entry;) {
+      Node &node = path[i];
+
+      // An entry that widens the encoding past the node's room goes in once the node is split.
+      std::optional<std::pair<uint64_t, uint32_t>> pending;
+      if (!node.page->insertKey(entry->first, entry->second)) {
+        pending = entry;
+      }
+
+      else if (!node.page->isOverflow()) {
+        node.dirty = true;
+        break;
+      }
+
+      node.dirty = true;
+      bool wasSplit;
+      if (node.id == rootId) {
+        wasSplit = splitRoot(node, pending);
+        entry.reset();
+      }
+
+      else {
+        entry = split(node, pending);
+        wasSplit = entry.has_value();
+      }
+
+      // A lost separator leaves its node reachable through the sibling links only.
+      if (!wasSplit && pending) {
+        inserted = i + 1 < path.size();
+        logger.error("no room for key {} in page {}", pending->first, node.id);
+      }
+    }
+
+    release(path);
+    return inserted;
+  }
+
+  bool BPlusTree::removePessimistic(uint64_t key) {
+    auto path = findPath(key, safeForRemove);
+    if (path.empty()) {
+      return false;
+    }
+
+    Node &leaf = path.back();
+    if (!leaf.page->removeKey(key)) {
+      release(path);
+      return false;
+    }
+
+    leaf.dirty = true;
+
+    // Merge under-full nodes bottom-up, every merge removes an entry from the parent.
+    for (size_t i = path.size() - 1; i > 0 && path[i].page->isUnderflow(); i--) {
+      if (!mergeRight(path[i - 1], path[i])) {
+        break;
+      }
+    }
+
+    Node &top = path.front();
+    if (top.id == rootId && !top.page->isLeaf() && top.page->itemCount() == 1) {
+      collapseRoot(path);
+    }
+
+    release(path);
+    return true;
+  }
+
+  std::optional<std::pair<uint64_t, uint32_t>>
+  BPlusTree::split(Node &node, std::optional<std::pair<uint64_t, uint32_t>> pending) {
+    auto sibling = create(node.page->isLeaf(), node.page->level());
+    if (!sibling) {
+      logger.error("failed to split page {}", node.id);
+      return std::nullopt;
+    }
+
+    const uint64_t separator = node.page->split(*sibling->page);
+    node.dirty = true;
+
+    // Either half has room for any entry after a split.
+    if (pending) {
+      auto &half = pending->first >= separator ? *sibling->page : *node.page;
+      half.insertKey(pending->first, pending->second);
+    }
+
+    // Latching the old right sibling after the new one keeps the left to right order.
+    relinkNext(*sibling);
+
+    const uint32_t siblingId = sibling->id;
+    release(*sibling);
+
+    logger.debug("split page {} into {} at key {}", node.id, siblingId, separator);
+    return std::pair{separator, siblingId};
+  }
+
+  bool BPlusTree::splitRoot(Node &root, std::optional<std::pair<uint64_t, uint32_t>> pending) {
+    auto left = create(root.page->isLeaf(), root.page->level());
+    auto right = create(root.page->isLeaf(), root.page->level());
+
+    if (!left || !right) {
+      logger.error("failed to split the root");
+
+      for (auto *child : {&left, &right}) {
+        if (*child) {
+          const uint32_t childId = (*child)->id;
+          release(**child);
+          pool.deletePage(childId);
+        }
+      }
+
+      return false;
+    }
+
+    // Move the upper half right and the lower half left, then point the root at both.
+    const uint16_t level = root.page->level();
+    const uint64_t separator = root.page->split(*right->page);
+
+    left->page->merge(*root.page);
+    left->page->setPrevPage(0);
+    right->page->setPrevPage(left->id);
+
+    if (pending) {
+      auto &half = pending->first >= separator ? *right->page : *left->page;
+      half.insertKey(pending->first, pending->second);
+    }
+
+    root.page->clear();
+    root.page->setNextPage(0);
+    root.page->setPrevPage(0);
+    root.page->setLeaf(false);
+    root.page->setLevel(level + 1);
+
+    root.page->insertKey(0, left->id);
+    root.page->insertKey(separator, right->id);
+    root.dirty = true;
+
+    release(*left);
+    release(*right);
+
+    logger.debug("split the root, height is now {}", level + 2);
+    return true;
+  }
+
+  bool BPlusTree::mergeRight(Node &parent, Node &node) {
+    // The node's right neighbour under the same parent is its sibling.
+    size_t index = 0;
+    while (index < parent.page->itemCount() && parent.page->pageIdAt(index) != node.id) {
+      index++;
+    }
+
+    if (index + 1 >= parent.page->itemCount()) {
+      return false;
+    }
+
+    auto right = acquire(parent.page->pageIdAt(index + 1), true);
+    if (!right) {
+      return false;
+    }
+
+    // Leave room for the next insert, a full node would have to split right away.
+    if (!node.page->canMerge(*right->page)) {
+      release(*right);
+      return false;
+    }
+
+    node.page->merge(*right->page);
+    node.dirty = true;
+    relinkNext(node);
+
+    parent.page->removeKey(parent.page->keyAt(index + 1));
+    parent.dirty = true;
+
+    const uint32_t rightId = right->id;
+    release(*right);
+
+    // A scan that just left the page may still hold its pin, the pool frees it once dropped.
+    if (!pool.retirePage(rightId)) {
+      logger.warn("failed to free merged page {}", rightId);
+    }
+
+    logger.debug("merged page {} into {}", rightId, node.id);
+    return true;
+  }
+
+  bool BPlusTree::collapseRoot(std::vector<Node> &path) {
+    Node &root = path.front();
+    const uint32_t childId = root.page->pageIdAt(0);
+
+    // The remaining child is usually the node the merge kept, which is already latched.
+    const bool held = path.size() > 1 && path[1].id == childId;
+
+    std::optional<Node> acquired;
+    if (!held) {
+      acquired = acquire(childId, true);
+      if (!acquired) {
+        return false;
+      }
+    }
+
+    Node &child = held ? path[1] : *acquired;
+
+    root.page->clear();
+    root.page->merge(*child.page);
+    root.page->setLeaf(child.page->isLeaf());
+    root.page->setLevel(child.page->level());
+    root.page->setNextPage(0);
+    root.page->setPrevPage(0);
+    root.dirty = true;
+
+    // The child is about to be dropped, there's nothing worth logging.
+    child.dirty = false;
+    release(child);
+
+    if (held) {
+      path.erase(path.begin() + 1);
+    }
+
+    if (!pool.retirePage(childId)) {
+      logger.warn("failed to free collapsed page {}", childId);
+    }
+
+    logger.debug("collapsed the root, height is now {}", root.page->level() + 1);
+    return true;
+  }
+
+  bool BPlusTree::relinkNext(Node &node) {
+    const uint32_t nextId = node.page->nextPage();
+    if (nextId == 0) {
+      return true;
+    }
+
+    auto next = acquire(nextId, true);
+    if (!next) {
+      return false;
+    }
+
+    next->page->setPrevPage(node.id);
+    next->dirty = true;
+    release(*next);
+
+    return true;
+  }
+} // namespace pulse::index
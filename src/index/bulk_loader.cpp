@@ -0,0 +1,218 @@
+/**
+ * @file src/index/bulk_loader.cpp
+ * @brief Implements the bulk loader class.
+ */
+
+#include "pulsedb/index/bulk_loader.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace pulse::index {
+  BulkLoader::BulkLoader(
+      storage::DiskManager &diskManager, BPlusTree &tree, double fillFactor, size_t batchPages
+  )
+      : diskManager(diskManager), tree(tree), fillFactor(fillFactor),
+        batchPages(std::max<size_t>(batchPages, 1)), pages(diskManager),
+        recordsAdded(0), pagesWritten(0), finished(false), logger("bulk-loader") {
+    auto root = tree.acquire(tree.rootId, false);
+    if (!root) {
+      throw std::runtime_error("Failed to open the root page.");
+    }
+
+    const bool empty = root->page->isLeaf() && root->page->itemCount() == 0;
+    tree.release(*root);
+
+    if (!empty) {
+      throw std::runtime_error("Bulk loading needs an empty tree.");
+    }
+  }
+
+  bool BulkLoader::add(std::span<const storage::BulkRecord> records) {
+    if (finished) {
+      logger.error("load is already finished");
+      return false;
+    }
+
+    // Check the whole batch first, so a rejected batch leaves nothing behind.
+    std::optional<uint32_t> previous = lastKey;
+    for (const auto &record : records) {
+      if (previous && record.key <= *previous) {
+        logger.error("key {} is out of order", record.key);
+        return false;
+      }
+
+      const uint32_t space =
+          storage::DataPage::spaceNeeded(record.length) + storage::DataPage::PAIR_SIZE;
+      if (storage::DataPage::DATA_HEADER_SIZE + space >= storage::Page::PAGE_SIZE) {
+        logger.error("record {} of {} bytes doesn't fit a page", record.key, record.length);
+        return false;
+      }
+
+      previous = record.key;
+    }
+
+    while (!records.empty()) {
+      if (!dataPage) {
+        dataPage = std::make_unique<storage::DataPage>(pages.allocate());
+      }
+
+      const size_t count = dataPage->insertRecords(records);
+      for (size_t i = 0; i < count; i++) {
+        dataKeys.push_back(records[i].key);
+      }
+
+      if (count > 0) {
+        recordsAdded += count;
+        lastKey = records[count - 1].key;
+        records = records.subspan(count);
+      }
+
+      // The rest didn't fit, move on to a new page.
+      if (!records.empty() && !sealData()) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  bool BulkLoader::finish() {
+    if (finished) {
+      logger.error("load is already finished");
+      return false;
+    }
+
+    if (dataPage && !sealData()) {
+      return false;
+    }
+
+    // Seal every level bottom-up, until a level is left with a single node to become the root.
+    std::unique_ptr<storage::IndexPage> top;
+    for (size_t level = 0; level < levels.size(); level++) {
+      if (level + 1 == levels.size() && levels[level].sealed == 0) {
+        top = std::move(levels[level].page);
+        break;
+      }
+
+      if (!seal(level, 0)) {
+        return false;
+      }
+    }
+
+    // What's left of the last extent goes back on the free list with the same sync.
+    pages.release();
+
+    // Every page the root will point to must be on disk before it does.
+    if (!writeBatch() || !diskManager.sync()) {
+      logger.error("failed to write the loaded pages");
+      return false;
+    }
+
+    if (top) {
+      auto root = tree.acquire(tree.rootId, true);
+      if (!root) {
+        return false;
+      }
+
+      root->page->clear();
+      root->page->merge(*top);
+      root->page->setLeaf(top->isLeaf());
+      root->page->setLevel(top->level());
+      root->page->setNextPage(0);
+      root->page->setPrevPage(0);
+      root->dirty = true;
+      tree.release(*root);
+
+      // The root took the node's entries, its own page was never written.
+      diskManager.deallocatePage(top->id());
+    }
+
+    finished = true;
+    levels.clear();
+
+    logger.info("loaded {} records into {} pages", recordsAdded, pagesWritten);
+    return true;
+  }
+
+  bool BulkLoader::push(size_t level, uint64_t key, uint32_t pageId) {
+    if (level == levels.size()) {
+      auto page =
+          std::make_unique<storage::IndexPage>(pages.allocate(), level == 0, level);
+      levels.push_back(Level{std::move(page), 0});
+    }
+
+    // Sealing may open levels above, so the level is looked up again afterwards.
+    if (levels[level].page->itemCount() >= nodeEntries(*levels[level].page, key, pageId) &&
+        !seal(level, pages.allocate())) {
+      return false;
+    }
+
+    levels[level].page->insertKey(key, pageId);
+    return true;
+  }
+
+  size_t BulkLoader::nodeEntries(
+      const storage::IndexPage &page, uint64_t key, uint32_t pageId
+  ) const noexcept {
+    // Full nodes would split on the next insert, nodes at the minimum would merge on a remove.
+    const size_t capacity = page.capacityWith(key, pageId);
+    const auto entries = static_cast<size_t>(static_cast<double>(capacity) * fillFactor);
+    return std::clamp(entries, storage::IndexPage::minEntries() + 1, capacity - 1);
+  }
+
+  bool BulkLoader::seal(size_t level, uint32_t nextId) {
+    Level &open = levels[level];
+    auto page = std::move(open.page);
+    const uint32_t pageId = page->id();
+
+    // Like a root split, the first node of a level is routed to from key 0.
+    const uint64_t firstKey = open.sealed == 0 ? 0 : page->keyAt(0);
+    page->setNextPage(nextId);
+    open.sealed++;
+
+    if (nextId != 0) {
+      open.page = std::make_unique<storage::IndexPage>(nextId, level == 0, level);
+      open.page->setPrevPage(pageId);
+    }
+
+    if (!write(std::move(page))) {
+      return false;
+    }
+
+    return push(level + 1, firstKey, pageId);
+  }
+
+  bool BulkLoader::sealData() {
+    const uint32_t pageId = dataPage->id();
+    for (uint32_t key : dataKeys) {
+      if (!push(0, key, pageId)) {
+        return false;
+      }
+    }
+
+    dataKeys.clear();
+    return write(std::move(dataPage));
+  }
+
+  bool BulkLoader::write(std::unique_ptr<storage::Page> page) {
+    batch.push_back(std::move(page));
+    return batch.size() < batchPages || writeBatch();
+  }
+
+  bool BulkLoader::writeBatch() {
+    std::vector<const storage::Page *> pages;
+    pages.reserve(batch.size());
+
+    for (const auto &page : batch) {
+      pages.push_back(page.get());
+    }
+
+    if (!diskManager.writePages(pages)) {
+      return false;
+    }
+
+    pagesWritten += batch.size();
+    batch.clear();
+    return true;
+  }
+} // namespace pulse::index
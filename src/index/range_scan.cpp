@@ -0,0 +1,211 @@
+/**
+ * @file src/index/range_scan.cpp
+ * @brief Implements the range scan class.
+ */
+
+#include "pulsedb/index/range_scan.hpp"
+#include <limits>
+
+namespace pulse::index {
+  RangeScan::RangeScan(BPlusTree &tree, uint64_t startKey, uint64_t endKey, size_t readAhead)
+      : tree(tree), startKey(startKey), endKey(endKey), readAhead(readAhead), leavesAhead(0),
+        lastWindow(false), finished(startKey > endKey), readingRecords(false), found(false),
+        position(0), logger("range-scan") {}
+
+  RangeScan::~RangeScan() noexcept {
+    data.release();
+
+    if (leaf) {
+      tree.pool.unpinPage(leaf->id, false);
+    }
+  }
+
+  std::optional<ScanEntry> RangeScan::next() {
+    data.release();
+    current.reset();
+
+    while (position == entries.size()) {
+      if (!advance()) {
+        return std::nullopt;
+      }
+    }
+
+    current = entries[position++];
+    return current;
+  }
+
+  std::optional<std::pair<const void *, uint16_t>> RangeScan::record() {
+    if (!current || current->key > std::numeric_limits<uint32_t>::max()) {
+      return std::nullopt;
+    }
+
+    // Scans that only want the keys never pay for reading the data pages ahead.
+    if (!readingRecords) {
+      readingRecords = true;
+      readAheadRecords(position - 1);
+    }
+
+    if (!data) {
+      data = tree.pool.readPage<storage::DataPage>(current->pageId);
+      if (!data) {
+        return std::nullopt;
+      }
+    }
+
+    auto slotId = data->getSlotId(static_cast<uint32_t>(current->key));
+    return slotId ? data->getRecord(*slotId) : std::nullopt;
+  }
+
+  bool RangeScan::advance() {
+    if (finished) {
+      return false;
+    }
+
+    entries.clear();
+    position = 0;
+
+    std::optional<BPlusTree::Node> next;
+    if (leaf) {
+      next = step();
+    }
+
+    // The first leaf, or the kept one was merged away and the chain has to be found again.
+    found = !next && !finished;
+    if (found) {
+      next = tree.findLeaf(lastKey.value_or(startKey), false);
+    }
+
+    if (!next) {
+      finished = true;
+      return false;
+    }
+
+    const bool more = collect(*next);
+    if (entries.empty() && !more) {
+      tree.release(*next);
+      finished = true;
+      return false;
+    }
+
+    // Keep only the pin, the latch would hold up writers for as long as the entries are consumed.
+    if (more) {
+      tree.pool.unlatchPage(next->id, false);
+      leaf = next;
+    }
+
+    else {
+      tree.release(*next);
+      finished = true;
+    }
+
+    readAheadLeaves();
+    if (readingRecords) {
+      readAheadRecords(0);
+    }
+
+    return true;
+  }
+
+  std::optional<BPlusTree::Node> RangeScan::step() {
+    BPlusTree::Node kept = *leaf;
+    leaf.reset();
+
+    tree.pool.latchPage(kept.id, false);
+
+    // The root leaf turns internal when it splits, descend again.
+    if (!kept.page->isLeaf()) {
+      tree.release(kept);
+      return std::nullopt;
+    }
+
+    // Keys merged in from the right sibling since come after the last key copied.
+    const size_t count = kept.page->itemCount();
+    if (count > 0 && lastKey && kept.page->keyAt(count - 1) > *lastKey) {
+      return kept;
+    }
+
+    const uint32_t nextId = kept.page->nextPage();
+    if (nextId == 0) {
+      tree.release(kept);
+      finished = true;
+      return std::nullopt;
+    }
+
+    // Latch the next leaf before letting go of this one. A leaf just found from the root is in
+    // the chain, even if a failed relink left its sibling's back link behind.
+    auto next = tree.acquire(nextId, false);
+    const bool linked =
+        next && next->page->isLeaf() && (found || next->page->prevPage() == kept.id);
+    tree.release(kept);
+
+    if (!linked) {
+      logger.debug("leaf {} left the chain, descending again", kept.id);
+
+      if (next) {
+        tree.release(*next);
+      }
+
+      return std::nullopt;
+    }
+
+    return next;
+  }
+
+  bool RangeScan::collect(const BPlusTree::Node &node) {
+    const storage::IndexPage &page = *node.page;
+    const size_t count = page.itemCount();
+
+    // Keys up to the last one copied were seen in an earlier leaf.
+    for (size_t i = 0; i < count; i++) {
+      const uint64_t key = page.keyAt(i);
+      const bool seen = lastKey ? key <= *lastKey : key < startKey;
+      if (seen) {
+        continue;
+      }
+
+      if (key > endKey) {
+        return false;
+      }
+
+      entries.push_back({key, page.pageIdAt(i)});
+      lastKey = key;
+    }
+
+    // A leaf ending before the range does may still be followed by keys within it.
+    return page.nextPage() != 0 && (count == 0 || page.keyAt(count - 1) < endKey);
+  }
+
+  void RangeScan::readAheadLeaves() {
+    if (readAhead == 0 || finished) {
+      return;
+    }
+
+    if (leavesAhead > 0) {
+      leavesAhead--;
+    }
+
+    // Top up once half the window is consumed, leaving the rest to overlap with the next reads.
+    if (lastWindow || leavesAhead > readAhead / 2) {
+      return;
+    }
+
+    auto leaves = tree.leavesAfter(lastKey.value_or(startKey), endKey, readAhead);
+
+    tree.pool.prefetch(leaves);
+    leavesAhead = leaves.size();
+    lastWindow = leaves.size() < readAhead;
+  }
+
+  void RangeScan::readAheadRecords(size_t from) {
+    std::vector<uint32_t> pageIds;
+    pageIds.reserve(entries.size() - from);
+
+    for (size_t i = from; i < entries.size(); i++) {
+      if (pageIds.empty() || pageIds.back() != entries[i].pageId) {
+        pageIds.push_back(entries[i].pageId);
+      }
+    }
+
+    tree.pool.prefetch(pageIds);
+  }
+} // namespace pulse::index
@@ -3,10 +3,15 @@
  * @brief Demonstrates the RDBMS interactively.
  */
 
+#include "pulsedb/cache/buffer_pool.hpp"
+#include "pulsedb/index/bplus_tree.hpp"
+#include "pulsedb/index/bulk_loader.hpp"
 #include "pulsedb/storage/data_page.hpp"
 #include "pulsedb/storage/disk_manager.hpp"
-#include "pulsedb/storage/index_page.hpp"
 #include "pulsedb/utils/logger.hpp"
+#include "pulsedb/wal/log_manager.hpp"
+#include <fstream>
+#include <map>
 
 using namespace pulse;
 namespace fs = std::filesystem;
@@ -15,21 +20,34 @@ enum class RecordType : uint16_t { STRING = 1 };
 
 class DemoREPL {
 public:
-  DemoREPL(const std::string &path) : logger("repl"), dm(path, !fs::exists(path)), rootPageId(0) {
+  DemoREPL(const std::string &path)
+      : logger("repl"), dm(path, !fs::exists(path)),
+        log(path + ".wal", !fs::exists(path + ".wal")), pool(dm, 64), warmupPath(path + ".warm") {
     utils::logging::setLevel(utils::LogLevel::NONE);
 
-    // Create initial root index page.
-    if (dm.pageCount() == 0) {
-      rootPageId = dm.allocatePage();
-      dm.flushPage(storage::IndexPage(rootPageId, true));
+    // Redo whatever reached the log but not the database.
+    log.recover(dm);
+    pool.attachLog(&log);
+    pool.warmUp(warmupPath);
+
+    // The root is the first page, create it for a new database.
+    std::optional<uint32_t> rootPageId;
+    if (dm.pageCount() > 0) {
+      rootPageId = 0;
     }
 
+    tree = std::make_unique<index::BPlusTree>(pool, rootPageId, &log);
+    log.commit();
+
     logger.info("initialized demo repl");
   }
 
+  ~DemoREPL() { pool.saveWarmup(warmupPath); }
+
   void start() {
     std::string line;
-    std::cout << "commands: read <key>, write <key> <value>, delete <key>, flush, exit\n\n";
+    std::cout << "commands: read <key>, write <key> <value>, delete <key>, load <file>, flush, "
+                 "exit\n\n";
 
     while (true) {
       std::cout << "pulse-db> ";
@@ -72,6 +90,14 @@ public:
       }
     }
 
+    else if (cmd == "load") {
+      std::string file;
+
+      if (iss >> file) {
+        load(file);
+      }
+    }
+
     else if (cmd == "flush")
       flush();
 
@@ -82,14 +108,7 @@ public:
 
 private:
   void read(uint32_t key) {
-    auto rootPage = dm.fetchPage(rootPageId);
-    if (!rootPage) {
-      logger.error("failed to fetch root page");
-      return;
-    }
-
-    auto *indexPage = static_cast<storage::IndexPage *>(rootPage.get());
-    auto dataPageId = indexPage->lookup(key);
+    auto dataPageId = tree->lookup(key);
     if (!dataPageId) {
       logger.error("key not found: {}", key);
       return;
@@ -121,46 +140,57 @@ private:
   }
 
   void write(uint32_t key, const std::string &value) {
-    auto rootPage = dm.fetchPage(rootPageId);
-    if (!rootPage) {
-      logger.error("failed to fetch root page");
+    if (tree->lookup(key)) {
+      logger.error("key already exists: {}", key);
       return;
     }
 
-    uint32_t dataPageId = dm.allocatePage();
-    auto dataPage = std::make_unique<storage::DataPage>(dataPageId);
+    const auto length = static_cast<uint16_t>(value.length() + 1);
+    const auto type = static_cast<uint16_t>(RecordType::STRING);
+    const size_t needed = storage::DataPage::spaceNeeded(length) + storage::DataPage::PAIR_SIZE;
 
-    // Insert the record into the data page.
-    auto slotId = dataPage->insertRecord(
-        key, value.c_str(), value.length() + 1, static_cast<uint16_t>(RecordType::STRING)
-    );
+    // Fill a data page that still has room before starting a new one.
+    std::unique_ptr<storage::Page> dataPage;
+    if (auto pageId = dm.findPageWithSpace(needed)) {
+      dataPage = dm.fetchPage(*pageId);
+    }
 
-    if (!slotId) {
-      logger.error("failed to insert record");
-      return;
+    auto *page = dataPage && dataPage->type() == storage::PageType::DATA
+                     ? static_cast<storage::DataPage *>(dataPage.get())
+                     : nullptr;
+
+    if (!page || !page->insertRecord(key, value.c_str(), length, type)) {
+      dataPage = std::make_unique<storage::DataPage>(dm.allocatePage());
+      page = static_cast<storage::DataPage *>(dataPage.get());
+
+      if (!page->insertRecord(key, value.c_str(), length, type)) {
+        logger.error("failed to insert record");
+        return;
+      }
     }
 
-    auto *indexPage = static_cast<storage::IndexPage *>(rootPage.get());
-    if (!indexPage->insertKey(key, dataPageId)) {
+    const uint32_t dataPageId = page->id();
+
+    // The tree logs the index pages it changes.
+    log.logPage(*dataPage);
+    if (!tree->insert(key, dataPageId)) {
       logger.error("failed to insert index entry");
       return;
     }
 
-    dm.flushPage(*indexPage);
+    // The log makes the write durable, the pages themselves can follow lazily.
+    if (!log.commit()) {
+      logger.error("failed to commit write");
+      return;
+    }
+
     dm.flushPage(*dataPage);
 
     std::cout << "-> wrote key " << key << " = \"" << value << "\"" << std::endl;
   }
 
   void remove(uint32_t key) {
-    auto rootPage = dm.fetchPage(rootPageId);
-    if (!rootPage) {
-      logger.error("failed to fetch root page");
-      return;
-    }
-
-    auto *indexPage = static_cast<storage::IndexPage *>(rootPage.get());
-    auto dataPageId = indexPage->lookup(key);
+    auto dataPageId = tree->lookup(key);
     if (!dataPageId) {
       logger.error("key not found: {}", key);
       return;
@@ -181,17 +211,66 @@ private:
       return;
     }
 
-    if (!indexPage->removeKey(key)) {
+    if (!tree->remove(key)) {
       logger.error("failed to remove key from index: {}", key);
       return;
     }
 
-    dm.flushPage(*indexPage);
+    // Give the room back now, the free space map only sees what the page can take as is.
+    if (page->needsCompact()) {
+      page->compact();
+    }
+
+    log.logPage(*page);
+    if (!log.commit()) {
+      logger.error("failed to commit delete");
+      return;
+    }
+
     dm.flushPage(*page);
     std::cout << "-> removed key " << key << std::endl;
   }
 
+  void load(const std::string &file) {
+    std::ifstream in(file);
+    if (!in) {
+      logger.error("failed to open {}", file);
+      return;
+    }
+
+    // Each line holds a key and its value.
+    std::map<uint32_t, std::string> rows;
+    uint32_t key;
+    std::string value;
+
+    while (in >> key && std::getline(in, value)) {
+      rows[key] = value.substr(1); // Skip the leading space.
+    }
+
+    std::vector<storage::BulkRecord> records;
+    for (const auto &[rowKey, rowValue] : rows) {
+      const auto length = static_cast<uint16_t>(rowValue.length() + 1);
+      records.push_back(
+          {rowKey, rowValue.c_str(), length, static_cast<uint16_t>(RecordType::STRING)}
+      );
+    }
+
+    try {
+      index::BulkLoader loader(dm, *tree);
+      if (!loader.add(records) || !loader.finish() || !log.commit()) {
+        logger.error("failed to load {}", file);
+        return;
+      }
+
+      std::cout << "-> loaded " << loader.recordCount() << " rows into " << loader.pageCount()
+                << " pages" << std::endl;
+    } catch (const std::exception &e) {
+      PULSEDB_LOG_ERROR(logger, "failed to load {}: {}", file, e.what());
+    }
+  }
+
   void flush() {
+    pool.flushAll();
     if (dm.sync()) {
       std::cout << "flushed all pages to disk" << std::endl;
     } else {
@@ -199,9 +278,12 @@ private:
     }
   }
 
-  uint32_t rootPageId;     /**< Root index page. */
-  storage::DiskManager dm; /**< Disk manager instance. */
-  utils::Logger logger;    /**< Logger instance. */
+  storage::DiskManager dm;                /**< Disk manager instance. */
+  wal::LogManager log;                    /**< Write-ahead log. */
+  cache::BufferPool pool;                 /**< Buffer pool for the index pages. */
+  std::unique_ptr<index::BPlusTree> tree; /**< Key index, opened after recovery. */
+  utils::Logger logger;                   /**< Logger instance. */
+  fs::path warmupPath;                    /**< Resident pages saved for the next start. */
 };
 
 int main() {
@@ -0,0 +1,104 @@
+/**
+ * @file src/storage/backends/thread_pool_backend.cpp
+ * @brief Implements the thread pool I/O backend.
+ */
+
+#include "pulsedb/storage/backends/thread_pool_backend.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <unistd.h>
+
+namespace pulse::storage {
+  namespace {
+    /**
+     * @brief Perform a full positional transfer, retrying short and interrupted calls.
+     * @param request The request to execute.
+     * @return True if all bytes were transferred.
+     */
+    bool execute(const IORequest &request) noexcept {
+      auto *buffer = static_cast<uint8_t *>(request.buffer);
+      size_t remaining = request.size;
+      uint64_t offset = request.offset;
+
+      while (remaining > 0) {
+        const ssize_t n = request.op == IOOp::READ
+                              ? ::pread(request.fd, buffer, remaining, offset)
+                              : ::pwrite(request.fd, buffer, remaining, offset);
+
+        if (n < 0 && errno == EINTR) {
+          continue;
+        }
+
+        if (n <= 0) {
+          return false;
+        }
+
+        buffer += n;
+        remaining -= n;
+        offset += n;
+      }
+
+      return true;
+    }
+  } // namespace
+
+  ThreadPoolBackend::ThreadPoolBackend(size_t threads) : stopping(false) {
+    workers.reserve(threads);
+    for (size_t i = 0; i < std::max<size_t>(threads, 1); i++) {
+      workers.emplace_back([this] { run(); });
+    }
+  }
+
+  ThreadPoolBackend::~ThreadPoolBackend() noexcept {
+    {
+      std::lock_guard lock(mutex);
+      stopping = true;
+    }
+
+    ready.notify_all();
+    for (auto &worker : workers) {
+      worker.join();
+    }
+  }
+
+  void ThreadPoolBackend::submit(std::span<IORequest> requests) {
+    {
+      std::lock_guard lock(mutex);
+      for (auto &request : requests) {
+        queue.push_back(std::move(request));
+      }
+    }
+
+    if (requests.size() == 1) {
+      ready.notify_one();
+    }
+
+    else {
+      ready.notify_all();
+    }
+  }
+
+  void ThreadPoolBackend::run() {
+    while (true) {
+      IORequest request;
+
+      {
+        std::unique_lock lock(mutex);
+        ready.wait(lock, [this] { return stopping || !queue.empty(); });
+
+        // Only exit once everything queued has been executed.
+        if (queue.empty()) {
+          return;
+        }
+
+        request = std::move(queue.front());
+        queue.pop_front();
+      }
+
+      const bool ok = execute(request);
+      if (request.callback) {
+        request.callback(ok);
+      }
+    }
+  }
+} // namespace pulse::storage
@@ -0,0 +1,289 @@
+/**
+ * @file src/storage/backends/uring_backend.cpp
+ * @brief Implements the io_uring I/O backend using the raw syscall interface.
+ */
+
+#include "pulsedb/storage/backends/uring_backend.hpp"
+
+#ifdef PULSEDB_HAVE_IO_URING
+
+#  include <algorithm>
+#  include <atomic>
+#  include <cerrno>
+#  include <cstring>
+#  include <linux/io_uring.h>
+#  include <stdexcept>
+#  include <sys/mman.h>
+#  include <sys/syscall.h>
+#  include <sys/uio.h>
+#  include <unistd.h>
+
+namespace pulse::storage {
+  namespace {
+    constexpr uint64_t SHUTDOWN = 0; /**< user_data of the sentinel that stops the reaper. */
+
+    /**
+     * @brief Load a ring index written by the kernel.
+     * @param ptr Pointer to the shared index.
+     * @return The index value.
+     */
+    uint32_t loadAcquire(uint32_t *ptr) noexcept {
+      return std::atomic_ref<uint32_t>(*ptr).load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Publish a ring index to the kernel.
+     * @param ptr Pointer to the shared index.
+     * @param value The new index value.
+     */
+    void storeRelease(uint32_t *ptr, uint32_t value) noexcept {
+      std::atomic_ref<uint32_t>(*ptr).store(value, std::memory_order_release);
+    }
+
+    int setup(uint32_t entries, io_uring_params *params) noexcept {
+      return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    int enterRing(int fd, uint32_t submit, uint32_t wait, uint32_t flags) noexcept {
+      return static_cast<int>(::syscall(__NR_io_uring_enter, fd, submit, wait, flags, nullptr, 0));
+    }
+  } // namespace
+
+  struct UringBackend::Pending {
+    IORequest request; /**< The original request. */
+    iovec iov;         /**< Remaining range of the buffer. */
+    uint32_t done;     /**< Bytes transferred so far. */
+  };
+
+  UringBackend::UringBackend(uint32_t queueDepth)
+      : ringFd(-1), sqRing(MAP_FAILED), sqes(static_cast<io_uring_sqe *>(MAP_FAILED)),
+        cqRing(MAP_FAILED), slots(0), logger("io-uring") {
+    io_uring_params params{};
+    ringFd = setup(std::max<uint32_t>(queueDepth, 1), &params);
+    if (ringFd < 0) {
+      throw std::runtime_error("io_uring is not available.");
+    }
+
+    sqCount = params.sq_entries;
+    cqCount = params.cq_entries;
+
+    sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+
+    // Newer kernels share a single mapping between both rings.
+    const bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single) {
+      sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+    }
+
+    sqRing = ::mmap(
+        nullptr,
+        sqRingSize,
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE,
+        ringFd,
+        IORING_OFF_SQ_RING
+    );
+
+    cqRing = single ? sqRing
+                    : ::mmap(
+                          nullptr,
+                          cqRingSize,
+                          PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE,
+                          ringFd,
+                          IORING_OFF_CQ_RING
+                      );
+
+    sqes = static_cast<io_uring_sqe *>(::mmap(
+        nullptr,
+        sqesSize,
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE,
+        ringFd,
+        IORING_OFF_SQES
+    ));
+
+    if (sqRing == MAP_FAILED || cqRing == MAP_FAILED || sqes == MAP_FAILED) {
+      if (sqes != MAP_FAILED) {
+        ::munmap(sqes, sqesSize);
+      }
+
+      if (cqRing != MAP_FAILED && cqRing != sqRing) {
+        ::munmap(cqRing, cqRingSize);
+      }
+
+      if (sqRing != MAP_FAILED) {
+        ::munmap(sqRing, sqRingSize);
+      }
+
+      ::close(ringFd);
+      throw std::runtime_error("Failed to map io_uring rings.");
+    }
+
+    auto *sq = static_cast<uint8_t *>(sqRing);
+    sqHead = reinterpret_cast<uint32_t *>(sq + params.sq_off.head);
+    sqTail = reinterpret_cast<uint32_t *>(sq + params.sq_off.tail);
+    sqMask = reinterpret_cast<uint32_t *>(sq + params.sq_off.ring_mask);
+    sqArray = reinterpret_cast<uint32_t *>(sq + params.sq_off.array);
+
+    auto *cq = static_cast<uint8_t *>(cqRing);
+    cqHead = reinterpret_cast<uint32_t *>(cq + params.cq_off.head);
+    cqTail = reinterpret_cast<uint32_t *>(cq + params.cq_off.tail);
+    cqMask = reinterpret_cast<uint32_t *>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+    // Never have more requests in flight than the completion ring can hold.
+    slots.release(cqCount);
+    reaper = std::thread([this] { reap(); });
+
+    logger.info("initialized io_uring with {} entries", sqCount);
+  }
+
+  UringBackend::~UringBackend() noexcept {
+    // Wait for every in-flight request to complete.
+    for (uint32_t i = 0; i < cqCount; i++) {
+      slots.acquire();
+    }
+
+    {
+      std::lock_guard lock(submitMutex);
+
+      const uint32_t tail = *sqTail;
+      const uint32_t index = tail & *sqMask;
+
+      io_uring_sqe *sqe = &sqes[index];
+      std::memset(sqe, 0, sizeof(io_uring_sqe));
+      sqe->opcode = IORING_OP_NOP;
+      sqe->user_data = SHUTDOWN;
+
+      sqArray[index] = index;
+      storeRelease(sqTail, tail + 1);
+      enter(1);
+    }
+
+    reaper.join();
+
+    ::munmap(sqes, sqesSize);
+    if (cqRing != sqRing) {
+      ::munmap(cqRing, cqRingSize);
+    }
+
+    ::munmap(sqRing, sqRingSize);
+    ::close(ringFd);
+  }
+
+  void UringBackend::submit(std::span<IORequest> requests) {
+    // Submit in chunks no larger than the submission ring.
+    for (size_t start = 0; start < requests.size(); start += sqCount) {
+      const auto count = static_cast<uint32_t>(std::min<size_t>(sqCount, requests.size() - start));
+
+      // Reserve completion slots before touching the ring so the reaper can always progress.
+      for (uint32_t i = 0; i < count; i++) {
+        slots.acquire();
+      }
+
+      std::lock_guard lock(submitMutex);
+      for (uint32_t i = 0; i < count; i++) {
+        auto &request = requests[start + i];
+        auto *pending = new Pending{std::move(request), {}, 0};
+        pending->iov = {pending->request.buffer, pending->request.size};
+
+        prepare(pending);
+      }
+
+      enter(count);
+    }
+  }
+
+  void UringBackend::prepare(Pending *pending) noexcept {
+    const uint32_t tail = *sqTail;
+    const uint32_t index = tail & *sqMask;
+
+    io_uring_sqe *sqe = &sqes[index];
+    std::memset(sqe, 0, sizeof(io_uring_sqe));
+
+    sqe->opcode = pending->request.op == IOOp::READ ? IORING_OP_READV : IORING_OP_WRITEV;
+    sqe->fd = pending->request.fd;
+    sqe->addr = reinterpret_cast<uint64_t>(&pending->iov);
+    sqe->len = 1;
+    sqe->off = pending->request.offset + pending->done;
+    sqe->user_data = reinterpret_cast<uint64_t>(pending);
+
+    sqArray[index] = index;
+    storeRelease(sqTail, tail + 1);
+  }
+
+  void UringBackend::enter(uint32_t count) noexcept {
+    while (count > 0) {
+      const int submitted = enterRing(ringFd, count, 0, 0);
+      if (submitted < 0) {
+        if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+          std::this_thread::yield();
+          continue;
+        }
+
+        // Entries stay on the ring and are picked up by the next enter.
+        PULSEDB_LOG_ERROR(logger, "io_uring_enter failed: {}", std::strerror(errno));
+        return;
+      }
+
+      count -= std::min<uint32_t>(count, submitted);
+    }
+  }
+
+  void UringBackend::reap() {
+    bool running = true;
+
+    while (running) {
+      uint32_t head = *cqHead;
+      const uint32_t tail = loadAcquire(cqTail);
+
+      if (head == tail) {
+        enterRing(ringFd, 0, 1, IORING_ENTER_GETEVENTS);
+        continue;
+      }
+
+      for (; head != tail; head++) {
+        const io_uring_cqe &cqe = cqes[head & *cqMask];
+        if (cqe.user_data == SHUTDOWN) {
+          running = false;
+          continue;
+        }
+
+        auto *pending = reinterpret_cast<Pending *>(cqe.user_data);
+        const int result = cqe.res;
+
+        // Retry interrupted requests and continue short transfers from where they stopped.
+        if (result == -EINTR || result == -EAGAIN ||
+            (result > 0 && pending->done + result < pending->request.size)) {
+          if (result > 0) {
+            pending->done += result;
+            pending->iov = {
+                static_cast<uint8_t *>(pending->request.buffer) + pending->done,
+                pending->request.size - pending->done
+            };
+          }
+
+          std::lock_guard lock(submitMutex);
+          prepare(pending);
+          enter(1);
+          continue;
+        }
+
+        const bool ok = result > 0 && pending->done + result == pending->request.size;
+        if (pending->request.callback) {
+          pending->request.callback(ok);
+        }
+
+        delete pending;
+        slots.release();
+      }
+
+      storeRelease(cqHead, head);
+    }
+  }
+} // namespace pulse::storage
+
+#endif // PULSEDB_HAVE_IO_URING
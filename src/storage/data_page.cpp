@@ -4,11 +4,19 @@
  */
 
 #include "pulsedb/storage/data_page.hpp"
+#include <algorithm>
+#include <array>
 #include <cstring>
-#include <vector>
 
 namespace pulse::storage {
-  DataPage::DataPage(uint32_t pageId) noexcept : Page(pageId, PageType::DATA) {
+  DataPage::DataPage(uint32_t pageId) noexcept : Page(pageId, PageType::DATA) { format(); }
+
+  DataPage::DataPage(uint8_t *buffer, uint32_t pageId) noexcept
+      : Page(buffer, pageId, PageType::DATA) {
+    format();
+  }
+
+  void DataPage::format() noexcept {
     // Initialize the header.
     auto *header = dataHeader();
     header->freeSpaceOffset = PAGE_SIZE;
@@ -18,6 +26,7 @@ namespace pulse::storage {
     header->firstFreeSlot = INVALID_SLOT;
 
     header->slotCount = 0;
+    header->deadBytes = 0;
   }
 
   std::optional<uint16_t>
@@ -26,6 +35,11 @@ namespace pulse::storage {
     const uint16_t recordSpace = spaceNeeded(length);
     const uint16_t totalSpace = recordSpace + DataPage::PAIR_SIZE;
 
+    // Deleted records hold room that only compaction gives back.
+    if (!hasSpace(totalSpace) && dataHeader()->deadBytes > 0) {
+      compact();
+    }
+
     // Check if there's enough space for both record and directory entry.
     if (!hasSpace(totalSpace)) {
       return std::nullopt;
@@ -45,7 +59,7 @@ namespace pulse::storage {
     // Allocate space for the record.
     auto offset = allocateSpace(length + RECORD_HEADER_SIZE);
     if (!offset) {
-      removeLastPair(); // Rollback if allocation failed.
+      removePair(*slotId); // Rollback if allocation failed.
       return std::nullopt;
     }
 
@@ -69,6 +83,72 @@ namespace pulse::storage {
     return slotId;
   }
 
+  size_t DataPage::insertRecords(std::span<const BulkRecord> records) {
+    auto *header = dataHeader();
+    const bool sorted =
+        std::is_sorted(records.begin(), records.end(), [](const auto &a, const auto &b) {
+          return a.key < b.key;
+        });
+
+    if (header->slotCount > 0 || header->directoryCount > 0 || !sorted) {
+      size_t count = 0;
+      while (count < records.size()) {
+        const auto &record = records[count];
+        if (!insertRecord(record.key, record.data, record.length, record.type)) {
+          break;
+        }
+
+        count++;
+      }
+
+      return count;
+    }
+
+    // Take records while the directory and slots stay below the record data.
+    size_t count = 0;
+    uint32_t tableEnd = DATA_HEADER_SIZE;
+    uint32_t dataStart = PAGE_SIZE;
+
+    while (count < records.size()) {
+      const uint32_t size = RECORD_HEADER_SIZE + records[count].length;
+      if (tableEnd + PAIR_SIZE + SLOT_SIZE + size >= dataStart) {
+        break;
+      }
+
+      tableEnd += PAIR_SIZE + SLOT_SIZE;
+      dataStart -= size;
+      count++;
+    }
+
+    // The slot array starts after the final directory, so size it first.
+    header->directoryCount = count;
+    header->slotCount = count;
+
+    auto *dir = slotsDirectory();
+    auto *slotArray = slots();
+    PageOffset offset = PAGE_SIZE;
+
+    for (size_t i = 0; i < count; i++) {
+      const auto &record = records[i];
+      const uint16_t size = RECORD_HEADER_SIZE + record.length;
+      offset -= size;
+
+      auto *recordHeader = reinterpret_cast<RecordHeader *>(data + offset);
+      recordHeader->length = record.length;
+      recordHeader->type = record.type;
+      std::memcpy(data + offset + RECORD_HEADER_SIZE, record.data, record.length);
+
+      dir[i] = {record.key, static_cast<uint16_t>(i)};
+      slotArray[i] = {static_cast<uint16_t>(offset), size, SlotFlags::NONE};
+    }
+
+    header->freeSpaceOffset = offset;
+    header->freeSpace -= (tableEnd - DATA_HEADER_SIZE) + (PAGE_SIZE - dataStart);
+    header->itemCount += count;
+
+    return count;
+  }
+
   bool DataPage::deleteRecord(uint16_t slotId) {
     if (slotId >= dataHeader()->slotCount) {
       return false;
@@ -85,8 +165,14 @@ namespace pulse::storage {
     slot.offset = dataHeader()->firstFreeSlot;
 
     dataHeader()->firstFreeSlot = slotId;
+    dataHeader()->deadBytes += slot.length;
     dataHeader()->itemCount--;
 
+    // Drop the key, otherwise it would find whatever record reuses the slot.
+    if (removePair(slotId)) {
+      dataHeader()->freeSpace += PAIR_SIZE;
+    }
+
     return true;
   }
 
@@ -145,67 +231,80 @@ namespace pulse::storage {
   }
 
   uint16_t DataPage::compact() {
-    uint16_t bytesFreed = 0;
-    uint16_t writeOffset = PAGE_SIZE;
+    auto *header = dataHeader();
+    auto *slotArray = slots();
 
-    uint16_t totalSpace = 0;
-    std::vector<uint8_t> tempData(PAGE_SIZE);
+    // Deleted slots at the end of the array go, the record data can grow into them.
+    while (header->slotCount > 0 &&
+           SlotFlags::isSet(slotArray[header->slotCount - 1].flags, SlotFlags::DELETED)) {
+      header->slotCount--;
+    }
 
-    for (uint16_t i = 0; i < dataHeader()->slotCount; i++) {
-      auto &slot = slots()[i];
-      if (!SlotFlags::isSet(slot.flags, SlotFlags::DELETED)) {
-        totalSpace += slot.length;
-        writeOffset -= slot.length;
+    // Order the live slots by offset, highest first. Moving the records up in that order never
+    // overwrites one that is still to be moved.
+    std::array<uint16_t, MAX_FREE_SPACE / SLOT_SIZE> order;
+    uint16_t live = 0;
 
-        std::memcpy(tempData.data() + writeOffset, data + slot.offset, slot.length);
-        slot.offset = writeOffset;
+    for (uint16_t i = 0; i < header->slotCount; i++) {
+      if (!SlotFlags::isSet(slotArray[i].flags, SlotFlags::DELETED)) {
+        order[live++] = i;
       }
     }
 
-    bytesFreed = dataHeader()->freeSpaceOffset - writeOffset;
+    std::sort(order.begin(), order.begin() + live, [slotArray](uint16_t a, uint16_t b) {
+      return slotArray[a].offset > slotArray[b].offset;
+    });
+
+    PageOffset writeOffset = PAGE_SIZE;
+    for (uint16_t i = 0; i < live; i++) {
+      auto &slot = slotArray[order[i]];
+      writeOffset -= slot.length;
 
-    // Only copy back if we actually freed space.
-    if (bytesFreed > 0) {
-      std::memcpy(data + writeOffset, tempData.data() + writeOffset, PAGE_SIZE - writeOffset);
-      dataHeader()->freeSpaceOffset = writeOffset;
-      dataHeader()->freeSpace += bytesFreed; // Update the page's free space counter.
+      if (writeOffset != slot.offset) {
+        std::memmove(data + writeOffset, data + slot.offset, slot.length);
+        slot.offset = static_cast<uint16_t>(writeOffset);
+      }
     }
 
+    header->freeSpaceOffset = writeOffset;
+    header->deadBytes = 0;
+
     // Rebuild the free slot list.
-    dataHeader()->firstFreeSlot = INVALID_SLOT;
+    header->firstFreeSlot = INVALID_SLOT;
     uint16_t lastFree = INVALID_SLOT;
 
-    for (uint16_t i = 0; i < dataHeader()->slotCount; i++) {
-      if (SlotFlags::isSet(slots()[i].flags, SlotFlags::DELETED)) {
+    for (uint16_t i = 0; i < header->slotCount; i++) {
+      if (SlotFlags::isSet(slotArray[i].flags, SlotFlags::DELETED)) {
         if (lastFree == INVALID_SLOT) {
-          dataHeader()->firstFreeSlot = i;
+          header->firstFreeSlot = i;
         }
 
         else {
-          slots()[lastFree].offset = i;
+          slotArray[lastFree].offset = i;
         }
 
         lastFree = i;
       }
     }
 
+    if (lastFree != INVALID_SLOT) {
+      slotArray[lastFree].offset = INVALID_SLOT;
+    }
+
+    // Count the free space again, slots reused by inserts were charged as new ones.
+    const uint16_t freeSpace = writeOffset - slotsEnd();
+    const uint16_t bytesFreed = freeSpace - header->freeSpace;
+    header->freeSpace = freeSpace;
+
     return bytesFreed;
   }
 
   bool DataPage::needsCompact() const noexcept {
-    const uint16_t usedSpace = PAGE_SIZE - dataHeader()->freeSpace;
-    uint16_t actualData = itemCount() * RECORD_HEADER_SIZE;
+    const auto *header = dataHeader();
+    const uint32_t usedSpace = MAX_FREE_SPACE - header->freeSpace;
 
-    for (uint16_t i = 0; i < dataHeader()->slotCount; i++) {
-      const auto &slot = slots()[i];
-      if (!SlotFlags::isSet(slot.flags, SlotFlags::DELETED)) {
-        actualData += slot.length;
-      }
-    }
-
-    // Calculate if we can compact.
-    // Check if fragmentation is greater than 25%.
-    return usedSpace > 0 && (usedSpace - actualData) * 4 > usedSpace;
+    // Check if deleted records take more than 25% of the used space.
+    return header->deadBytes > 0 && header->deadBytes * 4u > usedSpace;
   }
 
   std::optional<uint16_t> DataPage::findFreeSlot() noexcept {
@@ -217,12 +316,8 @@ namespace pulse::storage {
       return slotId;
     }
 
-    // Calculate space needed for new slot.
-    const uint16_t slotsOffset = DATA_HEADER_SIZE + (dataHeader()->directoryCount * PAIR_SIZE);
-    const uint16_t newSlotOffset = slotsOffset + (dataHeader()->slotCount * SLOT_SIZE);
-
     // Check if we have space for new slot.
-    if (newSlotOffset + SLOT_SIZE >= dataHeader()->freeSpaceOffset) {
+    if (slotsEnd() + SLOT_SIZE >= dataHeader()->freeSpaceOffset) {
       return std::nullopt;
     }
 
@@ -230,29 +325,59 @@ namespace pulse::storage {
   }
 
   [[nodiscard]] std::optional<uint16_t> DataPage::getSlotId(uint32_t key) const {
-    // TODO: Implement a better search algorithm.
-    const auto *dir = slotsDirectory();
-    for (uint16_t i = 0; i < dataHeader()->directoryCount; i++) {
-      if (dir[i].key == key) {
-        return dir[i].slotId;
-      }
+    const uint16_t pos = findPair(key);
+    if (pos < dataHeader()->directoryCount && slotsDirectory()[pos].key == key) {
+      return slotsDirectory()[pos].slotId;
     }
 
     return std::nullopt;
   }
 
   bool DataPage::insertPair(uint32_t key, uint16_t slotId) {
-    // Check if we have space for new directory entry.
-    const uint16_t newDirOffset = DATA_HEADER_SIZE + (dataHeader()->directoryCount * PAIR_SIZE);
-    if (newDirOffset + PAIR_SIZE >= dataHeader()->freeSpaceOffset) {
+    // Check if we have space for new directory entry, the slot array moves up by one pair.
+    if (slotsEnd() + PAIR_SIZE >= dataHeader()->freeSpaceOffset) {
       return false;
     }
 
+    // Make room for the pair after any equal keys, so the oldest stays first.
+    auto *header = dataHeader();
+    auto *dir = slotsDirectory();
+    uint16_t pos = findPair(key);
+    while (pos < header->directoryCount && dir[pos].key == key) {
+      pos++;
+    }
+
+    auto *slotArray = reinterpret_cast<uint8_t *>(slots());
+    std::memmove(slotArray + PAIR_SIZE, slotArray, header->slotCount * SLOT_SIZE);
+    std::memmove(dir + pos + 1, dir + pos, (header->directoryCount - pos) * PAIR_SIZE);
+
     // Insert the new pair.
+    dir[pos].key = key;
+    dir[pos].slotId = slotId;
+    header->directoryCount++;
+
+    return true;
+  }
+
+  bool DataPage::removePair(uint16_t slotId) {
+    auto *header = dataHeader();
     auto *dir = slotsDirectory();
-    dir[dataHeader()->directoryCount].key = key;
-    dir[dataHeader()->directoryCount].slotId = slotId;
-    dataHeader()->directoryCount++;
+
+    uint16_t pos = 0;
+    while (pos < header->directoryCount && dir[pos].slotId != slotId) {
+      pos++;
+    }
+
+    if (pos == header->directoryCount) {
+      return false;
+    }
+
+    // Close the gap, then move the slot array down after the shrunk directory.
+    std::memmove(dir + pos, dir + pos + 1, (header->directoryCount - pos - 1) * PAIR_SIZE);
+
+    auto *slotArray = reinterpret_cast<uint8_t *>(slots());
+    std::memmove(slotArray - PAIR_SIZE, slotArray, header->slotCount * SLOT_SIZE);
+    header->directoryCount--;
 
     return true;
   }
@@ -260,16 +385,25 @@ namespace pulse::storage {
   std::optional<uint16_t> DataPage::allocateSpace(uint16_t size) noexcept {
     auto *header = dataHeader();
 
-    const uint16_t newOffset = header->freeSpaceOffset - size;
-    const uint16_t slotsEnd =
-        DATA_HEADER_SIZE + (header->directoryCount * PAIR_SIZE) + (header->slotCount * SLOT_SIZE);
-
     // Check if there is enough space.
-    if (newOffset < slotsEnd) {
+    const PageOffset newOffset = header->freeSpaceOffset - size;
+    if (size > header->freeSpaceOffset || newOffset < slotsEnd()) {
       return std::nullopt;
     }
 
+    // Record data always starts below the end of the page.
     header->freeSpaceOffset = newOffset;
-    return newOffset;
+    return static_cast<uint16_t>(newOffset);
+  }
+
+  uint16_t DataPage::findPair(uint32_t key) const noexcept {
+    const auto *dir = slotsDirectory();
+    const auto *end = dir + dataHeader()->directoryCount;
+
+    const auto *it = std::lower_bound(dir, end, key, [](const SlotPair &pair, uint32_t key) {
+      return pair.key < key;
+    });
+
+    return static_cast<uint16_t>(it - dir);
   }
 } // namespace pulse::storage
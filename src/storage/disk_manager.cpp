@@ -6,14 +6,65 @@
 #include "pulsedb/storage/disk_manager.hpp"
 #include "pulsedb/storage/data_page.hpp"
 #include "pulsedb/storage/index_page.hpp"
+#include <algorithm>
+#include <cerrno>
 #include <cstring>
-#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <tuple>
+#include <unistd.h>
 
 namespace fs = std::filesystem;
 
 namespace pulse::storage {
-  DiskManager::DiskManager(const fs::path &path, bool create)
-      : dirty(false), path(path), nextPageId(0), logger("disk-manager") {
+  static_assert(
+      FreeSpacePage::END == DiskManager::INVALID_PAGE_ID,
+      "The free space map chain ends at the invalid page ID"
+  );
+
+  void DiskStats::report(utils::PrometheusWriter &writer) const {
+    writer.counter("disk_pages_read_total", "Pages read from the database file.", pagesRead);
+    writer.counter(
+        "disk_pages_written_total", "Pages written to the database file.", pagesWritten
+    );
+    writer.counter("disk_read_bytes_total", "Bytes read from the database file.", bytesRead);
+    writer.counter(
+        "disk_written_bytes_total", "Bytes written to the database file.", bytesWritten
+    );
+    writer.counter("disk_syncs_total", "Syncs of the database file.", syncs);
+    writer.histogram("disk_read_seconds", "Time to read a page.", readLatency);
+    writer.histogram("disk_write_seconds", "Time to write a page or a batch.", writeLatency);
+  }
+
+  DiskManager::DiskManager(
+      const fs::path &path,
+      bool create,
+      AccessMode mode,
+      Compression compression,
+      const SegmentLayout &layout
+  )
+      : fd(-1), mode(mode), mapping(nullptr), mappingSize(0), dirty(false), header{},
+        path(path), nextPageId(0), reservedPages(0), logger("disk-manager"),
+        metrics(std::make_shared<Metrics>()) {
+    if (create && isReadOnly()) {
+      throw std::runtime_error("Cannot create a read-only database.");
+    }
+
+    if (create && !isCompressionAvailable(compression)) {
+      logger.error("{} compression is not available", compressionName(compression));
+      throw std::runtime_error("Compression is not available.");
+    }
+
+    // Compressed pages go wherever they fit in one file, they can't be split by page ID.
+    if (create && layout.pagesPerSegment > 0 && compression != Compression::NONE) {
+      logger.error("compressed databases can't be segmented");
+      throw std::runtime_error("Compressed databases can't be segmented.");
+    }
+
+    header.compression = compression;
+    header.segmentPages = layout.pagesPerSegment;
+
     if (!create && !std::filesystem::exists(path)) {
       throw std::runtime_error("Database file does not exist.");
     }
@@ -26,6 +77,33 @@ namespace pulse::storage {
     else {
       readHeader();
     }
+
+    // The header decides the segment size, the pages of an existing database stay where they are.
+    if (header.segmentPages > 0) {
+      openSegments(layout.directories, create);
+    }
+
+    // Pages of a read-only database come straight from the mapping, there is no I/O to submit.
+    if (isReadOnly()) {
+      mapFile();
+      return;
+    }
+
+    // Read-only databases never allocate, the rest read their free space map now that the
+    // segments it may live in are set up.
+    if (!create) {
+      readFreeSpaceMap();
+    }
+
+    // Every segment directory gets a queue, pages on different devices don't wait on each other.
+    const size_t devices = segments ? segments->deviceCount() : 1;
+    for (size_t i = 0; i < devices; i++) {
+      queues.push_back(IOBackend::create());
+    }
+
+    logger.info(
+        "using {} backend for asynchronous I/O on {} queues", queues.front()->name(), devices
+    );
   }
 
   DiskManager::~DiskManager() noexcept {
@@ -35,16 +113,28 @@ namespace pulse::storage {
         sync();
       }
     } catch (const std::exception &e) {
-      logger.error("error during destruction: {}", e.what());
+      PULSEDB_LOG_ERROR(logger, "error during destruction: {}", e.what());
     }
+
+    // Drain in-flight requests before the descriptors go away.
+    queues.clear();
+    close();
   }
 
   DiskManager::DiskManager(DiskManager &&other) noexcept
-      : dirty(other.dirty), header(other.header), path(std::move(other.path)),
-        freePages(std::move(other.freePages)), nextPageId(other.nextPageId),
-        logger(std::move(other.logger)) {
+      : fd(other.fd), mode(other.mode), mapping(other.mapping), mappingSize(other.mappingSize),
+        dirty(other.dirty), header(other.header), path(std::move(other.path)),
+        freeSpaceMap(std::move(other.freeSpaceMap)), nextPageId(other.nextPageId),
+        reservedPages(other.reservedPages),
+        logger(std::move(other.logger)), pageMap(std::move(other.pageMap)),
+        segments(std::move(other.segments)), queues(std::move(other.queues)),
+        metrics(other.metrics) {
+    other.fd = -1;
+    other.mapping = nullptr;
+    other.mappingSize = 0;
     other.dirty = false;
     other.nextPageId = 0;
+    other.reservedPages = 0;
   }
 
   DiskManager &DiskManager::operator=(DiskManager &&other) noexcept {
@@ -55,35 +145,58 @@ namespace pulse::storage {
         }
 
         catch (const std::exception &e) {
-          logger.error("error writing header during move: {}", e.what());
+          PULSEDB_LOG_ERROR(logger, "error writing header during move: {}", e.what());
         }
       }
 
+      // Release our own queues and descriptors before taking the other ones.
+      queues.clear();
+      close();
+
       // Move resources.
+      fd = other.fd;
+      mode = other.mode;
+      mapping = other.mapping;
+      mappingSize = other.mappingSize;
       dirty = other.dirty;
       header = other.header;
       path = std::move(other.path);
-      freePages = std::move(other.freePages);
+      freeSpaceMap = std::move(other.freeSpaceMap);
       nextPageId = other.nextPageId;
+      reservedPages = other.reservedPages;
+      pageMap = std::move(other.pageMap);
+      segments = std::move(other.segments);
+      queues = std::move(other.queues);
+      metrics = other.metrics;
 
+      other.fd = -1;
+      other.mapping = nullptr;
+      other.mappingSize = 0;
       other.dirty = false;
       other.nextPageId = 0;
+      other.reservedPages = 0;
     }
 
     return *this;
   }
 
   uint32_t DiskManager::allocatePage() {
+    if (!writable("allocate a page")) {
+      return INVALID_PAGE_ID;
+    }
+
+    std::lock_guard lock(mutex);
     uint32_t pageId;
 
-    if (!freePages.empty()) {
-      pageId = freePages.back();
-      freePages.pop_back();
+    if (auto freePage = freeSpaceMap.takeFree()) {
+      pageId = *freePage;
       logger.info("allocated page {} from the free list", pageId);
     }
 
     else {
       pageId = header.pageCount++;
+      freeSpaceMap.grow(header.pageCount);
+      reserve(header.pageCount);
       logger.info("allocated new page {}", pageId);
     }
 
@@ -91,143 +204,975 @@ namespace pulse::storage {
     return pageId;
   }
 
+  uint32_t DiskManager::allocateExtent(uint32_t count) {
+    if (!writable("allocate an extent")) {
+      return INVALID_PAGE_ID;
+    }
+
+    std::lock_guard lock(mutex);
+
+    // The run can't reach the invalid page ID, nor wrap around.
+    if (count == 0 || header.pageCount > INVALID_PAGE_ID - count) {
+      logger.error("cannot allocate an extent of {} pages", count);
+      return INVALID_PAGE_ID;
+    }
+
+    const uint32_t first = header.pageCount;
+    header.pageCount += count;
+    freeSpaceMap.grow(header.pageCount);
+    reserve(header.pageCount);
+
+    dirty = true;
+    logger.info("allocated pages {} to {}", first, header.pageCount - 1);
+    return first;
+  }
+
   bool DiskManager::deallocatePage(uint32_t pageId) {
+    if (!writable("deallocate a page")) {
+      return false;
+    }
+
+    std::lock_guard lock(mutex);
+
     // Check if the page ID is valid.
     if (pageId >= header.pageCount) {
       logger.error("cant deallocate invalid page ID: {}", pageId);
       return false;
     }
 
-    logger.info("deallocating page: {}", pageId);
-    freePages.push_back(pageId);
+    if (!freeSpaceMap.release(pageId)) {
+      logger.error("page {} is already free", pageId);
+      return false;
+    }
+
+    logger.info("deallocated page: {}", pageId);
+
+    if (isCompressed()) {
+      pageMap.release(pageId);
+    }
 
     dirty = true;
     return true;
   }
 
+  void DiskManager::extendTo(uint32_t count) {
+    if (!writable("extend the page count")) {
+      return;
+    }
+
+    std::lock_guard lock(mutex);
+
+    if (count > header.pageCount) {
+      logger.info("extending page count from {} to {}", header.pageCount, count);
+      header.pageCount = count;
+      freeSpaceMap.grow(count);
+      dirty = true;
+    }
+  }
+
+  std::optional<uint32_t> DiskManager::findPageWithSpace(size_t bytes) {
+    std::lock_guard lock(mutex);
+    return freeSpaceMap.find(bytes);
+  }
+
+  void DiskManager::setLastLsn(uint64_t lsn) {
+    if (!writable("record the last LSN")) {
+      return;
+    }
+
+    std::lock_guard lock(mutex);
+
+    header.lastLsn = lsn;
+    dirty = true;
+  }
+
   std::unique_ptr<Page> DiskManager::fetchPage(uint32_t pageId) {
-    if (pageId >= header.pageCount) {
+    if (isReadOnly() && !isCompressed()) {
+      return mappedPage(pageId);
+    }
+
+    if (pageId >= pageCount()) {
       logger.error("invalid page ID: {}", pageId);
       return nullptr;
     }
 
-    logger.info("fetching page: {}", pageId);
+    logger.debug("fetching page: {}", pageId);
+    const auto start = std::chrono::steady_clock::now();
 
-    auto offset = getOffset(pageId);
-    std::vector<uint8_t> buffer(Page::PAGE_SIZE);
+    // Read straight into an aligned page buffer, no intermediate copy.
+    Page raw(pageId, PageType::INVALID);
+    if (!readStored(pageId, raw.data)) {
+      logger.error("failed to read page: {}", pageId);
+      return nullptr;
+    }
+
+    metrics->pagesRead.add();
+    metrics->readLatency.since(start);
 
-    std::fstream file(path, std::ios::binary | std::ios::in);
-    if (!file) {
-      logger.error("failed to open database file");
+    auto page = materialize(raw);
+    if (!page) {
+      logger.error("invalid page type: {}", static_cast<int>(raw.type()));
       return nullptr;
     }
 
-    file.seekg(offset);
-    file.read(reinterpret_cast<char *>(buffer.data()), Page::PAGE_SIZE);
+    logger.debug("fetched page: {}, type: {}", pageId, static_cast<int>(page->type()));
+    return page;
+  }
 
-    if (!file || file.gcount() != Page::PAGE_SIZE) {
-      logger.error("failed to read page: {}", pageId);
+  std::future<std::unique_ptr<Page>> DiskManager::fetchPageAsync(uint32_t pageId) {
+    if (isReadOnly()) {
+      // Compressed pages can't be viewed in place, they are decompressed into pages of their own.
+      std::promise<std::unique_ptr<Page>> promise;
+      promise.set_value(isCompressed() ? fetchPage(pageId) : mappedPage(pageId));
+      return promise.get_future();
+    }
+
+    std::future<std::unique_ptr<Page>> future;
+    auto request = fetchRequest(pageId, future);
+
+    if (request.callback) {
+      queues[queueOf(pageId)]->submit({&request, 1});
+    }
+
+    return future;
+  }
+
+  std::vector<std::future<std::unique_ptr<Page>>>
+  DiskManager::fetchPagesAsync(std::span<const uint32_t> pageIds) {
+    std::vector<std::future<std::unique_ptr<Page>>> futures(pageIds.size());
+    if (isReadOnly()) {
+      for (size_t i = 0; i < pageIds.size(); i++) {
+        futures[i] = fetchPageAsync(pageIds[i]);
+      }
+
+      return futures;
+    }
+
+    std::vector<IORequest> requests;
+    std::vector<size_t> devices;
+
+    requests.reserve(pageIds.size());
+    devices.reserve(pageIds.size());
+
+    for (size_t i = 0; i < pageIds.size(); i++) {
+      auto request = fetchRequest(pageIds[i], futures[i]);
+      if (request.callback) {
+        requests.push_back(std::move(request));
+        devices.push_back(queueOf(pageIds[i]));
+      }
+    }
+
+    submit(requests, devices);
+    return futures;
+  }
+
+  std::future<bool> DiskManager::readPageAsync(uint32_t pageId, uint8_t *buffer) {
+    auto promise = std::make_shared<std::promise<bool>>();
+    auto future = promise->get_future();
+
+    // The page cache already holds the page, copying it out is all there is to do.
+    if (isReadOnly() && isCompressed()) {
+      const bool ok = pageId < pageCount() && readStored(pageId, buffer);
+      const PageType type = reinterpret_cast<const PageHeader *>(buffer)->type;
+
+      promise->set_value(ok && (type == PageType::DATA || type == PageType::INDEX));
+      return future;
+    }
+
+    if (isReadOnly()) {
+      const uint8_t *bytes = mapped(pageId);
+      if (bytes) {
+        std::memcpy(buffer, bytes, Page::PAGE_SIZE);
+      }
+
+      promise->set_value(bytes != nullptr);
+      return future;
+    }
+
+    auto request = readRequest(pageId, buffer, [promise](bool ok) { promise->set_value(ok); });
+    if (request.callback) {
+      queues[queueOf(pageId)]->submit({&request, 1});
+    }
+
+    return future;
+  }
+
+  size_t DiskManager::prefetch(std::span<const uint32_t> pageIds) {
+    const uint32_t count = pageCount();
+
+    // The file and extent of every page, compressed pages were placed wherever they fit.
+    std::vector<std::tuple<int, uint64_t, uint64_t>> extents;
+    extents.reserve(pageIds.size());
+
+    for (uint32_t pageId : pageIds) {
+      if (pageId >= count) {
+        continue;
+      }
+
+      if (!isCompressed()) {
+        if (auto location = where(pageId)) {
+          extents.emplace_back(location->fd, location->offset, Page::PAGE_SIZE);
+        }
+
+        continue;
+      }
+
+      if (auto location = locate(pageId)) {
+        extents.emplace_back(fd, location->offset, location->capacity);
+      }
+    }
+
+    std::sort(extents.begin(), extents.end());
+    extents.erase(std::unique(extents.begin(), extents.end()), extents.end());
+
+    size_t advised = 0;
+    for (size_t i = 0; i < extents.size();) {
+      // Gather the run of pages that follow each other on disk.
+      const auto [file, offset, size] = extents[i];
+      uint64_t length = size;
+
+      size_t end = i + 1;
+      while (end < extents.size() && std::get<0>(extents[end]) == file &&
+             std::get<1>(extents[end]) == offset + length) {
+        length += std::get<2>(extents[end]);
+        end++;
+      }
+
+      int result;
+      if (isReadOnly()) {
+        // The header puts pages off the system page boundaries, madvise wants them aligned.
+        const uint64_t start = offset / Page::PAGE_SIZE * Page::PAGE_SIZE;
+        result = ::madvise(mapping + start, offset + length - start, MADV_WILLNEED);
+      }
+
+      else {
+        result = ::posix_fadvise(
+            file, static_cast<off_t>(offset), static_cast<off_t>(length), POSIX_FADV_WILLNEED
+        );
+      }
+
+      if (result != 0) {
+        logger.debug("failed to prefetch {} bytes at offset {}", length, offset);
+      }
+
+      else {
+        advised += end - i;
+      }
+
+      i = end;
+    }
+
+    logger.debug("prefetched {} pages", advised);
+    return advised;
+  }
+
+  IORequest
+  DiskManager::readRequest(uint32_t pageId, uint8_t *buffer, std::function<void(bool)> done) {
+    if (pageId >= pageCount()) {
+      logger.error("invalid page ID: {}", pageId);
+      done(false);
+      return {};
+    }
+
+    // A compressed page is read into a slot buffer of its own and decoded once it arrives.
+    int file = fd;
+    uint64_t offset;
+    std::shared_ptr<std::vector<uint8_t>> slot;
+
+    if (isCompressed()) {
+      auto location = locate(pageId);
+      if (!location) {
+        logger.error("page {} was never written", pageId);
+        done(false);
+        return {};
+      }
+
+      offset = location->offset;
+      if (location->capacity != Page::PAGE_SIZE) {
+        slot = std::make_shared<std::vector<uint8_t>>(location->capacity);
+      }
+    }
+
+    else {
+      auto location = where(pageId);
+      if (!location) {
+        done(false);
+        return {};
+      }
+
+      file = location->fd;
+      offset = location->offset;
+    }
+
+    uint8_t *target = slot ? slot->data() : buffer;
+    const auto size = static_cast<uint32_t>(slot ? slot->size() : Page::PAGE_SIZE);
+
+    // The callback can outlive a move of this manager, so it keeps its own logger.
+    auto callback = [buffer,
+                     pageId,
+                     slot,
+                     size,
+                     compression = header.compression,
+                     done = std::move(done),
+                     logger = logger,
+                     metrics = metrics,
+                     start = std::chrono::steady_clock::now()](bool ok) {
+      // The backends only report success once every byte is in, failed reads count nothing.
+      if (!ok) {
+        logger.error("failed to read page: {}", pageId);
+        done(false);
+        return;
+      }
+
+      metrics->pagesRead.add();
+      metrics->bytesRead.add(size);
+      metrics->readLatency.since(start);
+
+      if (slot && !decode(compression, slot->data(), slot->size(), buffer)) {
+        logger.error("failed to decompress page: {}", pageId);
+        done(false);
+        return;
+      }
+
+      const PageType type = reinterpret_cast<const PageHeader *>(buffer)->type;
+      if (type != PageType::DATA && type != PageType::INDEX) {
+        logger.error("invalid page type: {}", static_cast<int>(type));
+        done(false);
+        return;
+      }
+
+      done(true);
+    };
+
+    return {IOOp::READ, file, target, size, offset, std::move(callback)};
+  }
+
+  IORequest
+  DiskManager::fetchRequest(uint32_t pageId, std::future<std::unique_ptr<Page>> &future) {
+    /**
+     * @struct Read
+     * @brief State shared between the submitter and the completion callback.
+     */
+    struct Read {
+      Page raw;                                    /**< Buffer the backend reads into. */
+      std::promise<std::unique_ptr<Page>> promise; /**< Fulfilled on completion. */
+    };
+
+    auto read = std::make_shared<Read>(Read{Page(pageId, PageType::INVALID), {}});
+    future = read->promise.get_future();
+
+    return readRequest(pageId, read->raw.data, [read](bool ok) {
+      read->promise.set_value(ok ? materialize(read->raw) : nullptr);
+    });
+  }
+
+  std::optional<SegmentLocation> DiskManager::where(uint32_t pageId) const {
+    if (!segments) {
+      return SegmentLocation{fd, getOffset(pageId)};
+    }
+
+    return segments->locate(pageId);
+  }
+
+  void DiskManager::submit(std::span<IORequest> requests, std::span<const size_t> devices) {
+    if (queues.size() == 1) {
+      queues.front()->submit(requests);
+      return;
+    }
+
+    // Each queue gets its share as one batch, so a backend that batches still does.
+    std::vector<std::vector<IORequest>> batches(queues.size());
+    for (size_t i = 0; i < requests.size(); i++) {
+      batches[devices[i]].push_back(std::move(requests[i]));
+    }
+
+    for (size_t device = 0; device < batches.size(); device++) {
+      if (!batches[device].empty()) {
+        queues[device]->submit(batches[device]);
+      }
+    }
+  }
+
+  void DiskManager::openSegments(const std::vector<fs::path> &directories, bool create) {
+    if (isReadOnly()) {
+      logger.error("segmented databases can't be mapped read-only");
+      close();
+      throw std::runtime_error("Segmented databases can't be mapped read-only.");
+    }
+
+    try {
+      segments = std::make_unique<SegmentSet>(path, header.segmentPages, directories, create);
+    }
+
+    catch (...) {
+      close();
+      throw;
+    }
+
+    logger.info(
+        "pages are in segments of {} pages on {} devices",
+        header.segmentPages,
+        segments->deviceCount()
+    );
+  }
+
+  std::optional<PageLocation> DiskManager::locate(uint32_t pageId) const {
+    std::lock_guard lock(mutex);
+    if (pageId >= header.pageCount) {
+      return std::nullopt;
+    }
+
+    return pageMap.find(pageId);
+  }
+
+  DiskManager::StoredPage DiskManager::store(const Page &page) {
+    StoredPage stored = encode(page);
+
+    std::lock_guard lock(mutex);
+    place(stored);
+    return stored;
+  }
+
+  DiskManager::StoredPage DiskManager::encode(const Page &page) const {
+    static constexpr size_t PREFIX = sizeof(uint32_t);
+    StoredPage stored{page.id(), 0, std::vector<uint8_t>(Page::PAGE_SIZE)};
+
+    // Keep the compressed page only if it saves at least a sector, the length goes in front.
+    const size_t limit = Page::PAGE_SIZE - PageMap::SECTOR_SIZE - PREFIX;
+    auto length = compressPage(header.compression, page.data, stored.bytes.data() + PREFIX, limit);
+
+    size_t bytes = Page::PAGE_SIZE;
+    if (length) {
+      const auto prefix = static_cast<uint32_t>(*length);
+      std::memcpy(stored.bytes.data(), &prefix, PREFIX);
+
+      bytes = PREFIX + *length;
+      stored.bytes.resize(PageMap::slotSize(bytes));
+      std::fill(stored.bytes.begin() + bytes, stored.bytes.end(), 0);
+    }
+
+    else {
+      std::memcpy(stored.bytes.data(), page.data, Page::PAGE_SIZE);
+    }
+
+    return stored;
+  }
+
+  void DiskManager::place(StoredPage &stored) {
+    // Compressed slots are whole sectors below a page, so their size tells the map what they hold.
+    stored.offset = pageMap.place(stored.pageId, stored.bytes.size()).offset;
+
+    // The moved slot is only found again once the map is written with the header.
+    if (pageMap.isDirty()) {
+      dirty = true;
+    }
+  }
+
+  void DiskManager::track(std::span<const Page *const> pages) {
+    std::lock_guard lock(mutex);
+
+    for (const Page *page : pages) {
+      freeSpaceMap.update(page->id(), page->type() == PageType::DATA ? page->freeSpace() : 0);
+    }
+
+    if (freeSpaceMap.isDirty()) {
+      dirty = true;
+    }
+  }
+
+  bool DiskManager::decode(
+      Compression compression, const uint8_t *slot, size_t capacity, uint8_t *buffer
+  ) noexcept {
+    if (capacity == Page::PAGE_SIZE) {
+      std::memcpy(buffer, slot, Page::PAGE_SIZE);
+      return true;
+    }
+
+    uint32_t length;
+    std::memcpy(&length, slot, sizeof(length));
+    if (length > capacity - sizeof(length)) {
+      return false;
+    }
+
+    return decompressPage(compression, slot + sizeof(length), length, buffer);
+  }
+
+  bool DiskManager::readStored(uint32_t pageId, uint8_t *buffer) const {
+    if (!isCompressed()) {
+      auto location = where(pageId);
+      return location && readAt(location->fd, buffer, Page::PAGE_SIZE, location->offset);
+    }
+
+    auto location = locate(pageId);
+    if (!location) {
+      logger.error("page {} was never written", pageId);
+      return false;
+    }
+
+    if (mapping) {
+      if (location->offset + location->capacity > mappingSize) {
+        logger.error("page {} lies past the end of the file", pageId);
+        return false;
+      }
+
+      return decode(header.compression, mapping + location->offset, location->capacity, buffer);
+    }
+
+    // Uncompressed pages need no decoding, they are read straight into the buffer.
+    if (location->capacity == Page::PAGE_SIZE) {
+      return readAt(fd, buffer, Page::PAGE_SIZE, location->offset);
+    }
+
+    std::vector<uint8_t> slot(location->capacity);
+    return readAt(fd, slot.data(), slot.size(), location->offset) &&
+           decode(header.compression, slot.data(), slot.size(), buffer);
+  }
+
+  bool DiskManager::writeMap() {
+    const std::vector<uint8_t> bytes = pageMap.serialize();
+    const uint64_t offset = pageMap.reserve(bytes.size());
+
+    // The map has to be durable before the header points at it.
+    if (!writeAt(fd, bytes.data(), bytes.size(), offset) || ::fdatasync(fd) != 0) {
+      logger.error("failed to write the page map");
+      return false;
+    }
+
+    if (header.mapLength > 0) {
+      pageMap.retire(header.mapOffset, header.mapLength);
+    }
+
+    header.mapOffset = offset;
+    header.mapLength = static_cast<uint32_t>(bytes.size());
+    dirty = true;
+
+    logger.info("wrote page map of {} bytes at offset {}", bytes.size(), offset);
+    return true;
+  }
+
+  bool DiskManager::writeFreeSpaceMap() {
+    // Map pages are pages too, the ones added have to be covered as well.
+    while (freeSpaceMap.mapPages().size() < freeSpaceMap.mapPagesNeeded()) {
+      freeSpaceMap.addMapPage(header.pageCount++);
+    }
+
+    for (const auto &page : freeSpaceMap.serialize()) {
+      bool ok;
+      if (isCompressed()) {
+        StoredPage stored = encode(*page);
+        place(stored);
+        ok = writeAt(fd, stored.bytes.data(), stored.bytes.size(), stored.offset);
+      }
+
+      else {
+        auto location = where(page->id());
+        ok = location && writeAt(location->fd, page->data, Page::PAGE_SIZE, location->offset);
+      }
+
+      if (!ok) {
+        logger.error("failed to write free space map page {}", page->id());
+        return false;
+      }
+    }
+
+    if (!freeSpaceMap.mapPages().empty()) {
+      header.freeSpaceMap = freeSpaceMap.mapPages().front();
+    }
+
+    freeSpaceMap.commit();
+    dirty = true;
+
+    logger.info("wrote free space map of {} pages", freeSpaceMap.mapPages().size());
+    return true;
+  }
+
+  void DiskManager::readFreeSpaceMap() {
+    Page raw(INVALID_PAGE_ID, PageType::INVALID);
+    uint32_t pageId = header.freeSpaceMap;
+
+    while (pageId != INVALID_PAGE_ID) {
+      // A sync that added map pages may not have made it to the header.
+      if (pageId >= header.pageCount) {
+        logger.warn("free space map page {} lies past the last page", pageId);
+        break;
+      }
+
+      FreeSpacePage page(VIEW, raw.data);
+      if (!readStored(pageId, raw.data) || page.id() != pageId || !freeSpaceMap.load(page)) {
+        logger.warn("failed to read free space map page {}", pageId);
+        break;
+      }
+
+      pageId = page.nextPage();
+    }
+
+    // Pages the map doesn't cover are in use, with no room known.
+    freeSpaceMap.grow(header.pageCount);
+    logger.info(
+        "read free space map of {} pages, {} pages are free",
+        freeSpaceMap.mapPages().size(),
+        freeSpaceMap.freeCount()
+    );
+  }
+
+  uint8_t *DiskManager::mapped(uint32_t pageId) const noexcept {
+    if (pageId >= pageCount()) {
+      logger.error("invalid page ID: {}", pageId);
       return nullptr;
     }
 
-    // Get page type from header.
-    auto type = static_cast<PageType>(buffer[0]);
+    uint8_t *bytes = mapping + getOffset(pageId);
+    const PageType type = reinterpret_cast<const PageHeader *>(bytes)->type;
+    if (type != PageType::DATA && type != PageType::INDEX) {
+      logger.error("invalid page type: {}", static_cast<int>(type));
+      return nullptr;
+    }
+
+    return bytes;
+  }
+
+  std::unique_ptr<Page> DiskManager::mappedPage(uint32_t pageId) const {
+    uint8_t *bytes = mapped(pageId);
+    if (!bytes) {
+      return nullptr;
+    }
+
+    if (reinterpret_cast<const PageHeader *>(bytes)->type == PageType::DATA) {
+      return std::make_unique<DataPage>(VIEW, bytes);
+    }
+
+    return std::make_unique<IndexPage>(VIEW, bytes);
+  }
+
+  bool DiskManager::writable(const char *operation) const noexcept {
+    if (isReadOnly()) {
+      logger.error("cannot {}, the database is read-only", operation);
+      return false;
+    }
+
+    return true;
+  }
+
+  std::unique_ptr<Page> DiskManager::materialize(Page &raw) {
     std::unique_ptr<Page> page;
 
-    switch (type) {
+    // Get page type from header.
+    switch (raw.type()) {
       case PageType::DATA: {
-        page = std::make_unique<DataPage>(pageId);
+        page = std::make_unique<DataPage>(raw.id());
         break;
       }
 
       case PageType::INDEX: {
-        const auto *indexHeader = reinterpret_cast<const IndexHeader *>(buffer.data());
-        page = std::make_unique<IndexPage>(pageId, indexHeader->isLeaf, indexHeader->level);
+        const auto *indexHeader = raw.header<IndexHeader>();
+        page = std::make_unique<IndexPage>(raw.id(), indexHeader->isLeaf, indexHeader->level);
         break;
       }
 
       default:
-        logger.error("invalid page type: {}", static_cast<int>(type));
         return nullptr;
     }
 
-    logger.info("fetched page: {}, type: {}", pageId, static_cast<int>(type));
-
-    // Copy the header and data portions.
-    std::memcpy(page->getData() - Page::HEADER_SIZE, buffer.data(), Page::HEADER_SIZE);
-    std::memcpy(page->getData(), buffer.data() + Page::HEADER_SIZE, Page::MAX_FREE_SPACE);
-
+    // Hand the buffer that was read over to the typed page.
+    std::swap(static_cast<Page &>(*page).data, raw.data);
     return page;
   }
 
   bool DiskManager::sync() {
     logger.info("syncing database");
 
+    std::lock_guard lock(mutex);
+    if (freeSpaceMap.isDirty() && !writeFreeSpaceMap()) {
+      return false;
+    }
+
+    // Map pages may have moved to new slots as well.
+    if (isCompressed() && pageMap.isDirty() && !writeMap()) {
+      return false;
+    }
+
+    // The header may point at map pages in the segments, they have to be durable first.
+    if (segments && !segments->sync()) {
+      return false;
+    }
+
     if (dirty && !writeHeader()) {
       return false;
     }
 
-    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
-    if (!file) {
-      logger.error("failed to open database file");
+    if (::fdatasync(fd) != 0) {
+      PULSEDB_LOG_ERROR(logger, "failed to sync database file: {}", std::strerror(errno));
       return false;
     }
 
-    file.flush();
-    dirty = false;
+    metrics->syncs.add();
+
+    // Slots given up are only reused once the header points at a map that doesn't have them.
+    if (isCompressed()) {
+      pageMap.commit();
+    }
 
+    dirty = false;
     return true;
   }
 
   bool DiskManager::flushPage(const Page &page) {
-    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
-    if (!file) {
-      logger.error("failed to open database file: {}", path.string());
+    if (!writable("write a page")) {
       return false;
     }
 
-    uint64_t offset = getOffset(page.id());
-    file.seekp(offset);
-    if (!file) {
-      logger.error("failed to seek to page {}", page.id());
+    const Page *pages[] = {&page};
+    track(pages);
+
+    const auto start = std::chrono::steady_clock::now();
+    if (isCompressed()) {
+      const StoredPage stored = store(page);
+      if (!writeAt(fd, stored.bytes.data(), stored.bytes.size(), stored.offset)) {
+        logger.error("failed to write page {}", page.id());
+        return false;
+      }
+
+      metrics->pagesWritten.add();
+      metrics->writeLatency.since(start);
+
+      logger.debug("flushed page {} in {} bytes", page.id(), stored.bytes.size());
+      return true;
+    }
+
+    auto location = where(page.id());
+    if (!location || !writeAt(location->fd, page.data, Page::PAGE_SIZE, location->offset)) {
+      logger.error("failed to write page {}", page.id());
       return false;
     }
 
-    file.write(
-        reinterpret_cast<const char *>(page.getData() - Page::HEADER_SIZE), Page::PAGE_SIZE
-    );
+    metrics->pagesWritten.add();
+    metrics->writeLatency.since(start);
 
-    if (!file) {
-      logger.error("failed to write page {}", page.id());
+    logger.debug("flushed page {}", page.id());
+    return true;
+  }
+
+  std::future<bool> DiskManager::flushPageAsync(const Page &page) {
+    const Page *pages[] = {&page};
+    auto futures = flushPagesAsync(pages);
+    return std::move(futures.front());
+  }
+
+  std::vector<std::future<bool>> DiskManager::flushPagesAsync(std::span<const Page *const> pages) {
+    std::vector<std::future<bool>> futures;
+    std::vector<IORequest> requests;
+    std::vector<size_t> devices;
+
+    futures.reserve(pages.size());
+    requests.reserve(pages.size());
+    devices.reserve(pages.size());
+
+    if (pages.empty()) {
+      return futures;
+    }
+
+    if (!writable("write pages")) {
+      for (size_t i = 0; i < pages.size(); i++) {
+        std::promise<bool> promise;
+        promise.set_value(false);
+        futures.push_back(promise.get_future());
+      }
+
+      return futures;
+    }
+
+    track(pages);
+    for (const Page *page : pages) {
+      auto promise = std::make_shared<std::promise<bool>>();
+      futures.push_back(promise->get_future());
+
+      // An encoded page lives in the callback until the write completes.
+      std::shared_ptr<StoredPage> stored;
+      SegmentLocation location{fd, 0};
+
+      if (isCompressed()) {
+        stored = std::make_shared<StoredPage>(store(*page));
+        location.offset = stored->offset;
+      }
+
+      else if (auto found = where(page->id())) {
+        location = *found;
+      }
+
+      else {
+        logger.error("failed to write page {}", page->id());
+        promise->set_value(false);
+        continue;
+      }
+
+      const auto size = static_cast<uint32_t>(stored ? stored->bytes.size() : Page::PAGE_SIZE);
+      auto callback = [promise,
+                       stored,
+                       size,
+                       pageId = page->id(),
+                       logger = logger,
+                       metrics = metrics,
+                       start = std::chrono::steady_clock::now()](bool ok) {
+        // As with reads, only a write that went out in full is counted.
+        if (!ok) {
+          logger.error("failed to write page {}", pageId);
+        }
+
+        else {
+          metrics->pagesWritten.add();
+          metrics->bytesWritten.add(size);
+          metrics->writeLatency.since(start);
+        }
+
+        promise->set_value(ok);
+      };
+
+      requests.push_back(
+          {IOOp::WRITE,
+           location.fd,
+           stored ? stored->bytes.data() : page->data,
+           size,
+           location.offset,
+           std::move(callback)}
+      );
+      devices.push_back(queueOf(page->id()));
+    }
+
+    submit(requests, devices);
+    return futures;
+  }
+
+  bool DiskManager::writePages(std::span<const Page *const> pages) {
+    if (!writable("write pages")) {
       return false;
     }
 
-    file.flush();
-    logger.info("flushed page {}", page.id());
+    track(pages);
+
+    const auto start = std::chrono::steady_clock::now();
+    if (isCompressed()) {
+      std::vector<StoredPage> stored;
+      stored.reserve(pages.size());
+
+      for (const Page *page : pages) {
+        stored.push_back(store(*page));
+      }
+
+      std::sort(stored.begin(), stored.end(), [](const StoredPage &a, const StoredPage &b) {
+        return a.offset < b.offset;
+      });
+
+      std::vector<uint8_t> run;
+      size_t writes = 0;
+
+      for (size_t i = 0; i < stored.size();) {
+        // Gather the run of slots that follow each other in the file.
+        run = stored[i].bytes;
+        size_t end = i + 1;
+
+        while (end < stored.size() && stored[end].offset == stored[i].offset + run.size()) {
+          run.insert(run.end(), stored[end].bytes.begin(), stored[end].bytes.end());
+          end++;
+        }
+
+        if (!writeAt(fd, run.data(), run.size(), stored[i].offset)) {
+          logger.error("failed to write {} pages at offset {}", end - i, stored[i].offset);
+          return false;
+        }
+
+        writes++;
+        i = end;
+      }
+
+      metrics->pagesWritten.add(stored.size());
+      metrics->writeLatency.since(start);
+
+      logger.info("wrote {} compressed pages in {} writes", stored.size(), writes);
+      return true;
+    }
+
+    std::vector<const Page *> sorted(pages.begin(), pages.end());
+    std::sort(sorted.begin(), sorted.end(), [](const Page *a, const Page *b) {
+      return a->id() < b->id();
+    });
+
+    std::vector<uint8_t> run;
+    size_t writes = 0;
+
+    for (size_t i = 0; i < sorted.size();) {
+      // Gather the run of pages that follow each other on disk.
+      size_t end = i + 1;
+      while (end < sorted.size() && adjacent(sorted[end - 1]->id(), sorted[end]->id())) {
+        end++;
+      }
+
+      run.resize((end - i) * Page::PAGE_SIZE);
+      for (size_t j = i; j < end; j++) {
+        std::memcpy(run.data() + (j - i) * Page::PAGE_SIZE, sorted[j]->data, Page::PAGE_SIZE);
+      }
+
+      auto location = where(sorted[i]->id());
+      if (!location || !writeAt(location->fd, run.data(), run.size(), location->offset)) {
+        logger.error("failed to write pages {} to {}", sorted[i]->id(), sorted[end - 1]->id());
+        return false;
+      }
+
+      writes++;
+      i = end;
+    }
+
+    metrics->pagesWritten.add(sorted.size());
+    metrics->writeLatency.since(start);
+
+    logger.info("wrote {} pages in {} writes", sorted.size(), writes);
     return true;
   }
 
-  uint64_t DiskManager::fileSize() const noexcept {
-    std::error_code error_code;
-    auto size = std::filesystem::file_size(path, error_code);
+  uint32_t DiskManager::pageCount() const noexcept {
+    std::lock_guard lock(mutex);
+    return header.pageCount;
+  }
+
+  uint32_t DiskManager::freePageCount() const noexcept {
+    std::lock_guard lock(mutex);
+    return freeSpaceMap.freeCount();
+  }
+
+  uint64_t DiskManager::lastLsn() const noexcept {
+    std::lock_guard lock(mutex);
+    return header.lastLsn;
+  }
+
+  DiskStats DiskManager::stats() const noexcept {
+    return {
+        metrics->pagesRead.value(),
+        metrics->pagesWritten.value(),
+        metrics->bytesRead.value(),
+        metrics->bytesWritten.value(),
+        metrics->syncs.value(),
+        metrics->readLatency.snapshot(),
+        metrics->writeLatency.snapshot(),
+    };
+  }
 
-    if (error_code) {
-      logger.error("failed to get file size: {}", error_code.message());
+  uint64_t DiskManager::fileSize() const noexcept {
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+      PULSEDB_LOG_ERROR(logger, "failed to get file size: {}", std::strerror(errno));
       return 0;
     }
 
-    return size;
+    return static_cast<uint64_t>(st.st_size) + (segments ? segments->size() : 0);
   }
 
   void DiskManager::readHeader() {
-    std::fstream file(path, std::ios::binary | std::ios::in);
-    if (!file) {
-      logger.error("failed to open database file");
+    fd = ::open(path.c_str(), (isReadOnly() ? O_RDONLY : O_RDWR) | O_CLOEXEC);
+    if (fd < 0) {
+      PULSEDB_LOG_ERROR(logger, "failed to open database file: {}", std::strerror(errno));
       throw std::runtime_error("Failed to open database file.");
     }
 
-    file.read(reinterpret_cast<char *>(&header), sizeof(DatabaseHeader));
-    if (!file || file.gcount() != sizeof(DatabaseHeader)) {
+    if (!readAt(fd, &header, sizeof(DatabaseHeader), 0)) {
       logger.error("failed to read header");
       throw std::runtime_error("Failed to read header.");
     }
@@ -243,35 +1188,76 @@ namespace pulse::storage {
     }
 
     if (header.pageSize != Page::PAGE_SIZE) {
-      logger.error("invalid page size: expected {}, got {}", Page::PAGE_SIZE, header.pageSize);
+      const uint32_t expected = Page::PAGE_SIZE;
+      logger.error("invalid page size: expected {}, got {}", expected, header.pageSize);
       throw std::runtime_error("Invalid page size.");
     }
 
+    if (!isCompressionAvailable(header.compression)) {
+      logger.error("{} compression is not available", compressionName(header.compression));
+      throw std::runtime_error("Compression is not available.");
+    }
+
+    if (isCompressed() && header.mapLength > 0) {
+      std::vector<uint8_t> bytes(header.mapLength);
+      if (!readAt(fd, bytes.data(), bytes.size(), header.mapOffset) ||
+          !pageMap.load(bytes, header.mapOffset)) {
+        logger.error("failed to read the page map");
+        throw std::runtime_error("Failed to read the page map.");
+      }
+    }
+
+    // What's there was reserved when it was allocated, or is already written.
+    reservedPages = header.pageCount;
     logger.info("header read successfully");
   }
 
-  bool DiskManager::writeHeader() {
-    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
-    if (!file) {
-      logger.error("failed to open database file");
-      return false;
+  void DiskManager::mapFile() {
+    const uint64_t size = fileSize();
+
+    // Pages allocated but never written lie past the end of the file, they can't be read.
+    const auto available =
+        static_cast<uint32_t>((size - sizeof(DatabaseHeader)) / Page::PAGE_SIZE);
+    if (!isCompressed() && available < header.pageCount) {
+      logger.warn("only {} of {} pages were written", available, header.pageCount);
+      header.pageCount = available;
     }
 
-    file.seekp(0);
-    file.write(reinterpret_cast<const char *>(&header), sizeof(DatabaseHeader));
+    int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    // Fault the whole file in up front, so fetches never wait on the disk.
+    flags |= MAP_POPULATE;
+#endif
+
+    void *memory = ::mmap(nullptr, size, PROT_READ, flags, fd, 0);
+    if (memory == MAP_FAILED) {
+      PULSEDB_LOG_ERROR(logger, "failed to map database file: {}", std::strerror(errno));
+      close();
+      throw std::runtime_error("Failed to map database file.");
+    }
 
-    if (!file) {
+    // Traversals jump around the file, readahead after a page is reclaimed would be wasted.
+    if (::madvise(memory, size, MADV_RANDOM) != 0) {
+      PULSEDB_LOG_DEBUG(logger, "failed to advise mapping: {}", std::strerror(errno));
+    }
+
+    mapping = static_cast<uint8_t *>(memory);
+    mappingSize = size;
+    logger.info("mapped {} pages read-only", header.pageCount);
+  }
+
+  bool DiskManager::writeHeader() {
+    if (!writeAt(fd, &header, sizeof(DatabaseHeader), 0)) {
       logger.error("failed to write header");
       return false;
     }
 
-    file.flush();
     return true;
   }
 
   void DiskManager::initializeDatabase() {
-    std::ofstream file(path, std::ios::binary);
-    if (!file) {
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
       throw std::runtime_error("Failed to create database file.");
     }
 
@@ -280,13 +1266,101 @@ namespace pulse::storage {
     header.version = DB_VERSION;
     header.pageSize = Page::PAGE_SIZE;
     header.pageCount = 0;
-    header.firstFreePage = INVALID_PAGE_ID;
+    header.freeSpaceMap = INVALID_PAGE_ID;
     header.lastLsn = 0;
 
     if (!writeHeader()) {
       throw std::runtime_error("Failed to write initial database header.");
     }
 
-    logger.info("initialized new database at {}", path.string());
+    PULSEDB_LOG_INFO(logger, "initialized new database at {}", path.string());
+  }
+
+  void DiskManager::reserve(uint32_t count) noexcept {
+    if (count <= reservedPages || isCompressed() || segments) {
+      return;
+    }
+
+    // Reserve up to the next extent boundary, so allocating page by page reserves once per extent.
+    const uint64_t target = (static_cast<uint64_t>(count) + EXTENT_PAGES - 1) / EXTENT_PAGES *
+                            EXTENT_PAGES;
+    const uint64_t offset = getOffset(reservedPages);
+    const uint64_t length = (target - reservedPages) * Page::PAGE_SIZE;
+
+    // Unwritten pages still lie past the end of the file, reading one keeps failing.
+    const int result = ::fallocate(
+        fd, FALLOC_FL_KEEP_SIZE, static_cast<off_t>(offset), static_cast<off_t>(length)
+    );
+
+    if (result != 0) {
+      PULSEDB_LOG_DEBUG(
+          logger, "failed to reserve pages up to {}: {}", target, std::strerror(errno)
+      );
+    }
+
+    reservedPages = static_cast<uint32_t>(std::min<uint64_t>(target, INVALID_PAGE_ID));
+  }
+
+  bool
+  DiskManager::readAt(int file, void *buffer, size_t size, uint64_t offset) const noexcept {
+    auto *out = static_cast<uint8_t *>(buffer);
+    const size_t total = size;
+
+    while (size > 0) {
+      const ssize_t n = ::pread(file, out, size, static_cast<off_t>(offset));
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+
+      // Error or EOF before the full range was read.
+      if (n <= 0) {
+        return false;
+      }
+
+      out += n;
+      size -= n;
+      offset += n;
+    }
+
+    // Counted once the whole range is in, like the asynchronous reads.
+    metrics->bytesRead.add(total);
+    return true;
+  }
+
+  bool DiskManager::writeAt(int file, const void *buffer, size_t size, uint64_t offset) noexcept {
+    const auto *in = static_cast<const uint8_t *>(buffer);
+    const size_t total = size;
+
+    while (size > 0) {
+      const ssize_t n = ::pwrite(file, in, size, static_cast<off_t>(offset));
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+
+      if (n <= 0) {
+        return false;
+      }
+
+      in += n;
+      size -= n;
+      offset += n;
+    }
+
+    metrics->bytesWritten.add(total);
+    return true;
+  }
+
+  void DiskManager::close() noexcept {
+    if (mapping) {
+      ::munmap(mapping, mappingSize);
+      mapping = nullptr;
+      mappingSize = 0;
+    }
+
+    segments.reset();
+    if (fd >= 0) {
+      ::close(fd);
+      fd = -1;
+    }
   }
 } // namespace pulse::storage
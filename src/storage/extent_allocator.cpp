@@ -0,0 +1,56 @@
+/**
+ * @file src/storage/extent_allocator.cpp
+ * @brief Implements the extent allocator class.
+ */
+
+#include "pulsedb/storage/extent_allocator.hpp"
+#include <algorithm>
+
+namespace pulse::storage {
+  ExtentAllocator::ExtentAllocator(DiskManager &diskManager, uint32_t extentPages) noexcept
+      : diskManager(diskManager), extentPages(std::max<uint32_t>(extentPages, 1)), next(0),
+        end(0), logger("extent-allocator") {}
+
+  ExtentAllocator::~ExtentAllocator() noexcept {
+    try {
+      release();
+    } catch (const std::exception &e) {
+      PULSEDB_LOG_ERROR(logger, "error during destruction: {}", e.what());
+    }
+  }
+
+  uint32_t ExtentAllocator::allocate() {
+    std::lock_guard lock(mutex);
+
+    if (next == end) {
+      const uint32_t first = diskManager.allocateExtent(extentPages);
+      if (first == DiskManager::INVALID_PAGE_ID) {
+        logger.error("failed to allocate an extent of {} pages", extentPages);
+        return DiskManager::INVALID_PAGE_ID;
+      }
+
+      next = first;
+      end = first + extentPages;
+    }
+
+    return next++;
+  }
+
+  void ExtentAllocator::release() {
+    std::lock_guard lock(mutex);
+
+    if (next < end) {
+      logger.debug("releasing pages {} to {}", next, end - 1);
+    }
+
+    // The pages were never written, they can go straight on the free list.
+    for (; next < end; next++) {
+      diskManager.deallocatePage(next);
+    }
+  }
+
+  uint32_t ExtentAllocator::remaining() const {
+    std::lock_guard lock(mutex);
+    return end - next;
+  }
+} // namespace pulse::storage
@@ -0,0 +1,187 @@
+/**
+ * @file src/storage/free_space_map.cpp
+ * @brief Implements the free space map class.
+ */
+
+#include "pulsedb/storage/free_space_map.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace pulse::storage {
+  FreeSpacePage::FreeSpacePage(uint32_t pageId, uint32_t firstPage) noexcept
+      : Page(pageId, PageType::SPECIAL) {
+    auto *header = this->header<FreeSpaceHeader>();
+    header->firstPage = firstPage;
+    header->nextPage = END;
+    header->freeSpace = 0;
+    header->itemCount = 0;
+  }
+
+  void FreeSpacePage::setEntries(std::span<const uint8_t> entries) noexcept {
+    const size_t count = std::min<size_t>(entries.size(), CAPACITY);
+    std::memcpy(data + FREE_SPACE_HEADER_SIZE, entries.data(), count);
+    header()->itemCount = static_cast<uint16_t>(count);
+  }
+
+  FreeSpaceMap::FreeSpaceMap() noexcept : queued(0), freeTotal(0), dirty(false) {}
+
+  void FreeSpaceMap::grow(uint32_t pageCount) {
+    if (pageCount > categories.size()) {
+      categories.resize(pageCount, 0);
+    }
+  }
+
+  void FreeSpaceMap::update(uint32_t pageId, size_t freeBytes) {
+    if (pageId >= categories.size()) {
+      return;
+    }
+
+    // A page that is written again is in use, whatever the free list says.
+    if (categories[pageId] == FREE) {
+      freeTotal--;
+    }
+
+    set(pageId, categoryOf(freeBytes));
+  }
+
+  std::optional<uint32_t> FreeSpaceMap::find(size_t bytes) {
+    const size_t needed = std::max<size_t>(1, (bytes + CATEGORY_SIZE - 1) / CATEGORY_SIZE);
+
+    // The fullest pages that fit come first, so the emptier ones stay whole for larger records.
+    for (size_t category = needed; category < FREE; category++) {
+      auto &pages = candidates[category];
+
+      while (!pages.empty()) {
+        const uint32_t pageId = pages.back();
+        if (categories[pageId] == category) {
+          return pageId;
+        }
+
+        pages.pop_back();
+        queued--;
+      }
+    }
+
+    return std::nullopt;
+  }
+
+  bool FreeSpaceMap::release(uint32_t pageId) {
+    if (pageId >= categories.size() || categories[pageId] == FREE) {
+      return false;
+    }
+
+    freeTotal++;
+    set(pageId, FREE);
+    return true;
+  }
+
+  std::optional<uint32_t> FreeSpaceMap::takeFree() {
+    while (!freePages.empty()) {
+      const uint32_t pageId = freePages.back();
+      freePages.pop_back();
+      queued--;
+
+      if (categories[pageId] == FREE) {
+        freeTotal--;
+        set(pageId, 0);
+        return pageId;
+      }
+    }
+
+    return std::nullopt;
+  }
+
+  void FreeSpaceMap::addMapPage(uint32_t pageId) {
+    grow(pageId + 1);
+    update(pageId, 0);
+
+    mapPageIds.push_back(pageId);
+    dirty = true;
+  }
+
+  std::vector<std::unique_ptr<FreeSpacePage>> FreeSpaceMap::serialize() const {
+    std::vector<std::unique_ptr<FreeSpacePage>> pages;
+    pages.reserve(mapPageIds.size());
+
+    for (size_t i = 0; i < mapPageIds.size(); i++) {
+      const size_t first = std::min(i * FreeSpacePage::CAPACITY, categories.size());
+      const size_t count = std::min<size_t>(FreeSpacePage::CAPACITY, categories.size() - first);
+
+      auto page = std::make_unique<FreeSpacePage>(mapPageIds[i], static_cast<uint32_t>(first));
+      page->setEntries(std::span(categories).subspan(first, count));
+
+      if (i + 1 < mapPageIds.size()) {
+        page->setNextPage(mapPageIds[i + 1]);
+      }
+
+      pages.push_back(std::move(page));
+    }
+
+    return pages;
+  }
+
+  bool FreeSpaceMap::load(const FreeSpacePage &page) {
+    if (page.type() != PageType::SPECIAL || page.firstPage() != categories.size() ||
+        page.itemCount() > FreeSpacePage::CAPACITY) {
+      return false;
+    }
+
+    const auto entries = page.entries();
+    categories.insert(categories.end(), entries.begin(), entries.end());
+    mapPageIds.push_back(page.id());
+
+    for (uint32_t pageId = page.firstPage(); pageId < categories.size(); pageId++) {
+      freeTotal += categories[pageId] == FREE;
+      enqueue(pageId);
+    }
+
+    return true;
+  }
+
+  uint8_t FreeSpaceMap::categoryOf(size_t freeBytes) noexcept {
+    return static_cast<uint8_t>(std::min<size_t>(freeBytes / CATEGORY_SIZE, FREE - 1));
+  }
+
+  void FreeSpaceMap::set(uint32_t pageId, uint8_t value) {
+    if (categories[pageId] == value) {
+      return;
+    }
+
+    categories[pageId] = value;
+    dirty = true;
+    enqueue(pageId);
+
+    // Pages that change category often leave many stale entries behind, drop them all at once.
+    if (queued > 2 * categories.size() + FreeSpacePage::CAPACITY) {
+      rebuild();
+    }
+  }
+
+  void FreeSpaceMap::enqueue(uint32_t pageId) {
+    const uint8_t value = categories[pageId];
+
+    // Category 0 pages are never candidates, the entries they leave behind are skipped.
+    if (value == FREE) {
+      freePages.push_back(pageId);
+      queued++;
+    }
+
+    else if (value > 0) {
+      candidates[value].push_back(pageId);
+      queued++;
+    }
+  }
+
+  void FreeSpaceMap::rebuild() {
+    for (auto &pages : candidates) {
+      pages.clear();
+    }
+
+    freePages.clear();
+    queued = 0;
+
+    for (uint32_t pageId = 0; pageId < categories.size(); pageId++) {
+      enqueue(pageId);
+    }
+  }
+} // namespace pulse::storage
@@ -7,9 +7,52 @@
 #include <algorithm>
 #include <cstring>
 
+#if defined(__SANITIZE_THREAD__)
+#define PULSEDB_TSAN 1
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define PULSEDB_TSAN 1
+#endif
+#endif
+
+#ifdef PULSEDB_TSAN
+extern "C" void AnnotateIgnoreReadsBegin(const char *file, int line);
+extern "C" void AnnotateIgnoreReadsEnd(const char *file, int line);
+#endif
+
+namespace {
+  /**
+   * @struct RacyReads
+   * @brief Tells ThreadSanitizer that the reads of a probe race with writers on purpose.
+   * @note The reads are validated against the frame's version, a race only makes them retry.
+   */
+  struct RacyReads {
+    RacyReads() noexcept {
+#ifdef PULSEDB_TSAN
+      AnnotateIgnoreReadsBegin(__FILE__, __LINE__);
+#endif
+    }
+
+    ~RacyReads() noexcept {
+#ifdef PULSEDB_TSAN
+      AnnotateIgnoreReadsEnd(__FILE__, __LINE__);
+#endif
+    }
+  };
+} // namespace
+
 namespace pulse::storage {
   IndexPage::IndexPage(uint32_t pageId, bool isLeaf, uint16_t level) noexcept
       : Page(pageId, PageType::INDEX) {
+    format(isLeaf, level);
+  }
+
+  IndexPage::IndexPage(uint8_t *buffer, uint32_t pageId, bool isLeaf, uint16_t level) noexcept
+      : Page(buffer, pageId, PageType::INDEX) {
+    format(isLeaf, level);
+  }
+
+  void IndexPage::format(bool isLeaf, uint16_t level) noexcept {
     // Initialize the header.
     auto *header = indexHeader();
     header->isLeaf = isLeaf;
@@ -19,22 +62,24 @@ namespace pulse::storage {
     header->prevPageId = 0;
     header->parentId = 0;
 
+    // The first insert sets the frame of reference.
+    header->baseKey = 0;
+    header->basePageId = 0;
+    header->keyWidth = 1;
+    header->pageIdWidth = 1;
+
     // Update free space to account for extended header size.
-    header->freeSpace = MAX_FREE_SPACE;
+    updateFreeSpace();
   }
 
   std::optional<uint32_t> IndexPage::lookup(uint64_t key) const noexcept {
-    // Binary search for key.
-    const IndexEntry *begin = entries();
-    const IndexEntry *end = begin + itemCount();
-
-    auto it = std::lower_bound(begin, end, key, [](const IndexEntry &entry, uint64_t key) {
-      return entry.key < key;
-    });
+    // Search the key array for the key.
+    const size_t count = itemCount();
+    const size_t pos = findPosition(key);
 
     // If key is found, return pageId.
-    if (it != end && it->key == key) {
-      return it->pageId;
+    if (pos != count && keyAt(pos) == key) {
+      return pageIdAt(pos);
     }
 
     // If this is a leaf, key not found.
@@ -43,58 +88,98 @@ namespace pulse::storage {
     }
 
     // If internal node, return pageId of child that could contain key.
-    if (it == begin) {
-      return begin->pageId;
+    if (pos == 0) {
+      return pageIdAt(0);
+    }
+
+    return pageIdAt(pos - 1);
+  }
+
+  std::optional<IndexPage::Probe> IndexPage::probe(const uint8_t *buffer, uint64_t key) noexcept {
+    const RacyReads racy;
+
+    // Take the header once, a writer can change it between any two reads.
+    IndexHeader header;
+    std::memcpy(&header, buffer, sizeof(header));
+
+    const uint8_t keyWidth = header.keyWidth;
+    const uint8_t pageIdWidth = header.pageIdWidth;
+    const bool widths = (keyWidth == 1 || keyWidth == 2 || keyWidth == 4 || keyWidth == 8) &&
+                        (pageIdWidth == 1 || pageIdWidth == 2 || pageIdWidth == 4);
+
+    if (header.type != PageType::INDEX || !widths) {
+      return std::nullopt;
+    }
+
+    // With the count in range every read below stays within the arrays.
+    const size_t capacity = capacityOf(keyWidth, pageIdWidth);
+    const size_t count = header.itemCount;
+    if (count > capacity || (!header.isLeaf && count == 0)) {
+      return std::nullopt;
+    }
+
+    const uint8_t *keys = buffer + ENTRIES_OFFSET;
+    const uint8_t *pageIds = keys + (capacity * keyWidth + 7) / 8 * 8;
+    const size_t pos = position(keys, count, header.baseKey, keyWidth, key);
+
+    Probe probe{header.pageId, header.level, header.isLeaf, std::nullopt, pos};
+    if (pos != count && header.baseKey + load(keys, pos, keyWidth) == key) {
+      probe.value = header.basePageId + static_cast<uint32_t>(load(pageIds, pos, pageIdWidth));
+    }
+
+    else if (!header.isLeaf) {
+      probe.slot = pos == 0 ? 0 : pos - 1;
+      probe.value =
+          header.basePageId + static_cast<uint32_t>(load(pageIds, probe.slot, pageIdWidth));
     }
 
-    return (it - 1)->pageId;
+    return probe;
   }
 
   bool IndexPage::insertKey(uint64_t key, uint32_t pageId) {
-    // Check if we have space for new entry.
-    if (indexHeader()->freeSpace < sizeof(IndexEntry)) {
-      return false;
+    const size_t count = itemCount();
+
+    // An entry outside the frame of reference, or a full page, needs the entries re-encoded.
+    if (!fits(key, pageId) || count >= capacity()) {
+      const Encoding encoding = encodingWith(*this, 0, 0, std::pair{key, pageId});
+      if (count + 1 > capacityOf(encoding.keyWidth, encoding.pageIdWidth)) {
+        return false;
+      }
+
+      encode(encoding);
     }
 
     // Find insert position.
-    IndexEntry *pos = findInsertPosition(key);
+    const size_t pos = findPosition(key);
 
     // Shift existing entries right.
-    if (pos != entries() + itemCount()) {
-      std::memmove(pos + 1, pos, (itemCount() - (pos - entries())) * sizeof(IndexEntry));
-    }
+    moveEntries(pos + 1, pos, count - pos);
 
     // Insert new entry.
-    pos->key = key;
-    pos->pageId = pageId;
-    pos->offset = 0; // No variable length data yet.
+    store(pos, key, pageId);
 
     // Update page header.
     indexHeader()->itemCount++;
-    indexHeader()->freeSpace -= sizeof(IndexEntry);
+    updateFreeSpace();
 
     return true;
   }
 
   bool IndexPage::removeKey(uint64_t key) {
-    IndexEntry *begin = entries();
-    IndexEntry *end = begin + itemCount();
-
-    auto it = std::lower_bound(begin, end, key, [](const IndexEntry &entry, uint64_t key) {
-      return entry.key < key;
-    });
+    const size_t count = itemCount();
+    const size_t pos = findPosition(key);
 
     // Key not found.
-    if (it == end || it->key != key) {
+    if (pos == count || keyAt(pos) != key) {
       return false;
     }
 
     // Shift entries left.
-    std::memmove(it, it + 1, (end - it - 1) * sizeof(IndexEntry));
+    moveEntries(pos, pos + 1, count - pos - 1);
 
     // Update page header.
     indexHeader()->itemCount--;
-    indexHeader()->freeSpace += sizeof(IndexEntry);
+    updateFreeSpace();
 
     return true;
   }
@@ -107,87 +192,276 @@ namespace pulse::storage {
       return results;
     }
 
-    const IndexEntry *begin = entries();
-    const IndexEntry *end = begin + itemCount();
-
     // Find start position.
-    auto it = std::lower_bound(begin, end, startKey, [](const IndexEntry &entry, uint64_t key) {
-      return entry.key < key;
-    });
+    const size_t count = itemCount();
+    size_t pos = findPosition(startKey);
 
     // Collect all pageIds in range.
-    while (it != end && it->key <= endKey) {
-      results.push_back(it->pageId);
-      ++it;
+    while (pos != count && keyAt(pos) <= endKey) {
+      results.push_back(pageIdAt(pos));
+      ++pos;
     }
 
     return results;
   }
 
+  size_t IndexPage::capacityWith(uint64_t key, uint32_t pageId) const noexcept {
+    if (fits(key, pageId) && itemCount() < capacity()) {
+      return capacity();
+    }
+
+    const Encoding encoding = encodingWith(*this, 0, 0, std::pair{key, pageId});
+    return capacityOf(encoding.keyWidth, encoding.pageIdWidth);
+  }
+
+  bool IndexPage::canMerge(const IndexPage &rightSibling) const noexcept {
+    const Encoding encoding = encodingWith(rightSibling, 0, rightSibling.itemCount());
+    return itemCount() + rightSibling.itemCount() <
+           capacityOf(encoding.keyWidth, encoding.pageIdWidth);
+  }
+
   uint64_t IndexPage::split(IndexPage &newPage) {
     size_t mid = itemCount() / 2;
-    IndexEntry *begin = entries();
-    IndexEntry *splitPoint = begin + mid;
-    IndexEntry *end = begin + itemCount();
 
-    // Copy upper half to new page.
-    size_t numEntries = end - splitPoint;
-    std::memcpy(newPage.entries(), splitPoint, numEntries * sizeof(IndexEntry));
+    // Copy upper half to new page, each half then packs its own narrower range.
+    size_t numEntries = itemCount() - mid;
+    newPage.append(*this, mid, numEntries);
+
+    indexHeader()->itemCount = mid;
+    encode(encodingWith(*this, 0, 0));
 
     // Update sibling links.
     newPage.setNextPage(nextPage());
     newPage.setPrevPage(id());
     setNextPage(newPage.id());
 
-    if (newPage.nextPage() != 0) {
-      // TODO: Implement with disk manager.
-    }
-
-    // Update headers.
-    newPage.indexHeader()->itemCount = numEntries;
-    newPage.indexHeader()->freeSpace -= numEntries * sizeof(IndexEntry);
-
-    indexHeader()->itemCount = mid;
-    indexHeader()->freeSpace += numEntries * sizeof(IndexEntry);
+    // The old right sibling still points back here, the caller relinks it.
 
     // Return median key.
-    return splitPoint->key;
+    return newPage.keyAt(0);
   }
 
   bool IndexPage::merge(IndexPage &rightSibling) {
-    size_t totalEntries = itemCount() + rightSibling.itemCount();
-
-    // Check if entries will fit.
-    if (totalEntries > maxEntries()) {
+    // Copy entries from right sibling, if they fit.
+    if (!append(rightSibling, 0, rightSibling.itemCount())) {
       return false;
     }
 
-    // Copy entries from right sibling.
-    std::memcpy(
-        entries() + itemCount(),
-        rightSibling.entries(),
-        rightSibling.itemCount() * sizeof(IndexEntry)
-    );
-
     // Update sibling links.
+    // The caller relinks the next sibling's back pointer.
     this->setNextPage(rightSibling.nextPage());
-    if (rightSibling.nextPage() != 0) {
-      // TODO: Implement with disk manager.
+
+    return true;
+  }
+
+  void IndexPage::clear() noexcept {
+    indexHeader()->itemCount = 0;
+    updateFreeSpace();
+  }
+
+  IndexPage::Encoding IndexPage::encodingFor(
+      uint64_t minKey, uint64_t maxKey, uint32_t minPageId, uint32_t maxPageId
+  ) noexcept {
+    auto widthOf = [](uint64_t range) -> uint8_t {
+      if (range <= UINT8_MAX) {
+        return 1;
+      }
+
+      if (range <= UINT16_MAX) {
+        return 2;
+      }
+
+      return range <= UINT32_MAX ? 4 : 8;
+    };
+
+    return {minKey, minPageId, widthOf(maxKey - minKey), widthOf(maxPageId - minPageId)};
+  }
+
+  IndexPage::Encoding IndexPage::encodingWith(
+      const IndexPage &other, size_t from, size_t count,
+      std::optional<std::pair<uint64_t, uint32_t>> extra
+  ) const noexcept {
+    uint64_t minKey = UINT64_MAX;
+    uint64_t maxKey = 0;
+    uint32_t minPageId = UINT32_MAX;
+    uint32_t maxPageId = 0;
+
+    auto addKey = [&](uint64_t key) {
+      minKey = std::min(minKey, key);
+      maxKey = std::max(maxKey, key);
+    };
+
+    auto addPageId = [&](uint32_t pageId) {
+      minPageId = std::min(minPageId, pageId);
+      maxPageId = std::max(maxPageId, pageId);
+    };
+
+    // Keys are sorted, only the ends count. Page IDs aren't, every one does.
+    const size_t own = itemCount();
+    if (own > 0) {
+      addKey(keyAt(0));
+      addKey(keyAt(own - 1));
+    }
+
+    for (size_t i = 0; i < own; i++) {
+      addPageId(pageIdAt(i));
+    }
+
+    if (count > 0) {
+      addKey(other.keyAt(from));
+      addKey(other.keyAt(from + count - 1));
+    }
+
+    for (size_t i = from; i < from + count; i++) {
+      addPageId(other.pageIdAt(i));
+    }
+
+    if (extra) {
+      addKey(extra->first);
+      addPageId(extra->second);
+    }
+
+    // Nothing to hold, any encoding does.
+    if (minKey > maxKey) {
+      return {0, 0, 1, 1};
+    }
+
+    return encodingFor(minKey, maxKey, minPageId, maxPageId);
+  }
+
+  bool IndexPage::fits(uint64_t key, uint32_t pageId) const noexcept {
+    auto within = [](uint64_t value, uint64_t base, size_t width) {
+      return value >= base && (width == 8 || value - base < (uint64_t{1} << (width * 8)));
+    };
+
+    const auto *header = indexHeader();
+    return within(key, header->baseKey, header->keyWidth) &&
+           within(pageId, header->basePageId, header->pageIdWidth);
+  }
+
+  void IndexPage::encode(const Encoding &encoding) noexcept {
+    // The arrays move when the widths change, so the entries are read back from a copy.
+    alignas(64) uint8_t copy[PAGE_SIZE];
+    std::memcpy(copy, data, PAGE_SIZE);
+    const IndexPage old(VIEW, copy);
+
+    auto *header = indexHeader();
+    header->baseKey = encoding.baseKey;
+    header->basePageId = encoding.basePageId;
+    header->keyWidth = encoding.keyWidth;
+    header->pageIdWidth = encoding.pageIdWidth;
+
+    for (size_t i = 0; i < itemCount(); i++) {
+      store(i, old.keyAt(i), old.pageIdAt(i));
     }
 
-    // Update header.
-    indexHeader()->itemCount = totalEntries;
-    indexHeader()->freeSpace -= rightSibling.itemCount() * sizeof(IndexEntry);
+    updateFreeSpace();
+  }
 
+  bool IndexPage::append(const IndexPage &other, size_t from, size_t count) noexcept {
+    const size_t own = itemCount();
+    const Encoding encoding = encodingWith(other, from, count);
+    if (own + count > capacityOf(encoding.keyWidth, encoding.pageIdWidth)) {
+      return false;
+    }
+
+    encode(encoding);
+    for (size_t i = 0; i < count; i++) {
+      store(own + i, other.keyAt(from + i), other.pageIdAt(from + i));
+    }
+
+    indexHeader()->itemCount = own + count;
+    updateFreeSpace();
     return true;
   }
 
-  IndexEntry *IndexPage::findInsertPosition(uint64_t key) noexcept {
-    IndexEntry *begin = entries();
-    IndexEntry *end = begin + itemCount();
+  void IndexPage::store(size_t index, uint64_t key, uint32_t pageId) noexcept {
+    const auto *header = indexHeader();
+    const uint64_t packedKey = key - header->baseKey;
+    const uint32_t packedPageId = pageId - header->basePageId;
+
+    // Little endian, the low bytes of a value are its packed form.
+    std::memcpy(keys() + index * header->keyWidth, &packedKey, header->keyWidth);
+    std::memcpy(pageIds() + index * header->pageIdWidth, &packedPageId, header->pageIdWidth);
+  }
+
+  void IndexPage::updateFreeSpace() noexcept {
+    const auto *header = indexHeader();
+    indexHeader()->freeSpace = static_cast<uint16_t>(
+        (capacity() - itemCount()) * (header->keyWidth + header->pageIdWidth)
+    );
+  }
 
-    return std::lower_bound(begin, end, key, [](const IndexEntry &entry, uint64_t key) {
-      return entry.key < key;
-    });
+  size_t IndexPage::findPosition(uint64_t key) const noexcept {
+    const auto *header = indexHeader();
+    return position(keys(), itemCount(), header->baseKey, header->keyWidth, key);
+  }
+
+  size_t IndexPage::position(
+      const uint8_t *keys, size_t count, uint64_t baseKey, uint8_t keyWidth, uint64_t key
+  ) noexcept {
+    // Keys outside the frame of reference come before or after every packed one.
+    if (key <= baseKey) {
+      return 0;
+    }
+
+    const uint64_t offset = key - baseKey;
+    switch (keyWidth) {
+      case 1:
+        return offset > UINT8_MAX ? count
+                                  : lowerBound(reinterpret_cast<const uint8_t *>(keys), count,
+                                               static_cast<uint8_t>(offset));
+
+      case 2:
+        return offset > UINT16_MAX ? count
+                                   : lowerBound(reinterpret_cast<const uint16_t *>(keys),
+                                                count, static_cast<uint16_t>(offset));
+
+      case 4:
+        return offset > UINT32_MAX ? count
+                                   : lowerBound(reinterpret_cast<const uint32_t *>(keys),
+                                                count, static_cast<uint32_t>(offset));
+
+      default:
+        return lowerBound(reinterpret_cast<const uint64_t *>(keys), count, offset);
+    }
+  }
+
+  void IndexPage::moveEntries(size_t to, size_t from, size_t count) noexcept {
+    // Each array moves on its own, the entry's fields are its slots in both.
+    const auto *header = indexHeader();
+    std::memmove(
+        keys() + to * header->keyWidth, keys() + from * header->keyWidth,
+        count * header->keyWidth
+    );
+    std::memmove(
+        pageIds() + to * header->pageIdWidth, pageIds() + from * header->pageIdWidth,
+        count * header->pageIdWidth
+    );
+  }
+
+  uint64_t IndexPage::load(const uint8_t *array, size_t index, size_t width) noexcept {
+    switch (width) {
+      case 1:
+        return array[index];
+
+      case 2: {
+        uint16_t value;
+        std::memcpy(&value, array + index * 2, sizeof(value));
+        return value;
+      }
+
+      case 4: {
+        uint32_t value;
+        std::memcpy(&value, array + index * 4, sizeof(value));
+        return value;
+      }
+
+      default: {
+        uint64_t value;
+        std::memcpy(&value, array + index * 8, sizeof(value));
+        return value;
+      }
+    }
   }
 } // namespace pulse::storage
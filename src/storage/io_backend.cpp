@@ -0,0 +1,25 @@
+/**
+ * @file src/storage/io_backend.cpp
+ * @brief Implements backend selection for asynchronous I/O.
+ */
+
+#include "pulsedb/storage/io_backend.hpp"
+#include "pulsedb/storage/backends/thread_pool_backend.hpp"
+#include "pulsedb/storage/backends/uring_backend.hpp"
+#include <stdexcept>
+
+namespace pulse::storage {
+  std::unique_ptr<IOBackend> IOBackend::create(uint32_t queueDepth, size_t threads) {
+#ifdef PULSEDB_HAVE_IO_URING
+    // Kernels without io_uring (or sandboxes that block it) fall back to threads.
+    try {
+      return std::make_unique<UringBackend>(queueDepth);
+    } catch (const std::runtime_error &) {
+    }
+#else
+    (void)queueDepth;
+#endif
+
+    return std::make_unique<ThreadPoolBackend>(threads);
+  }
+} // namespace pulse::storage
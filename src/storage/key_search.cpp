@@ -0,0 +1,230 @@
+/**
+ * @file src/storage/key_search.cpp
+ * @brief Implements the vectorized key search.
+ */
+
+#include "pulsedb/storage/key_search.hpp"
+#include <cstring>
+
+#if defined(__AVX2__)
+#  include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#  include <arm_neon.h>
+#endif
+
+namespace pulse::storage {
+  namespace {
+    constexpr size_t LINEAR_BYTES = 128; /**< Window size, in bytes, the binary search stops at. */
+
+    /**
+     * @brief Load a key without assuming it's aligned.
+     * @param keys Array of keys.
+     * @param i Index of the key.
+     * @return The key.
+     * @note Pages viewed in a read-only mapping sit at getOffset(), which is only 4-byte aligned.
+     */
+    template <typename Key> Key loadKey(const Key *keys, size_t i) noexcept {
+      Key key;
+      std::memcpy(&key, keys + i, sizeof(key));
+      return key;
+    }
+
+    /**
+     * @brief Count the 64-bit keys less than the given key.
+     * @param keys Sorted array of keys.
+     * @param count Number of keys.
+     * @param key Key to compare with.
+     * @return Number of keys less than the given key.
+     */
+    size_t countLess(const uint64_t *keys, size_t count, uint64_t key) noexcept {
+      size_t less = 0;
+      size_t i = 0;
+
+#if defined(__AVX2__)
+      // There is no unsigned 64-bit compare, flipping the sign bit makes the signed one work.
+      const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+      const __m256i target = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<int64_t>(key)), sign);
+
+      for (; i + 4 <= count; i += 4) {
+        const __m256i lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+        const __m256i lt = _mm256_cmpgt_epi64(target, _mm256_xor_si256(lanes, sign));
+        less += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(lt)));
+      }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+      // Matching lanes are all ones, subtracting them counts up.
+      const uint64x2_t target = vdupq_n_u64(key);
+      uint64x2_t counts = vdupq_n_u64(0);
+
+      for (; i + 2 <= count; i += 2) {
+        counts = vsubq_u64(counts, vcltq_u64(vld1q_u64(keys + i), target));
+      }
+
+      less = vgetq_lane_u64(counts, 0) + vgetq_lane_u64(counts, 1);
+#endif
+
+      for (; i < count; i++) {
+        less += loadKey(keys, i) < key;
+      }
+
+      return less;
+    }
+
+    /**
+     * @brief Count the 32-bit keys less than the given key.
+     * @param keys Sorted array of keys.
+     * @param count Number of keys.
+     * @param key Key to compare with.
+     * @return Number of keys less than the given key.
+     */
+    size_t countLess(const uint32_t *keys, size_t count, uint32_t key) noexcept {
+      size_t less = 0;
+      size_t i = 0;
+
+#if defined(__AVX2__)
+      const __m256i sign = _mm256_set1_epi32(INT32_MIN);
+      const __m256i target = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int32_t>(key)), sign);
+
+      for (; i + 8 <= count; i += 8) {
+        const __m256i lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+        const __m256i lt = _mm256_cmpgt_epi32(target, _mm256_xor_si256(lanes, sign));
+        less += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(lt)));
+      }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+      const uint32x4_t target = vdupq_n_u32(key);
+      uint32x4_t counts = vdupq_n_u32(0);
+
+      for (; i + 4 <= count; i += 4) {
+        counts = vsubq_u32(counts, vcltq_u32(vld1q_u32(keys + i), target));
+      }
+
+      less = vaddvq_u32(counts);
+#endif
+
+      for (; i < count; i++) {
+        less += loadKey(keys, i) < key;
+      }
+
+      return less;
+    }
+
+    /**
+     * @brief Count the 16-bit keys less than the given key.
+     * @param keys Sorted array of keys.
+     * @param count Number of keys.
+     * @param key Key to compare with.
+     * @return Number of keys less than the given key.
+     */
+    size_t countLess(const uint16_t *keys, size_t count, uint16_t key) noexcept {
+      size_t less = 0;
+      size_t i = 0;
+
+#if defined(__AVX2__)
+      // The byte mask has two bits for each matching lane.
+      const __m256i sign = _mm256_set1_epi16(INT16_MIN);
+      const __m256i target = _mm256_xor_si256(_mm256_set1_epi16(static_cast<int16_t>(key)), sign);
+
+      for (; i + 16 <= count; i += 16) {
+        const __m256i lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+        const __m256i lt = _mm256_cmpgt_epi16(target, _mm256_xor_si256(lanes, sign));
+        less += __builtin_popcount(_mm256_movemask_epi8(lt)) / 2;
+      }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+      const uint16x8_t target = vdupq_n_u16(key);
+      uint16x8_t counts = vdupq_n_u16(0);
+
+      for (; i + 8 <= count; i += 8) {
+        counts = vsubq_u16(counts, vcltq_u16(vld1q_u16(keys + i), target));
+      }
+
+      less = vaddvq_u16(counts);
+#endif
+
+      for (; i < count; i++) {
+        less += loadKey(keys, i) < key;
+      }
+
+      return less;
+    }
+
+    /**
+     * @brief Count the 8-bit keys less than the given key.
+     * @param keys Sorted array of keys.
+     * @param count Number of keys.
+     * @param key Key to compare with.
+     * @return Number of keys less than the given key.
+     */
+    size_t countLess(const uint8_t *keys, size_t count, uint8_t key) noexcept {
+      size_t less = 0;
+      size_t i = 0;
+
+#if defined(__AVX2__)
+      const __m256i sign = _mm256_set1_epi8(INT8_MIN);
+      const __m256i target = _mm256_xor_si256(_mm256_set1_epi8(static_cast<int8_t>(key)), sign);
+
+      for (; i + 32 <= count; i += 32) {
+        const __m256i lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+        const __m256i lt = _mm256_cmpgt_epi8(target, _mm256_xor_si256(lanes, sign));
+        less += __builtin_popcount(_mm256_movemask_epi8(lt));
+      }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+      // The linear window is at most 128 keys, so no lane count wraps.
+      const uint8x16_t target = vdupq_n_u8(key);
+      uint8x16_t counts = vdupq_n_u8(0);
+
+      for (; i + 16 <= count; i += 16) {
+        counts = vsubq_u8(counts, vcltq_u8(vld1q_u8(keys + i), target));
+      }
+
+      less = vaddvq_u8(counts);
+#endif
+
+      for (; i < count; i++) {
+        less += loadKey(keys, i) < key;
+      }
+
+      return less;
+    }
+
+    /**
+     * @brief Find the first key not less than the given key, for any key width.
+     * @param keys Sorted array of keys.
+     * @param count Number of keys.
+     * @param key Key to search for.
+     * @return Index of the first key not less than the given key, or count if there is none.
+     */
+    template <typename Key> size_t search(const Key *keys, size_t count, Key key) noexcept {
+      const Key *base = keys;
+
+      // Halve the window without branching on the comparison, then finish with a linear count.
+      while (count > LINEAR_BYTES / sizeof(Key)) {
+        const size_t half = count / 2;
+        base = loadKey(base, half) < key ? base + half : base;
+        count -= half;
+      }
+
+      return static_cast<size_t>(base - keys) + countLess(base, count, key);
+    }
+  } // namespace
+
+  size_t lowerBound(const uint64_t *keys, size_t count, uint64_t key) noexcept {
+    return search(keys, count, key);
+  }
+
+  template <typename Key> size_t lowerBound(const Key *keys, size_t count, Key key) noexcept {
+    return search(keys, count, key);
+  }
+
+  template size_t lowerBound<uint8_t>(const uint8_t *, size_t, uint8_t) noexcept;
+  template size_t lowerBound<uint16_t>(const uint16_t *, size_t, uint16_t) noexcept;
+  template size_t lowerBound<uint32_t>(const uint32_t *, size_t, uint32_t) noexcept;
+
+  const char *keySearchBackend() noexcept {
+#if defined(__AVX2__)
+    return "avx2";
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    return "neon";
+#else
+    return "scalar";
+#endif
+  }
+} // namespace pulse::storage
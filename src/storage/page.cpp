@@ -7,10 +7,16 @@
 #include <cstring>
 
 namespace pulse::storage {
-  Page::Page(uint32_t pageId, PageType type) noexcept {
-    // Allocate memory for the page with 64-byte alignment.
-    data = static_cast<uint8_t *>(::operator new(PAGE_SIZE, std::align_val_t{64}));
+  Page::Page(uint32_t pageId, PageType type) noexcept
+      : Page(
+            static_cast<uint8_t *>(::operator new(PAGE_SIZE, std::align_val_t{64})), pageId, type
+        ) {
+    // The buffer was allocated for this page alone.
+    owned = true;
+  }
 
+  Page::Page(uint8_t *buffer, uint32_t pageId, PageType type) noexcept
+      : data(buffer), owned(false) {
     // Initialize the header.
     std::memset(data, 0, PAGE_SIZE);
     header()->type = type;
@@ -21,29 +27,32 @@ namespace pulse::storage {
   }
 
   Page::~Page() noexcept {
-    // Free the memory if it exists.
-    if (data) {
+    // Free the memory if it exists and is ours.
+    if (data && owned) {
       ::operator delete(data, std::align_val_t{64});
     }
   }
 
-  Page::Page(Page &&other) noexcept : data(other.data) {
+  Page::Page(Page &&other) noexcept : data(other.data), owned(other.owned) {
     // Reset the other page's data.
     other.data = nullptr;
   }
 
   Page &Page::operator=(Page &&other) noexcept {
     if (this != &other) {
-      // Free current memory if it exists.
-      if (data) {
+      // Free current memory if it exists and is ours.
+      if (data && owned) {
         ::operator delete(data, std::align_val_t{64});
       }
 
       // Take ownership of the data pointer.
       data = other.data;
+      owned = other.owned;
       other.data = nullptr;
     }
 
     return *this;
   }
+
+  void Page::copyFrom(const Page &other) noexcept { std::memcpy(data, other.data, PAGE_SIZE); }
 } // namespace pulse::storage
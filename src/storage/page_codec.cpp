@@ -0,0 +1,82 @@
+/**
+ * @file src/storage/page_codec.cpp
+ * @brief Implements the page codecs.
+ */
+
+#include "pulsedb/storage/page_codec.hpp"
+#include "pulsedb/storage/page.hpp"
+
+#ifdef PULSEDB_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace pulse::storage {
+  std::optional<size_t> compressPage(
+      Compression compression, const uint8_t *page, uint8_t *out, size_t capacity
+  ) noexcept {
+#ifdef PULSEDB_HAVE_ZLIB
+    if (compression == Compression::DEFLATE) {
+      // The fastest level, the workload is waiting on the disk rather than the CPU.
+      uLongf length = capacity;
+      if (::compress2(out, &length, page, Page::PAGE_SIZE, Z_BEST_SPEED) != Z_OK) {
+        return std::nullopt;
+      }
+
+      return length;
+    }
+#else
+    (void)page;
+    (void)out;
+    (void)capacity;
+#endif
+
+    (void)compression;
+    return std::nullopt;
+  }
+
+  bool decompressPage(
+      Compression compression, const uint8_t *in, size_t length, uint8_t *page
+  ) noexcept {
+#ifdef PULSEDB_HAVE_ZLIB
+    if (compression == Compression::DEFLATE) {
+      uLongf size = Page::PAGE_SIZE;
+      return ::uncompress(page, &size, in, length) == Z_OK && size == Page::PAGE_SIZE;
+    }
+#else
+    (void)in;
+    (void)length;
+    (void)page;
+#endif
+
+    (void)compression;
+    return false;
+  }
+
+  bool isCompressionAvailable(Compression compression) noexcept {
+    switch (compression) {
+      case Compression::NONE:
+        return true;
+
+      case Compression::DEFLATE:
+#ifdef PULSEDB_HAVE_ZLIB
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    return false;
+  }
+
+  const char *compressionName(Compression compression) noexcept {
+    switch (compression) {
+      case Compression::NONE:
+        return "none";
+
+      case Compression::DEFLATE:
+        return "deflate";
+    }
+
+    return "unknown";
+  }
+} // namespace pulse::storage
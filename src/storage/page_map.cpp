@@ -0,0 +1,170 @@
+/**
+ * @file src/storage/page_map.cpp
+ * @brief Implements the page map class.
+ */
+
+#include "pulsedb/storage/page_map.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace pulse::storage {
+  // The first sector holds the database header.
+  PageMap::PageMap() noexcept
+      : freeSlots(Page::PAGE_SIZE / SECTOR_SIZE + 1), fileEnd(SECTOR_SIZE), dirty(false) {}
+
+  std::optional<PageLocation> PageMap::find(uint32_t pageId) const noexcept {
+    if (pageId >= locations.size() || locations[pageId].offset == 0) {
+      return std::nullopt;
+    }
+
+    return locations[pageId];
+  }
+
+  PageLocation PageMap::place(uint32_t pageId, size_t bytes) {
+    if (pageId >= locations.size()) {
+      locations.resize(pageId + 1, PageLocation{0, 0});
+    }
+
+    PageLocation &location = locations[pageId];
+    const uint64_t capacity = slotSize(bytes);
+
+    // Only a whole page slot holds an uncompressed page, so the capacity tells them apart.
+    const bool raw = bytes == Page::PAGE_SIZE;
+    if (location.offset != 0 && capacity <= location.capacity &&
+        raw == (location.capacity == Page::PAGE_SIZE)) {
+      return location;
+    }
+
+    if (location.offset != 0) {
+      retire(location.offset, location.capacity);
+    }
+
+    location = {take(capacity), static_cast<uint32_t>(capacity)};
+    dirty = true;
+    return location;
+  }
+
+  void PageMap::release(uint32_t pageId) {
+    if (pageId >= locations.size() || locations[pageId].offset == 0) {
+      return;
+    }
+
+    retire(locations[pageId].offset, locations[pageId].capacity);
+    locations[pageId] = {0, 0};
+    dirty = true;
+  }
+
+  uint64_t PageMap::reserve(size_t bytes) {
+    // Maps are larger than any slot, they always go at the end.
+    const uint64_t offset = fileEnd;
+    fileEnd += slotSize(bytes);
+    return offset;
+  }
+
+  void PageMap::retire(uint64_t offset, size_t bytes) {
+    retired.emplace_back(offset, slotSize(bytes));
+  }
+
+  void PageMap::commit() {
+    for (const auto &[offset, bytes] : retired) {
+      free(offset, bytes);
+    }
+
+    retired.clear();
+    dirty = false;
+  }
+
+  std::vector<uint8_t> PageMap::serialize() const {
+    std::vector<uint8_t> bytes(locations.size() * sizeof(PageLocation));
+    std::memcpy(bytes.data(), locations.data(), bytes.size());
+    return bytes;
+  }
+
+  bool PageMap::load(std::span<const uint8_t> bytes, uint64_t mapOffset) {
+    if (bytes.size() % sizeof(PageLocation) != 0) {
+      return false;
+    }
+
+    locations.resize(bytes.size() / sizeof(PageLocation));
+    std::memcpy(locations.data(), bytes.data(), bytes.size());
+
+    for (auto &slots : freeSlots) {
+      slots.clear();
+    }
+
+    retired.clear();
+    dirty = false;
+
+    // Everything between the slots in use, the map included, is free.
+    std::vector<std::pair<uint64_t, uint64_t>> used;
+    used.reserve(locations.size() + 1);
+
+    for (const PageLocation &location : locations) {
+      if (location.offset != 0) {
+        used.emplace_back(location.offset, location.capacity);
+      }
+    }
+
+    if (!bytes.empty()) {
+      used.emplace_back(mapOffset, slotSize(bytes.size()));
+    }
+
+    std::sort(used.begin(), used.end());
+
+    fileEnd = SECTOR_SIZE;
+    for (const auto &[offset, size] : used) {
+      if (offset > fileEnd) {
+        free(fileEnd, offset - fileEnd);
+      }
+
+      fileEnd = std::max(fileEnd, offset + size);
+    }
+
+    return true;
+  }
+
+  uint64_t PageMap::freeBytes() const noexcept {
+    uint64_t bytes = 0;
+    for (size_t sectors = 0; sectors < freeSlots.size(); sectors++) {
+      bytes += freeSlots[sectors].size() * sectors * SECTOR_SIZE;
+    }
+
+    return bytes;
+  }
+
+  uint64_t PageMap::take(uint64_t capacity) {
+    const size_t sectors = capacity / SECTOR_SIZE;
+
+    // The smallest free slot that fits, splitting off what's left of it.
+    for (size_t size = sectors; size < freeSlots.size(); size++) {
+      if (freeSlots[size].empty()) {
+        continue;
+      }
+
+      const uint64_t offset = freeSlots[size].back();
+      freeSlots[size].pop_back();
+
+      if (size > sectors) {
+        free(offset + capacity, (size - sectors) * SECTOR_SIZE);
+      }
+
+      return offset;
+    }
+
+    const uint64_t offset = fileEnd;
+    fileEnd += capacity;
+    return offset;
+  }
+
+  void PageMap::free(uint64_t offset, uint64_t bytes) {
+    const size_t largest = freeSlots.size() - 1;
+
+    while (bytes > 0) {
+      const uint64_t size = std::min<uint64_t>(bytes, largest * SECTOR_SIZE);
+      freeSlots[size / SECTOR_SIZE].push_back(offset);
+
+      offset += size;
+      bytes -= size;
+    }
+  }
+} // namespace pulse::storage
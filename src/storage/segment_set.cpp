@@ -0,0 +1,127 @@
+/**
+ * @file src/storage/segment_set.cpp
+ * @brief Implements the segment set class.
+ */
+
+#include "pulsedb/storage/segment_set.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <format>
+#include <mutex>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace pulse::storage {
+  SegmentSet::SegmentSet(
+      const fs::path &database, uint32_t pagesPerSegment, std::vector<fs::path> directories,
+      bool create
+  )
+      : database(database), pages(pagesPerSegment), directories(std::move(directories)),
+        create(create), logger("segment-set") {
+    if (pages < MIN_PAGES) {
+      logger.error("segments of {} pages are too small, the minimum is {}", pages, MIN_PAGES);
+      throw std::runtime_error("Segments are too small.");
+    }
+  }
+
+  SegmentSet::~SegmentSet() noexcept {
+    for (int fd : files) {
+      if (fd >= 0) {
+        ::close(fd);
+      }
+    }
+  }
+
+  std::optional<SegmentLocation> SegmentSet::locate(uint32_t pageId) {
+    const size_t segment = pageId / pages;
+    const uint64_t offset = static_cast<uint64_t>(pageId % pages) * Page::PAGE_SIZE;
+
+    // Segments are only opened once, every later lookup shares the lock.
+    {
+      std::shared_lock lock(mutex);
+      if (segment < files.size() && files[segment] >= 0) {
+        return SegmentLocation{files[segment], offset};
+      }
+    }
+
+    std::unique_lock lock(mutex);
+    if (segment >= files.size()) {
+      files.resize(segment + 1, -1);
+    }
+
+    if (files[segment] < 0) {
+      files[segment] = open(segment);
+      if (files[segment] < 0) {
+        return std::nullopt;
+      }
+    }
+
+    return SegmentLocation{files[segment], offset};
+  }
+
+  bool SegmentSet::sync() {
+    std::shared_lock lock(mutex);
+    bool ok = true;
+
+    for (size_t segment = 0; segment < files.size(); segment++) {
+      if (files[segment] >= 0 && ::fdatasync(files[segment]) != 0) {
+        PULSEDB_LOG_ERROR(logger, "failed to sync segment {}: {}", segment, std::strerror(errno));
+        ok = false;
+      }
+    }
+
+    return ok;
+  }
+
+  uint64_t SegmentSet::size() const {
+    std::shared_lock lock(mutex);
+    uint64_t total = 0;
+
+    for (int fd : files) {
+      struct stat st{};
+      if (fd >= 0 && ::fstat(fd, &st) == 0) {
+        total += static_cast<uint64_t>(st.st_size);
+      }
+    }
+
+    return total;
+  }
+
+  fs::path SegmentSet::pathOf(size_t segment) const {
+    const fs::path directory =
+        directories.empty() ? database.parent_path() : directories[segment % directories.size()];
+    return directory / std::format("{}.{}", database.filename().string(), segment);
+  }
+
+  int SegmentSet::open(size_t segment) {
+    const fs::path path = pathOf(segment);
+
+    // Segments of an old database by the same name are stale, a new one starts them empty.
+    const int fd =
+        ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC | (create ? O_TRUNC : 0), 0644);
+    if (fd < 0) {
+      PULSEDB_LOG_ERROR(
+          logger, "failed to open segment {}: {}", path.string(), std::strerror(errno)
+      );
+      return -1;
+    }
+
+    struct stat st{};
+    if (::fstat(fd, &st) == 0 && st.st_size == 0) {
+      // Reserve the whole segment so it's laid out in one piece, the length stays 0 until written.
+      const auto length = static_cast<off_t>(static_cast<uint64_t>(pages) * Page::PAGE_SIZE);
+      if (::fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, length) != 0) {
+        PULSEDB_LOG_DEBUG(
+            logger, "failed to reserve segment {}: {}", segment, std::strerror(errno)
+        );
+      }
+    }
+
+    PULSEDB_LOG_INFO(logger, "opened segment {} at {}", segment, path.string());
+    return fd;
+  }
+} // namespace pulse::storage
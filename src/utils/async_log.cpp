@@ -0,0 +1,127 @@
+/**
+ * @file src/utils/async_log.cpp
+ * @brief Implements the asynchronous log class.
+ */
+
+#include "pulsedb/utils/async_log.hpp"
+#include "pulsedb/utils/logger.hpp"
+
+namespace pulse::utils {
+  namespace {
+    /**
+     * @struct RingHandle
+     * @brief Holds the ring of a thread, giving it up when the thread exits.
+     */
+    struct RingHandle {
+      std::shared_ptr<LogRing> ring; /**< The ring, shared with the log. */
+
+      /**
+       * @brief Retire the ring, the drain thread writes what's left.
+       */
+      ~RingHandle() noexcept {
+        if (ring) {
+          ring->retire();
+        }
+      }
+    };
+
+    constexpr auto DRAIN_INTERVAL = std::chrono::milliseconds(10); /**< Pause when idle. */
+  } // namespace
+
+  LogEntry &LogRing::reserve(std::condition_variable &wake) noexcept {
+    const size_t current = head.load(std::memory_order_relaxed);
+
+    // A full ring waits for the drain thread, messages are never dropped.
+    while (current - tail.load(std::memory_order_acquire) >= CAPACITY) {
+      wake.notify_one();
+      std::this_thread::yield();
+    }
+
+    if (current - tail.load(std::memory_order_relaxed) == CAPACITY / 2) {
+      wake.notify_one();
+    }
+
+    return entries[current % CAPACITY];
+  }
+
+  size_t LogRing::drain() {
+    const size_t current = tail.load(std::memory_order_relaxed);
+    const size_t end = head.load(std::memory_order_acquire);
+
+    for (size_t i = current; i < end; i++) {
+      const LogEntry &entry = entries[i % CAPACITY];
+      Logger::write(
+          *entry.output, entry.level, {entry.name.data(), entry.nameLength}, entry.time,
+          {entry.message.data(), entry.length}
+      );
+    }
+
+    tail.store(end, std::memory_order_release);
+    return end - current;
+  }
+
+  AsyncLog &AsyncLog::instance() {
+    static AsyncLog log;
+    return log;
+  }
+
+  AsyncLog::AsyncLog() : stopping(false) { thread = std::thread([this] { run(); }); }
+
+  AsyncLog::~AsyncLog() noexcept {
+    {
+      std::lock_guard lock(mutex);
+      stopping = true;
+    }
+
+    wake.notify_all();
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+
+  void AsyncLog::flush() {
+    std::lock_guard lock(mutex);
+    drainAll();
+  }
+
+  LogRing &AsyncLog::local() {
+    thread_local RingHandle handle;
+    if (!handle.ring) {
+      handle.ring = std::make_shared<LogRing>();
+
+      std::lock_guard lock(mutex);
+      rings.push_back(handle.ring);
+    }
+
+    return *handle.ring;
+  }
+
+  size_t AsyncLog::drainAll() {
+    size_t count = 0;
+    for (const auto &ring : rings) {
+      count += ring->drain();
+    }
+
+    // Rings of exited threads go once nothing is left in them.
+    std::erase_if(rings, [](const auto &ring) { return ring->isDone(); });
+    return count;
+  }
+
+  void AsyncLog::run() {
+    std::unique_lock lock(mutex);
+    while (!stopping) {
+      if (drainAll() == 0) {
+        wake.wait_for(lock, DRAIN_INTERVAL);
+      }
+
+      // Keep going without a pause while messages come in, but let new rings register.
+      else {
+        lock.unlock();
+        std::this_thread::yield();
+        lock.lock();
+      }
+    }
+
+    drainAll();
+  }
+} // namespace pulse::utils
@@ -0,0 +1,35 @@
+/**
+ * @file src/utils/logger.cpp
+ * @brief Implements the logger class.
+ */
+
+#include "pulsedb/utils/logger.hpp"
+
+namespace pulse::utils {
+  void Logger::write(
+      std::ostream &output, LogLevel level, std::string_view name, std::chrono::sys_seconds time,
+      std::string_view message
+  ) {
+    /**
+     * @struct Timestamp
+     * @brief The formatted timestamp of the last second a thread logged in.
+     */
+    struct Timestamp {
+      std::chrono::sys_seconds time; /**< The second formatted. */
+      std::string text;              /**< The formatted local time. */
+    };
+
+    // Looking up the zone and formatting the time is most of the cost, do it once per second.
+    thread_local Timestamp cached{};
+    if (cached.text.empty() || cached.time != time) {
+      cached.time = time;
+      cached.text =
+          std::format("{:%Y-%m-%d %H:%M:%S}", std::chrono::current_zone()->to_local(time));
+    }
+
+    const auto &[code, prefix] = LEVEL_DATA[static_cast<uint8_t>(level)];
+
+    // Send the formatted log message to the output stream.
+    output << std::format("[{}]{}[{}:{}]: \x1B[0m{}\n", cached.text, code, name, prefix, message);
+  }
+} // namespace pulse::utils
@@ -0,0 +1,118 @@
+/**
+ * @file src/utils/metrics.cpp
+ * @brief Implements the metrics classes.
+ */
+
+#include "pulsedb/utils/metrics.hpp"
+#include <algorithm>
+#include <bit>
+#include <format>
+
+namespace pulse::utils {
+  size_t threadStripe() noexcept {
+    static std::atomic<size_t> next{0};
+
+    // Threads take stripes in turn, so the first STRIPE_COUNT threads never share one.
+    thread_local const size_t stripe =
+        next.fetch_add(1, std::memory_order_relaxed) & (STRIPE_COUNT - 1);
+    return stripe;
+  }
+
+  uint64_t Counter::value() const noexcept {
+    uint64_t total = 0;
+    for (const auto &stripe : stripes) {
+      total += stripe.value.load(std::memory_order_relaxed);
+    }
+
+    return total;
+  }
+
+  uint64_t HistogramSnapshot::percentile(double quantile) const noexcept {
+    if (count == 0) {
+      return 0;
+    }
+
+    const auto rank = static_cast<uint64_t>(std::clamp(quantile, 0.0, 1.0) * (count - 1)) + 1;
+    uint64_t seen = 0;
+
+    for (size_t bucket = 0; bucket < BUCKETS - 1; bucket++) {
+      seen += buckets[bucket];
+      if (seen >= rank) {
+        return upperBound(bucket);
+      }
+    }
+
+    return upperBound(BUCKETS - 1);
+  }
+
+  void HistogramSnapshot::merge(const HistogramSnapshot &other) noexcept {
+    for (size_t bucket = 0; bucket < BUCKETS; bucket++) {
+      buckets[bucket] += other.buckets[bucket];
+    }
+
+    count += other.count;
+    sum += other.sum;
+  }
+
+  void Histogram::record(uint64_t nanos) noexcept {
+    // Values below 2^i have at most i significant bits.
+    const size_t bucket = std::min<size_t>(std::bit_width(nanos), HistogramSnapshot::BUCKETS - 1);
+
+    Stripe &stripe = stripes[threadStripe()];
+    stripe.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    stripe.sum.fetch_add(nanos, std::memory_order_relaxed);
+  }
+
+  HistogramSnapshot Histogram::snapshot() const noexcept {
+    HistogramSnapshot result;
+
+    for (const auto &stripe : stripes) {
+      for (size_t bucket = 0; bucket < HistogramSnapshot::BUCKETS; bucket++) {
+        const uint64_t count = stripe.buckets[bucket].load(std::memory_order_relaxed);
+        result.buckets[bucket] += count;
+        result.count += count;
+      }
+
+      result.sum += stripe.sum.load(std::memory_order_relaxed);
+    }
+
+    return result;
+  }
+
+  void PrometheusWriter::counter(std::string_view name, std::string_view help, uint64_t value) {
+    describe(name, help, "counter");
+    output += std::format("{}_{} {}\n", prefix, name, value);
+  }
+
+  void PrometheusWriter::gauge(std::string_view name, std::string_view help, double value) {
+    describe(name, help, "gauge");
+    output += std::format("{}_{} {}\n", prefix, name, value);
+  }
+
+  void PrometheusWriter::histogram(
+      std::string_view name, std::string_view help, const HistogramSnapshot &histogram
+  ) {
+    describe(name, help, "histogram");
+
+    // Prometheus buckets are cumulative, and the last one is +Inf.
+    uint64_t cumulative = 0;
+    for (size_t bucket = 0; bucket < HistogramSnapshot::BUCKETS - 1; bucket++) {
+      cumulative += histogram.buckets[bucket];
+      const double bound = static_cast<double>(HistogramSnapshot::upperBound(bucket)) * 1e-9;
+      output += std::format("{}_{}_bucket{{le=\"{}\"}} {}\n", prefix, name, bound, cumulative);
+    }
+
+    output += std::format("{}_{}_bucket{{le=\"+Inf\"}} {}\n", prefix, name, histogram.count);
+    output += std::format(
+        "{}_{}_sum {}\n", prefix, name, static_cast<double>(histogram.sum) * 1e-9
+    );
+    output += std::format("{}_{}_count {}\n", prefix, name, histogram.count);
+  }
+
+  void PrometheusWriter::describe(
+      std::string_view name, std::string_view help, std::string_view type
+  ) {
+    output += std::format("# HELP {}_{} {}\n", prefix, name, help);
+    output += std::format("# TYPE {}_{} {}\n", prefix, name, type);
+  }
+} // namespace pulse::utils
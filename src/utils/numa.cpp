@@ -0,0 +1,105 @@
+/**
+ * @file src/utils/numa.cpp
+ * @brief Implements the NUMA topology functions.
+ */
+
+#include "pulsedb/utils/numa.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <string>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+  constexpr size_t UNSET = SIZE_MAX; /**< No node set for the thread. */
+
+  thread_local size_t threadNode = UNSET; /**< Node set by setThreadNode(), if any. */
+
+  /**
+   * @brief Read the online node list, "0-1,3" style, for its highest node.
+   * @return Number of nodes, 1 if the list can't be read.
+   */
+  size_t readNodes() {
+    std::ifstream file("/sys/devices/system/node/online");
+    std::string list;
+    if (!(file >> list)) {
+      return 1;
+    }
+
+    // Every range ends in its highest node, so the highest number anywhere is the last node.
+    size_t highest = 0;
+    size_t value = 0;
+    bool digits = false;
+    for (char c : list + ",") {
+      if (c >= '0' && c <= '9') {
+        value = value * 10 + static_cast<size_t>(c - '0');
+        digits = true;
+        continue;
+      }
+
+      if (digits) {
+        highest = std::max(highest, value);
+      }
+
+      value = 0;
+      digits = false;
+    }
+
+    return highest + 1;
+  }
+} // namespace
+
+namespace pulse::utils {
+  size_t numaNodes() noexcept {
+    static const size_t nodes = [] {
+      try {
+        return readNodes();
+      } catch (...) {
+        return size_t{1};
+      }
+    }();
+
+    return nodes;
+  }
+
+  size_t currentNode() noexcept {
+    if (threadNode != UNSET) {
+      return threadNode;
+    }
+
+    // Served from the vDSO, no system call.
+    unsigned int cpu = 0;
+    unsigned int node = 0;
+    if (::getcpu(&cpu, &node) != 0) {
+      return 0;
+    }
+
+    return node;
+  }
+
+  void setThreadNode(size_t node) noexcept { threadNode = node; }
+
+  bool bindToNode(void *memory, size_t length, size_t node) noexcept {
+    constexpr size_t MASK_BITS = sizeof(unsigned long) * 8;
+    if (node >= numaNodes() || numaNodes() == 1) {
+      return false;
+    }
+
+    std::vector<unsigned long> mask;
+    try {
+      mask.resize(node / MASK_BITS + 1);
+    } catch (...) {
+      return false;
+    }
+
+    mask[node / MASK_BITS] = 1ul << (node % MASK_BITS);
+    return ::syscall(
+               SYS_mbind, memory, length, MPOL_PREFERRED, mask.data(), mask.size() * MASK_BITS + 1,
+               0
+           ) == 0;
+  }
+} // namespace pulse::utils
@@ -0,0 +1,530 @@
+/**
+ * @file src/wal/log_manager.cpp
+ * @brief Implements the log manager class.
+ */
+
+#include "pulsedb/wal/log_manager.hpp"
+#include "pulsedb/utils/checksum.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <thread>
+#include <unordered_map>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace pulse::wal {
+  LogManager::LogManager(const fs::path &path, bool create)
+      : fd(-1), path(path), nextLsn(FILE_HEADER_SIZE), bufferStart(FILE_HEADER_SIZE),
+        durableLsn(FILE_HEADER_SIZE), flushing(false), syncs(0), lastCheckpoint(0),
+        logger("log-manager") {
+    if (!create && !fs::exists(path)) {
+      throw std::runtime_error("Log file does not exist.");
+    }
+
+    const int flags = O_RDWR | O_CLOEXEC | (create ? O_CREAT | O_TRUNC : 0);
+    fd = ::open(path.c_str(), flags, 0644);
+    if (fd < 0) {
+      PULSEDB_LOG_ERROR(logger, "failed to open log file: {}", std::strerror(errno));
+      throw std::runtime_error("Failed to open log file.");
+    }
+
+    LogFileHeader header{LOG_MAGIC, LOG_VERSION, 0};
+    if (create) {
+      const std::vector<uint8_t> bytes(
+          reinterpret_cast<const uint8_t *>(&header),
+          reinterpret_cast<const uint8_t *>(&header) + sizeof(header)
+      );
+
+      if (!writeAt(bytes, 0) || ::fdatasync(fd) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Failed to write log header.");
+      }
+
+      PULSEDB_LOG_INFO(logger, "created log at {}", path.string());
+      return;
+    }
+
+    if (::pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+        header.magic != LOG_MAGIC || header.version != LOG_VERSION) {
+      ::close(fd);
+      throw std::runtime_error("Invalid log file.");
+    }
+
+    // Records before the last checkpoint were intact when it was taken, only the rest is checked.
+    uint64_t from = FILE_HEADER_SIZE;
+    if (header.checkpoint != 0 && readCheckpoint(header.checkpoint)) {
+      lastCheckpoint = header.checkpoint;
+      from = lastCheckpoint - CHECKPOINT_SIZE;
+    }
+
+    else if (header.checkpoint != 0) {
+      logger.warn("no checkpoint at lsn {}, reading the whole log", header.checkpoint);
+    }
+
+    // Appends continue after the last intact record.
+    nextLsn = bufferStart = durableLsn = from + readRecords(from).size();
+    PULSEDB_LOG_INFO(logger, "opened log at {}, ending at {}", path.string(), nextLsn);
+  }
+
+  LogManager::~LogManager() noexcept {
+    try {
+      flush(currentLsn());
+    } catch (const std::exception &e) {
+      PULSEDB_LOG_ERROR(logger, "error during destruction: {}", e.what());
+    }
+
+    if (fd >= 0) {
+      ::close(fd);
+    }
+  }
+
+  uint64_t LogManager::logUpdate(
+      storage::Page &page, storage::PageOffset offset, storage::PageOffset length
+  ) {
+    if (length == 0 || offset + length > storage::Page::PAGE_SIZE) {
+      logger.error("invalid update range {}+{} of page {}", offset, length, page.id());
+      return 0;
+    }
+
+    std::lock_guard lock(mutex);
+    page.setLsn(nextLsn + RECORD_HEADER_SIZE + length);
+    return append(LogRecordType::UPDATE, page.id(), offset, page.data + offset, length);
+  }
+
+  uint64_t LogManager::logPage(storage::Page &page) {
+    const storage::PageOffset length = storage::Page::PAGE_SIZE;
+
+    // Stamp first, so the image carries its own LSN.
+    std::lock_guard lock(mutex);
+    page.setLsn(nextLsn + RECORD_HEADER_SIZE + length);
+    return append(LogRecordType::PAGE, page.id(), 0, page.data, length);
+  }
+
+  uint64_t LogManager::commit() {
+    uint64_t lsn;
+
+    {
+      std::lock_guard lock(mutex);
+      lsn = append(LogRecordType::COMMIT, storage::DiskManager::INVALID_PAGE_ID, 0, nullptr, 0);
+    }
+
+    return flush(lsn) ? lsn : 0;
+  }
+
+  bool LogManager::flush(uint64_t lsn) {
+    std::unique_lock lock(mutex);
+    lsn = std::min(lsn, nextLsn);
+
+    while (durableLsn < lsn) {
+      // Someone else is syncing, their sync may already cover us.
+      if (flushing) {
+        flushed.wait(lock);
+        continue;
+      }
+
+      // Become the leader and take everything appended so far along.
+      flushing = true;
+      std::vector<uint8_t> batch;
+      batch.swap(buffer);
+
+      const uint64_t start = bufferStart;
+      const uint64_t end = nextLsn;
+      bufferStart = end;
+
+      lock.unlock();
+      const bool ok = writeAt(batch, start) && ::fdatasync(fd) == 0;
+      lock.lock();
+
+      flushing = false;
+      if (ok) {
+        durableLsn = end;
+        syncs++;
+      }
+
+      else {
+        // Put the records back in front of anything appended meanwhile.
+        PULSEDB_LOG_ERROR(logger, "failed to sync log: {}", std::strerror(errno));
+        buffer.insert(buffer.begin(), batch.begin(), batch.end());
+        bufferStart = start;
+      }
+
+      flushed.notify_all();
+      if (!ok) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  uint64_t LogManager::checkpoint(uint64_t beginLsn, std::span<const DirtyPage> dirtyPages) {
+    CheckpointRecord record{beginLsn, beginLsn};
+    for (const DirtyPage &dirty : dirtyPages) {
+      record.redoLsn = std::min(record.redoLsn, dirty.recLsn);
+    }
+
+    uint64_t lsn;
+
+    {
+      std::lock_guard lock(mutex);
+      for (size_t i = 0; i < dirtyPages.size(); i += DIRTY_PER_RECORD) {
+        const size_t count = std::min(DIRTY_PER_RECORD, dirtyPages.size() - i);
+        append(
+            LogRecordType::DIRTY_PAGES, storage::DiskManager::INVALID_PAGE_ID, 0,
+            dirtyPages.data() + i, static_cast<storage::PageOffset>(count * sizeof(DirtyPage))
+        );
+      }
+
+      lsn = append(
+          LogRecordType::CHECKPOINT, storage::DiskManager::INVALID_PAGE_ID, 0, &record,
+          sizeof(record)
+      );
+    }
+
+    if (!flush(lsn)) {
+      return 0;
+    }
+
+    // Only point the header at the checkpoint once it's durable, until then the last one holds.
+    const LogFileHeader header{LOG_MAGIC, LOG_VERSION, lsn};
+    const std::vector<uint8_t> bytes(
+        reinterpret_cast<const uint8_t *>(&header),
+        reinterpret_cast<const uint8_t *>(&header) + sizeof(header)
+    );
+
+    std::lock_guard lock(mutex);
+    if (lsn < lastCheckpoint) {
+      return lsn;
+    }
+
+    if (!writeAt(bytes, 0) || ::fdatasync(fd) != 0) {
+      PULSEDB_LOG_ERROR(
+          logger, "failed to write the checkpoint to the log header: {}", std::strerror(errno)
+      );
+      return 0;
+    }
+
+    lastCheckpoint = lsn;
+    logger.info(
+        "checkpoint at lsn {} with {} dirty pages, redo from {}", lsn, dirtyPages.size(),
+        record.redoLsn
+    );
+
+    return lsn;
+  }
+
+  size_t LogManager::recover(storage::DiskManager &diskManager, size_t workers) {
+    std::lock_guard lock(mutex);
+
+    // Without a checkpoint every record may be missing from the database.
+    CheckpointRecord checkpoint{0, FILE_HEADER_SIZE};
+    if (auto last = lastCheckpoint ? readCheckpoint(lastCheckpoint) : std::nullopt) {
+      checkpoint = *last;
+    }
+
+    const uint64_t from = std::clamp<uint64_t>(
+        checkpoint.redoLsn, FILE_HEADER_SIZE, std::max<uint64_t>(lastCheckpoint, FILE_HEADER_SIZE)
+    );
+
+    const auto records = readRecords(from);
+    const uint64_t end = from + records.size();
+    uint64_t applied = diskManager.lastLsn();
+
+    // A database ahead of its log was recovered from a different log, trust the page LSNs only.
+    if (applied > end) {
+      logger.warn("database was recovered up to lsn {}, past the log end {}", applied, end);
+      applied = 0;
+    }
+
+    // Analysis: rebuild the checkpoint's dirty page table and find the records left to redo.
+    std::unordered_map<uint32_t, uint64_t> dirty;
+    std::vector<size_t> candidates;
+
+    for (size_t pos = 0; pos < records.size();) {
+      LogRecordHeader header;
+      std::memcpy(&header, records.data() + pos, RECORD_HEADER_SIZE);
+
+      const bool ours = header.lsn > checkpoint.beginLsn && header.lsn <= lastCheckpoint;
+      if (header.type == LogRecordType::DIRTY_PAGES && ours) {
+        for (size_t i = 0; i < header.length / sizeof(DirtyPage); i++) {
+          DirtyPage entry;
+          std::memcpy(
+              &entry, records.data() + pos + RECORD_HEADER_SIZE + i * sizeof(DirtyPage),
+              sizeof(entry)
+          );
+
+          auto [it, added] = dirty.try_emplace(entry.pageId, entry.recLsn);
+          it->second = std::min(it->second, entry.recLsn);
+        }
+      }
+
+      // Some records were applied by an earlier recovery.
+      const bool redo =
+          header.type == LogRecordType::UPDATE || header.type == LogRecordType::PAGE;
+      if (redo && header.lsn > applied) {
+        candidates.push_back(pos);
+      }
+
+      pos += header.size;
+    }
+
+    // Pages left out of the checkpoint were on disk up to its start, so only later records of
+    // theirs need redo. Each page goes to one worker, which keeps its records in log order.
+    if (workers == ALL_CORES) {
+      workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    std::vector<std::vector<size_t>> partitions(workers);
+    uint32_t pageCount = 0;
+
+    for (size_t pos : candidates) {
+      LogRecordHeader header;
+      std::memcpy(&header, records.data() + pos, RECORD_HEADER_SIZE);
+
+      if (header.lsn <= checkpoint.beginLsn) {
+        auto it = dirty.find(header.pageId);
+        if (it == dirty.end() || header.lsn <= it->second) {
+          continue;
+        }
+      }
+
+      partitions[header.pageId % workers].push_back(pos);
+      pageCount = std::max(pageCount, header.pageId + 1);
+    }
+
+    if (pageCount > 0) {
+      diskManager.extendTo(pageCount);
+    }
+
+    std::atomic<size_t> count = 0;
+    std::atomic<bool> failed = false;
+
+    auto redo = [&](const std::vector<size_t> &positions) {
+      std::map<uint32_t, std::unique_ptr<storage::Page>> pages;
+      size_t done = 0;
+
+      for (size_t pos : positions) {
+        LogRecordHeader header;
+        std::memcpy(&header, records.data() + pos, RECORD_HEADER_SIZE);
+        const uint8_t *payload = records.data() + pos + RECORD_HEADER_SIZE;
+
+        auto &page = pages[header.pageId];
+        if (!page) {
+          page = diskManager.fetchPage(header.pageId);
+        }
+
+        if (!page && header.type == LogRecordType::PAGE) {
+          page = std::make_unique<storage::Page>(header.pageId, storage::PageType::INVALID);
+        }
+
+        if (!page) {
+          logger.warn("no image to redo lsn {} onto page {}, skipping", header.lsn, header.pageId);
+          continue;
+        }
+
+        // The page already holds this change.
+        if (header.lsn <= page->lsn()) {
+          continue;
+        }
+
+        std::memcpy(page->data + header.offset, payload, header.length);
+        page->setLsn(header.lsn);
+        done++;
+      }
+
+      for (const auto &[pageId, page] : pages) {
+        if (page && !diskManager.flushPage(*page)) {
+          logger.error("failed to write recovered page {}", pageId);
+          failed = true;
+        }
+      }
+
+      count += done;
+    };
+
+    // The calling thread takes the first partition.
+    std::vector<std::thread> threads;
+    for (size_t worker = 1; worker < workers; worker++) {
+      if (!partitions[worker].empty()) {
+        threads.emplace_back(redo, std::cref(partitions[worker]));
+      }
+    }
+
+    redo(partitions[0]);
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    if (failed) {
+      return count;
+    }
+
+    diskManager.setLastLsn(end);
+    diskManager.sync();
+
+    logger.info(
+        "recovered {} records from lsn {} with {} workers", count.load(), from, threads.size() + 1
+    );
+
+    return count;
+  }
+
+  uint64_t LogManager::currentLsn() const noexcept {
+    std::lock_guard lock(mutex);
+    return nextLsn;
+  }
+
+  uint64_t LogManager::flushedLsn() const noexcept {
+    std::lock_guard lock(mutex);
+    return durableLsn;
+  }
+
+  size_t LogManager::syncCount() const noexcept {
+    std::lock_guard lock(mutex);
+    return syncs;
+  }
+
+  uint64_t LogManager::checkpointLsn() const noexcept {
+    std::lock_guard lock(mutex);
+    return lastCheckpoint;
+  }
+
+  uint64_t LogManager::append(
+      LogRecordType type,
+      uint32_t pageId,
+      storage::PageOffset offset,
+      const void *payload,
+      storage::PageOffset length
+  ) {
+    const uint32_t size = RECORD_HEADER_SIZE + length;
+    LogRecordHeader header{size, 0, nextLsn + size, type, pageId, offset, length};
+
+    header.checksum = utils::crc32(&header, RECORD_HEADER_SIZE);
+    header.checksum = utils::crc32(payload, length, header.checksum);
+
+    const auto *bytes = reinterpret_cast<const uint8_t *>(&header);
+    buffer.insert(buffer.end(), bytes, bytes + RECORD_HEADER_SIZE);
+
+    if (length > 0) {
+      const auto *data = static_cast<const uint8_t *>(payload);
+      buffer.insert(buffer.end(), data, data + length);
+    }
+
+    nextLsn = header.lsn;
+    return nextLsn;
+  }
+
+  std::vector<uint8_t> LogManager::readRecords(uint64_t from) {
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(from)) {
+      PULSEDB_LOG_ERROR(logger, "failed to get log size: {}", std::strerror(errno));
+      return {};
+    }
+
+    std::vector<uint8_t> records(static_cast<size_t>(st.st_size - static_cast<off_t>(from)));
+    for (size_t done = 0; done < records.size();) {
+      const ssize_t n = ::pread(fd, records.data() + done, records.size() - done, from + done);
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+
+      if (n <= 0) {
+        records.resize(done);
+        break;
+      }
+
+      done += n;
+    }
+
+    // Keep records up to the first one that is torn or doesn't belong where it is.
+    size_t pos = 0;
+    while (const size_t size = intact(records.data() + pos, records.size() - pos, from + pos)) {
+      pos += size;
+    }
+
+    if (pos < records.size()) {
+      logger.warn("truncating {} bytes of torn log tail", records.size() - pos);
+      records.resize(pos);
+
+      if (::ftruncate(fd, static_cast<off_t>(from + pos)) != 0) {
+        PULSEDB_LOG_ERROR(logger, "failed to truncate log: {}", std::strerror(errno));
+      }
+    }
+
+    return records;
+  }
+
+  std::optional<CheckpointRecord> LogManager::readCheckpoint(uint64_t lsn) {
+    if (lsn < FILE_HEADER_SIZE + CHECKPOINT_SIZE) {
+      return std::nullopt;
+    }
+
+    uint8_t bytes[CHECKPOINT_SIZE];
+    const uint64_t offset = lsn - CHECKPOINT_SIZE;
+    if (::pread(fd, bytes, sizeof(bytes), static_cast<off_t>(offset)) !=
+            static_cast<ssize_t>(sizeof(bytes)) ||
+        intact(bytes, sizeof(bytes), offset) != CHECKPOINT_SIZE) {
+      return std::nullopt;
+    }
+
+    LogRecordHeader header;
+    std::memcpy(&header, bytes, RECORD_HEADER_SIZE);
+    if (header.type != LogRecordType::CHECKPOINT) {
+      return std::nullopt;
+    }
+
+    CheckpointRecord record;
+    std::memcpy(&record, bytes + RECORD_HEADER_SIZE, sizeof(record));
+    return record;
+  }
+
+  size_t LogManager::intact(const uint8_t *bytes, size_t available, uint64_t offset) noexcept {
+    if (available < RECORD_HEADER_SIZE) {
+      return 0;
+    }
+
+    LogRecordHeader header;
+    std::memcpy(&header, bytes, RECORD_HEADER_SIZE);
+
+    if (header.size != RECORD_HEADER_SIZE + header.length || header.size > available ||
+        header.lsn != offset + header.size ||
+        header.offset + header.length > storage::Page::PAGE_SIZE) {
+      return 0;
+    }
+
+    const uint32_t checksum = header.checksum;
+    header.checksum = 0;
+
+    uint32_t crc = utils::crc32(&header, RECORD_HEADER_SIZE);
+    crc = utils::crc32(bytes + RECORD_HEADER_SIZE, header.length, crc);
+    return crc == checksum ? header.size : 0;
+  }
+
+  bool LogManager::writeAt(const std::vector<uint8_t> &buffer, uint64_t offset) noexcept {
+    const uint8_t *in = buffer.data();
+    size_t size = buffer.size();
+
+    while (size > 0) {
+      const ssize_t n = ::pwrite(fd, in, size, static_cast<off_t>(offset));
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+
+      if (n <= 0) {
+        return false;
+      }
+
+      in += n;
+      size -= n;
+      offset += n;
+    }
+
+    return true;
+  }
+} // namespace pulse::wal
@@ -35,6 +35,16 @@ TEST_CASE("LRUReplacer basic operations", "[cache][policies][lru]") {
     replacer.pin(1);
     REQUIRE_FALSE(replacer.victim());
   }
+
+  SECTION("victim requests are counted") {
+    replacer.unpin(1);
+    REQUIRE(replacer.victim());
+    REQUIRE_FALSE(replacer.victim());
+
+    const ReplacerStats stats = replacer.stats();
+    REQUIRE(stats.victims == 1);
+    REQUIRE(stats.exhausted == 1);
+  }
 }
 
 TEST_CASE("LRUReplacer LRU ordering", "[cache][policies][lru]") {
@@ -111,6 +121,20 @@ TEST_CASE("LRUReplacer concurrent frame handling", "[cache][policies][lru]") {
   }
 }
 
+TEST_CASE("LRUReplacer candidates", "[cache][policies][lru]") {
+  LRUReplacer replacer;
+  replacer.unpin(1);
+  replacer.unpin(2);
+  replacer.unpin(3);
+  replacer.unpin(1);
+
+  REQUIRE(replacer.candidates(8) == std::vector<size_t>{2, 3, 1});
+  REQUIRE(replacer.candidates(2) == std::vector<size_t>{2, 3});
+
+  // Peeking doesn't change what gets evicted.
+  REQUIRE(*replacer.victim() == 2);
+}
+
 TEST_CASE("LRUReplacer edge cases", "[cache][policies][lru]") {
   LRUReplacer replacer;
 
@@ -0,0 +1,123 @@
+/**
+ * @file tests/pulsedb/cache/policies/test_two_q_replacer.cpp
+ * @brief Test cases for TwoQReplacer class.
+ */
+
+#include "pulsedb/cache/policies/two_q_replacer.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+using namespace pulse::cache;
+
+TEST_CASE("TwoQReplacer basic operations", "[cache][policies][two_q]") {
+  TwoQReplacer replacer(8);
+
+  SECTION("initial state") { REQUIRE_FALSE(replacer.victim()); }
+
+  SECTION("single frame") {
+    replacer.unpin(1);
+    auto victim = replacer.victim();
+
+    REQUIRE(victim);
+    REQUIRE(*victim == 1);
+    REQUIRE_FALSE(replacer.victim());
+  }
+
+  SECTION("pin unpinned frame") {
+    replacer.unpin(1);
+    replacer.pin(1);
+    REQUIRE_FALSE(replacer.victim());
+  }
+
+  SECTION("pin non-existent frame") {
+    replacer.pin(1);
+    REQUIRE_FALSE(replacer.victim());
+  }
+
+  SECTION("frames beyond capacity are ignored") {
+    replacer.unpin(8);
+    replacer.pin(100);
+    REQUIRE_FALSE(replacer.victim());
+  }
+}
+
+TEST_CASE("TwoQReplacer queue ordering", "[cache][policies][two_q]") {
+  TwoQReplacer replacer(8);
+
+  SECTION("probation is FIFO") {
+    replacer.unpin(1);
+    replacer.unpin(2);
+    replacer.unpin(3);
+
+    REQUIRE(*replacer.victim() == 1);
+    REQUIRE(*replacer.victim() == 2);
+    REQUIRE(*replacer.victim() == 3);
+    REQUIRE_FALSE(replacer.victim());
+  }
+
+  SECTION("main is LRU") {
+    for (size_t i = 0; i < 3; i++) {
+      replacer.unpin(i);
+      replacer.unpin(i);
+    }
+
+    replacer.unpin(0);
+
+    REQUIRE(*replacer.victim() == 1);
+    REQUIRE(*replacer.victim() == 2);
+    REQUIRE(*replacer.victim() == 0);
+  }
+
+  SECTION("pin forgets history") {
+    replacer.unpin(1);
+    replacer.unpin(1);
+    replacer.pin(1);
+
+    // Back on probation as the oldest frame, rather than in main.
+    for (size_t i = 1; i <= 4; i++) {
+      replacer.unpin(i);
+    }
+
+    REQUIRE(*replacer.victim() == 1);
+    REQUIRE(*replacer.victim() == 2);
+  }
+}
+
+TEST_CASE("TwoQReplacer scan resistance", "[cache][policies][two_q]") {
+  const size_t numFrames = 16;
+  TwoQReplacer replacer(numFrames);
+
+  // A hot working set accessed twice.
+  for (size_t i = 0; i < 8; i++) {
+    replacer.unpin(i);
+    replacer.unpin(i);
+  }
+
+  // A scan touches the remaining frames once each.
+  for (size_t i = 8; i < numFrames; i++) {
+    replacer.unpin(i);
+  }
+
+  // Scan frames go first while probation holds more than its share.
+  for (size_t i = 8; i < numFrames - numFrames / 4; i++) {
+    REQUIRE(*replacer.victim() == i);
+  }
+
+  // Then the main queue takes over.
+  REQUIRE(*replacer.victim() == 0);
+}
+
+TEST_CASE("TwoQReplacer candidates", "[cache][policies][two_q]") {
+  TwoQReplacer replacer(8);
+  for (size_t i = 0; i < 4; i++) {
+    replacer.unpin(i);
+  }
+
+  replacer.unpin(0);
+  replacer.unpin(1);
+
+  // Probation holds 2 and 3, within its share, so main goes first from least recent.
+  REQUIRE(replacer.candidates(8) == std::vector<size_t>{0, 1, 2, 3});
+  for (size_t expected : replacer.candidates(8)) {
+    REQUIRE(*replacer.victim() == expected);
+  }
+}
@@ -0,0 +1,273 @@
+/**
+ * @file tests/pulsedb/cache/test_background_writer.cpp
+ * @brief Test cases for BackgroundWriter class.
+ */
+
+#include "pulsedb/cache/background_writer.hpp"
+#include "pulsedb/storage/data_page.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+using namespace pulse::storage;
+using namespace pulse::cache;
+namespace fs = std::filesystem;
+
+namespace {
+  const fs::path writerPath = "test_writer.db";
+  const fs::path writerLogPath = "test_writer.db.wal";
+
+  void cleanupWriter() {
+    for (const auto &path : {writerPath, writerLogPath}) {
+      if (fs::exists(path)) {
+        fs::remove(path);
+      }
+    }
+  }
+
+  /**
+   * @brief Poll a condition until it holds or a second has passed.
+   */
+  template <typename F> bool eventually(F &&condition) {
+    for (int i = 0; i < 200 && !condition(); i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    return condition();
+  }
+} // namespace
+
+TEST_CASE("BufferPool write-back", "[cache][background_writer]") {
+  cleanupWriter();
+  DiskManager dm(writerPath, true);
+  BufferPool pool(dm, 8);
+
+  std::vector<uint32_t> pageIds;
+  for (size_t i = 0; i < 8; i++) {
+    auto *page = pool.createPage(PageType::DATA);
+    REQUIRE(page != nullptr);
+
+    pageIds.push_back(page->id());
+    pool.unpinPage(page->id(), true);
+  }
+
+  REQUIRE(pool.dirtyRatio() == 1.0);
+
+  SECTION("eviction candidates only") {
+    REQUIRE(pool.writeBack(8, 2, false) == 2);
+    REQUIRE(pool.dirtyRatio() == 0.75);
+  }
+
+  SECTION("eager") {
+    REQUIRE(pool.writeBack(8, 0, true) == 8);
+    REQUIRE(pool.dirtyRatio() == 0.0);
+    REQUIRE(pool.writeBack(8, 0, true) == 0);
+  }
+
+  SECTION("limit") {
+    REQUIRE(pool.writeBack(3, 8, true) == 3);
+    REQUIRE(pool.dirtyRatio() == 5.0 / 8.0);
+  }
+
+  SECTION("pinned pages are skipped") {
+    for (uint32_t pageId : pageIds) {
+      REQUIRE(pool.fetchPage(pageId) != nullptr);
+    }
+
+    REQUIRE(pool.writeBack(8, 8, true) == 0);
+
+    for (uint32_t pageId : pageIds) {
+      pool.unpinPage(pageId, false);
+    }
+  }
+
+  SECTION("written pages survive eviction") {
+    auto *page = static_cast<DataPage *>(pool.fetchPage(pageIds[0]));
+    const char value[] = "written back";
+    auto slotId = page->insertRecord(1, value, sizeof(value), 1);
+    REQUIRE(slotId);
+    pool.unpinPage(pageIds[0], true);
+
+    REQUIRE(pool.writeBack(8, 0, true) == 8);
+
+    // Evict everything, the clean frames are dropped without another write.
+    for (size_t i = 0; i < 8; i++) {
+      auto *filler = pool.createPage(PageType::DATA);
+      REQUIRE(filler != nullptr);
+      pool.unpinPage(filler->id(), false);
+    }
+
+    page = static_cast<DataPage *>(pool.fetchPage(pageIds[0]));
+    REQUIRE(page != nullptr);
+
+    auto record = page->getRecord(*slotId);
+    REQUIRE(record);
+    REQUIRE(std::memcmp(record->first, value, sizeof(value)) == 0);
+    pool.unpinPage(pageIds[0], false);
+  }
+
+  cleanupWriter();
+}
+
+TEST_CASE("BufferPool compaction", "[cache][background_writer]") {
+  cleanupWriter();
+  DiskManager dm(writerPath, true);
+  BufferPool pool(dm, 8);
+
+  auto *page = static_cast<DataPage *>(pool.createPage(PageType::DATA));
+  REQUIRE(page != nullptr);
+  const uint32_t pageId = page->id();
+
+  const std::string data(100, 'x');
+  for (uint32_t i = 0; i < 10; i++) {
+    REQUIRE(page->insertRecord(i, data.c_str(), 100, 1));
+  }
+
+  for (uint16_t slotId = 0; slotId < 10; slotId += 2) {
+    REQUIRE(page->deleteRecord(slotId));
+  }
+
+  REQUIRE(page->needsCompact());
+
+  SECTION("pinned pages are left alone") {
+    REQUIRE(pool.compact(8) == 0);
+    REQUIRE(page->needsCompact());
+    pool.unpinPage(pageId, true);
+  }
+
+  SECTION("unpinned pages are compacted and stay dirty") {
+    pool.unpinPage(pageId, true);
+    REQUIRE(pool.compact(8) == 1);
+    REQUIRE(pool.compact(8) == 0);
+    REQUIRE(pool.dirtyRatio() > 0.0);
+
+    auto guard = pool.readPage<DataPage>(pageId);
+    REQUIRE(guard);
+    REQUIRE(guard->deadBytes() == 0);
+    REQUIRE(guard->getRecord(1));
+  }
+
+  SECTION("the background writer compacts before writing") {
+    pool.unpinPage(pageId, true);
+
+    WriterConfig config;
+    config.interval = std::chrono::milliseconds(1);
+
+    BackgroundWriter writer(pool, config);
+    REQUIRE(eventually([&writer] { return writer.pagesCompacted() == 1; }));
+    writer.stop();
+  }
+
+  cleanupWriter();
+}
+
+TEST_CASE("BackgroundWriter", "[cache][background_writer]") {
+  cleanupWriter();
+  DiskManager dm(writerPath, true);
+  BufferPool pool(dm, 32, 2);
+
+  for (size_t i = 0; i < 32; i++) {
+    auto *page = pool.createPage(PageType::DATA);
+    REQUIRE(page != nullptr);
+    pool.unpinPage(page->id(), true);
+  }
+
+  SECTION("drains to the low watermark") {
+    WriterConfig config;
+    config.lowRatio = 0.25;
+    config.highRatio = 0.5;
+    config.lookahead = 0;
+    config.interval = std::chrono::milliseconds(1);
+
+    BackgroundWriter writer(pool, config);
+    REQUIRE(eventually([&pool, &config] { return pool.dirtyRatio() <= config.lowRatio; }));
+
+    writer.stop();
+    REQUIRE(writer.pagesWritten() >= 24);
+  }
+
+  SECTION("keeps eviction candidates clean below the watermark") {
+    WriterConfig config;
+    config.highRatio = 2.0; // Never eager.
+    config.lookahead = 4;
+    config.interval = std::chrono::milliseconds(1);
+
+    BackgroundWriter writer(pool, config);
+    REQUIRE(eventually([&writer] { return writer.pagesWritten() >= 8; }));
+
+    writer.stop();
+    REQUIRE(pool.dirtyRatio() == 24.0 / 32.0);
+  }
+
+  SECTION("rate limit") {
+    WriterConfig config;
+    config.lowRatio = 0.0;
+    config.highRatio = 0.0;
+    config.maxPagesPerSecond = 4;
+    config.interval = std::chrono::milliseconds(1);
+
+    BackgroundWriter writer(pool, config);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    writer.stop();
+
+    // One second of burst, plus whatever trickled in since.
+    REQUIRE(writer.pagesWritten() >= 4);
+    REQUIRE(writer.pagesWritten() <= 5);
+  }
+
+  SECTION("checkpoints the log") {
+    pulse::wal::LogManager log(writerLogPath, true);
+    pool.attachLog(&log);
+
+    WriterConfig config;
+    config.interval = std::chrono::milliseconds(1);
+    config.checkpointInterval = std::chrono::milliseconds(1);
+
+    BackgroundWriter writer(pool, config);
+    REQUIRE(eventually([&writer] { return writer.checkpointsTaken() >= 2; }));
+
+    writer.stop();
+    pool.attachLog(nullptr);
+    REQUIRE(log.checkpointLsn() > 0);
+  }
+
+  SECTION("runs alongside fetches") {
+    WriterConfig config;
+    config.lowRatio = 0.0;
+    config.highRatio = 0.0;
+    config.interval = std::chrono::milliseconds(1);
+
+    BackgroundWriter writer(pool, config);
+    std::vector<std::thread> threads;
+
+    for (size_t t = 0; t < 4; t++) {
+      threads.emplace_back([&pool, t]() {
+        for (size_t i = 0; i < 500; i++) {
+          const auto pageId = static_cast<uint32_t>((t * 7 + i) % 48);
+          if (pageId >= 32) {
+            auto *page = pool.createPage(PageType::DATA);
+            if (page != nullptr) {
+              pool.unpinPage(page->id(), true);
+            }
+
+            continue;
+          }
+
+          if (pool.fetchPage(pageId) != nullptr) {
+            pool.unpinPage(pageId, true);
+          }
+        }
+      });
+    }
+
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    writer.stop();
+  }
+
+  cleanupWriter();
+}
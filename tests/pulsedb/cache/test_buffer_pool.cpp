@@ -5,8 +5,10 @@
 
 #include "pulsedb/cache/buffer_pool.hpp"
 #include "pulsedb/storage/index_page.hpp"
+#include <atomic>
 #include <catch2/catch_test_macros.hpp>
 #include <filesystem>
+#include <fstream>
 #include <random>
 #include <thread>
 
@@ -70,6 +72,23 @@ TEST_CASE("BufferPool basic operations", "[cache][buffer_pool]") {
     pool.unpinPage(internalPage->id(), false);
   }
 
+  SECTION("latch pinned pages") {
+    auto *page = pool.createPage(PageType::DATA);
+    REQUIRE(page != nullptr);
+
+    // Shared latches stack, the exclusive one waits for them.
+    REQUIRE(pool.latchPage(page->id(), false));
+    REQUIRE(pool.latchPage(page->id(), false));
+    REQUIRE(pool.unlatchPage(page->id(), false));
+    REQUIRE(pool.unlatchPage(page->id(), false));
+
+    REQUIRE(pool.latchPage(page->id(), true));
+    REQUIRE(pool.unlatchPage(page->id(), true));
+
+    pool.unpinPage(page->id(), false);
+    REQUIRE_FALSE(pool.latchPage(1000, false));
+  }
+
   cleanup();
 }
 
@@ -90,6 +109,28 @@ TEST_CASE("BufferPool page management", "[cache][buffer_pool]") {
     REQUIRE(pool.fetchPage(pageId) == nullptr);
   }
 
+  SECTION("retired pages are freed once unpinned") {
+    auto *page = pool.createPage(PageType::DATA);
+    REQUIRE(page != nullptr);
+
+    const uint32_t pageId = page->id();
+    const uint32_t freed = dm.freePageCount();
+
+    REQUIRE(pool.retirePage(pageId));
+    REQUIRE(dm.freePageCount() == freed);
+    REQUIRE(pool.unpinPage(pageId, true));
+    REQUIRE(dm.freePageCount() == freed + 1);
+    REQUIRE(pool.fetchPage(pageId) == nullptr);
+
+    // Unpinned pages go at once, like deletePage.
+    auto *other = pool.createPage(PageType::DATA);
+    REQUIRE(other != nullptr);
+    REQUIRE(pool.unpinPage(other->id(), false));
+    const uint32_t reused = dm.freePageCount();
+    REQUIRE(pool.retirePage(other->id()));
+    REQUIRE(dm.freePageCount() == reused + 1);
+  }
+
   SECTION("dirty page handling") {
     auto *page = pool.createPage(PageType::DATA);
 
@@ -99,6 +140,71 @@ TEST_CASE("BufferPool page management", "[cache][buffer_pool]") {
     REQUIRE(pool.deletePage(page->id()));
   }
 
+  SECTION("flushes leave pages a writer holds alone") {
+    const uint32_t pageId = pool.newPage<IndexPage>().pageId();
+    REQUIRE(pool.flushPage(pageId));
+
+    REQUIRE(pool.writePage<IndexPage>(pageId)->insertKey(1, 10));
+    {
+      auto guard = pool.writePage<IndexPage>(pageId);
+      REQUIRE(guard->insertKey(2, 20));
+      REQUIRE_FALSE(pool.flushPage(pageId));
+      pool.flushAll();
+    }
+
+    // The writes the flushes skipped are still there to be written.
+    REQUIRE(pool.dirtyRatio() > 0.0);
+    pool.flushAll();
+    REQUIRE(pool.dirtyRatio() == 0.0);
+
+    auto page = dm.fetchPage(pageId);
+    REQUIRE(page != nullptr);
+    REQUIRE(static_cast<IndexPage *>(page.get())->lookup(1) == 10u);
+    REQUIRE(static_cast<IndexPage *>(page.get())->lookup(2) == 20u);
+  }
+
+  SECTION("pages reuse the frame buffers") {
+    BufferPool single(dm, 1);
+    auto *first = single.createPage(PageType::INDEX, true);
+    REQUIRE(first != nullptr);
+    REQUIRE_FALSE(first->ownsBuffer());
+
+    const uint32_t firstId = first->id();
+    REQUIRE(static_cast<IndexPage *>(first)->insertKey(9, 90));
+    REQUIRE(single.unpinPage(firstId, true));
+
+    // Evicting the page writes it out and frees the only frame for the next one.
+    auto *second = single.createPage(PageType::DATA);
+    REQUIRE(second != nullptr);
+    REQUIRE(second->type() == PageType::DATA);
+    REQUIRE(single.unpinPage(second->id(), true));
+
+    // Reading the first page back lands in the same frame, with no page of its own.
+    auto *reread = single.fetchPage(firstId);
+    REQUIRE(reread != nullptr);
+    REQUIRE_FALSE(reread->ownsBuffer());
+    REQUIRE(reread->type() == PageType::INDEX);
+    REQUIRE(static_cast<IndexPage *>(reread)->lookup(9) == 90u);
+    REQUIRE(single.unpinPage(firstId, false));
+  }
+
+  SECTION("prefetching skips resident pages") {
+    auto *page = pool.createPage(PageType::DATA);
+    REQUIRE(page != nullptr);
+
+    const uint32_t residentId = page->id();
+    REQUIRE(pool.unpinPage(residentId, true));
+    REQUIRE(pool.flushPage(residentId));
+
+    // The page on disk but not in the pool is the only one to read ahead.
+    DataPage evicted(dm.allocatePage());
+    REQUIRE(dm.flushPage(evicted));
+
+    const uint32_t pageIds[] = {residentId, evicted.id()};
+    REQUIRE(pool.prefetch(pageIds) == 1);
+    REQUIRE(pool.prefetch(std::span(pageIds, 1)) == 0);
+  }
+
   cleanup();
 }
 
@@ -175,6 +281,42 @@ TEST_CASE("BufferPool concurrent access", "[cache][buffer_pool]") {
     }
   }
 
+  SECTION("parallel misses on the same page") {
+    auto *page = pool.createPage(PageType::DATA);
+    REQUIRE(page != nullptr);
+
+    uint32_t pageId = page->id();
+    REQUIRE(pool.unpinPage(pageId, true));
+
+    // Push the page out so every thread below misses on it.
+    for (size_t i = 0; i < poolSize; i++) {
+      auto *filler = pool.createPage(PageType::DATA);
+      REQUIRE(filler != nullptr);
+      pool.unpinPage(filler->id(), false);
+    }
+
+    const size_t numThreads = 8;
+    std::vector<std::thread> threads;
+    std::vector<Page *> results(numThreads);
+
+    for (size_t i = 0; i < numThreads; i++) {
+      threads.emplace_back([&pool, &results, pageId, i]() {
+        results[i] = pool.fetchPage(pageId);
+      });
+    }
+
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    // Everyone must see the same frame, the page was only read once.
+    for (auto *result : results) {
+      REQUIRE(result != nullptr);
+      REQUIRE(result == results.front());
+      pool.unpinPage(pageId, false);
+    }
+  }
+
   SECTION("parallel creates and fetches") {
     const size_t numThreads = 5;
     std::vector<std::thread> threads;
@@ -243,3 +385,594 @@ TEST_CASE("BufferPool edge cases", "[cache][buffer_pool]") {
 
   cleanup();
 }
+
+TEST_CASE("BufferPool sharding", "[cache][buffer_pool]") {
+  cleanup();
+  DiskManager dm(testPath, true);
+
+  SECTION("shard count is clamped") {
+    BufferPool none(dm, poolSize, 0);
+    REQUIRE(none.shardCount() == 1);
+
+    BufferPool tooMany(dm, poolSize, poolSize * 2);
+    REQUIRE(tooMany.shardCount() == poolSize);
+  }
+
+  SECTION("pages spread across shards") {
+    const size_t shards = 4;
+    BufferPool pool(dm, shards * 4, shards);
+    REQUIRE(pool.shardCount() == shards);
+
+    std::vector<uint32_t> pageIds;
+    for (size_t i = 0; i < shards * 4; i++) {
+      auto *page = pool.createPage(PageType::DATA);
+      REQUIRE(page != nullptr);
+
+      pageIds.push_back(page->id());
+      REQUIRE(pool.unpinPage(page->id(), true));
+    }
+
+    REQUIRE(pool.size() == shards * 4);
+
+    // Each shard is full, so one more page per shard evicts within that shard only.
+    for (size_t i = 0; i < shards; i++) {
+      auto *page = pool.createPage(PageType::DATA);
+      REQUIRE(page != nullptr);
+      REQUIRE(pool.unpinPage(page->id(), false));
+    }
+
+    REQUIRE(pool.size() == shards * 4);
+
+    // Evicted pages were written back and can be read again.
+    for (uint32_t pageId : pageIds) {
+      auto *page = pool.fetchPage(pageId);
+      REQUIRE(page != nullptr);
+      REQUIRE(page->id() == pageId);
+      REQUIRE(pool.unpinPage(pageId, false));
+    }
+  }
+
+  SECTION("concurrent hits on different shards") {
+    BufferPool pool(dm, 64, 8);
+    std::vector<uint32_t> pageIds;
+
+    for (size_t i = 0; i < 32; i++) {
+      auto *page = pool.createPage(PageType::DATA);
+      REQUIRE(page != nullptr);
+
+      pageIds.push_back(page->id());
+      pool.unpinPage(page->id(), false);
+    }
+
+    std::vector<std::thread> threads;
+    std::atomic<size_t> failures = 0;
+
+    for (size_t t = 0; t < 8; t++) {
+      threads.emplace_back([&pool, &pageIds, &failures, t]() {
+        for (size_t i = 0; i < 1000; i++) {
+          uint32_t pageId = pageIds[(t + i * 8) % pageIds.size()];
+          if (pool.fetchPage(pageId) == nullptr) {
+            failures++;
+            continue;
+          }
+
+          pool.unpinPage(pageId, false);
+        }
+      });
+    }
+
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    REQUIRE(failures == 0);
+  }
+
+  SECTION("lock-free hits race with evictions") {
+    BufferPool pool(dm, 8, 2);
+    std::vector<uint32_t> pageIds;
+
+    for (size_t i = 0; i < 32; i++) {
+      auto *page = pool.createPage(PageType::DATA);
+      REQUIRE(page != nullptr);
+
+      pageIds.push_back(page->id());
+      pool.unpinPage(page->id(), true);
+    }
+
+    std::vector<std::thread> threads;
+    std::atomic<size_t> wrong = 0;
+
+    // Far more pages than frames, so hits keep running into frames that are being evicted.
+    for (size_t t = 0; t < 4; t++) {
+      threads.emplace_back([&pool, &pageIds, &wrong, t]() {
+        std::mt19937 rng(static_cast<uint32_t>(t));
+        for (size_t i = 0; i < 2000; i++) {
+          uint32_t pageId = pageIds[rng() % pageIds.size()];
+          auto *page = pool.fetchPage(pageId);
+          if (page == nullptr) {
+            continue;
+          }
+
+          if (page->id() != pageId) {
+            wrong++;
+          }
+
+          pool.unpinPage(pageId, false);
+        }
+      });
+    }
+
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    REQUIRE(wrong == 0);
+    REQUIRE(pool.size() <= 8);
+  }
+
+  cleanup();
+}
+
+TEST_CASE("BufferPool optimistic reads", "[cache][buffer_pool]") {
+  cleanup();
+  DiskManager dm(testPath, true);
+  BufferPool pool(dm, poolSize);
+
+  std::vector<uint32_t> pageIds;
+  for (size_t i = 0; i < poolSize; i++) {
+    auto *page = pool.createPage(PageType::INDEX, true);
+    REQUIRE(page != nullptr);
+
+    pageIds.push_back(page->id());
+    pool.unpinPage(page->id(), true);
+  }
+
+  SECTION("resident pages are read without a pin") {
+    const PoolStats before = pool.stats();
+    auto read = pool.readOptimistic(pageIds[0]);
+    REQUIRE(read);
+    REQUIRE(read->valid());
+
+    auto probe = IndexPage::probe(read->bytes, 1);
+    REQUIRE(probe);
+    REQUIRE(probe->pageId == pageIds[0]);
+
+    // The read leaves the pins and the counters alone.
+    REQUIRE(pool.stats().hits == before.hits);
+    REQUIRE(pool.stats().misses == before.misses);
+  }
+
+  SECTION("pages that aren't resident") {
+    REQUIRE_FALSE(pool.readOptimistic(1000));
+  }
+
+  SECTION("swips remember the frame") {
+    Swip swip{nullptr};
+    auto read = pool.readOptimistic(pageIds[2], &swip);
+    REQUIRE(read);
+    REQUIRE(swip.load() == read->frame);
+
+    auto again = pool.readOptimistic(pageIds[2], &swip);
+    REQUIRE(again);
+    REQUIRE(again->frame == read->frame);
+
+    // A swip naming a frame that holds another page is pointed at the right one.
+    auto other = pool.readOptimistic(pageIds[3]);
+    REQUIRE(other);
+    swip.store(other->frame);
+
+    again = pool.readOptimistic(pageIds[2], &swip);
+    REQUIRE(again);
+    REQUIRE(again->frame == read->frame);
+    REQUIRE(swip.load() == read->frame);
+  }
+
+  SECTION("exclusive latches invalidate reads") {
+    auto read = pool.readOptimistic(pageIds[1]);
+    REQUIRE(read);
+
+    auto *page = pool.fetchPage(pageIds[1]);
+    REQUIRE(page != nullptr);
+    REQUIRE(pool.latchPage(pageIds[1], true));
+
+    // Nothing can be read while the page is latched, and the older read fails once it's released.
+    REQUIRE_FALSE(pool.readOptimistic(pageIds[1]));
+    REQUIRE(pool.unlatchPage(pageIds[1], true));
+    REQUIRE_FALSE(read->valid());
+    REQUIRE(pool.readOptimistic(pageIds[1]));
+
+    // Shared latches don't change the page.
+    read = pool.readOptimistic(pageIds[1]);
+    REQUIRE(pool.latchPage(pageIds[1], false));
+    REQUIRE(pool.unlatchPage(pageIds[1], false));
+    REQUIRE(read->valid());
+    pool.unpinPage(pageIds[1], false);
+  }
+
+  SECTION("evictions invalidate reads") {
+    auto read = pool.readOptimistic(pageIds[0]);
+    REQUIRE(read);
+
+    auto *extra = pool.createPage(PageType::DATA);
+    REQUIRE(extra != nullptr);
+    pool.unpinPage(extra->id(), true);
+
+    REQUIRE(pool.stats().evictions == 1);
+    REQUIRE_FALSE(read->valid());
+    REQUIRE_FALSE(pool.readOptimistic(pageIds[0]));
+  }
+
+  SECTION("swips left by evictions") {
+    Swip swip{nullptr};
+    REQUIRE(pool.readOptimistic(pageIds[0], &swip));
+
+    // The swip's frame now holds the new page, so it no longer leads to the evicted one.
+    auto *extra = pool.createPage(PageType::DATA);
+    REQUIRE(extra != nullptr);
+    pool.unpinPage(extra->id(), true);
+    REQUIRE_FALSE(pool.readOptimistic(pageIds[0], &swip));
+
+    REQUIRE(pool.fetchPage(pageIds[0]) != nullptr);
+    pool.unpinPage(pageIds[0], false);
+
+    auto read = pool.readOptimistic(pageIds[0], &swip);
+    REQUIRE(read);
+    REQUIRE(swip.load() == read->frame);
+    REQUIRE(read->frame->holds(pageIds[0]));
+  }
+
+  cleanup();
+}
+
+namespace {
+  /**
+   * @brief Run work on a thread that takes itself for one on the given NUMA node.
+   */
+  template <typename F>
+  void onNode(size_t node, F &&work) {
+    std::thread thread([node, &work] {
+      pulse::utils::setThreadNode(node);
+      work();
+    });
+
+    thread.join();
+  }
+} // namespace
+
+TEST_CASE("BufferPool NUMA partitions", "[cache][buffer_pool]") {
+  cleanup();
+  DiskManager dm(testPath, true);
+
+  SECTION("nodes split the frames and shards") {
+    BufferPool pool(dm, poolSize, 4, ReplacerPolicy::LRU, 2);
+    REQUIRE(pool.nodeCount() == 2);
+    REQUIRE(pool.shardCount() == 4);
+
+    // Every node keeps at least one shard and one frame.
+    BufferPool few(dm, poolSize, 1, ReplacerPolicy::LRU, 3);
+    REQUIRE(few.shardCount() == 3);
+    REQUIRE(BufferPool(dm, 2, 1, ReplacerPolicy::LRU, 4).nodeCount() == 2);
+    REQUIRE(BufferPool(dm, poolSize, 1, ReplacerPolicy::LRU, BufferPool::ALL_NODES).nodeCount() ==
+            pulse::utils::numaNodes());
+  }
+
+  SECTION("pages go to the faulting thread's node") {
+    BufferPool pool(dm, 8, 2, ReplacerPolicy::LRU, 2);
+    std::vector<uint32_t> pageIds;
+
+    // Node 0 only has half the frames, so the first pages it makes are evicted.
+    onNode(0, [&pool, &pageIds] {
+      for (size_t i = 0; i < 8; i++) {
+        auto *page = pool.createPage(PageType::DATA);
+        if (page) {
+          pageIds.push_back(page->id());
+          pool.unpinPage(page->id(), true);
+        }
+      }
+    });
+
+    REQUIRE(pageIds.size() == 8);
+    REQUIRE_FALSE(pool.nodeOf(pageIds[0]));
+    REQUIRE(pool.nodeOf(pageIds[7]) == 0u);
+    REQUIRE(pool.size() == 4);
+
+    // A miss on node 1 lands there, a hit on node 0's page stays put.
+    bool fetched = false;
+    onNode(1, [&pool, &pageIds, &fetched] {
+      fetched = pool.fetchPage(pageIds[0]) && pool.unpinPage(pageIds[0], false) &&
+                pool.fetchPage(pageIds[7]) && pool.unpinPage(pageIds[7], false);
+    });
+
+    REQUIRE(fetched);
+    REQUIRE(pool.nodeOf(pageIds[0]) == 1u);
+    REQUIRE(pool.nodeOf(pageIds[7]) == 0u);
+    REQUIRE(pool.size() == 5);
+
+    const PoolStats stats = pool.stats();
+    REQUIRE(stats.misses == 1);
+    REQUIRE(stats.remoteHits == 1);
+
+    // Pages on another node can still be latched, flushed and deleted.
+    onNode(0, [&pool, &pageIds, &fetched] {
+      auto guard = pool.writePage<DataPage>(pageIds[0]);
+      fetched = static_cast<bool>(guard);
+    });
+
+    REQUIRE(fetched);
+    REQUIRE(pool.flushPage(pageIds[0]));
+    REQUIRE(pool.nodeOf(pageIds[0]) == 1u);
+    REQUIRE(pool.deletePage(pageIds[0]));
+    REQUIRE_FALSE(pool.nodeOf(pageIds[0]));
+  }
+
+  SECTION("concurrent misses from different nodes") {
+    BufferPool pool(dm, 16, 4, ReplacerPolicy::LRU, 2);
+    std::vector<uint32_t> pageIds;
+
+    for (size_t i = 0; i < 32; i++) {
+      auto *page = pool.createPage(PageType::DATA);
+      REQUIRE(page != nullptr);
+
+      pageIds.push_back(page->id());
+      pool.unpinPage(page->id(), true);
+    }
+
+    std::atomic<size_t> failures = 0;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; t++) {
+      threads.emplace_back([&pool, &pageIds, &failures, t] {
+        pulse::utils::setThreadNode(t % 2);
+        for (size_t i = 0; i < 2000; i++) {
+          const uint32_t pageId = pageIds[(i * 7 + t) % pageIds.size()];
+          auto *page = pool.fetchPage(pageId);
+          if (!page || page->id() != pageId) {
+            failures++;
+            continue;
+          }
+
+          pool.unpinPage(pageId, false);
+        }
+      });
+    }
+
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    REQUIRE(failures == 0);
+
+    // No page is ever held by two nodes at once.
+    size_t resident = 0;
+    for (uint32_t pageId : pageIds) {
+      resident += pool.nodeOf(pageId) ? 1 : 0;
+    }
+
+    REQUIRE(pool.size() == resident);
+  }
+
+  cleanup();
+}
+
+TEST_CASE("BufferPool replacement policies", "[cache][buffer_pool]") {
+  cleanup();
+  DiskManager dm(testPath, true);
+
+  for (auto policy : {ReplacerPolicy::LRU, ReplacerPolicy::CLOCK, ReplacerPolicy::TWO_Q}) {
+    BufferPool pool(dm, poolSize, 1, policy);
+    std::vector<uint32_t> pageIds;
+
+    for (size_t i = 0; i < poolSize * 3; i++) {
+      auto *page = pool.createPage(PageType::DATA);
+      REQUIRE(page != nullptr);
+
+      pageIds.push_back(page->id());
+      REQUIRE(pool.unpinPage(page->id(), true));
+    }
+
+    REQUIRE(pool.size() == poolSize);
+
+    // Every page survives eviction whatever order the policy picks.
+    for (uint32_t pageId : pageIds) {
+      auto *page = pool.fetchPage(pageId);
+      REQUIRE(page != nullptr);
+      REQUIRE(page->id() == pageId);
+      REQUIRE(pool.unpinPage(pageId, false));
+    }
+  }
+
+  cleanup();
+}
+
+TEST_CASE("BufferPool 2Q resists scans", "[cache][buffer_pool]") {
+  cleanup();
+  DiskManager dm(testPath, true);
+  BufferPool pool(dm, poolSize, 1, ReplacerPolicy::TWO_Q);
+
+  std::vector<uint32_t> hot;
+  std::vector<Page *> hotPages;
+  for (size_t i = 0; i < poolSize / 2; i++) {
+    auto *page = pool.createPage(PageType::DATA);
+    REQUIRE(page != nullptr);
+
+    hot.push_back(page->id());
+    hotPages.push_back(page);
+    pool.unpinPage(page->id(), true);
+  }
+
+  // Touch the hot pages again so they are promoted out of probation.
+  for (uint32_t pageId : hot) {
+    REQUIRE(pool.fetchPage(pageId) != nullptr);
+    pool.unpinPage(pageId, false);
+  }
+
+  // Scan many more pages than the pool holds.
+  for (size_t i = 0; i < poolSize * 4; i++) {
+    auto *page = pool.createPage(PageType::DATA);
+    REQUIRE(page != nullptr);
+    pool.unpinPage(page->id(), true);
+  }
+
+  // The hot pages were never evicted, so they are still in the same frames.
+  for (size_t i = 0; i < hot.size(); i++) {
+    REQUIRE(pool.fetchPage(hot[i]) == hotPages[i]);
+    pool.unpinPage(hot[i], false);
+  }
+
+  cleanup();
+}
+
+TEST_CASE("BufferPool statistics", "[cache][buffer_pool]") {
+  cleanup();
+  DiskManager dm(testPath, true);
+  BufferPool pool(dm, poolSize);
+
+  std::vector<uint32_t> pageIds;
+  for (size_t i = 0; i < poolSize; i++) {
+    auto *page = pool.createPage(PageType::DATA);
+    REQUIRE(page != nullptr);
+
+    pageIds.push_back(page->id());
+    pool.unpinPage(page->id(), true);
+  }
+
+  // Empty frames are taken without asking the replacer.
+  REQUIRE(pool.stats().evictions == 0);
+  REQUIRE(pool.stats().replacer.victims == 0);
+
+  SECTION("evictions, misses and hits") {
+    auto *extra = pool.createPage(PageType::DATA);
+    REQUIRE(extra != nullptr);
+    pool.unpinPage(extra->id(), true);
+
+    PoolStats stats = pool.stats();
+    REQUIRE(stats.evictions == 1);
+    REQUIRE(stats.dirtyEvictions == 1);
+    REQUIRE(stats.replacer.victims == 1);
+
+    // The first page was the one evicted, so it's read back.
+    REQUIRE(pool.fetchPage(pageIds[0]) != nullptr);
+    pool.unpinPage(pageIds[0], false);
+    REQUIRE(pool.fetchPage(pageIds[0]) != nullptr);
+    pool.unpinPage(pageIds[0], false);
+
+    stats = pool.stats();
+    REQUIRE(stats.misses == 1);
+    REQUIRE(stats.hits == 1);
+    REQUIRE(stats.evictions == 2);
+    REQUIRE(stats.fetchLatency.count == 1);
+    REQUIRE(dm.stats().pagesRead == 1);
+  }
+
+  SECTION("flushes are timed") {
+    REQUIRE(pool.flushPage(pageIds[0]));
+    pool.flushAll();
+
+    REQUIRE(pool.stats().flushLatency.count == 2);
+    REQUIRE(dm.stats().pagesWritten == poolSize);
+  }
+
+  SECTION("contended latches are counted") {
+    REQUIRE(pool.fetchPage(pageIds[0]) != nullptr);
+    REQUIRE(pool.latchPage(pageIds[0], true));
+
+    bool latched = false;
+    std::thread reader([&pool, &pageIds, &latched] {
+      latched = pool.latchPage(pageIds[0], false) && pool.unlatchPage(pageIds[0], false);
+    });
+
+    while (pool.stats().latchWaits == 0) {
+      std::this_thread::yield();
+    }
+
+    REQUIRE(pool.unlatchPage(pageIds[0], true));
+    reader.join();
+    REQUIRE(latched);
+    pool.unpinPage(pageIds[0], false);
+  }
+
+  SECTION("prometheus dump") {
+    REQUIRE(pool.fetchPage(pageIds[0]) != nullptr);
+    pool.unpinPage(pageIds[0], false);
+
+    const std::string text = pool.prometheus();
+    REQUIRE(text.find("# TYPE pulsedb_pool_hits_total counter\n") != std::string::npos);
+    REQUIRE(text.find("pulsedb_pool_hits_total 1\n") != std::string::npos);
+    REQUIRE(text.find("pulsedb_pool_misses_total 0\n") != std::string::npos);
+    REQUIRE(text.find("pulsedb_replacer_victims_total 0\n") != std::string::npos);
+    REQUIRE(text.find("pulsedb_disk_pages_read_total 0\n") != std::string::npos);
+    REQUIRE(text.find("pulsedb_pool_fetch_seconds_count 0\n") != std::string::npos);
+  }
+
+  cleanup();
+}
+
+TEST_CASE("BufferPool warm-up", "[cache][buffer_pool]") {
+  cleanup();
+  const fs::path warmPath = "test.db.warm";
+  DiskManager dm(testPath, true);
+  std::vector<uint32_t> pageIds;
+
+  {
+    BufferPool pool(dm, 16);
+    for (size_t i = 0; i < 16; i++) {
+      auto *page = pool.createPage(PageType::DATA);
+      REQUIRE(page != nullptr);
+      pageIds.push_back(page->id());
+      pool.unpinPage(page->id(), true);
+    }
+
+    // The first page ends up the hottest, the last the coldest.
+    for (size_t i = pageIds.size(); i-- > 0;) {
+      REQUIRE(pool.fetchPage(pageIds[i]) != nullptr);
+      pool.unpinPage(pageIds[i], false);
+    }
+
+    REQUIRE(pool.saveWarmup(warmPath));
+  }
+
+  SECTION("the hottest pages come back in order") {
+    BufferPool pool(dm, 8);
+    REQUIRE(pool.warmUp(warmPath, 4) == 8);
+    REQUIRE(pool.stats().misses == 8);
+
+    for (size_t i = 0; i < 8; i++) {
+      REQUIRE(pool.readOptimistic(pageIds[i]));
+    }
+
+    // The coldest page loaded is the first to go.
+    REQUIRE(pool.fetchPage(pageIds[8]) != nullptr);
+    pool.unpinPage(pageIds[8], false);
+
+    REQUIRE_FALSE(pool.readOptimistic(pageIds[7]));
+    for (size_t i = 0; i < 7; i++) {
+      REQUIRE(pool.readOptimistic(pageIds[i]));
+    }
+  }
+
+  SECTION("sharded pools warm up every shard") {
+    BufferPool pool(dm, 16, 4);
+    REQUIRE(pool.warmUp(warmPath) == 16);
+    REQUIRE(pool.size() == 16);
+  }
+
+  SECTION("missing or corrupt snapshots load nothing") {
+    BufferPool pool(dm, 8);
+    REQUIRE(pool.warmUp("test.db.missing") == 0);
+
+    // Flip a byte of the first page ID.
+    {
+      std::fstream file(warmPath, std::ios::binary | std::ios::in | std::ios::out);
+      file.seekg(12);
+      const char byte = static_cast<char>(file.get());
+      file.seekp(12);
+      file.put(static_cast<char>(byte ^ 0x7f));
+    }
+
+    REQUIRE(pool.warmUp(warmPath) == 0);
+    REQUIRE(pool.size() == 0);
+  }
+
+  fs::remove(warmPath);
+  cleanup();
+}
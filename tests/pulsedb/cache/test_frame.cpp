@@ -5,6 +5,7 @@
 
 #include "pulsedb/cache/frame.hpp"
 #include "pulsedb/storage/data_page.hpp"
+#include "pulsedb/storage/index_page.hpp"
 #include <catch2/catch_test_macros.hpp>
 
 using namespace pulse::storage;
@@ -22,16 +23,59 @@ TEST_CASE("Frame basic operations", "[cache][frame]") {
   }
 
   SECTION("reset with page") {
+    alignas(64) uint8_t buffer[Page::PAGE_SIZE];
     Frame frame;
-    auto page = std::make_unique<DataPage>(1);
-    auto *pagePtr = page.get();
+    frame.bind(buffer);
 
-    frame.reset(std::move(page));
+    auto &page = frame.create<DataPage>(1);
     REQUIRE(frame.id() == 1);
     REQUIRE(frame.pins() == 0);
     REQUIRE_FALSE(frame.isDirty());
-    REQUIRE(frame.getPage() == pagePtr);
+    REQUIRE(frame.getPage() == &page);
     REQUIRE(frame.isUnpinned());
+
+    frame.reset();
+    REQUIRE(frame.id() == 0);
+    REQUIRE(frame.getPage() == nullptr);
+    REQUIRE(frame.isEmpty());
+  }
+}
+
+TEST_CASE("Frame pages over its buffer", "[cache][frame]") {
+  alignas(64) uint8_t buffer[Page::PAGE_SIZE];
+  Frame frame;
+  frame.bind(buffer);
+
+  SECTION("created pages live in the buffer") {
+    auto &page = frame.create<IndexPage>(3, false, 2);
+    REQUIRE(frame.getBuffer() == buffer);
+    REQUIRE_FALSE(page.ownsBuffer());
+    REQUIRE(page.insertKey(5, 50));
+    REQUIRE(IndexPage(VIEW, buffer).lookup(5) == 50u);
+  }
+
+  SECTION("adopting the bytes in the buffer") {
+    {
+      DataPage page(buffer, 4);
+      REQUIRE(page.insertRecord(1, "one", 4, 0));
+    }
+
+    frame.load(4);
+    REQUIRE(frame.isLoading());
+    REQUIRE(frame.adopt());
+    REQUIRE_FALSE(frame.isLoading());
+    REQUIRE(frame.id() == 4);
+    REQUIRE(frame.getPage()->type() == PageType::DATA);
+
+    auto *page = static_cast<DataPage *>(frame.getPage());
+    REQUIRE(page->getSlotId(1));
+  }
+
+  SECTION("adopting an invalid page") {
+    Page page(buffer, 5, PageType::INVALID);
+    frame.load(5);
+    REQUIRE_FALSE(frame.adopt());
+    REQUIRE(frame.isEmpty());
   }
 }
 
@@ -59,6 +103,103 @@ TEST_CASE("Frame pin operations", "[cache][frame]") {
     REQUIRE(frame.unpin() == 0);
     REQUIRE(frame.pins() == 0);
   }
+
+  SECTION("lock") {
+    REQUIRE(frame.tryLock());
+    REQUIRE(frame.isLocked());
+    REQUIRE(frame.pins() == 0);
+
+    // Pins back off while locked, and the lock is exclusive.
+    REQUIRE_FALSE(frame.tryPin());
+    REQUIRE_FALSE(frame.tryLock());
+    REQUIRE(frame.pins() == 0);
+
+    frame.unlock();
+    REQUIRE_FALSE(frame.isLocked());
+    REQUIRE(frame.tryPin());
+    REQUIRE(frame.pins() == 1);
+  }
+
+  SECTION("lock pinned frame") {
+    frame.pin();
+    REQUIRE_FALSE(frame.tryLock());
+
+    frame.unpin();
+    REQUIRE(frame.tryLock());
+  }
+
+  SECTION("locking bumps the version") {
+    const uint64_t seen = frame.version();
+    REQUIRE(seen % 2 == 0);
+    REQUIRE(frame.validate(seen));
+
+    // The version is odd while the frame is locked, and moves on once it's unlocked.
+    REQUIRE(frame.tryLock());
+    REQUIRE(frame.version() % 2 == 1);
+    REQUIRE_FALSE(frame.validate(seen));
+
+    frame.unlock();
+    REQUIRE(frame.version() == seen + 2);
+    REQUIRE_FALSE(frame.validate(seen));
+    REQUIRE(frame.validate(frame.version()));
+
+    // A pin doesn't change the contents, so it leaves the version alone.
+    frame.pin();
+    frame.unpin();
+    REQUIRE(frame.validate(seen + 2));
+  }
+}
+
+TEST_CASE("Frame swips", "[cache][frame]") {
+  alignas(64) uint8_t buffer[Page::PAGE_SIZE];
+  Frame parent;
+  Frame child;
+  parent.bind(buffer);
+
+  SECTION("swips are kept per slot") {
+    Swip *first = parent.swip(0);
+    Swip *second = parent.swip(1);
+    REQUIRE(first != nullptr);
+    REQUIRE(first != second);
+    REQUIRE(parent.swip(0) == first);
+    REQUIRE(first->load() == nullptr);
+  }
+
+  SECTION("every child of a packed node has its own swip") {
+    // Packed entries fit more children than full-width ones, none of them may share a swip.
+    const size_t wide = IndexPage::minCapacity();
+    const size_t last = IndexPage::maxEntries() - 1;
+    REQUIRE(parent.swip(last) != nullptr);
+    REQUIRE(parent.swip(last) != parent.swip(last - wide));
+    REQUIRE(parent.swip(wide) != parent.swip(0));
+
+    parent.swip(0)->store(&child);
+    REQUIRE(parent.swip(wide)->load() == nullptr);
+    REQUIRE(parent.swip(last + 1) == nullptr);
+  }
+
+  SECTION("a new page drops the swips") {
+    parent.create<IndexPage>(1, false, 1);
+    parent.swip(3)->store(&child);
+
+    parent.create<IndexPage>(2, false, 1);
+    REQUIRE(parent.swip(3)->load() == nullptr);
+
+    parent.swip(3)->store(&child);
+    parent.reset();
+    REQUIRE(parent.swip(3)->load() == nullptr);
+  }
+
+  SECTION("frames tell which page they hold") {
+    REQUIRE_FALSE(parent.holds(0));
+
+    parent.create<DataPage>(5);
+    REQUIRE(parent.holds(5));
+    REQUIRE_FALSE(parent.holds(6));
+
+    parent.reset();
+    REQUIRE_FALSE(parent.holds(5));
+  }
 }
 
 TEST_CASE("Frame dirty flag operations", "[cache][frame]") {
@@ -0,0 +1,76 @@
+/**
+ * @file tests/pulsedb/cache/test_frame_arena.cpp
+ * @brief Test cases for FrameArena class.
+ */
+
+#include "pulsedb/cache/frame_arena.hpp"
+#include "pulsedb/utils/numa.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <cstring>
+
+using namespace pulse::storage;
+using namespace pulse::cache;
+
+TEST_CASE("FrameArena slots", "[cache][frame_arena]") {
+  SECTION("empty arena") {
+    FrameArena arena;
+    REQUIRE(arena.slotCount() == 0);
+    REQUIRE(arena.bytes() == 0);
+  }
+
+  SECTION("small arenas round to whole pages") {
+    FrameArena arena(3);
+    REQUIRE(arena.slotCount() == 3);
+    REQUIRE(arena.bytes() == 3 * Page::PAGE_SIZE);
+  }
+
+  SECTION("large arenas round to huge pages") {
+    const size_t count = FrameArena::HUGE_PAGE_SIZE / Page::PAGE_SIZE + 1;
+    FrameArena arena(count);
+    REQUIRE(arena.bytes() == 2 * FrameArena::HUGE_PAGE_SIZE);
+  }
+
+  SECTION("slots are contiguous, aligned and zeroed") {
+    FrameArena arena(16);
+    for (size_t i = 0; i < arena.slotCount(); i++) {
+      uint8_t *slot = arena.slot(i);
+      REQUIRE(reinterpret_cast<uintptr_t>(slot) % 64 == 0);
+      REQUIRE(slot == arena.slot(0) + i * Page::PAGE_SIZE);
+      REQUIRE(slot[0] == 0);
+      REQUIRE(slot[Page::PAGE_SIZE - 1] == 0);
+
+      // Every slot is writable without touching its neighbours.
+      std::memset(slot, static_cast<int>(i + 1), Page::PAGE_SIZE);
+    }
+
+    for (size_t i = 0; i < arena.slotCount(); i++) {
+      REQUIRE(arena.slot(i)[0] == i + 1);
+      REQUIRE(arena.slot(i)[Page::PAGE_SIZE - 1] == i + 1);
+    }
+  }
+
+  SECTION("binding to a node") {
+    FrameArena arena(4, 0);
+    REQUIRE(arena.isBound() == (pulse::utils::numaNodes() > 1));
+    REQUIRE_FALSE(FrameArena(4).isBound());
+
+    // A node the machine doesn't have leaves the slots unbound but usable.
+    FrameArena elsewhere(4, pulse::utils::numaNodes());
+    REQUIRE_FALSE(elsewhere.isBound());
+    std::memset(elsewhere.slot(3), 1, Page::PAGE_SIZE);
+    REQUIRE(elsewhere.slot(3)[0] == 1);
+  }
+
+  SECTION("moving hands over the slots") {
+    FrameArena arena(2);
+    uint8_t *first = arena.slot(0);
+
+    FrameArena moved(std::move(arena));
+    REQUIRE(arena.slotCount() == 0);
+    REQUIRE(moved.slotCount() == 2);
+    REQUIRE(moved.slot(0) == first);
+
+    arena = std::move(moved);
+    REQUIRE(arena.slot(0) == first);
+  }
+}
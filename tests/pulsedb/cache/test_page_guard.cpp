@@ -0,0 +1,177 @@
+/**
+ * @file tests/pulsedb/cache/test_page_guard.cpp
+ * @brief Test cases for the page guard classes.
+ */
+
+#include "pulsedb/cache/buffer_pool.hpp"
+#include "pulsedb/cache/page_guard.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <thread>
+
+using namespace pulse::storage;
+using namespace pulse::cache;
+namespace fs = std::filesystem;
+
+namespace {
+  const fs::path guardPath = "test_page_guard.db";
+
+  void cleanupGuard() {
+    if (fs::exists(guardPath)) {
+      fs::remove(guardPath);
+    }
+  }
+} // namespace
+
+TEST_CASE("Page guards pin and unpin", "[cache][page_guard]") {
+  cleanupGuard();
+  DiskManager dm(guardPath, true);
+  BufferPool pool(dm, 1);
+
+  uint32_t pageId;
+  {
+    auto guard = pool.newPage<DataPage>();
+    REQUIRE(guard);
+    pageId = guard.pageId();
+
+    // The only frame is pinned.
+    REQUIRE(pool.createPage(PageType::DATA) == nullptr);
+    REQUIRE_FALSE(pool.deletePage(pageId));
+  }
+
+  SECTION("going out of scope unpins") {
+    REQUIRE(pool.deletePage(pageId));
+  }
+
+  SECTION("early release") {
+    auto guard = pool.readPage(pageId);
+    REQUIRE(guard);
+
+    guard.release();
+    REQUIRE_FALSE(guard);
+    REQUIRE(pool.deletePage(pageId));
+  }
+
+  SECTION("moving hands over the pin") {
+    auto guard = pool.writePage<DataPage>(pageId);
+    auto moved = std::move(guard);
+    REQUIRE_FALSE(guard);
+    REQUIRE(moved);
+
+    ReadPageGuard<DataPage> assigned;
+    moved.release();
+    assigned = pool.readPage<DataPage>(pageId);
+    REQUIRE(assigned);
+    REQUIRE_FALSE(pool.deletePage(pageId));
+
+    assigned = ReadPageGuard<DataPage>();
+    REQUIRE(pool.deletePage(pageId));
+  }
+
+  cleanupGuard();
+}
+
+TEST_CASE("Page guards check the page type", "[cache][page_guard]") {
+  cleanupGuard();
+  DiskManager dm(guardPath, true);
+  BufferPool pool(dm, 4);
+
+  const uint32_t pageId = pool.newPage<IndexPage>(false, 2).pageId();
+
+  SECTION("matching type") {
+    auto guard = pool.readPage<IndexPage>(pageId);
+    REQUIRE(guard);
+    REQUIRE_FALSE(guard->isLeaf());
+    REQUIRE(guard->level() == 2);
+  }
+
+  SECTION("any type") {
+    auto guard = pool.readPage(pageId);
+    REQUIRE(guard);
+    REQUIRE(guard->type() == PageType::INDEX);
+  }
+
+  SECTION("mismatched type is unpinned") {
+    REQUIRE_FALSE(pool.readPage<DataPage>(pageId));
+    REQUIRE_FALSE(pool.writePage<DataPage>(pageId));
+    REQUIRE(pool.deletePage(pageId));
+  }
+
+  SECTION("missing page") {
+    REQUIRE_FALSE(pool.readPage(1000));
+  }
+
+  cleanupGuard();
+}
+
+TEST_CASE("Page guards track dirtiness", "[cache][page_guard]") {
+  cleanupGuard();
+  DiskManager dm(guardPath, true);
+  BufferPool pool(dm, 4);
+
+  const uint32_t pageId = pool.newPage<IndexPage>().pageId();
+  REQUIRE(pool.flushPage(pageId));
+  REQUIRE(pool.dirtyRatio() == 0.0);
+
+  SECTION("reading leaves the page clean") {
+    {
+      auto guard = pool.readPage<IndexPage>(pageId);
+      REQUIRE_FALSE(guard->lookup(1));
+    }
+
+    REQUIRE(pool.dirtyRatio() == 0.0);
+  }
+
+  SECTION("const access through a write guard leaves the page clean") {
+    {
+      const auto guard = pool.writePage<IndexPage>(pageId);
+      REQUIRE(guard->itemCount() == 0);
+    }
+
+    REQUIRE(pool.dirtyRatio() == 0.0);
+  }
+
+  SECTION("writing marks the page dirty") {
+    {
+      auto guard = pool.writePage<IndexPage>(pageId);
+      REQUIRE(guard->insertKey(1, 10));
+    }
+
+    REQUIRE(pool.dirtyRatio() > 0.0);
+    pool.flushAll();
+
+    auto page = dm.fetchPage(pageId);
+    REQUIRE(page != nullptr);
+    REQUIRE(static_cast<IndexPage *>(page.get())->lookup(1) == 10u);
+  }
+
+  cleanupGuard();
+}
+
+TEST_CASE("Page guards latch the page", "[cache][page_guard]") {
+  cleanupGuard();
+  DiskManager dm(guardPath, true);
+  BufferPool pool(dm, 4);
+
+  const uint32_t pageId = pool.newPage<IndexPage>().pageId();
+  const int threadCount = 4;
+  const int insertsPerThread = 50;
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < threadCount; t++) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < insertsPerThread; i++) {
+        auto guard = pool.writePage<IndexPage>(pageId);
+        guard->insertKey(t * insertsPerThread + i, 1);
+      }
+    });
+  }
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  auto guard = pool.readPage<IndexPage>(pageId);
+  REQUIRE(guard->itemCount() == threadCount * insertsPerThread);
+  cleanupGuard();
+}
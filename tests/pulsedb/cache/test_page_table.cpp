@@ -0,0 +1,133 @@
+/**
+ * @file tests/pulsedb/cache/test_page_table.cpp
+ * @brief Test cases for PageTable class.
+ */
+
+#include "pulsedb/cache/page_table.hpp"
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <thread>
+#include <vector>
+
+using namespace pulse::cache;
+
+TEST_CASE("PageTable basic operations", "[cache][page_table]") {
+  PageTable table(16);
+
+  SECTION("initial state") {
+    REQUIRE(table.size() == 0);
+    REQUIRE_FALSE(table.find(0));
+  }
+
+  SECTION("insert and find") {
+    REQUIRE(table.insert(1, 3));
+    REQUIRE(table.insert(2, 7));
+
+    REQUIRE(table.size() == 2);
+    REQUIRE(table.find(1) == 3);
+    REQUIRE(table.find(2) == 7);
+    REQUIRE_FALSE(table.find(3));
+  }
+
+  SECTION("insert updates existing entry") {
+    REQUIRE(table.insert(1, 3));
+    REQUIRE(table.insert(1, 4));
+
+    REQUIRE(table.size() == 1);
+    REQUIRE(table.find(1) == 4);
+  }
+
+  SECTION("erase") {
+    REQUIRE(table.insert(1, 3));
+    REQUIRE(table.erase(1));
+
+    REQUIRE(table.size() == 0);
+    REQUIRE_FALSE(table.find(1));
+    REQUIRE_FALSE(table.erase(1));
+  }
+
+  SECTION("fill to capacity") {
+    for (uint32_t i = 0; i < 16; i++) {
+      REQUIRE(table.insert(i * 16, i));
+    }
+
+    for (uint32_t i = 0; i < 16; i++) {
+      REQUIRE(table.find(i * 16) == i);
+    }
+  }
+}
+
+TEST_CASE("PageTable erase keeps probe runs intact", "[cache][page_table]") {
+  PageTable table(64);
+
+  // Strided IDs, like the pages of one shard, collide often.
+  for (uint32_t i = 0; i < 64; i++) {
+    REQUIRE(table.insert(i * 8, i));
+  }
+
+  // Remove every other entry and make sure the rest are still reachable.
+  for (uint32_t i = 0; i < 64; i += 2) {
+    REQUIRE(table.erase(i * 8));
+  }
+
+  REQUIRE(table.size() == 32);
+  for (uint32_t i = 0; i < 64; i++) {
+    if (i % 2 == 0) {
+      REQUIRE_FALSE(table.find(i * 8));
+    }
+
+    else {
+      REQUIRE(table.find(i * 8) == i);
+    }
+  }
+
+  // Churn through many more IDs than the table holds.
+  for (uint32_t round = 0; round < 100; round++) {
+    const uint32_t pageId = 1000 + round;
+    REQUIRE(table.insert(pageId, round));
+    REQUIRE(table.find(pageId) == round);
+    REQUIRE(table.erase(pageId));
+  }
+
+  REQUIRE(table.size() == 32);
+}
+
+TEST_CASE("PageTable concurrent lookups", "[cache][page_table]") {
+  PageTable table(64);
+  for (uint32_t i = 0; i < 32; i++) {
+    table.insert(i, i);
+  }
+
+  std::atomic<bool> done = false;
+  std::atomic<size_t> wrong = 0;
+  std::vector<std::thread> readers;
+
+  // Lookups may miss while entries shift, but must never return another page's frame.
+  for (size_t t = 0; t < 4; t++) {
+    readers.emplace_back([&table, &done, &wrong]() {
+      while (!done) {
+        for (uint32_t i = 0; i < 32; i++) {
+          auto frameId = table.find(i);
+          if (frameId && *frameId != i) {
+            wrong++;
+          }
+        }
+      }
+    });
+  }
+
+  // A single writer churns entries around the stable ones.
+  for (uint32_t round = 0; round < 10000; round++) {
+    const uint32_t pageId = 100 + round % 32;
+    table.insert(pageId, pageId);
+    table.erase(pageId);
+  }
+
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  REQUIRE(wrong == 0);
+  REQUIRE(table.size() == 32);
+}
@@ -0,0 +1,377 @@
+/**
+ * @file tests/pulsedb/index/test_bplus_tree.cpp
+ * @brief Test cases for BPlusTree class.
+ */
+
+#include "pulsedb/index/bplus_tree.hpp"
+#include <algorithm>
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <numeric>
+#include <random>
+#include <thread>
+
+using namespace pulse::storage;
+using namespace pulse::cache;
+using namespace pulse::index;
+namespace fs = std::filesystem;
+
+namespace {
+  const fs::path treePath = "test_tree.db";
+
+  void cleanupTree() {
+    if (fs::exists(treePath)) {
+      fs::remove(treePath);
+    }
+  }
+
+  /**
+   * @brief The value stored for a key in these tests.
+   */
+  uint32_t valueOf(uint64_t key) { return static_cast<uint32_t>(key * 7 + 1); }
+} // namespace
+
+TEST_CASE("BPlusTree basic operations", "[index][bplus_tree]") {
+  cleanupTree();
+  DiskManager dm(treePath, true);
+  BufferPool pool(dm, 64);
+  BPlusTree tree(pool);
+
+  SECTION("empty tree") {
+    REQUIRE(tree.height() == 1);
+    REQUIRE_FALSE(tree.lookup(1));
+    REQUIRE_FALSE(tree.remove(1));
+    REQUIRE(tree.range(0, 100).empty());
+  }
+
+  SECTION("insert and lookup") {
+    REQUIRE(tree.insert(10, 100));
+    REQUIRE(tree.insert(5, 50));
+
+    REQUIRE(tree.lookup(10) == 100u);
+    REQUIRE(tree.lookup(5) == 50u);
+    REQUIRE_FALSE(tree.lookup(7));
+  }
+
+  SECTION("duplicate keys are rejected") {
+    REQUIRE(tree.insert(1, 10));
+    REQUIRE_FALSE(tree.insert(1, 20));
+    REQUIRE(tree.lookup(1) == 10u);
+  }
+
+  SECTION("remove") {
+    REQUIRE(tree.insert(1, 10));
+    REQUIRE(tree.remove(1));
+    REQUIRE_FALSE(tree.lookup(1));
+    REQUIRE_FALSE(tree.remove(1));
+  }
+
+  cleanupTree();
+}
+
+TEST_CASE("BPlusTree growth past one page", "[index][bplus_tree]") {
+  cleanupTree();
+  DiskManager dm(treePath, true);
+  BufferPool pool(dm, 64);
+  BPlusTree tree(pool);
+
+  const uint64_t keyCount = 20 * IndexPage::maxEntries();
+  std::vector<uint64_t> keys(keyCount);
+  std::iota(keys.begin(), keys.end(), 0);
+
+  SECTION("sequential inserts") {
+    for (uint64_t key : keys) {
+      REQUIRE(tree.insert(key, valueOf(key)));
+    }
+
+    REQUIRE(tree.height() > 1);
+    for (uint64_t key : keys) {
+      REQUIRE(tree.lookup(key) == valueOf(key));
+    }
+  }
+
+  SECTION("lookups of resident pages take no pins") {
+    const uint64_t count = 4 * IndexPage::maxEntries();
+    for (uint64_t key = 0; key < count; key++) {
+      REQUIRE(tree.insert(key, valueOf(key)));
+    }
+
+    REQUIRE(tree.height() > 1);
+    const PoolStats before = pool.stats();
+    for (uint64_t key = 0; key < count; key++) {
+      REQUIRE(tree.lookup(key) == valueOf(key));
+    }
+
+    REQUIRE_FALSE(tree.lookup(count));
+    REQUIRE(pool.stats().hits == before.hits);
+    REQUIRE(pool.stats().misses == before.misses);
+  }
+
+  SECTION("a hot tree stays resident through a scan") {
+    // Four pools' worth of data pages first, so the scan reads every one of them back in.
+    const size_t dataCount = 4 * 64;
+    std::vector<uint32_t> dataIds;
+    for (size_t i = 0; i < dataCount; i++) {
+      auto *page = pool.createPage(PageType::DATA);
+      REQUIRE(page);
+      dataIds.push_back(page->id());
+      REQUIRE(pool.unpinPage(page->id(), true));
+    }
+
+    const uint64_t count = 4 * IndexPage::maxEntries();
+    for (uint64_t key = 0; key < count; key++) {
+      REQUIRE(tree.insert(key, valueOf(key)));
+    }
+
+    // The lookups only ever read the tree optimistically, every miss is then the scan's own.
+    const PoolStats before = pool.stats();
+    for (size_t i = 0; i < dataIds.size(); i++) {
+      REQUIRE(pool.fetchPage(dataIds[i]));
+      REQUIRE(pool.unpinPage(dataIds[i], false));
+
+      if (i % 16 == 0) {
+        for (uint64_t key = 0; key < count; key += 16) {
+          REQUIRE(tree.lookup(key) == valueOf(key));
+        }
+      }
+    }
+
+    REQUIRE(pool.stats().misses - before.misses == dataCount);
+  }
+
+  SECTION("random inserts and range scans") {
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+    for (uint64_t key : keys) {
+      REQUIRE(tree.insert(key, valueOf(key)));
+    }
+
+    auto all = tree.range(0, keyCount);
+    REQUIRE(all.size() == keyCount);
+    for (uint64_t key = 0; key < keyCount; key++) {
+      REQUIRE(all[key] == valueOf(key));
+    }
+
+    // A range spanning several leaves.
+    const uint64_t start = IndexPage::maxEntries() / 3;
+    const uint64_t end = start + 3 * IndexPage::maxEntries();
+    auto part = tree.range(start, end);
+    REQUIRE(part.size() == end - start + 1);
+    REQUIRE(part.front() == valueOf(start));
+    REQUIRE(part.back() == valueOf(end));
+
+    REQUIRE(tree.range(keyCount + 1, keyCount + 10).empty());
+    REQUIRE(tree.range(10, 5).empty());
+  }
+
+  SECTION("removing everything shrinks the tree") {
+    for (uint64_t key : keys) {
+      REQUIRE(tree.insert(key, valueOf(key)));
+    }
+
+    const uint16_t height = tree.height();
+    REQUIRE(height > 1);
+
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+    for (size_t i = 0; i < keys.size(); i++) {
+      REQUIRE(tree.remove(keys[i]));
+      REQUIRE_FALSE(tree.lookup(keys[i]));
+
+      // Spot check that the rest survives the merges.
+      if (i % 500 == 0 && i + 1 < keys.size()) {
+        REQUIRE(tree.lookup(keys.back()) == valueOf(keys.back()));
+      }
+    }
+
+    REQUIRE(tree.height() < height);
+    REQUIRE(tree.range(0, keyCount).empty());
+
+    // The emptied tree is still usable.
+    REQUIRE(tree.insert(3, 30));
+    REQUIRE(tree.lookup(3) == 30u);
+  }
+
+  cleanupTree();
+}
+
+TEST_CASE("BPlusTree nodes that widen", "[index][bplus_tree]") {
+  cleanupTree();
+  DiskManager dm(treePath, true);
+  BufferPool pool(dm, 64);
+  BPlusTree tree(pool);
+
+  // Millisecond timestamps with the same page ID fill the leaves past what full width holds.
+  const uint64_t epoch = 1'700'000'000'000'000;
+  const uint64_t count = 4 * IndexPage::maxEntries();
+  std::vector<uint64_t> order(count);
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), std::mt19937(11));
+
+  for (uint64_t i : order) {
+    REQUIRE(tree.insert(epoch + 1000 * i, 3));
+  }
+
+  // Far away page IDs don't fit the full leaves until they split.
+  for (uint64_t i : order) {
+    REQUIRE(tree.insert(epoch + 1000 * i + 1, UINT32_MAX - static_cast<uint32_t>(i)));
+  }
+
+  for (uint64_t key : {uint64_t{0}, uint64_t{1} << 40, UINT64_MAX}) {
+    REQUIRE(tree.insert(key, 5));
+  }
+
+  for (uint64_t i = 0; i < count; i++) {
+    REQUIRE(tree.lookup(epoch + 1000 * i) == 3u);
+    REQUIRE(tree.lookup(epoch + 1000 * i + 1) == UINT32_MAX - i);
+  }
+
+  REQUIRE(tree.lookup(0) == 5u);
+  REQUIRE(tree.lookup(UINT64_MAX) == 5u);
+  REQUIRE(tree.range(0, UINT64_MAX).size() == 2 * count + 3);
+
+  for (uint64_t i : order) {
+    REQUIRE(tree.remove(epoch + 1000 * i));
+    REQUIRE(tree.remove(epoch + 1000 * i + 1));
+  }
+
+  REQUIRE(tree.range(0, UINT64_MAX).size() == 3);
+  REQUIRE(tree.lookup(uint64_t{1} << 40) == 5u);
+
+  cleanupTree();
+}
+
+TEST_CASE("BPlusTree reopening", "[index][bplus_tree]") {
+  cleanupTree();
+  const uint64_t keyCount = 5 * IndexPage::maxEntries();
+  uint32_t rootPageId;
+
+  {
+    DiskManager dm(treePath, true);
+    BufferPool pool(dm, 32);
+    BPlusTree tree(pool);
+
+    for (uint64_t key = 0; key < keyCount; key++) {
+      REQUIRE(tree.insert(key, valueOf(key)));
+    }
+
+    rootPageId = tree.rootPageId();
+  }
+
+  DiskManager dm(treePath, false);
+  BufferPool pool(dm, 32);
+  BPlusTree tree(pool, rootPageId);
+
+  for (uint64_t key = 0; key < keyCount; key++) {
+    REQUIRE(tree.lookup(key) == valueOf(key));
+  }
+
+  cleanupTree();
+}
+
+TEST_CASE("BPlusTree rejects a root that is no index page", "[index][bplus_tree]") {
+  cleanupTree();
+  DiskManager dm(treePath, true);
+  BufferPool pool(dm, 8);
+
+  auto *page = pool.createPage(PageType::DATA);
+  REQUIRE(page != nullptr);
+
+  const uint32_t pageId = page->id();
+  pool.unpinPage(pageId, true);
+
+  REQUIRE_THROWS_AS(BPlusTree(pool, pageId), std::runtime_error);
+  cleanupTree();
+}
+
+TEST_CASE("BPlusTree concurrent access", "[index][bplus_tree]") {
+  cleanupTree();
+  DiskManager dm(treePath, true);
+  BufferPool pool(dm, 128, 4);
+  BPlusTree tree(pool);
+
+  const size_t threadCount = 4;
+  const uint64_t keysPerThread = 3 * IndexPage::maxEntries();
+
+  SECTION("parallel inserts with readers") {
+    std::atomic<bool> done{false};
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+
+    for (size_t t = 0; t < threadCount; t++) {
+      threads.emplace_back([&, t] {
+        // Interleave the threads' keys so they contend for the same leaves.
+        for (uint64_t i = 0; i < keysPerThread; i++) {
+          const uint64_t key = i * threadCount + t;
+          if (!tree.insert(key, valueOf(key)) || tree.lookup(key) != valueOf(key)) {
+            failures++;
+          }
+        }
+      });
+    }
+
+    std::thread reader([&] {
+      while (!done) {
+        auto values = tree.range(0, keysPerThread * threadCount);
+        if (!std::is_sorted(values.begin(), values.end())) {
+          failures++;
+        }
+      }
+    });
+
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    done = true;
+    reader.join();
+
+    REQUIRE(failures == 0);
+    REQUIRE(tree.range(0, keysPerThread * threadCount).size() == keysPerThread * threadCount);
+  }
+
+  SECTION("parallel inserts and removes") {
+    for (uint64_t key = 0; key < keysPerThread * threadCount; key++) {
+      REQUIRE(tree.insert(key, valueOf(key)));
+    }
+
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+
+    for (size_t t = 0; t < threadCount; t++) {
+      threads.emplace_back([&, t] {
+        for (uint64_t i = 0; i < keysPerThread; i++) {
+          const uint64_t key = i * threadCount + t;
+
+          // Even threads remove their keys, odd ones add new keys past the end.
+          const bool ok = t % 2 == 0
+                              ? tree.remove(key)
+                              : tree.insert(key + keysPerThread * threadCount, valueOf(key));
+          if (!ok) {
+            failures++;
+          }
+        }
+      });
+    }
+
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    REQUIRE(failures == 0);
+    for (uint64_t i = 0; i < keysPerThread; i++) {
+      for (size_t t = 0; t < threadCount; t++) {
+        const uint64_t key = i * threadCount + t;
+        if (t % 2 == 0) {
+          REQUIRE_FALSE(tree.lookup(key));
+        }
+
+        else {
+          REQUIRE(tree.lookup(key) == valueOf(key));
+          REQUIRE(tree.lookup(key + keysPerThread * threadCount) == valueOf(key));
+        }
+      }
+    }
+  }
+
+  cleanupTree();
+}
@@ -0,0 +1,247 @@
+/**
+ * @file tests/pulsedb/index/test_bulk_loader.cpp
+ * @brief Test cases for BulkLoader class.
+ */
+
+#include "pulsedb/index/bulk_loader.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <string>
+
+using namespace pulse::storage;
+using namespace pulse::cache;
+using namespace pulse::index;
+namespace fs = std::filesystem;
+
+namespace {
+  const fs::path loadPath = "test_bulk_load.db";
+
+  void cleanupLoad() {
+    if (fs::exists(loadPath)) {
+      fs::remove(loadPath);
+    }
+  }
+
+  /**
+   * @brief The value loaded for a key in these tests.
+   */
+  std::string loadedValue(uint32_t key) { return "row " + std::to_string(key); }
+
+  /**
+   * @brief Load keys [0, count) in spans of the given size.
+   */
+  bool loadKeys(BulkLoader &loader, uint32_t count, uint32_t step = 1, size_t spanSize = 1000) {
+    std::vector<std::string> values;
+    std::vector<BulkRecord> records;
+
+    for (uint32_t start = 0; start < count; start += spanSize) {
+      values.clear();
+      records.clear();
+
+      for (uint32_t i = start; i < std::min<uint32_t>(count, start + spanSize); i++) {
+        values.push_back(loadedValue(i * step));
+      }
+
+      for (uint32_t i = 0; i < values.size(); i++) {
+        const auto length = static_cast<uint16_t>(values[i].size() + 1);
+        records.push_back({(start + i) * step, values[i].c_str(), length, 1});
+      }
+
+      if (!loader.add(records)) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * @brief Read the value of a key through the tree and its data page.
+   */
+  std::string readLoaded(DiskManager &dm, BPlusTree &tree, uint32_t key) {
+    auto pageId = tree.lookup(key);
+    if (!pageId) {
+      return {};
+    }
+
+    auto page = dm.fetchPage(*pageId);
+    if (!page || page->type() != PageType::DATA) {
+      return {};
+    }
+
+    auto *dataPage = static_cast<DataPage *>(page.get());
+    auto slotId = dataPage->getSlotId(key);
+    auto record = slotId ? dataPage->getRecord(*slotId) : std::nullopt;
+    return record ? static_cast<const char *>(record->first) : std::string();
+  }
+} // namespace
+
+TEST_CASE("BulkLoader building trees", "[index][bulk_loader]") {
+  cleanupLoad();
+  DiskManager dm(loadPath, true);
+  BufferPool pool(dm, 32);
+  BPlusTree tree(pool);
+
+  SECTION("nothing to load") {
+    BulkLoader loader(dm, tree);
+    REQUIRE(loader.finish());
+    REQUIRE(tree.height() == 1);
+    REQUIRE(tree.range(0, 100).empty());
+  }
+
+  SECTION("a single leaf becomes the root") {
+    BulkLoader loader(dm, tree);
+    REQUIRE(loadKeys(loader, 50));
+    REQUIRE(loader.finish());
+
+    REQUIRE(tree.height() == 1);
+    for (uint32_t key = 0; key < 50; key++) {
+      REQUIRE(readLoaded(dm, tree, key) == loadedValue(key));
+    }
+  }
+
+  SECTION("several levels") {
+    // Packed leaves hold hundreds of nearby keys, sparse nodes keep the tree three levels deep
+    // with the default page size.
+    const uint32_t count = 100000;
+    BulkLoader loader(dm, tree, 0.3);
+    REQUIRE(loadKeys(loader, count, 2));
+    REQUIRE(loader.finish());
+    REQUIRE(loader.recordCount() == count);
+
+    if (Page::PAGE_SIZE == 4096) {
+      REQUIRE(tree.height() == 3);
+    }
+
+    else {
+      REQUIRE(tree.height() > 1);
+    }
+
+    for (uint32_t key = 0; key < 2 * count; key += 2) {
+      REQUIRE(readLoaded(dm, tree, key) == loadedValue(key));
+      REQUIRE_FALSE(tree.lookup(key + 1));
+    }
+
+    // The leaves are linked in order.
+    REQUIRE(tree.range(0, 2 * count).size() == count);
+
+    // The tree keeps working as usual.
+    for (uint32_t key = 1; key < 2 * count; key += 100) {
+      REQUIRE(tree.insert(key, 1));
+      REQUIRE(tree.lookup(key) == 1u);
+    }
+
+    for (uint32_t key = 0; key < 2 * count; key += 4) {
+      REQUIRE(tree.remove(key));
+    }
+
+    REQUIRE(readLoaded(dm, tree, 2) == loadedValue(2));
+    REQUIRE_FALSE(tree.lookup(4));
+  }
+
+  SECTION("small spans pack as tightly") {
+    BulkLoader large(dm, tree);
+    REQUIRE(loadKeys(large, 5000, 1, 5000));
+    REQUIRE(large.finish());
+
+    const fs::path otherPath = "test_bulk_load_other.db";
+    {
+      DiskManager otherDm(otherPath, true);
+      BufferPool otherPool(otherDm, 32);
+      BPlusTree otherTree(otherPool);
+
+      BulkLoader small(otherDm, otherTree);
+      REQUIRE(loadKeys(small, 5000, 1, 7));
+      REQUIRE(small.finish());
+      REQUIRE(small.pageCount() == large.pageCount());
+    }
+
+    fs::remove(otherPath);
+  }
+
+  cleanupLoad();
+}
+
+TEST_CASE("BulkLoader rejections", "[index][bulk_loader]") {
+  cleanupLoad();
+  DiskManager dm(loadPath, true);
+  BufferPool pool(dm, 32);
+  BPlusTree tree(pool);
+
+  SECTION("keys out of order") {
+    BulkLoader loader(dm, tree);
+    const BulkRecord records[] = {{5, "a", 2, 1}, {5, "b", 2, 1}};
+    REQUIRE_FALSE(loader.add(records));
+    REQUIRE(loader.recordCount() == 0);
+
+    const BulkRecord first[] = {{5, "a", 2, 1}};
+    const BulkRecord second[] = {{3, "b", 2, 1}};
+    REQUIRE(loader.add(first));
+    REQUIRE_FALSE(loader.add(second));
+    REQUIRE(loader.recordCount() == 1);
+  }
+
+  SECTION("a record larger than a page") {
+    BulkLoader loader(dm, tree);
+    const std::string large(DataPage::MAX_FREE_SPACE, 'x');
+    const BulkRecord records[] = {{1, large.data(), static_cast<uint16_t>(large.size()), 1}};
+    REQUIRE_FALSE(loader.add(records));
+  }
+
+  SECTION("adding after finishing") {
+    BulkLoader loader(dm, tree);
+    REQUIRE(loader.finish());
+    REQUIRE_FALSE(loader.finish());
+
+    const BulkRecord records[] = {{1, "a", 2, 1}};
+    REQUIRE_FALSE(loader.add(records));
+  }
+
+  SECTION("a tree that isn't empty") {
+    REQUIRE(tree.insert(1, 1));
+    REQUIRE_THROWS_AS(BulkLoader(dm, tree), std::runtime_error);
+  }
+
+  cleanupLoad();
+}
+
+TEST_CASE("BulkLoader reopening", "[index][bulk_loader]") {
+  cleanupLoad();
+  const uint32_t count = 20000;
+  uint32_t rootPageId;
+
+  {
+    DiskManager dm(loadPath, true);
+    BufferPool pool(dm, 32);
+    BPlusTree tree(pool);
+
+    BulkLoader loader(dm, tree);
+    REQUIRE(loadKeys(loader, count));
+    REQUIRE(loader.finish());
+
+    rootPageId = tree.rootPageId();
+    pool.flushAll();
+  }
+
+  SECTION("read-write") {
+    DiskManager dm(loadPath, false);
+    BufferPool pool(dm, 32);
+    BPlusTree tree(pool, rootPageId);
+
+    for (uint32_t key = 0; key < count; key += 7) {
+      REQUIRE(readLoaded(dm, tree, key) == loadedValue(key));
+    }
+  }
+
+  SECTION("read-only") {
+    DiskManager dm(loadPath, false, AccessMode::READ_ONLY);
+    BufferPool pool(dm, 32);
+    BPlusTree tree(pool, rootPageId);
+
+    for (uint32_t key = 0; key < count; key += 7) {
+      REQUIRE(readLoaded(dm, tree, key) == loadedValue(key));
+    }
+  }
+
+  cleanupLoad();
+}
@@ -0,0 +1,257 @@
+/**
+ * @file tests/pulsedb/index/test_range_scan.cpp
+ * @brief Test cases for RangeScan class.
+ */
+
+#include "pulsedb/index/bulk_loader.hpp"
+#include "pulsedb/index/range_scan.hpp"
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <thread>
+
+using namespace pulse::storage;
+using namespace pulse::cache;
+using namespace pulse::index;
+namespace fs = std::filesystem;
+
+namespace {
+  const fs::path scanPath = "test_range_scan.db";
+
+  void cleanupScan() {
+    if (fs::exists(scanPath)) {
+      fs::remove(scanPath);
+    }
+  }
+
+  /**
+   * @brief The page ID stored for a key in these tests.
+   */
+  uint32_t scannedValue(uint64_t key) { return static_cast<uint32_t>(key * 3 + 1); }
+
+  /**
+   * @brief Scan a range, checking every entry, and count the entries.
+   */
+  size_t countScan(BPlusTree &tree, uint64_t start, uint64_t end, size_t readAhead) {
+    RangeScan scan(tree, start, end, readAhead);
+    std::optional<uint64_t> last;
+    size_t count = 0;
+
+    while (auto entry = scan.next()) {
+      if (entry->key < start || entry->key > end || (last && entry->key <= *last) ||
+          entry->pageId != scannedValue(entry->key)) {
+        return 0;
+      }
+
+      last = entry->key;
+      count++;
+    }
+
+    return count;
+  }
+} // namespace
+
+TEST_CASE("RangeScan walking the leaves", "[index][range_scan]") {
+  cleanupScan();
+  DiskManager dm(scanPath, true);
+  BufferPool pool(dm, 64);
+  BPlusTree tree(pool);
+
+  // Even keys only, over enough leaves for two internal levels.
+  const uint64_t count = 40 * IndexPage::maxEntries();
+  for (uint64_t i = 0; i < count; i++) {
+    REQUIRE(tree.insert(2 * i, scannedValue(2 * i)));
+  }
+
+  REQUIRE(tree.height() >= 2);
+
+  SECTION("the whole tree") {
+    REQUIRE(countScan(tree, 0, 2 * count, RangeScan::DEFAULT_READ_AHEAD) == count);
+    REQUIRE(countScan(tree, 0, UINT64_MAX, 1) == count);
+  }
+
+  SECTION("without read-ahead") {
+    REQUIRE(countScan(tree, 0, 2 * count, 0) == count);
+  }
+
+  SECTION("bounds between and on keys") {
+    REQUIRE(countScan(tree, 1, 9, 4) == 4);
+    REQUIRE(countScan(tree, 2, 8, 4) == 4);
+    REQUIRE(countScan(tree, 1000, 1000 + 2 * IndexPage::maxEntries(), 4) ==
+            IndexPage::maxEntries() + 1);
+  }
+
+  SECTION("empty ranges") {
+    REQUIRE(countScan(tree, 9, 1, 4) == 0);
+    REQUIRE(countScan(tree, 3, 3, 4) == 0);
+    REQUIRE(countScan(tree, 2 * count, UINT64_MAX, 4) == 0);
+
+    RangeScan scan(tree, 5, 1);
+    REQUIRE_FALSE(scan.next());
+    REQUIRE_FALSE(scan.record());
+  }
+
+  SECTION("matches collecting the range") {
+    auto pageIds = tree.range(100, 5000);
+    RangeScan scan(tree, 100, 5000);
+
+    for (uint32_t pageId : pageIds) {
+      auto entry = scan.next();
+      REQUIRE(entry);
+      REQUIRE(entry->pageId == pageId);
+    }
+
+    REQUIRE_FALSE(scan.next());
+    REQUIRE_FALSE(scan.next());
+  }
+
+  SECTION("abandoned scans unpin their leaves") {
+    for (int i = 0; i < 100; i++) {
+      RangeScan scan(tree, 0, 2 * count);
+      REQUIRE(scan.next());
+    }
+
+    // A leaked pin per scan would have used up every frame.
+    REQUIRE(tree.insert(1, scannedValue(1)));
+    REQUIRE(countScan(tree, 0, 2 * count, 4) == count + 1);
+  }
+
+  SECTION("leaves merged away under a scan are freed once it lets go") {
+    // Only the leftmost pages survive the merges, so the kept leaf in the middle goes.
+    std::optional<RangeScan> scan(std::in_place, tree, count, 2 * count);
+    REQUIRE(scan->next());
+
+    for (uint64_t i = 0; i < count; i++) {
+      REQUIRE(tree.remove(2 * i));
+    }
+
+    REQUIRE(tree.height() == 1);
+    const uint32_t freed = dm.freePageCount();
+    scan.reset();
+    REQUIRE(dm.freePageCount() == freed + 1);
+  }
+
+  cleanupScan();
+}
+
+TEST_CASE("RangeScan alongside writers", "[index][range_scan]") {
+  cleanupScan();
+  DiskManager dm(scanPath, true);
+  BufferPool pool(dm, 256, 4);
+  BPlusTree tree(pool);
+
+  // Even keys stay put, odd keys come and go, splitting and merging the leaves under the scans.
+  const uint64_t count = 8 * IndexPage::maxEntries();
+  for (uint64_t i = 0; i < count; i++) {
+    REQUIRE(tree.insert(2 * i, scannedValue(2 * i)));
+  }
+
+  std::atomic<bool> done{false};
+  std::atomic<int> failures{0};
+  std::vector<std::thread> writers;
+
+  for (uint64_t t = 0; t < 2; t++) {
+    writers.emplace_back([&, t] {
+      for (int round = 0; round < 3; round++) {
+        for (uint64_t i = t; i < count; i += 2) {
+          tree.insert(2 * i + 1, scannedValue(2 * i + 1));
+        }
+
+        for (uint64_t i = t; i < count; i += 2) {
+          tree.remove(2 * i + 1);
+        }
+      }
+    });
+  }
+
+  std::thread reader([&] {
+    while (!done) {
+      RangeScan scan(tree, 0, 2 * count, 4);
+      std::optional<uint64_t> last;
+      uint64_t evens = 0;
+
+      while (auto entry = scan.next()) {
+        if ((last && entry->key <= *last) || entry->pageId != scannedValue(entry->key)) {
+          failures++;
+        }
+
+        evens += entry->key % 2 == 0;
+        last = entry->key;
+      }
+
+      if (evens != count) {
+        failures++;
+      }
+    }
+  });
+
+  for (auto &writer : writers) {
+    writer.join();
+  }
+
+  done = true;
+  reader.join();
+
+  REQUIRE(failures == 0);
+  REQUIRE(countScan(tree, 0, 2 * count, 4) == count);
+  cleanupScan();
+}
+
+TEST_CASE("RangeScan reading records", "[index][range_scan]") {
+  cleanupScan();
+  const uint32_t count = 20000;
+  uint32_t rootPageId;
+
+  {
+    DiskManager dm(scanPath, true);
+    BufferPool pool(dm, 32);
+    BPlusTree tree(pool);
+    BulkLoader loader(dm, tree);
+
+    std::vector<std::string> values;
+    std::vector<BulkRecord> records;
+    for (uint32_t key = 0; key < count; key++) {
+      values.push_back("value " + std::to_string(key));
+    }
+
+    for (uint32_t key = 0; key < count; key++) {
+      const auto length = static_cast<uint16_t>(values[key].size() + 1);
+      records.push_back({key, values[key].c_str(), length, 1});
+    }
+
+    REQUIRE(loader.add(records));
+    REQUIRE(loader.finish());
+
+    rootPageId = tree.rootPageId();
+    pool.flushAll();
+  }
+
+  for (auto mode : {AccessMode::READ_WRITE, AccessMode::READ_ONLY}) {
+    DiskManager dm(scanPath, false, mode);
+    BufferPool pool(dm, 32);
+    BPlusTree tree(pool, rootPageId);
+
+    RangeScan scan(tree, 100, count);
+    uint32_t expected = 100;
+
+    while (auto entry = scan.next()) {
+      REQUIRE(entry->key == expected);
+
+      // Skip some records, the entries keep coming regardless.
+      if (expected % 3 != 0) {
+        auto record = scan.record();
+        REQUIRE(record);
+        REQUIRE(std::string(static_cast<const char *>(record->first)) ==
+                "value " + std::to_string(expected));
+      }
+
+      expected++;
+    }
+
+    REQUIRE(expected == count);
+  }
+
+  cleanupScan();
+}
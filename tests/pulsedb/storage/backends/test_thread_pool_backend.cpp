@@ -0,0 +1,71 @@
+/**
+ * @file tests/pulsedb/storage/backends/test_thread_pool_backend.cpp
+ * @brief Test cases for ThreadPoolBackend class.
+ */
+
+#include "pulsedb/storage/backends/thread_pool_backend.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <future>
+#include <unistd.h>
+#include <vector>
+
+using namespace pulse::storage;
+namespace fs = std::filesystem;
+
+TEST_CASE("ThreadPoolBackend read and write", "[storage][backends][thread_pool]") {
+  const fs::path testPath = "test_io.bin";
+  int fd = ::open(testPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  REQUIRE(fd >= 0);
+
+  ThreadPoolBackend backend(2);
+  REQUIRE(std::strcmp(backend.name(), "thread-pool") == 0);
+
+  SECTION("batched writes then reads") {
+    const size_t count = 16;
+    std::vector<std::vector<uint8_t>> buffers(count, std::vector<uint8_t>(512));
+    std::vector<std::promise<bool>> done(count);
+    std::vector<IORequest> requests;
+
+    for (size_t i = 0; i < count; i++) {
+      std::memset(buffers[i].data(), static_cast<int>(i + 1), buffers[i].size());
+      requests.push_back(
+          {IOOp::WRITE, fd, buffers[i].data(), 512, i * 512, [&done, i](bool ok) {
+             done[i].set_value(ok);
+           }}
+      );
+    }
+
+    backend.submit(requests);
+    for (auto &promise : done) {
+      REQUIRE(promise.get_future().get());
+    }
+
+    std::vector<uint8_t> readBack(512);
+    std::promise<bool> readDone;
+    IORequest read{IOOp::READ, fd, readBack.data(), 512, 5 * 512, [&readDone](bool ok) {
+                     readDone.set_value(ok);
+                   }};
+
+    backend.submit({&read, 1});
+    REQUIRE(readDone.get_future().get());
+    REQUIRE(readBack[0] == 6);
+    REQUIRE(readBack[511] == 6);
+  }
+
+  SECTION("read past end of file fails") {
+    std::vector<uint8_t> buffer(512);
+    std::promise<bool> done;
+    IORequest read{IOOp::READ, fd, buffer.data(), 512, 4096, [&done](bool ok) {
+                     done.set_value(ok);
+                   }};
+
+    backend.submit({&read, 1});
+    REQUIRE_FALSE(done.get_future().get());
+  }
+
+  ::close(fd);
+  fs::remove(testPath);
+}
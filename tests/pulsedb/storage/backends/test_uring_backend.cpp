@@ -0,0 +1,89 @@
+/**
+ * @file tests/pulsedb/storage/backends/test_uring_backend.cpp
+ * @brief Test cases for UringBackend class.
+ */
+
+#include "pulsedb/storage/backends/uring_backend.hpp"
+
+#ifdef PULSEDB_HAVE_IO_URING
+
+#  include <catch2/catch_test_macros.hpp>
+#  include <cstring>
+#  include <fcntl.h>
+#  include <filesystem>
+#  include <future>
+#  include <memory>
+#  include <unistd.h>
+#  include <vector>
+
+using namespace pulse::storage;
+namespace fs = std::filesystem;
+
+TEST_CASE("UringBackend read and write", "[storage][backends][uring]") {
+  const fs::path testPath = "test_uring.bin";
+  int fd = ::open(testPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  REQUIRE(fd >= 0);
+
+  // Small ring so a batch of 16 has to be submitted in chunks.
+  std::unique_ptr<UringBackend> created;
+  try {
+    created = std::make_unique<UringBackend>(8);
+  } catch (const std::runtime_error &) {
+    WARN("io_uring is not available, skipping");
+    ::close(fd);
+    fs::remove(testPath);
+    return;
+  }
+
+  UringBackend &backend = *created;
+  REQUIRE(std::strcmp(backend.name(), "io_uring") == 0);
+
+  SECTION("batched writes then reads") {
+    const size_t count = 16;
+    std::vector<std::vector<uint8_t>> buffers(count, std::vector<uint8_t>(512));
+    std::vector<std::promise<bool>> done(count);
+    std::vector<IORequest> requests;
+
+    for (size_t i = 0; i < count; i++) {
+      std::memset(buffers[i].data(), static_cast<int>(i + 1), buffers[i].size());
+      requests.push_back(
+          {IOOp::WRITE, fd, buffers[i].data(), 512, i * 512, [&done, i](bool ok) {
+             done[i].set_value(ok);
+           }}
+      );
+    }
+
+    backend.submit(requests);
+    for (auto &promise : done) {
+      REQUIRE(promise.get_future().get());
+    }
+
+    std::vector<uint8_t> readBack(512);
+    std::promise<bool> readDone;
+    IORequest read{IOOp::READ, fd, readBack.data(), 512, 5 * 512, [&readDone](bool ok) {
+                     readDone.set_value(ok);
+                   }};
+
+    backend.submit({&read, 1});
+    REQUIRE(readDone.get_future().get());
+    REQUIRE(readBack[0] == 6);
+    REQUIRE(readBack[511] == 6);
+  }
+
+  SECTION("read past end of file fails") {
+    std::vector<uint8_t> buffer(512);
+    std::promise<bool> done;
+    IORequest read{IOOp::READ, fd, buffer.data(), 512, 4096, [&done](bool ok) {
+                     done.set_value(ok);
+                   }};
+
+    backend.submit({&read, 1});
+    REQUIRE_FALSE(done.get_future().get());
+  }
+
+  created.reset();
+  ::close(fd);
+  fs::remove(testPath);
+}
+
+#endif // PULSEDB_HAVE_IO_URING
@@ -5,6 +5,8 @@
 
 #include "pulsedb/storage/data_page.hpp"
 #include <catch2/catch_test_macros.hpp>
+#include <string>
+#include <vector>
 
 using namespace pulse::storage;
 
@@ -78,6 +80,117 @@ TEST_CASE("DataPage record operations", "[storage][data_page]") {
   }
 }
 
+TEST_CASE("DataPage key directory", "[storage][data_page]") {
+  DataPage page(1);
+
+  // Insert distinct keys out of order until the page is full, but for room to add one more.
+  const uint16_t reserve = DataPage::spaceNeeded(4) + DataPage::PAIR_SIZE;
+  std::vector<uint32_t> keys;
+  for (uint32_t i = 0; i < 1000 && page.freeSpace() >= 2 * reserve; i++) {
+    const uint32_t key = (i * 7919) % 1000;
+    const std::string value = std::to_string(key);
+
+    if (!page.insertRecord(key, value.c_str(), value.size() + 1, 1)) {
+      break;
+    }
+
+    keys.push_back(key);
+  }
+
+  REQUIRE(keys.size() > 100);
+  REQUIRE(page.directoryCount() == keys.size());
+
+  SECTION("every key finds its own record") {
+    for (uint32_t key : keys) {
+      auto slotId = page.getSlotId(key);
+      REQUIRE(slotId);
+
+      auto record = page.getRecord(*slotId);
+      REQUIRE(record);
+      REQUIRE(std::string(static_cast<const char *>(record->first)) == std::to_string(key));
+    }
+
+    REQUIRE_FALSE(page.getSlotId(1000));
+  }
+
+  SECTION("deleting drops the key") {
+    const uint32_t key = keys[keys.size() / 2];
+    REQUIRE(page.deleteRecord(*page.getSlotId(key)));
+    REQUIRE_FALSE(page.getSlotId(key));
+    REQUIRE(page.directoryCount() == keys.size() - 1);
+
+    // The freed slot goes to a new key, the other keys keep their records.
+    auto slotId = page.insertRecord(5000, "new", 4, 1);
+    REQUIRE(slotId);
+    REQUIRE(page.getSlotId(5000) == slotId);
+
+    for (uint32_t other : keys) {
+      if (other != key) {
+        auto record = page.getRecord(*page.getSlotId(other));
+        REQUIRE(record);
+        REQUIRE(std::string(static_cast<const char *>(record->first)) == std::to_string(other));
+      }
+    }
+  }
+}
+
+TEST_CASE("DataPage batched inserts", "[storage][data_page]") {
+  std::vector<std::string> values;
+  std::vector<BulkRecord> records;
+
+  // More records than any page size holds.
+  for (uint32_t key = 0; key < Page::PAGE_SIZE / 4; key++) {
+    values.push_back("value " + std::to_string(key));
+  }
+
+  for (uint32_t key = 0; key < values.size(); key++) {
+    const auto length = static_cast<uint16_t>(values[key].size() + 1);
+    records.push_back({key, values[key].c_str(), length, 1});
+  }
+
+  SECTION("an empty page packs until full") {
+    DataPage page(1);
+    const size_t count = page.insertRecords(records);
+
+    REQUIRE(count > 100);
+    REQUIRE(count < records.size());
+    REQUIRE(page.itemCount() == count);
+    REQUIRE(page.directoryCount() == count);
+
+    for (uint32_t key = 0; key < count; key++) {
+      auto record = page.getRecord(*page.getSlotId(key));
+      REQUIRE(record);
+      REQUIRE(std::string(static_cast<const char *>(record->first)) == values[key]);
+    }
+
+    // The batch fills the page just as far as single inserts would.
+    DataPage single(2);
+    for (const auto &record : records) {
+      if (!single.insertRecord(record.key, record.data, record.length, record.type)) {
+        break;
+      }
+    }
+
+    REQUIRE(single.itemCount() == count);
+    REQUIRE(single.freeSpace() == page.freeSpace());
+
+    // The record the batch stopped at doesn't fit either way.
+    const auto &next = records[count];
+    REQUIRE_FALSE(page.insertRecord(next.key, next.data, next.length, next.type));
+  }
+
+  SECTION("a used page inserts one by one") {
+    DataPage page(1);
+    REQUIRE(page.insertRecord(5000, "first", 6, 1));
+
+    const size_t count = page.insertRecords(std::span(records).first(10));
+    REQUIRE(count == 10);
+    REQUIRE(page.itemCount() == 11);
+    REQUIRE(page.getSlotId(5000));
+    REQUIRE(page.getSlotId(9));
+  }
+}
+
 TEST_CASE("DataPage space management", "[storage][data_page]") {
   SECTION("space needed calculation") {
     const uint16_t dataLen = 100;
@@ -157,8 +270,12 @@ TEST_CASE("DataPage fragmentation operations", "[storage][data_page]") {
     }
 
     // Perform compaction.
+    const uint16_t freeBefore = page.freeSpace();
     uint16_t freed = page.compact();
-    REQUIRE(freed > 0);
+    REQUIRE(freed >= 5 * (recordSize + DataPage::RECORD_HEADER_SIZE));
+    REQUIRE(page.freeSpace() == freeBefore + freed);
+    REQUIRE(page.deadBytes() == 0);
+    REQUIRE_FALSE(page.needsCompact());
 
     // Verify remaining records.
     for (size_t i = 1; i < slots.size(); i += 2) {
@@ -168,6 +285,106 @@ TEST_CASE("DataPage fragmentation operations", "[storage][data_page]") {
       REQUIRE(record->second == recordSize);
     }
   }
+
+  SECTION("deletes count dead bytes") {
+    DataPage page(1);
+    const std::string data(100, 'x');
+
+    auto first = page.insertRecord(1, data.c_str(), 100, 1);
+    auto second = page.insertRecord(2, data.c_str(), 100, 1);
+    REQUIRE(first);
+    REQUIRE(second);
+    REQUIRE(page.deadBytes() == 0);
+
+    REQUIRE(page.deleteRecord(*first));
+    REQUIRE(page.deadBytes() == 100 + DataPage::RECORD_HEADER_SIZE);
+    REQUIRE_FALSE(page.deleteRecord(*first));
+    REQUIRE(page.deadBytes() == 100 + DataPage::RECORD_HEADER_SIZE);
+    REQUIRE(page.needsCompact());
+  }
+
+  SECTION("records keep their slots and contents") {
+    DataPage page(1);
+
+    // Distinct contents, so a record moved over another would show.
+    std::vector<uint16_t> slots;
+    for (uint32_t i = 0; i < 20; i++) {
+      const std::string data(50 + i, static_cast<char>('a' + i));
+      auto slot = page.insertRecord(i, data.c_str(), static_cast<uint16_t>(data.size()), i);
+      REQUIRE(slot);
+
+      slots.push_back(*slot);
+    }
+
+    // Reuse a slot, so slot order and record order differ.
+    for (uint32_t i = 0; i < 20; i += 3) {
+      REQUIRE(page.deleteRecord(slots[i]));
+    }
+
+    const std::string reused(80, 'z');
+    auto slot = page.insertRecord(100, reused.c_str(), 80, 100);
+    REQUIRE(slot == slots[18]);
+
+    REQUIRE(page.compact() > 0);
+
+    for (uint32_t i = 0; i < 20; i++) {
+      auto record = page.getRecord(slots[i]);
+      if (i % 3 == 0 && i != 18) {
+        REQUIRE_FALSE(record);
+        continue;
+      }
+
+      const std::string expected = i == 18 ? reused : std::string(50 + i, 'a' + i);
+      REQUIRE(record);
+      REQUIRE(std::string(static_cast<const char *>(record->first), record->second) == expected);
+      REQUIRE(page.getSlotId(i == 18 ? 100 : i) == slots[i]);
+    }
+
+    // Deleted slots are still handed out again.
+    auto again = page.insertRecord(200, "foo", 3, 1);
+    REQUIRE(again);
+    REQUIRE(*again % 3 == 0);
+  }
+
+  SECTION("trailing deleted slots are dropped") {
+    DataPage page(1);
+    const std::string data(100, 'x');
+
+    for (uint32_t i = 0; i < 5; i++) {
+      REQUIRE(page.insertRecord(i, data.c_str(), 100, 1));
+    }
+
+    REQUIRE(page.deleteRecord(3));
+    REQUIRE(page.deleteRecord(4));
+
+    const uint16_t freeBefore = page.freeSpace();
+    REQUIRE(page.compact() == 2 * (100 + DataPage::RECORD_HEADER_SIZE + DataPage::SLOT_SIZE));
+    REQUIRE(page.freeSpace() > freeBefore);
+    REQUIRE(page.slotCount() == 3);
+    REQUIRE(page.insertRecord(5, data.c_str(), 100, 1) == 3);
+  }
+
+  SECTION("inserts compact a page full of deleted records") {
+    DataPage page(1);
+    const uint16_t recordSize = 200;
+    const std::string data(recordSize, 'x');
+
+    // Cycle through far more records than fit, deleting each one after the next goes in.
+    std::optional<uint16_t> previous;
+    for (uint32_t i = 0; i < 5 * Page::PAGE_SIZE / recordSize; i++) {
+      auto slot = page.insertRecord(i, data.c_str(), recordSize, 1);
+      REQUIRE(slot);
+
+      if (previous) {
+        REQUIRE(page.deleteRecord(*previous));
+      }
+
+      previous = slot;
+    }
+
+    REQUIRE(page.itemCount() == 1);
+    REQUIRE(page.slotCount() <= 2);
+  }
 }
 
 TEST_CASE("DataPage slot flag operations", "[storage][data_page]") {
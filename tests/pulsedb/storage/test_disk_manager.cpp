@@ -7,6 +7,12 @@
 #include "pulsedb/storage/disk_manager.hpp"
 #include "pulsedb/storage/index_page.hpp"
 #include <catch2/catch_test_macros.hpp>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
 
 using namespace pulse::storage;
 namespace fs = std::filesystem;
@@ -84,10 +90,129 @@ TEST_CASE("DiskManager page allocation", "[storage][disk_manager]") {
     REQUIRE_FALSE(dm.deallocatePage(1000)); // Non-existent page.
   }
 
+  SECTION("extent allocation") {
+    DiskManager dm(testPath, true);
+    REQUIRE(dm.allocatePage() == 0);
+    REQUIRE(dm.allocatePage() == 1);
+    REQUIRE(dm.deallocatePage(0));
+
+    // A run always comes from the end of the file, the free page stays free.
+    REQUIRE(dm.allocateExtent(8) == 2);
+    REQUIRE(dm.pageCount() == 10);
+    REQUIRE(dm.freePageCount() == 1);
+    REQUIRE(dm.allocateExtent(0) == DiskManager::INVALID_PAGE_ID);
+
+    // Reserved pages don't change the file's length, unwritten pages still can't be read.
+    REQUIRE(dm.fileSize() == sizeof(DatabaseHeader));
+    REQUIRE(dm.fetchPage(5) == nullptr);
+
+    REQUIRE(dm.flushPage(DataPage(9)));
+    REQUIRE(dm.fileSize() == sizeof(DatabaseHeader) + 10 * Page::PAGE_SIZE);
+  }
+
   // Cleanup.
   fs::remove(testPath);
 }
 
+TEST_CASE("DiskManager free space map", "[storage][disk_manager]") {
+  const fs::path testPath = "test.db";
+  if (fs::exists(testPath)) {
+    fs::remove(testPath);
+  }
+
+  const uint32_t record = DataPage::spaceNeeded(10) + DataPage::PAIR_SIZE;
+
+  SECTION("written data pages are found by their room") {
+    DiskManager dm(testPath, true);
+    REQUIRE_FALSE(dm.findPageWithSpace(record));
+
+    DataPage empty(dm.allocatePage());
+    DataPage full(dm.allocatePage());
+    IndexPage index(dm.allocatePage(), true);
+
+    // Leave room for the small record, whatever the category size.
+    const uint32_t room = record + 2 * FreeSpaceMap::CATEGORY_SIZE;
+    const std::string large(DataPage::MAX_FREE_SPACE - room, 'x');
+    REQUIRE(full.insertRecord(1, large.c_str(), large.size(), 1));
+
+    const Page *pages[] = {&empty, &full, &index};
+    REQUIRE(dm.writePages(pages));
+
+    REQUIRE(dm.findPageWithSpace(record) == full.id());
+    REQUIRE(dm.findPageWithSpace(1000) == empty.id());
+    REQUIRE_FALSE(dm.findPageWithSpace(DataPage::MAX_FREE_SPACE + 1));
+  }
+
+  SECTION("the map and the free list survive a reopen") {
+    {
+      DiskManager dm(testPath, true);
+      for (uint32_t i = 0; i < 4; i++) {
+        DataPage page(dm.allocatePage());
+        REQUIRE(page.insertRecord(i, "foobarbaz", 10, 1));
+        REQUIRE(dm.flushPage(page));
+      }
+
+      REQUIRE(dm.deallocatePage(1));
+      REQUIRE(dm.deallocatePage(2));
+      REQUIRE_FALSE(dm.deallocatePage(2));
+      REQUIRE(dm.freePageCount() == 2);
+    }
+
+    DiskManager dm(testPath, false);
+    REQUIRE(dm.freePageCount() == 2);
+
+    const auto pageId = dm.findPageWithSpace(record);
+    REQUIRE(pageId);
+    REQUIRE((*pageId == 0 || *pageId == 3));
+
+    const uint32_t first = dm.allocatePage();
+    const uint32_t second = dm.allocatePage();
+    REQUIRE(((first == 1 && second == 2) || (first == 2 && second == 1)));
+    REQUIRE(dm.freePageCount() == 0);
+
+    const uint32_t fresh = dm.allocatePage();
+    REQUIRE(fresh == dm.pageCount() - 1);
+  }
+
+  SECTION("writing a free page takes it off the free list") {
+    {
+      DiskManager dm(testPath, true);
+      DataPage page(dm.allocatePage());
+      REQUIRE(dm.flushPage(page));
+      REQUIRE(dm.deallocatePage(page.id()));
+    }
+
+    // What recovery does for a page the map on disk thinks is free.
+    DiskManager dm(testPath, false);
+    REQUIRE(dm.freePageCount() == 1);
+
+    DataPage page(0);
+    REQUIRE(dm.flushPage(page));
+    REQUIRE(dm.freePageCount() == 0);
+    REQUIRE(dm.allocatePage() != 0);
+  }
+
+  SECTION("the map grows with the database") {
+    const uint32_t count = FreeSpacePage::CAPACITY + 10;
+    {
+      DiskManager dm(testPath, true);
+      for (uint32_t i = 0; i < count; i++) {
+        static_cast<void>(dm.allocatePage());
+      }
+
+      REQUIRE(dm.deallocatePage(count - 1));
+      REQUIRE(dm.sync());
+    }
+
+    DiskManager dm(testPath, false);
+    REQUIRE(dm.pageCount() == count + 2);
+    REQUIRE(dm.freePageCount() == 1);
+    REQUIRE(dm.allocatePage() == count - 1);
+  }
+
+  fs::remove(testPath);
+}
+
 TEST_CASE("DiskManager page I/O", "[storage][disk_manager]") {
   const fs::path testPath = "test.db";
   if (fs::exists(testPath)) {
@@ -157,6 +282,164 @@ TEST_CASE("DiskManager page I/O", "[storage][disk_manager]") {
     REQUIRE(dm.fetchPage(1000) == nullptr); // Non-existent page.
   }
 
+  SECTION("unwritten page read") {
+    DiskManager dm(testPath, true);
+    uint32_t pageId = dm.allocatePage();
+
+    // Allocated but never flushed, so the read hits EOF and moves no bytes.
+    const uint64_t before = dm.stats().bytesRead;
+    REQUIRE(dm.fetchPage(pageId) == nullptr);
+    REQUIRE(dm.stats().bytesRead == before);
+  }
+
+  SECTION("file grows with flushed pages") {
+    DiskManager dm(testPath, true);
+    uint32_t pageId = dm.allocatePage();
+
+    REQUIRE(dm.flushPage(DataPage(pageId)));
+    REQUIRE(dm.fileSize() == sizeof(DatabaseHeader) + Page::PAGE_SIZE);
+    REQUIRE(dm.sync());
+  }
+
+  SECTION("I/O is counted") {
+    DiskManager dm(testPath, true);
+    uint32_t pageId = dm.allocatePage();
+
+    REQUIRE(dm.flushPage(DataPage(pageId)));
+    REQUIRE(dm.fetchPage(pageId) != nullptr);
+    REQUIRE(dm.sync());
+
+    const DiskStats stats = dm.stats();
+    REQUIRE(stats.pagesRead == 1);
+    REQUIRE(stats.pagesWritten == 1);
+    REQUIRE(stats.bytesRead >= Page::PAGE_SIZE);
+    REQUIRE(stats.bytesWritten >= Page::PAGE_SIZE);
+    REQUIRE(stats.syncs == 1);
+    REQUIRE(stats.readLatency.count == 1);
+    REQUIRE(stats.writeLatency.count == 1);
+  }
+
+  // Cleanup.
+  fs::remove(testPath);
+}
+
+TEST_CASE("DiskManager asynchronous I/O", "[storage][disk_manager]") {
+  const fs::path testPath = "test.db";
+  if (fs::exists(testPath)) {
+    fs::remove(testPath);
+  }
+
+  SECTION("async write and read") {
+    DiskManager dm(testPath, true);
+    uint32_t pageId = dm.allocatePage();
+
+    IndexPage page(pageId, false, 3);
+    REQUIRE(page.insertKey(7, 70));
+    REQUIRE(dm.flushPageAsync(page).get());
+
+    auto readPage = dm.fetchPageAsync(pageId).get();
+    REQUIRE(readPage != nullptr);
+    REQUIRE(readPage->type() == PageType::INDEX);
+
+    auto *indexPage = static_cast<IndexPage *>(readPage.get());
+    REQUIRE_FALSE(indexPage->isLeaf());
+    REQUIRE(indexPage->level() == 3);
+    REQUIRE(*indexPage->lookup(7) == 70);
+  }
+
+  SECTION("async reads that hit EOF move no bytes") {
+    DiskManager dm(testPath, true);
+    uint32_t pageId = dm.allocatePage();
+
+    const uint64_t before = dm.stats().bytesRead;
+    REQUIRE(dm.fetchPageAsync(pageId).get() == nullptr);
+    REQUIRE(dm.stats().bytesRead == before);
+  }
+
+  SECTION("batched writes and reads") {
+    DiskManager dm(testPath, true);
+    std::vector<std::unique_ptr<DataPage>> pages;
+    std::vector<const Page *> toWrite;
+    std::vector<uint32_t> ids;
+
+    for (uint32_t i = 0; i < 8; i++) {
+      pages.push_back(std::make_unique<DataPage>(dm.allocatePage()));
+      REQUIRE(pages.back()->insertRecord(i, &i, sizeof(i), 1));
+
+      toWrite.push_back(pages.back().get());
+      ids.push_back(pages.back()->id());
+    }
+
+    for (auto &result : dm.flushPagesAsync(toWrite)) {
+      REQUIRE(result.get());
+    }
+
+    auto reads = dm.fetchPagesAsync(ids);
+    REQUIRE(reads.size() == ids.size());
+
+    for (uint32_t i = 0; i < reads.size(); i++) {
+      auto page = reads[i].get();
+      REQUIRE(page != nullptr);
+      REQUIRE(page->id() == ids[i]);
+
+      auto *dataPage = static_cast<DataPage *>(page.get());
+      auto record = dataPage->getRecord(*dataPage->getSlotId(i));
+      REQUIRE(record);
+      REQUIRE(*static_cast<const uint32_t *>(record->first) == i);
+    }
+  }
+
+  SECTION("coalesced writes") {
+    DiskManager dm(testPath, true);
+    std::vector<std::unique_ptr<DataPage>> pages;
+    std::vector<const Page *> toWrite;
+
+    for (uint32_t i = 0; i < 6; i++) {
+      pages.push_back(std::make_unique<DataPage>(dm.allocatePage()));
+      REQUIRE(pages.back()->insertRecord(i, &i, sizeof(i), 1));
+    }
+
+    // Out of order, with a gap at page 2.
+    for (uint32_t i : {5, 0, 4, 1, 3}) {
+      toWrite.push_back(pages[i].get());
+    }
+
+    REQUIRE(dm.writePages(toWrite));
+    REQUIRE(dm.fetchPage(2) == nullptr);
+
+    for (uint32_t i : {0, 1, 3, 4, 5}) {
+      auto page = dm.fetchPage(i);
+      REQUIRE(page != nullptr);
+
+      auto *dataPage = static_cast<DataPage *>(page.get());
+      auto record = dataPage->getRecord(*dataPage->getSlotId(i));
+      REQUIRE(record);
+      REQUIRE(*static_cast<const uint32_t *>(record->first) == i);
+    }
+  }
+
+  SECTION("prefetching pages") {
+    DiskManager dm(testPath, true);
+    for (uint32_t i = 0; i < 6; i++) {
+      DataPage page(dm.allocatePage());
+      REQUIRE(dm.flushPage(page));
+    }
+
+    // Two runs and a duplicate, the page past the end is skipped.
+    const uint32_t pageIds[] = {4, 0, 1, 5, 1, 1000};
+    REQUIRE(dm.prefetch(pageIds) == 4);
+    REQUIRE(dm.prefetch({}) == 0);
+    REQUIRE(dm.fetchPage(5) != nullptr);
+  }
+
+  SECTION("async read of invalid page") {
+    DiskManager dm(testPath, true);
+    REQUIRE(dm.fetchPageAsync(1000).get() == nullptr);
+
+    uint32_t unwritten = dm.allocatePage();
+    REQUIRE(dm.fetchPageAsync(unwritten).get() == nullptr);
+  }
+
   // Cleanup.
   fs::remove(testPath);
 }
@@ -184,10 +467,10 @@ TEST_CASE("DiskManager persistence", "[storage][disk_manager]") {
       REQUIRE(dm.sync());
     }
 
-    // Reopen and verify.
+    // Reopen and verify, the free space map went in a page of its own.
     {
       DiskManager dm(testPath, false);
-      REQUIRE(dm.pageCount() == 1);
+      REQUIRE(dm.pageCount() == 2);
 
       auto readPage = dm.fetchPage(pageId);
       REQUIRE(readPage != nullptr);
@@ -310,3 +593,433 @@ TEST_CASE("DiskManager move semantics", "[storage][disk_manager]") {
     fs::remove("temp.db");
   }
 }
+
+TEST_CASE("DiskManager read-only mapping", "[storage][disk_manager]") {
+  const fs::path testPath = "test.db";
+  if (fs::exists(testPath)) {
+    fs::remove(testPath);
+  }
+
+  uint32_t dataId;
+  uint32_t indexId;
+  {
+    DiskManager dm(testPath, true);
+    dataId = dm.allocatePage();
+    indexId = dm.allocatePage();
+
+    DataPage data(dataId);
+    REQUIRE(data.insertRecord(1, "foobarbaz", 10, 1));
+
+    IndexPage index(indexId, true);
+    for (uint64_t key = 0; key < 100; key++) {
+      REQUIRE(index.insertKey(key * 3, static_cast<uint32_t>(key)));
+    }
+
+    REQUIRE(dm.flushPage(data));
+    REQUIRE(dm.flushPage(index));
+    REQUIRE(dm.sync());
+
+    // The free space map took the next page, this one is allocated but never written.
+    REQUIRE(dm.allocatePage() == 3);
+  }
+
+  SECTION("creating a read-only database") {
+    REQUIRE_THROWS_AS(DiskManager(testPath, true, AccessMode::READ_ONLY), std::runtime_error);
+  }
+
+  SECTION("fetching views into the mapping") {
+    DiskManager dm(testPath, false, AccessMode::READ_ONLY);
+    REQUIRE(dm.isReadOnly());
+    REQUIRE(dm.pageCount() == 3);
+
+    auto data = dm.fetchPage(dataId);
+    REQUIRE(data != nullptr);
+    REQUIRE(data->type() == PageType::DATA);
+    REQUIRE_FALSE(data->ownsBuffer());
+
+    auto *dataPage = static_cast<DataPage *>(data.get());
+    auto record = dataPage->getRecord(*dataPage->getSlotId(1));
+    REQUIRE(record);
+    REQUIRE(strcmp(static_cast<const char *>(record->first), "foobarbaz") == 0);
+
+    // Keys in a mapped page aren't naturally aligned, searching them still works.
+    auto index = dm.fetchPageAsync(indexId).get();
+    REQUIRE(index != nullptr);
+    REQUIRE(index->type() == PageType::INDEX);
+
+    auto *indexPage = static_cast<IndexPage *>(index.get());
+    for (uint64_t key = 0; key < 100; key++) {
+      REQUIRE(indexPage->lookup(key * 3) == key);
+      REQUIRE_FALSE(indexPage->lookup(key * 3 + 1));
+    }
+
+    REQUIRE(dm.fetchPage(2) == nullptr);
+    REQUIRE(dm.fetchPage(3) == nullptr);
+    REQUIRE(dm.fetchPage(1000) == nullptr);
+  }
+
+  SECTION("reading into a buffer") {
+    DiskManager dm(testPath, false, AccessMode::READ_ONLY);
+    alignas(64) uint8_t buffer[Page::PAGE_SIZE];
+
+    REQUIRE(dm.readPageAsync(indexId, buffer).get());
+    REQUIRE(IndexPage(VIEW, buffer).lookup(30) == 10u);
+    REQUIRE_FALSE(dm.readPageAsync(3, buffer).get());
+  }
+
+  SECTION("prefetching the mapping") {
+    DiskManager dm(testPath, false, AccessMode::READ_ONLY);
+    const uint32_t pageIds[] = {indexId, dataId, 3};
+    REQUIRE(dm.prefetch(pageIds) == 2);
+  }
+
+  SECTION("writes are rejected") {
+    DiskManager dm(testPath, false, AccessMode::READ_ONLY);
+    REQUIRE(dm.allocatePage() == DiskManager::INVALID_PAGE_ID);
+    REQUIRE_FALSE(dm.deallocatePage(dataId));
+
+    DataPage page(dataId);
+    const Page *pages[] = {&page};
+    REQUIRE_FALSE(dm.flushPage(page));
+    REQUIRE_FALSE(dm.writePages(pages));
+    REQUIRE_FALSE(dm.flushPagesAsync(pages).front().get());
+
+    dm.extendTo(10);
+    REQUIRE(dm.pageCount() == 3);
+  }
+
+  SECTION("the mapping moves with the manager") {
+    DiskManager dm(testPath, false, AccessMode::READ_ONLY);
+    DiskManager moved(std::move(dm));
+    REQUIRE(moved.isReadOnly());
+
+    auto page = moved.fetchPage(dataId);
+    REQUIRE(page != nullptr);
+    REQUIRE(page->type() == PageType::DATA);
+  }
+
+  fs::remove(testPath);
+}
+
+TEST_CASE("DiskManager compressed pages", "[storage][disk_manager]") {
+  const fs::path testPath = "test.db";
+  const fs::path plainPath = "test_plain.db";
+  for (const auto &path : {testPath, plainPath}) {
+    if (fs::exists(path)) {
+      fs::remove(path);
+    }
+  }
+
+  if (!isCompressionAvailable(Compression::DEFLATE)) {
+    REQUIRE_THROWS_AS(
+        DiskManager(testPath, true, AccessMode::READ_WRITE, Compression::DEFLATE),
+        std::runtime_error
+    );
+
+    fs::remove(testPath);
+    return;
+  }
+
+  // A page of short, similar records, like most data pages.
+  auto fillPage = [](DataPage &page, uint32_t seed) {
+    const std::string value = "row value " + std::to_string(seed);
+    uint32_t key = 0;
+    while (page.insertRecord(key++, value.c_str(), value.size() + 1, 1)) {
+    }
+  };
+
+  auto checkPage = [](const Page *page, uint32_t seed) {
+    REQUIRE(page != nullptr);
+    REQUIRE(page->type() == PageType::DATA);
+
+    auto *dataPage = static_cast<const DataPage *>(page);
+    auto record = dataPage->getRecord(*dataPage->getSlotId(3));
+    REQUIRE(record);
+    REQUIRE(std::string(static_cast<const char *>(record->first)) ==
+            "row value " + std::to_string(seed));
+  };
+
+  const uint32_t count = 32;
+
+  SECTION("pages take less space") {
+    for (const auto &[path, compression] :
+         {std::pair{testPath, Compression::DEFLATE}, std::pair{plainPath, Compression::NONE}}) {
+      DiskManager dm(path, true, AccessMode::READ_WRITE, compression);
+      REQUIRE(dm.compression() == compression);
+
+      for (uint32_t i = 0; i < count; i++) {
+        DataPage page(dm.allocatePage());
+        fillPage(page, i);
+        REQUIRE(dm.flushPage(page));
+      }
+
+      REQUIRE(dm.sync());
+    }
+
+    REQUIRE(fs::file_size(testPath) * 3 < fs::file_size(plainPath));
+  }
+
+  SECTION("reads decompress every page") {
+    DiskManager dm(testPath, true, AccessMode::READ_WRITE, Compression::DEFLATE);
+    std::vector<std::unique_ptr<DataPage>> pages;
+    std::vector<const Page *> toWrite;
+    std::vector<uint32_t> ids;
+
+    for (uint32_t i = 0; i < count; i++) {
+      pages.push_back(std::make_unique<DataPage>(dm.allocatePage()));
+      fillPage(*pages.back(), i);
+      toWrite.push_back(pages.back().get());
+      ids.push_back(pages.back()->id());
+    }
+
+    // Half written in one coalesced batch, half asynchronously.
+    REQUIRE(dm.writePages(std::span(toWrite).first(count / 2)));
+    for (auto &result : dm.flushPagesAsync(std::span(toWrite).last(count / 2))) {
+      REQUIRE(result.get());
+    }
+
+    auto reads = dm.fetchPagesAsync(ids);
+    for (uint32_t i = 0; i < count; i++) {
+      checkPage(reads[i].get().get(), i);
+      checkPage(dm.fetchPage(ids[i]).get(), i);
+    }
+
+    alignas(64) uint8_t buffer[Page::PAGE_SIZE];
+    REQUIRE(dm.readPageAsync(ids[5], buffer).get());
+    checkPage(std::make_unique<DataPage>(VIEW, buffer).get(), 5);
+
+    // Allocated but never written.
+    uint32_t unwritten = dm.allocatePage();
+    REQUIRE(dm.fetchPage(unwritten) == nullptr);
+    REQUIRE_FALSE(dm.readPageAsync(unwritten, buffer).get());
+  }
+
+  SECTION("incompressible pages are stored as is") {
+    DiskManager dm(testPath, true, AccessMode::READ_WRITE, Compression::DEFLATE);
+    DataPage page(dm.allocatePage());
+    fillPage(page, 1);
+    REQUIRE(dm.flushPage(page));
+
+    // Growing past its slot moves the page.
+    std::mt19937 rng(3);
+    std::vector<uint8_t> noise(2000);
+    for (auto &byte : noise) {
+      byte = static_cast<uint8_t>(rng());
+    }
+
+    DataPage noisy(page.id());
+    REQUIRE(noisy.insertRecord(1, noise.data(), noise.size(), 1));
+    REQUIRE(noisy.insertRecord(2, noise.data() + 1000, 1000, 1));
+    REQUIRE(dm.flushPage(noisy));
+
+    auto read = dm.fetchPage(page.id());
+    REQUIRE(read != nullptr);
+
+    auto *readPage = static_cast<const DataPage *>(read.get());
+    auto record = readPage->getRecord(*readPage->getSlotId(1));
+    REQUIRE(record);
+    REQUIRE(record->second == noise.size());
+    REQUIRE(std::memcmp(record->first, noise.data(), noise.size()) == 0);
+  }
+
+  SECTION("reopening") {
+    {
+      DiskManager dm(testPath, true, AccessMode::READ_WRITE, Compression::DEFLATE);
+      for (uint32_t i = 0; i < count; i++) {
+        DataPage page(dm.allocatePage());
+        fillPage(page, i);
+        REQUIRE(dm.flushPage(page));
+      }
+
+      REQUIRE(dm.sync());
+
+      // Moved after the sync, the next map has to be written when the manager closes.
+      std::mt19937 rng(5);
+      std::vector<uint8_t> noise(3000);
+      for (auto &byte : noise) {
+        byte = static_cast<uint8_t>(rng());
+      }
+
+      const std::string value = "row value 100";
+      DataPage page(0);
+      REQUIRE(page.insertRecord(3, value.c_str(), value.size() + 1, 1));
+      REQUIRE(page.insertRecord(4, noise.data(), noise.size(), 1));
+      REQUIRE(dm.flushPage(page));
+      REQUIRE(dm.deallocatePage(count - 1));
+    }
+
+    for (auto mode : {AccessMode::READ_WRITE, AccessMode::READ_ONLY}) {
+      // Existing databases keep their format, whatever is asked for.
+      DiskManager dm(testPath, false, mode, Compression::NONE);
+      REQUIRE(dm.compression() == Compression::DEFLATE);
+
+      checkPage(dm.fetchPage(0).get(), 100);
+      for (uint32_t i = 1; i < count - 1; i++) {
+        checkPage(dm.fetchPage(i).get(), i);
+        checkPage(dm.fetchPageAsync(i).get().get(), i);
+      }
+
+      const uint32_t pageIds[] = {0, 1, 2, 7};
+      REQUIRE(dm.prefetch(pageIds) == 4);
+    }
+
+    // Freed space is found again, rewriting every page doesn't grow the file.
+    const auto size = fs::file_size(testPath);
+    {
+      DiskManager dm(testPath, false);
+      for (uint32_t i = 0; i < count - 1; i++) {
+        DataPage page(i);
+        fillPage(page, i + 1);
+        REQUIRE(dm.flushPage(page));
+      }
+    }
+
+    REQUIRE(fs::file_size(testPath) <= size + Page::PAGE_SIZE);
+  }
+
+  for (const auto &path : {testPath, plainPath}) {
+    if (fs::exists(path)) {
+      fs::remove(path);
+    }
+  }
+}
+
+TEST_CASE("DiskManager segments", "[storage][disk_manager]") {
+  const fs::path testPath = "test.db";
+  const std::vector<fs::path> directories = {"test_segments_a", "test_segments_b"};
+  const SegmentLayout layout{16, directories};
+
+  if (fs::exists(testPath)) {
+    fs::remove(testPath);
+  }
+
+  for (const auto &directory : directories) {
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+  }
+
+  // Every page knows its own ID, so a page read from the wrong place is caught.
+  auto writePage = [](DiskManager &dm, uint32_t pageId) {
+    DataPage page(pageId);
+    REQUIRE(page.insertRecord(pageId, &pageId, sizeof(pageId), 1));
+    return dm.flushPage(page);
+  };
+
+  auto checkPage = [](DiskManager &dm, uint32_t pageId) {
+    auto page = dm.fetchPage(pageId);
+    REQUIRE(page != nullptr);
+    REQUIRE(page->id() == pageId);
+    REQUIRE(static_cast<DataPage *>(page.get())->getSlotId(pageId));
+  };
+
+  const uint32_t count = 40;
+
+  SECTION("pages are spread over the segments") {
+    DiskManager dm(testPath, true, AccessMode::READ_WRITE, Compression::NONE, layout);
+    REQUIRE(dm.isSegmented());
+    REQUIRE(dm.queueCount() == 2);
+
+    for (uint32_t i = 0; i < count; i++) {
+      REQUIRE(dm.allocatePage() == i);
+      REQUIRE(writePage(dm, i));
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+      checkPage(dm, i);
+    }
+
+    // The file only holds the header, the segments hold the pages.
+    REQUIRE(fs::file_size(testPath) == sizeof(DatabaseHeader));
+    REQUIRE(fs::file_size(directories[0] / "test.db.0") == 16 * Page::PAGE_SIZE);
+    REQUIRE(fs::file_size(directories[1] / "test.db.1") == 16 * Page::PAGE_SIZE);
+    REQUIRE(fs::file_size(directories[0] / "test.db.2") == 8 * Page::PAGE_SIZE);
+    REQUIRE(dm.fileSize() == sizeof(DatabaseHeader) + count * Page::PAGE_SIZE);
+  }
+
+  SECTION("asynchronous and batched I/O cross segments") {
+    DiskManager dm(testPath, true, AccessMode::READ_WRITE, Compression::NONE, layout);
+
+    std::vector<std::unique_ptr<DataPage>> pages;
+    std::vector<const Page *> batch;
+    for (uint32_t i = 0; i < count; i++) {
+      pages.push_back(std::make_unique<DataPage>(dm.allocatePage()));
+      batch.push_back(pages.back().get());
+    }
+
+    // Runs are split where a segment ends.
+    REQUIRE(dm.writePages(std::span(batch).subspan(0, 20)));
+    for (auto &future : dm.flushPagesAsync(std::span(batch).subspan(20))) {
+      REQUIRE(future.get());
+    }
+
+    std::vector<uint32_t> pageIds(count);
+    for (uint32_t i = 0; i < count; i++) {
+      pageIds[i] = i;
+    }
+
+    auto futures = dm.fetchPagesAsync(pageIds);
+    for (uint32_t i = 0; i < count; i++) {
+      auto page = futures[i].get();
+      REQUIRE(page != nullptr);
+      REQUIRE(page->id() == i);
+    }
+
+    REQUIRE(dm.prefetch(pageIds) == count);
+  }
+
+  SECTION("reopening keeps the segment size") {
+    {
+      DiskManager dm(testPath, true, AccessMode::READ_WRITE, Compression::NONE, layout);
+      for (uint32_t i = 0; i < count; i++) {
+        REQUIRE(writePage(dm, dm.allocatePage()));
+      }
+
+      REQUIRE(dm.deallocatePage(20));
+    }
+
+    // The layout's size is ignored, the header's wins.
+    DiskManager dm(testPath, false, AccessMode::READ_WRITE, Compression::NONE, {64, directories});
+    REQUIRE(dm.isSegmented());
+    REQUIRE(dm.pageCount() > count);
+    REQUIRE(dm.freePageCount() == 1);
+
+    for (uint32_t i = 0; i < count; i++) {
+      if (i != 20) {
+        checkPage(dm, i);
+      }
+    }
+  }
+
+  SECTION("unwritten page read") {
+    DiskManager dm(testPath, true, AccessMode::READ_WRITE, Compression::NONE, layout);
+    uint32_t pageId = dm.allocatePage();
+
+    // The segment is reserved but the page never written, so the read still hits EOF.
+    REQUIRE(dm.fetchPage(pageId) == nullptr);
+    REQUIRE_FALSE(dm.fetchPageAsync(pageId).get());
+  }
+
+  SECTION("unsupported layouts") {
+    REQUIRE_THROWS_AS(
+        DiskManager(testPath, true, AccessMode::READ_WRITE, Compression::NONE, {4, directories}),
+        std::runtime_error
+    );
+
+    REQUIRE_THROWS_AS(
+        DiskManager(testPath, true, AccessMode::READ_WRITE, Compression::DEFLATE, layout),
+        std::runtime_error
+    );
+
+    { DiskManager dm(testPath, true, AccessMode::READ_WRITE, Compression::NONE, layout); }
+    REQUIRE_THROWS_AS(
+        DiskManager(testPath, false, AccessMode::READ_ONLY, Compression::NONE, layout),
+        std::runtime_error
+    );
+  }
+
+  // Cleanup.
+  fs::remove(testPath);
+  for (const auto &directory : directories) {
+    fs::remove_all(directory);
+  }
+}
@@ -0,0 +1,109 @@
+/**
+ * @file tests/pulsedb/storage/test_extent_allocator.cpp
+ * @brief Test cases for ExtentAllocator class.
+ */
+
+#include "pulsedb/storage/extent_allocator.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <thread>
+#include <vector>
+
+using namespace pulse::storage;
+namespace fs = std::filesystem;
+
+TEST_CASE("ExtentAllocator runs", "[storage][extent_allocator]") {
+  const fs::path testPath = "test.db";
+  if (fs::exists(testPath)) {
+    fs::remove(testPath);
+  }
+
+  SECTION("pages are handed out in order") {
+    DiskManager dm(testPath, true);
+    ExtentAllocator extents(dm, 16);
+    REQUIRE(extents.remaining() == 0);
+
+    for (uint32_t i = 0; i < 16; i++) {
+      REQUIRE(extents.allocate() == i);
+    }
+
+    // Single pages taken in between don't break up the next run.
+    REQUIRE(dm.allocatePage() == 16);
+    REQUIRE(extents.allocate() == 17);
+    REQUIRE(extents.remaining() == 15);
+  }
+
+  SECTION("free pages don't break up a run") {
+    DiskManager dm(testPath, true);
+    for (uint32_t i = 0; i < 4; i++) {
+      REQUIRE(dm.allocatePage() == i);
+    }
+
+    REQUIRE(dm.deallocatePage(1));
+    REQUIRE(dm.deallocatePage(3));
+
+    ExtentAllocator extents(dm, 8);
+    REQUIRE(extents.allocate() == 4);
+    REQUIRE(extents.allocate() == 5);
+  }
+
+  SECTION("pages left over go back on the free list") {
+    DiskManager dm(testPath, true);
+    {
+      ExtentAllocator extents(dm, 16);
+      REQUIRE(extents.allocate() == 0);
+      REQUIRE(extents.allocate() == 1);
+
+      extents.release();
+      REQUIRE(extents.remaining() == 0);
+      REQUIRE(dm.freePageCount() == 14);
+
+      // A new run is taken once the old one is released, and released when the allocator goes.
+      REQUIRE(extents.allocate() == 16);
+    }
+
+    REQUIRE(dm.freePageCount() == 29);
+    REQUIRE(dm.allocatePage() != 0);
+  }
+
+  SECTION("threads share the run") {
+    DiskManager dm(testPath, true);
+    ExtentAllocator extents(dm, 64);
+
+    std::vector<std::vector<uint32_t>> allocated(4);
+    std::vector<std::thread> threads;
+    for (auto &pageIds : allocated) {
+      threads.emplace_back([&extents, &pageIds] {
+        for (int i = 0; i < 64; i++) {
+          pageIds.push_back(extents.allocate());
+        }
+      });
+    }
+
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    // Every page of the four runs is handed out exactly once.
+    std::vector<bool> seen(256, false);
+    for (const auto &pageIds : allocated) {
+      for (uint32_t pageId : pageIds) {
+        REQUIRE(pageId < 256);
+        REQUIRE_FALSE(seen[pageId]);
+        seen[pageId] = true;
+      }
+    }
+
+    REQUIRE(dm.pageCount() == 256);
+  }
+
+  SECTION("read-only databases have no runs to hand out") {
+    { DiskManager dm(testPath, true); }
+
+    DiskManager dm(testPath, false, AccessMode::READ_ONLY);
+    ExtentAllocator extents(dm);
+    REQUIRE(extents.allocate() == DiskManager::INVALID_PAGE_ID);
+  }
+
+  // Cleanup.
+  fs::remove(testPath);
+}
@@ -0,0 +1,155 @@
+/**
+ * @file tests/pulsedb/storage/test_free_space_map.cpp
+ * @brief Test cases for FreeSpaceMap class.
+ */
+
+#include "pulsedb/storage/free_space_map.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+using namespace pulse::storage;
+
+namespace {
+  constexpr uint32_t STEP = FreeSpaceMap::CATEGORY_SIZE;
+} // namespace
+
+TEST_CASE("FreeSpaceMap finding room", "[storage][free_space_map]") {
+  FreeSpaceMap map;
+  map.grow(10);
+  REQUIRE(map.pageCount() == 10);
+  REQUIRE_FALSE(map.find(1));
+  REQUIRE_FALSE(map.isDirty());
+
+  SECTION("categories round the free space down") {
+    REQUIRE(FreeSpaceMap::categoryOf(0) == 0);
+    REQUIRE(FreeSpaceMap::categoryOf(STEP - 1) == 0);
+    REQUIRE(FreeSpaceMap::categoryOf(STEP) == 1);
+    REQUIRE(FreeSpaceMap::categoryOf(Page::PAGE_SIZE) == FreeSpaceMap::FREE - 1);
+
+    map.update(3, 10 * STEP + 1);
+    REQUIRE(map.category(3) == 10);
+    REQUIRE(map.category(42) == 0);
+    REQUIRE(map.isDirty());
+  }
+
+  SECTION("the fullest page that fits is found") {
+    map.update(1, 50 * STEP);
+    map.update(2, 20 * STEP);
+    map.update(3, 5 * STEP);
+
+    REQUIRE(map.find(1) == 3u);
+    REQUIRE(map.find(5 * STEP) == 3u);
+    REQUIRE(map.find(5 * STEP + 1) == 2u);
+    REQUIRE(map.find(21 * STEP) == 1u);
+    REQUIRE_FALSE(map.find(51 * STEP));
+  }
+
+  SECTION("pages that filled up are skipped") {
+    map.update(1, 50 * STEP);
+    map.update(2, 20 * STEP);
+    REQUIRE(map.find(10 * STEP) == 2u);
+
+    map.update(2, 0);
+    REQUIRE(map.find(10 * STEP) == 1u);
+
+    map.update(2, 20 * STEP);
+    map.update(2, 30 * STEP);
+    map.update(2, 20 * STEP);
+    REQUIRE(map.find(10 * STEP) == 2u);
+  }
+
+  SECTION("pages out of range are ignored") {
+    map.update(10, 50 * STEP);
+    REQUIRE_FALSE(map.find(1));
+    REQUIRE_FALSE(map.release(10));
+  }
+}
+
+TEST_CASE("FreeSpaceMap free list", "[storage][free_space_map]") {
+  FreeSpaceMap map;
+  map.grow(10);
+  REQUIRE_FALSE(map.takeFree());
+
+  SECTION("released pages are taken again") {
+    map.update(4, 50 * STEP);
+    REQUIRE(map.release(4));
+    REQUIRE(map.release(7));
+    REQUIRE_FALSE(map.release(7));
+    REQUIRE(map.freeCount() == 2);
+
+    // Free pages don't take records, whatever room they had.
+    REQUIRE_FALSE(map.find(STEP));
+
+    const auto first = map.takeFree();
+    const auto second = map.takeFree();
+    REQUIRE(first);
+    REQUIRE(second);
+    REQUIRE(*first != *second);
+    REQUIRE_FALSE(map.takeFree());
+    REQUIRE(map.freeCount() == 0);
+    REQUIRE(map.category(4) == 0);
+  }
+
+  SECTION("written pages leave the free list") {
+    REQUIRE(map.release(4));
+    map.update(4, 0);
+
+    REQUIRE(map.freeCount() == 0);
+    REQUIRE_FALSE(map.takeFree());
+  }
+
+  SECTION("stale entries don't pile up") {
+    for (int i = 0; i < 100000; i++) {
+      REQUIRE(map.release(i % 10));
+      map.update(i % 10, (i % 200 + 1) * STEP);
+    }
+
+    REQUIRE(map.freeCount() == 0);
+    REQUIRE(map.find(STEP));
+  }
+}
+
+TEST_CASE("FreeSpaceMap serialization", "[storage][free_space_map]") {
+  FreeSpaceMap map;
+  const uint32_t count = FreeSpacePage::CAPACITY + 100;
+  map.grow(count);
+  REQUIRE(map.mapPagesNeeded() == 2);
+
+  map.update(1, 30 * STEP);
+  map.update(count - 1, 60 * STEP);
+  REQUIRE(map.release(2));
+  REQUIRE(map.release(FreeSpacePage::CAPACITY));
+
+  map.addMapPage(count);
+  map.addMapPage(count + 1);
+  REQUIRE(map.pageCount() == count + 2);
+
+  const auto pages = map.serialize();
+  REQUIRE(pages.size() == 2);
+  REQUIRE(pages[0]->type() == PageType::SPECIAL);
+  REQUIRE(pages[0]->firstPage() == 0);
+  REQUIRE(pages[0]->nextPage() == count + 1);
+  REQUIRE(pages[0]->itemCount() == FreeSpacePage::CAPACITY);
+  REQUIRE(pages[1]->firstPage() == FreeSpacePage::CAPACITY);
+  REQUIRE(pages[1]->nextPage() == FreeSpacePage::END);
+  REQUIRE(pages[1]->itemCount() == 102);
+
+  SECTION("loading restores the categories and the free list") {
+    FreeSpaceMap loaded;
+    REQUIRE(loaded.load(*pages[0]));
+    REQUIRE(loaded.load(*pages[1]));
+    REQUIRE_FALSE(loaded.isDirty());
+
+    REQUIRE(loaded.pageCount() == count + 2);
+    REQUIRE(loaded.mapPages() == map.mapPages());
+    REQUIRE(loaded.freeCount() == 2);
+    REQUIRE(loaded.find(40 * STEP) == count - 1);
+    REQUIRE(loaded.find(STEP) == 1u);
+    REQUIRE(loaded.category(count) == 0);
+  }
+
+  SECTION("pages out of order are rejected") {
+    FreeSpaceMap loaded;
+    REQUIRE_FALSE(loaded.load(*pages[1]));
+    REQUIRE(loaded.pageCount() == 0);
+  }
+}
@@ -5,6 +5,8 @@
 
 #include "pulsedb/storage/index_page.hpp"
 #include <catch2/catch_test_macros.hpp>
+#include <random>
+#include <vector>
 
 using namespace pulse::storage;
 
@@ -123,9 +125,9 @@ TEST_CASE("IndexPage node operations", "[storage][index_page]") {
     IndexPage page1(1, true);
     page1.setNextPage(3);
 
-    // Fill first page to capacity.
+    // Fill first page to capacity, keys stay narrow enough for any page size.
     for (uint64_t i = 0; i < IndexPage::maxEntries(); ++i) {
-      REQUIRE(page1.insertKey(i * 10, i * 100));
+      REQUIRE(page1.insertKey(i * 2, i * 100));
     }
 
     // Verify split operation.
@@ -168,7 +170,7 @@ TEST_CASE("IndexPage node operations", "[storage][index_page]") {
     // Fill to minimum entries.
     const auto minEntries = IndexPage::minEntries();
     for (uint64_t i = 0; i <= minEntries; ++i) {
-      REQUIRE(page.insertKey(i * 10, i * 100));
+      REQUIRE(page.insertKey(i * 2, i * 100));
     }
 
     // Verify minimum occupancy state.
@@ -177,7 +179,7 @@ TEST_CASE("IndexPage node operations", "[storage][index_page]") {
 
     // Fill to maximum entries.
     for (uint64_t i = minEntries + 1; i < IndexPage::maxEntries(); ++i) {
-      REQUIRE(page.insertKey(i * 10, i * 100));
+      REQUIRE(page.insertKey(i * 2, i * 100));
     }
 
     // Verify maximum occupancy state.
@@ -207,19 +209,190 @@ TEST_CASE("IndexPage sibling management", "[storage][index_page]") {
 
 TEST_CASE("IndexPage capacity management", "[storage][index_page]") {
   SECTION("entry limits") {
-    REQUIRE(IndexPage::maxEntries() == IndexPage::MAX_FREE_SPACE / sizeof(IndexEntry));
-    REQUIRE(IndexPage::minEntries() == IndexPage::maxEntries() / 2);
+    const size_t wide = IndexPage::ENTRY_SPACE / (sizeof(uint64_t) + sizeof(uint32_t));
+    REQUIRE(IndexPage::minCapacity() == wide);
+    REQUIRE(IndexPage::maxEntries() == 2 * (wide - 1));
+    REQUIRE(IndexPage::minEntries() == wide / 2);
+
+    IndexPage page(1, true);
+    REQUIRE(page.capacity() == IndexPage::maxEntries());
   }
 
   SECTION("overflow handling") {
     IndexPage page(1, true);
 
-    // Fill to maximum capacity.
+    // Fill to maximum capacity, keys stay narrow enough for any page size.
     for (uint64_t i = 0; i < IndexPage::maxEntries(); ++i) {
-      REQUIRE(page.insertKey(i * 10, i * 100));
+      REQUIRE(page.insertKey(i * 2, i * 100));
     }
 
     // Verify overflow handling.
     REQUIRE_FALSE(page.insertKey(999, 9999));
   }
 }
+
+TEST_CASE("IndexPage key packing", "[storage][index_page]") {
+  const uint64_t epoch = 1'700'000'000'000'000;
+
+  SECTION("nearby keys pack narrow") {
+    IndexPage page(1, true);
+
+    // Microsecond timestamps pointing into a run of data pages.
+    for (uint64_t i = 0; !page.isOverflow(); i++) {
+      REQUIRE(page.insertKey(epoch + i * 50, 5000 + static_cast<uint32_t>(i / 20)));
+    }
+
+    REQUIRE(page.itemCount() == IndexPage::maxEntries());
+
+    for (uint64_t i = 0; i < page.itemCount(); i++) {
+      REQUIRE(page.keyAt(i) == epoch + i * 50);
+      REQUIRE(page.lookup(epoch + i * 50) == 5000 + i / 20);
+      REQUIRE_FALSE(page.lookup(epoch + i * 50 + 1));
+    }
+
+    REQUIRE_FALSE(page.lookup(0));
+    REQUIRE_FALSE(page.lookup(UINT64_MAX));
+  }
+
+  SECTION("spread keys fall back to full width") {
+    IndexPage page(1, true);
+    const std::vector<uint64_t> keys = {0, 1, UINT64_MAX / 2, UINT64_MAX / 2 + 1, UINT64_MAX};
+
+    for (uint64_t key : keys) {
+      REQUIRE(page.insertKey(key, static_cast<uint32_t>(key)));
+    }
+
+    REQUIRE(page.capacity() == IndexPage::minCapacity());
+    for (size_t i = 0; i < keys.size(); i++) {
+      REQUIRE(page.keyAt(i) == keys[i]);
+      REQUIRE(page.lookup(keys[i]) == static_cast<uint32_t>(keys[i]));
+    }
+
+    REQUIRE(page.getRange(1, UINT64_MAX / 2 + 1).size() == 3);
+  }
+
+  SECTION("entries below the base re-encode the page") {
+    IndexPage page(1, false, 1);
+    for (uint64_t key = 1000; key < 1100; key++) {
+      REQUIRE(page.insertKey(key, static_cast<uint32_t>(key)));
+    }
+
+    REQUIRE(page.insertKey(5, 7));
+    REQUIRE(page.insertKey(500, UINT32_MAX));
+
+    REQUIRE(page.itemCount() == 102);
+    REQUIRE(page.keyAt(0) == 5);
+    REQUIRE(page.pageIdAt(1) == UINT32_MAX);
+
+    // Internal nodes route keys between entries to the child on the left.
+    REQUIRE(page.lookup(6) == 7u);
+    REQUIRE(page.lookup(999) == UINT32_MAX);
+    REQUIRE(page.lookup(1050) == 1050u);
+    REQUIRE(page.lookup(9999) == 1099u);
+
+    REQUIRE(page.removeKey(5));
+    REQUIRE(page.lookup(500) == UINT32_MAX);
+  }
+
+  SECTION("a full narrow page splits before taking a wide entry") {
+    IndexPage page1(1, true);
+    const uint64_t count = IndexPage::minCapacity() + 100;
+    for (uint64_t i = 0; i < count; i++) {
+      REQUIRE(page1.insertKey(epoch + i, 10));
+    }
+
+    REQUIRE_FALSE(page1.hasRoomFor(UINT64_MAX, UINT32_MAX));
+    REQUIRE(page1.capacityWith(UINT64_MAX, UINT32_MAX) == IndexPage::minCapacity());
+    REQUIRE_FALSE(page1.insertKey(UINT64_MAX, UINT32_MAX));
+    REQUIRE(page1.itemCount() == count);
+
+    IndexPage page2(2, true);
+    const uint64_t separator = page1.split(page2);
+    REQUIRE(separator == page2.keyAt(0));
+
+    // Either half takes any entry.
+    REQUIRE(page1.insertKey(0, UINT32_MAX));
+    REQUIRE(page2.insertKey(UINT64_MAX, UINT32_MAX));
+    REQUIRE(page1.lookup(epoch) == 10u);
+    REQUIRE(page2.lookup(separator) == 10u);
+    REQUIRE(page2.lookup(UINT64_MAX) == UINT32_MAX);
+  }
+
+  SECTION("merges check the combined encoding") {
+    IndexPage page1(1, true);
+    IndexPage page2(2, true);
+    const uint64_t count = IndexPage::minCapacity();
+    for (uint64_t i = 0; i < count; i++) {
+      REQUIRE(page1.insertKey(i, 1));
+      REQUIRE(page2.insertKey(epoch + i, 2));
+    }
+
+    // Narrow apart, the two need full-width keys together.
+    REQUIRE_FALSE(page1.canMerge(page2));
+    REQUIRE_FALSE(page1.merge(page2));
+    REQUIRE(page1.itemCount() == count);
+    REQUIRE(page1.lookup(count - 1) == 1u);
+
+    IndexPage page3(3, true);
+    for (uint64_t i = count; i < count + 200; i++) {
+      REQUIRE(page3.insertKey(i, 3));
+    }
+
+    REQUIRE(page1.canMerge(page3));
+    REQUIRE(page1.merge(page3));
+    REQUIRE(page1.itemCount() == count + 200);
+    REQUIRE(page1.lookup(count + 150) == 3u);
+  }
+}
+
+TEST_CASE("IndexPage probes of raw bytes", "[storage][index_page]") {
+  alignas(64) uint8_t buffer[Page::PAGE_SIZE]{};
+
+  SECTION("probes agree with lookups") {
+    IndexPage leaf(buffer, 4, true);
+    for (uint64_t key = 100; key < 300; key += 2) {
+      REQUIRE(leaf.insertKey(key, static_cast<uint32_t>(key * 3)));
+    }
+
+    for (uint64_t key = 90; key < 310; key++) {
+      auto probe = IndexPage::probe(buffer, key);
+      REQUIRE(probe);
+      REQUIRE(probe->pageId == 4);
+      REQUIRE(probe->isLeaf);
+      REQUIRE(probe->value == leaf.lookup(key));
+    }
+  }
+
+  SECTION("internal nodes route to a child") {
+    IndexPage node(buffer, 5, false, 1);
+    REQUIRE(node.insertKey(0, 10));
+    REQUIRE(node.insertKey(50, 11));
+    REQUIRE(node.insertKey(100, 12));
+
+    for (uint64_t key : {0, 49, 50, 99, 100, 1000}) {
+      auto probe = IndexPage::probe(buffer, key);
+      REQUIRE(probe);
+      REQUIRE_FALSE(probe->isLeaf);
+      REQUIRE(probe->level == 1);
+      REQUIRE(probe->value == node.lookup(key));
+    }
+  }
+
+  SECTION("bytes that aren't an index page") {
+    REQUIRE_FALSE(IndexPage::probe(buffer, 1));
+
+    IndexPage node(buffer, 6, false, 1);
+    REQUIRE_FALSE(IndexPage::probe(buffer, 1));
+
+    // Torn pages either fail the checks or give some answer, never a read out of bounds.
+    std::mt19937 rng(11);
+    for (int round = 0; round < 100; round++) {
+      IndexPage page(buffer, 7, true);
+      for (size_t i = Page::HEADER_SIZE; i < Page::PAGE_SIZE; i++) {
+        buffer[i] = static_cast<uint8_t>(rng());
+      }
+
+      (void)IndexPage::probe(buffer, rng());
+    }
+  }
+}
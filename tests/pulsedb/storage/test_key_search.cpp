@@ -0,0 +1,115 @@
+/**
+ * @file tests/pulsedb/storage/test_key_search.cpp
+ * @brief Test cases for the vectorized key search.
+ */
+
+#include "pulsedb/storage/key_search.hpp"
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace pulse::storage;
+
+namespace {
+  /**
+   * @brief The index std::lower_bound finds for a key.
+   */
+  template <typename Key> size_t expectedBound(const std::vector<Key> &keys, Key key) {
+    return std::lower_bound(keys.begin(), keys.end(), key) - keys.begin();
+  }
+
+  /**
+   * @brief Check the search of keys of one width against std::lower_bound.
+   */
+  template <typename Key> void checkWidth(std::mt19937_64 &rng) {
+    const uint64_t top = Key(~Key{0});
+
+    // Sizes around the vector widths and linear thresholds, up to a full packed page.
+    for (size_t size : {1, 3, 8, 15, 16, 17, 31, 32, 33, 64, 65, 127, 128, 129, 300, 672, 1012}) {
+      std::vector<Key> keys(size);
+      for (auto &key : keys) {
+        key = static_cast<Key>(rng() % (top + 1));
+      }
+
+      std::sort(keys.begin(), keys.end());
+      for (size_t i = 0; i < 500; i++) {
+        const auto key = static_cast<Key>(rng() % (top + 1));
+        REQUIRE(lowerBound(keys.data(), keys.size(), key) == expectedBound(keys, key));
+      }
+
+      for (Key key : {Key{0}, Key(top / 2), Key(top / 2 + 1), Key(top)}) {
+        REQUIRE(lowerBound(keys.data(), keys.size(), key) == expectedBound(keys, key));
+      }
+    }
+  }
+} // namespace
+
+TEST_CASE("Key search backend", "[storage][key_search]") {
+  const std::string backend = keySearchBackend();
+  REQUIRE((backend == "avx2" || backend == "neon" || backend == "scalar"));
+}
+
+TEST_CASE("Key search edge cases", "[storage][key_search]") {
+  SECTION("empty array") {
+    REQUIRE(lowerBound(nullptr, 0, 42) == 0);
+  }
+
+  SECTION("all keys less or greater") {
+    std::vector<uint64_t> keys(40);
+    for (size_t i = 0; i < keys.size(); i++) {
+      keys[i] = 100 + i;
+    }
+
+    REQUIRE(lowerBound(keys.data(), keys.size(), 0) == 0);
+    REQUIRE(lowerBound(keys.data(), keys.size(), 100) == 0);
+    REQUIRE(lowerBound(keys.data(), keys.size(), 1000) == keys.size());
+  }
+
+  SECTION("duplicates find the first") {
+    const std::vector<uint64_t> keys = {1, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 9};
+    REQUIRE(lowerBound(keys.data(), keys.size(), 3) == 1);
+    REQUIRE(lowerBound(keys.data(), keys.size(), 4) == keys.size() - 1);
+  }
+
+  SECTION("keys with the top bit set compare unsigned") {
+    const std::vector<uint64_t> keys = {0, 1, UINT64_MAX / 2, UINT64_MAX / 2 + 1, UINT64_MAX};
+    for (uint64_t key : {uint64_t{0}, UINT64_MAX / 2, UINT64_MAX / 2 + 1, UINT64_MAX - 1}) {
+      REQUIRE(lowerBound(keys.data(), keys.size(), key) == expectedBound(keys, key));
+    }
+  }
+}
+
+TEST_CASE("Key search matches std::lower_bound", "[storage][key_search]") {
+  std::mt19937_64 rng(21);
+
+  // Sizes around the vector width and the linear threshold, up to a full index page.
+  for (size_t size : {1, 2, 3, 4, 5, 7, 8, 15, 16, 17, 31, 32, 33, 100, 289, 290}) {
+    std::vector<uint64_t> keys(size);
+    for (auto &key : keys) {
+      key = rng() % (size * 4);
+    }
+
+    std::sort(keys.begin(), keys.end());
+    for (uint64_t key = 0; key <= size * 4; key++) {
+      REQUIRE(lowerBound(keys.data(), keys.size(), key) == expectedBound(keys, key));
+    }
+  }
+}
+
+TEST_CASE("Key search over packed widths", "[storage][key_search]") {
+  std::mt19937_64 rng(34);
+
+  SECTION("8-bit keys") {
+    checkWidth<uint8_t>(rng);
+  }
+
+  SECTION("16-bit keys") {
+    checkWidth<uint16_t>(rng);
+  }
+
+  SECTION("32-bit keys") {
+    checkWidth<uint32_t>(rng);
+  }
+}
@@ -63,7 +63,9 @@ TEST_CASE("Page space managment", "[storage][page]") {
   }
 
   SECTION("size constants") {
-    REQUIRE(Page::PAGE_SIZE == 4096);
+    REQUIRE(Page::PAGE_SIZE == PULSEDB_PAGE_SIZE);
+    REQUIRE(Page::PAGE_SIZE >= 4096);
+    REQUIRE(static_cast<PageOffset>(Page::PAGE_SIZE) == Page::PAGE_SIZE);
     REQUIRE(Page::HEADER_SIZE == sizeof(PageHeader));
     REQUIRE(Page::MAX_FREE_SPACE == Page::PAGE_SIZE - Page::HEADER_SIZE);
   }
@@ -81,3 +83,42 @@ TEST_CASE("Page type handling", "[storage][page]") {
     REQUIRE(invalidPage.type() == PageType::INVALID);
   }
 }
+
+TEST_CASE("Page views over external buffers", "[storage][page]") {
+  alignas(64) uint8_t buffer[Page::PAGE_SIZE];
+
+  SECTION("building a page in place") {
+    Page page(buffer, 7, PageType::DATA);
+    REQUIRE_FALSE(page.ownsBuffer());
+    REQUIRE(page.id() == 7);
+    REQUIRE(page.type() == PageType::DATA);
+    REQUIRE(page.freeSpace() == Page::MAX_FREE_SPACE);
+  }
+
+  SECTION("viewing a page already in the buffer") {
+    {
+      Page page(buffer, 7, PageType::INDEX);
+      page.setLsn(42);
+    }
+
+    // The buffer outlives the first view untouched.
+    Page view(VIEW, buffer);
+    REQUIRE_FALSE(view.ownsBuffer());
+    REQUIRE(view.id() == 7);
+    REQUIRE(view.type() == PageType::INDEX);
+    REQUIRE(view.lsn() == 42);
+  }
+
+  SECTION("moving keeps ownership with the buffer") {
+    Page owned(1, PageType::DATA);
+    REQUIRE(owned.ownsBuffer());
+
+    Page view(buffer, 2, PageType::DATA);
+    view = std::move(owned);
+    REQUIRE(view.ownsBuffer());
+    REQUIRE(view.id() == 1);
+
+    Page moved(std::move(view));
+    REQUIRE(moved.ownsBuffer());
+  }
+}
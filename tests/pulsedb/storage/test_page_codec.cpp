@@ -0,0 +1,68 @@
+/**
+ * @file tests/pulsedb/storage/test_page_codec.cpp
+ * @brief Test cases for the page codecs.
+ */
+
+#include "pulsedb/storage/page.hpp"
+#include "pulsedb/storage/page_codec.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace pulse::storage;
+
+TEST_CASE("Page codec availability", "[storage][page_codec]") {
+  REQUIRE(isCompressionAvailable(Compression::NONE));
+  REQUIRE(std::string(compressionName(Compression::NONE)) == "none");
+  REQUIRE(std::string(compressionName(Compression::DEFLATE)) == "deflate");
+  REQUIRE(std::string(compressionName(static_cast<Compression>(42))) == "unknown");
+
+  std::vector<uint8_t> page(Page::PAGE_SIZE, 0);
+  std::vector<uint8_t> out(Page::PAGE_SIZE);
+  REQUIRE_FALSE(compressPage(Compression::NONE, page.data(), out.data(), out.size()));
+}
+
+TEST_CASE("Page codec round trips", "[storage][page_codec]") {
+  if (!isCompressionAvailable(Compression::DEFLATE)) {
+    WARN("deflate is not compiled in");
+    return;
+  }
+
+  std::vector<uint8_t> page(Page::PAGE_SIZE, 0);
+  std::vector<uint8_t> out(Page::PAGE_SIZE);
+  std::vector<uint8_t> back(Page::PAGE_SIZE);
+
+  SECTION("repetitive pages shrink") {
+    for (size_t i = 0; i < page.size(); i++) {
+      page[i] = static_cast<uint8_t>(i % 16);
+    }
+
+    auto length = compressPage(Compression::DEFLATE, page.data(), out.data(), out.size());
+    REQUIRE(length);
+    REQUIRE(*length < Page::PAGE_SIZE / 4);
+
+    REQUIRE(decompressPage(Compression::DEFLATE, out.data(), *length, back.data()));
+    REQUIRE(back == page);
+  }
+
+  SECTION("random pages don't fit a smaller buffer") {
+    std::mt19937 rng(7);
+    for (auto &byte : page) {
+      byte = static_cast<uint8_t>(rng());
+    }
+
+    REQUIRE_FALSE(compressPage(Compression::DEFLATE, page.data(), out.data(), 1024));
+  }
+
+  SECTION("corrupt input is rejected") {
+    auto length = compressPage(Compression::DEFLATE, page.data(), out.data(), out.size());
+    REQUIRE(length);
+
+    REQUIRE_FALSE(decompressPage(Compression::DEFLATE, out.data(), *length / 2, back.data()));
+
+    std::memset(out.data(), 0xFF, *length);
+    REQUIRE_FALSE(decompressPage(Compression::DEFLATE, out.data(), *length, back.data()));
+  }
+}
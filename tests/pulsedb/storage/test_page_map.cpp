@@ -0,0 +1,114 @@
+/**
+ * @file tests/pulsedb/storage/test_page_map.cpp
+ * @brief Test cases for PageMap class.
+ */
+
+#include "pulsedb/storage/page_map.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+using namespace pulse::storage;
+
+namespace {
+  constexpr uint64_t SECTOR = PageMap::SECTOR_SIZE;
+} // namespace
+
+TEST_CASE("PageMap placing pages", "[storage][page_map]") {
+  PageMap map;
+  REQUIRE_FALSE(map.find(0));
+  REQUIRE(map.end() == SECTOR);
+  REQUIRE_FALSE(map.isDirty());
+
+  SECTION("slots are whole sectors after the header") {
+    auto first = map.place(0, 100);
+    REQUIRE(first.offset == SECTOR);
+    REQUIRE(first.capacity == SECTOR);
+
+    auto second = map.place(5, SECTOR + 1);
+    REQUIRE(second.offset == 2 * SECTOR);
+    REQUIRE(second.capacity == 2 * SECTOR);
+
+    REQUIRE(map.find(5)->offset == second.offset);
+    REQUIRE_FALSE(map.find(3));
+    REQUIRE(map.end() == 4 * SECTOR);
+    REQUIRE(map.isDirty());
+  }
+
+  SECTION("pages that still fit stay in place") {
+    const auto slot = map.place(0, 3 * SECTOR);
+    map.commit();
+
+    REQUIRE(map.place(0, SECTOR).offset == slot.offset);
+    REQUIRE(map.place(0, 3 * SECTOR).offset == slot.offset);
+    REQUIRE_FALSE(map.isDirty());
+  }
+
+  SECTION("uncompressed pages need a page slot of their own") {
+    const auto compressed = map.place(0, Page::PAGE_SIZE - SECTOR);
+    const auto raw = map.place(0, Page::PAGE_SIZE);
+    REQUIRE(raw.offset != compressed.offset);
+    REQUIRE(raw.capacity == Page::PAGE_SIZE);
+
+    REQUIRE(map.place(0, 100).offset != raw.offset);
+  }
+
+  SECTION("given up slots are reused after a commit") {
+    const auto slot = map.place(0, SECTOR);
+    REQUIRE(map.place(0, 2 * SECTOR).offset != slot.offset);
+
+    // Not yet, the map on disk may still point at the old slot.
+    REQUIRE(map.place(1, SECTOR).offset != slot.offset);
+    REQUIRE(map.freeBytes() == 0);
+
+    map.release(1);
+    map.commit();
+    REQUIRE(map.freeBytes() == 2 * SECTOR);
+    REQUIRE(map.place(2, SECTOR).offset < map.end());
+    REQUIRE(map.place(3, SECTOR).offset < map.end());
+    REQUIRE(map.freeBytes() == 0);
+    REQUIRE_FALSE(map.find(1));
+  }
+
+  SECTION("larger free slots are split") {
+    static_cast<void>(map.place(0, Page::PAGE_SIZE));
+    map.release(0);
+    map.commit();
+
+    const auto first = map.place(1, SECTOR);
+    REQUIRE(first.offset == SECTOR);
+    REQUIRE(map.freeBytes() == Page::PAGE_SIZE - SECTOR);
+
+    REQUIRE(map.place(2, 2 * SECTOR).offset == 2 * SECTOR);
+    REQUIRE(map.end() == SECTOR + Page::PAGE_SIZE);
+  }
+}
+
+TEST_CASE("PageMap serialization", "[storage][page_map]") {
+  PageMap map;
+  static_cast<void>(map.place(0, SECTOR));
+  static_cast<void>(map.place(1, Page::PAGE_SIZE));
+  static_cast<void>(map.place(2, 2 * SECTOR));
+  map.release(1);
+  map.commit();
+
+  const auto bytes = map.serialize();
+  REQUIRE(bytes.size() == 3 * sizeof(PageLocation));
+  const uint64_t mapOffset = map.reserve(bytes.size());
+
+  SECTION("gaps between used slots are free after loading") {
+    PageMap loaded;
+    REQUIRE(loaded.load(bytes, mapOffset));
+    REQUIRE_FALSE(loaded.isDirty());
+
+    REQUIRE(loaded.find(0)->offset == map.find(0)->offset);
+    REQUIRE(loaded.find(2)->capacity == 2 * SECTOR);
+    REQUIRE_FALSE(loaded.find(1));
+
+    REQUIRE(loaded.freeBytes() == Page::PAGE_SIZE);
+    REQUIRE(loaded.end() == map.end());
+  }
+
+  SECTION("malformed maps are rejected") {
+    PageMap loaded;
+    REQUIRE_FALSE(loaded.load(std::span(bytes).first(5), mapOffset));
+  }
+}
@@ -0,0 +1,69 @@
+/**
+ * @file tests/pulsedb/storage/test_segment_set.cpp
+ * @brief Test cases for SegmentSet class.
+ */
+
+#include "pulsedb/storage/segment_set.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+using namespace pulse::storage;
+namespace fs = std::filesystem;
+
+TEST_CASE("SegmentSet layout", "[storage][segment_set]") {
+  const fs::path database = "test_segments.db";
+  const std::vector<fs::path> directories = {"test_segments_a", "test_segments_b"};
+  for (const auto &directory : directories) {
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+  }
+
+  SECTION("segments smaller than the minimum") {
+    REQUIRE_THROWS_AS(
+        SegmentSet(database, SegmentSet::MIN_PAGES - 1, directories, true), std::runtime_error
+    );
+  }
+
+  SECTION("pages map to segments and offsets") {
+    SegmentSet segments(database, 16, directories, true);
+    REQUIRE(segments.deviceCount() == 2);
+
+    auto first = segments.locate(3);
+    auto second = segments.locate(16 + 5);
+    REQUIRE(first);
+    REQUIRE(second);
+    REQUIRE(first->offset == 3 * Page::PAGE_SIZE);
+    REQUIRE(second->offset == 5 * Page::PAGE_SIZE);
+    REQUIRE(first->fd != second->fd);
+
+    // Segments are opened once, dealt to the directories in turn and start out empty.
+    REQUIRE(segments.locate(0)->fd == first->fd);
+    REQUIRE(segments.pathOf(0) == directories[0] / "test_segments.db.0");
+    REQUIRE(segments.pathOf(1) == directories[1] / "test_segments.db.1");
+    REQUIRE(fs::exists(segments.pathOf(1)));
+    REQUIRE(segments.size() == 0);
+    REQUIRE(segments.sync());
+  }
+
+  SECTION("devices and adjacency") {
+    SegmentSet segments(database, 16, directories, true);
+    REQUIRE(segments.deviceOf(0) == 0);
+    REQUIRE(segments.deviceOf(15) == 0);
+    REQUIRE(segments.deviceOf(16) == 1);
+    REQUIRE(segments.deviceOf(32) == 0);
+
+    REQUIRE(segments.adjacent(3, 4));
+    REQUIRE_FALSE(segments.adjacent(15, 16));
+    REQUIRE_FALSE(segments.adjacent(3, 5));
+  }
+
+  SECTION("segments go next to the database without directories") {
+    SegmentSet segments(database, 16, {}, true);
+    REQUIRE(segments.deviceCount() == 1);
+    REQUIRE(segments.pathOf(2) == fs::path("test_segments.db.2"));
+  }
+
+  // Cleanup.
+  for (const auto &directory : directories) {
+    fs::remove_all(directory);
+  }
+}
@@ -0,0 +1,180 @@
+/**
+ * @file tests/pulsedb/utils/test_async_log.cpp
+ * @brief Test cases for AsyncLog class.
+ */
+
+#include "pulsedb/utils/async_log.hpp"
+#include "pulsedb/utils/logger.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace pulse::utils;
+
+namespace {
+  /**
+   * @brief Count the lines of a stream's output that contain a string.
+   */
+  size_t countLines(const std::string &output, const std::string &needle) {
+    std::istringstream lines(output);
+    size_t count = 0;
+
+    for (std::string line; std::getline(lines, line);) {
+      count += line.find(needle) != std::string::npos ? 1 : 0;
+    }
+
+    return count;
+  }
+} // namespace
+
+TEST_CASE("AsyncLog", "[utils][async_log]") {
+  if (!logging::isCompiled(LogLevel::ERROR)) {
+    WARN("logging is compiled out");
+    return;
+  }
+
+  std::ostringstream output;
+  const Logger logger("async-test", static_cast<std::ostream &>(output));
+
+  // Every level passes the runtime filter at its bottom.
+  logging::setLevel(LogLevel::DEBUG);
+  logging::setAsync(true);
+
+  SECTION("messages arrive in order after a flush") {
+    for (int i = 0; i < 1000; i++) {
+      logger.error("message {}", i);
+    }
+
+    logging::flush();
+    const std::string text = output.str();
+    REQUIRE(countLines(text, "[async-test:ERROR]") == 1000);
+    REQUIRE(text.find("message 0\n") < text.find("message 1\n"));
+    REQUIRE(text.find("message 998\n") < text.find("message 999\n"));
+  }
+
+  SECTION("messages of exited threads aren't lost") {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+      threads.emplace_back([&logger, t] {
+        for (int i = 0; i < 500; i++) {
+          logger.error("thread {} message {}", t, i);
+        }
+      });
+    }
+
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    logging::flush();
+    REQUIRE(countLines(output.str(), "[async-test:ERROR]") == 2000);
+  }
+
+  SECTION("long messages are cut") {
+    logger.error("{}", std::string(2 * LogEntry::MESSAGE_SIZE, 'x'));
+    logging::flush();
+
+    REQUIRE(output.str().find(std::string(LogEntry::MESSAGE_SIZE, 'x')) != std::string::npos);
+    REQUIRE(output.str().find(std::string(LogEntry::MESSAGE_SIZE + 1, 'x')) == std::string::npos);
+  }
+
+  SECTION("turning it off writes what's queued") {
+    logger.error("queued");
+    logging::setAsync(false);
+    REQUIRE(countLines(output.str(), "queued") == 1);
+
+    logger.error("direct");
+    REQUIRE(countLines(output.str(), "direct") == 1);
+  }
+
+  logging::setAsync(false);
+  logging::setLevel(LogLevel::NONE);
+}
+
+TEST_CASE("Logger compile time levels", "[utils][async_log]") {
+  STATIC_REQUIRE_FALSE(logging::isCompiled(LogLevel::NONE));
+  STATIC_REQUIRE(logging::severity(LogLevel::DEBUG) < logging::severity(LogLevel::INFO));
+  STATIC_REQUIRE(logging::severity(LogLevel::WARN) < logging::severity(LogLevel::ERROR));
+
+  // Levels below the compiled level aren't even formatted.
+  std::ostringstream output;
+  const Logger logger("compiled-test", static_cast<std::ostream &>(output));
+  logging::setLevel(LogLevel::DEBUG);
+
+  logger.debug("debug");
+  logger.error("error");
+  logging::setLevel(LogLevel::NONE);
+
+  const std::string text = output.str();
+  REQUIRE(countLines(text, "debug") == (logging::isCompiled(LogLevel::DEBUG) ? 1 : 0));
+  REQUIRE(countLines(text, "error") == (logging::isCompiled(LogLevel::ERROR) ? 1 : 0));
+}
+
+TEST_CASE("Logger runtime levels", "[utils][async_log]") {
+  std::ostringstream output;
+  const Logger logger("runtime-test", static_cast<std::ostream &>(output));
+
+  // A level shows itself and everything more severe.
+  logging::setLevel(LogLevel::INFO);
+  logger.debug("debug");
+  logger.info("info");
+  logger.warn("warn");
+  logger.error("error");
+
+  logging::setLevel(LogLevel::NONE);
+  logger.error("hidden");
+
+  const std::string text = output.str();
+  REQUIRE(countLines(text, "debug") == 0);
+  REQUIRE(countLines(text, "info") == (logging::isCompiled(LogLevel::INFO) ? 1 : 0));
+  REQUIRE(countLines(text, "warn") == (logging::isCompiled(LogLevel::WARN) ? 1 : 0));
+  REQUIRE(countLines(text, "error") == (logging::isCompiled(LogLevel::ERROR) ? 1 : 0));
+  REQUIRE(countLines(text, "hidden") == 0);
+}
+
+TEST_CASE("Logger macros skip the arguments of hidden levels", "[utils][async_log]") {
+  std::ostringstream output;
+  const Logger logger("macro-test", static_cast<std::ostream &>(output));
+  int evaluated = 0;
+
+  auto argument = [&evaluated] {
+    evaluated++;
+    return std::string("argument");
+  };
+
+  SECTION("filtered at runtime") {
+    logging::setLevel(LogLevel::ERROR);
+    PULSEDB_LOG_DEBUG(logger, "{}", argument());
+    PULSEDB_LOG_INFO(logger, "{}", argument());
+    PULSEDB_LOG_WARN(logger, "{}", argument());
+    REQUIRE(evaluated == 0);
+
+    PULSEDB_LOG_ERROR(logger, "{}", argument());
+    REQUIRE(evaluated == (logging::isCompiled(LogLevel::ERROR) ? 1 : 0));
+  }
+
+  SECTION("compiled out") {
+    // Nothing is filtered at runtime, so only the compiled level stops a call.
+    logging::setLevel(LogLevel::DEBUG);
+    PULSEDB_LOG_DEBUG(logger, "{}", argument());
+    PULSEDB_LOG_INFO(logger, "{}", argument());
+    PULSEDB_LOG_WARN(logger, "{}", argument());
+    PULSEDB_LOG_ERROR(logger, "{}", argument());
+
+    int compiled = 0;
+    for (LogLevel level : {LogLevel::DEBUG, LogLevel::INFO, LogLevel::WARN, LogLevel::ERROR}) {
+      compiled += logging::isCompiled(level) ? 1 : 0;
+    }
+
+    REQUIRE(evaluated == compiled);
+    REQUIRE(countLines(output.str(), "argument") == static_cast<size_t>(compiled));
+
+    // NONE is never compiled in, whatever PULSEDB_LOG_LEVEL is.
+    PULSEDB_LOG_AT(NONE, error, logger, "{}", argument());
+    REQUIRE(evaluated == compiled);
+  }
+
+  logging::setLevel(LogLevel::NONE);
+}
@@ -0,0 +1,129 @@
+/**
+ * @file tests/pulsedb/utils/test_metrics.cpp
+ * @brief Test cases for Counter, Histogram and PrometheusWriter classes.
+ */
+
+#include "pulsedb/utils/metrics.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace pulse::utils;
+
+TEST_CASE("Counter", "[utils][metrics]") {
+  Counter counter;
+  REQUIRE(counter.value() == 0);
+
+  SECTION("adds up") {
+    counter.add();
+    counter.add(41);
+    REQUIRE(counter.value() == 42);
+  }
+
+  SECTION("threads add to it concurrently") {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 2 * static_cast<int>(STRIPE_COUNT); t++) {
+      threads.emplace_back([&counter] {
+        for (int i = 0; i < 1000; i++) {
+          counter.add();
+        }
+      });
+    }
+
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    REQUIRE(counter.value() == 2 * STRIPE_COUNT * 1000);
+  }
+
+  SECTION("stripes sit on lines of their own") {
+    STATIC_REQUIRE(sizeof(Counter) == STRIPE_COUNT * CACHE_LINE_SIZE);
+    REQUIRE(threadStripe() < STRIPE_COUNT);
+    REQUIRE(threadStripe() == threadStripe());
+  }
+}
+
+TEST_CASE("Histogram", "[utils][metrics]") {
+  Histogram histogram;
+
+  SECTION("empty") {
+    const HistogramSnapshot snapshot = histogram.snapshot();
+    REQUIRE(snapshot.count == 0);
+    REQUIRE(snapshot.percentile(0.5) == 0);
+  }
+
+  SECTION("values land in power of two buckets") {
+    histogram.record(0);
+    histogram.record(1);
+    histogram.record(1000);
+    histogram.record(1024);
+
+    const HistogramSnapshot snapshot = histogram.snapshot();
+    REQUIRE(snapshot.count == 4);
+    REQUIRE(snapshot.sum == 2025);
+    REQUIRE(snapshot.buckets[0] == 1);
+    REQUIRE(snapshot.buckets[1] == 1);
+    REQUIRE(snapshot.buckets[10] == 1);
+    REQUIRE(snapshot.buckets[11] == 1);
+  }
+
+  SECTION("huge values go to the last bucket") {
+    histogram.record(UINT64_C(1) << 40);
+    REQUIRE(histogram.snapshot().buckets[HistogramSnapshot::BUCKETS - 1] == 1);
+  }
+
+  SECTION("percentiles are bucket bounds") {
+    for (uint64_t i = 0; i < 90; i++) {
+      histogram.record(100);
+    }
+
+    for (uint64_t i = 0; i < 10; i++) {
+      histogram.record(100000);
+    }
+
+    const HistogramSnapshot snapshot = histogram.snapshot();
+    REQUIRE(snapshot.percentile(0.5) == 128);
+    REQUIRE(snapshot.percentile(0.99) == 131072);
+  }
+
+  SECTION("snapshots merge") {
+    histogram.record(10);
+    HistogramSnapshot snapshot = histogram.snapshot();
+    snapshot.merge(histogram.snapshot());
+
+    REQUIRE(snapshot.count == 2);
+    REQUIRE(snapshot.sum == 20);
+    REQUIRE(snapshot.buckets[4] == 2);
+  }
+}
+
+TEST_CASE("PrometheusWriter", "[utils][metrics]") {
+  PrometheusWriter writer("test");
+
+  SECTION("counters and gauges") {
+    writer.counter("hits_total", "Hits.", 7);
+    writer.gauge("ratio", "A ratio.", 0.5);
+
+    const std::string &text = writer.text();
+    REQUIRE(text.find("# HELP test_hits_total Hits.\n") != std::string::npos);
+    REQUIRE(text.find("# TYPE test_hits_total counter\n") != std::string::npos);
+    REQUIRE(text.find("test_hits_total 7\n") != std::string::npos);
+    REQUIRE(text.find("# TYPE test_ratio gauge\n") != std::string::npos);
+    REQUIRE(text.find("test_ratio 0.5\n") != std::string::npos);
+  }
+
+  SECTION("histogram buckets are cumulative") {
+    Histogram histogram;
+    histogram.record(1);
+    histogram.record(3);
+    writer.histogram("latency_seconds", "Latency.", histogram.snapshot());
+
+    const std::string &text = writer.text();
+    REQUIRE(text.find("# TYPE test_latency_seconds histogram\n") != std::string::npos);
+    REQUIRE(text.find("test_latency_seconds_bucket{le=\"4e-09\"} 2\n") != std::string::npos);
+    REQUIRE(text.find("test_latency_seconds_bucket{le=\"+Inf\"} 2\n") != std::string::npos);
+    REQUIRE(text.find("test_latency_seconds_count 2\n") != std::string::npos);
+  }
+}
@@ -0,0 +1,45 @@
+/**
+ * @file tests/pulsedb/utils/test_numa.cpp
+ * @brief Test cases for the NUMA topology functions.
+ */
+
+#include "pulsedb/utils/numa.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <sys/mman.h>
+#include <thread>
+
+using namespace pulse::utils;
+
+TEST_CASE("NUMA topology", "[utils][numa]") {
+  SECTION("every machine has a node") {
+    REQUIRE(numaNodes() >= 1);
+    REQUIRE(currentNode() < numaNodes());
+  }
+
+  SECTION("threads can be told their node") {
+    size_t seen = 0;
+    std::thread thread([&seen] {
+      setThreadNode(3);
+      seen = currentNode();
+    });
+
+    thread.join();
+    REQUIRE(seen == 3);
+
+    // Only the thread that was told is affected.
+    REQUIRE(currentNode() < numaNodes());
+  }
+
+  SECTION("binding memory") {
+    const size_t length = 1 << 20;
+    void *memory =
+        ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    REQUIRE(memory != MAP_FAILED);
+
+    // A single node has nothing to bind to, and there's never a node past the last one.
+    REQUIRE(bindToNode(memory, length, 0) == (numaNodes() > 1));
+    REQUIRE_FALSE(bindToNode(memory, length, numaNodes()));
+
+    ::munmap(memory, length);
+  }
+}
@@ -0,0 +1,532 @@
+/**
+ * @file tests/pulsedb/wal/test_log_manager.cpp
+ * @brief Test cases for LogManager class.
+ */
+
+#include "pulsedb/cache/buffer_pool.hpp"
+#include "pulsedb/storage/data_page.hpp"
+#include "pulsedb/wal/log_manager.hpp"
+#include <algorithm>
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+using namespace pulse::storage;
+using namespace pulse::wal;
+namespace fs = std::filesystem;
+
+namespace {
+  const fs::path walDbPath = "test_wal.db";
+  const fs::path walPath = "test_wal.db.wal";
+
+  void cleanupWal() {
+    for (const auto &path : {walDbPath, walPath}) {
+      if (fs::exists(path)) {
+        fs::remove(path);
+      }
+    }
+  }
+
+  /**
+   * @brief Read the string stored under a key of a data page.
+   */
+  std::string readValue(DiskManager &dm, uint32_t pageId, uint32_t key) {
+    auto page = dm.fetchPage(pageId);
+    if (!page || page->type() != PageType::DATA) {
+      return {};
+    }
+
+    auto *dataPage = static_cast<DataPage *>(page.get());
+    auto slotId = dataPage->getSlotId(key);
+    if (!slotId) {
+      return {};
+    }
+
+    auto record = dataPage->getRecord(*slotId);
+    return record ? static_cast<const char *>(record->first) : std::string();
+  }
+} // namespace
+
+TEST_CASE("LogManager construction", "[wal][log_manager]") {
+  cleanupWal();
+
+  SECTION("new log creation") {
+    LogManager log(walPath, true);
+    REQUIRE(fs::exists(walPath));
+    REQUIRE(log.currentLsn() == LogManager::FILE_HEADER_SIZE);
+    REQUIRE(log.flushedLsn() == LogManager::FILE_HEADER_SIZE);
+  }
+
+  SECTION("opening non-existent log") {
+    REQUIRE_THROWS_AS(LogManager(walPath, false), std::runtime_error);
+  }
+
+  SECTION("opening an invalid log") {
+    std::ofstream(walPath) << "not a log file at all";
+    REQUIRE_THROWS_AS(LogManager(walPath, false), std::runtime_error);
+  }
+
+  SECTION("reopening continues after the last record") {
+    uint64_t end;
+
+    {
+      LogManager log(walPath, true);
+      DataPage page(0);
+      log.logPage(page);
+      end = log.commit();
+      REQUIRE(end > 0);
+    }
+
+    LogManager log(walPath, false);
+    REQUIRE(log.currentLsn() == end);
+    REQUIRE(log.flushedLsn() == end);
+  }
+
+  cleanupWal();
+}
+
+TEST_CASE("LogManager appending", "[wal][log_manager]") {
+  cleanupWal();
+  LogManager log(walPath, true);
+  DataPage page(3);
+
+  SECTION("lsns increase and stamp the page") {
+    const uint64_t first = log.logPage(page);
+    REQUIRE(first == LogManager::FILE_HEADER_SIZE + LogManager::RECORD_HEADER_SIZE +
+                         Page::PAGE_SIZE);
+    REQUIRE(page.lsn() == first);
+
+    const uint64_t second = log.logUpdate(page, Page::HEADER_SIZE, 16);
+    REQUIRE(second == first + LogManager::RECORD_HEADER_SIZE + 16);
+    REQUIRE(page.lsn() == second);
+    REQUIRE(log.currentLsn() == second);
+  }
+
+  SECTION("records stay buffered until flushed") {
+    const uint64_t lsn = log.logPage(page);
+    REQUIRE(log.flushedLsn() < lsn);
+
+    REQUIRE(log.flush(lsn));
+    REQUIRE(log.flushedLsn() == lsn);
+    REQUIRE(log.syncCount() == 1);
+
+    // Already durable, no further sync.
+    REQUIRE(log.flush(lsn));
+    REQUIRE(log.syncCount() == 1);
+  }
+
+  SECTION("one sync covers every buffered record") {
+    uint64_t lsn = 0;
+    for (int i = 0; i < 32; i++) {
+      lsn = log.logUpdate(page, Page::HEADER_SIZE, 8);
+    }
+
+    REQUIRE(log.flush(lsn));
+    REQUIRE(log.syncCount() == 1);
+  }
+
+  SECTION("invalid update range") {
+    REQUIRE(log.logUpdate(page, 0, 0) == 0);
+    REQUIRE(log.logUpdate(page, Page::PAGE_SIZE - 4, 8) == 0);
+    REQUIRE(log.currentLsn() == LogManager::FILE_HEADER_SIZE);
+  }
+
+  cleanupWal();
+}
+
+TEST_CASE("LogManager group commit", "[wal][log_manager]") {
+  cleanupWal();
+  LogManager log(walPath, true);
+
+  const int threadCount = 8;
+  const int commitsPerThread = 50;
+
+  std::vector<std::thread> threads;
+  std::atomic<int> failures{0};
+
+  for (int t = 0; t < threadCount; t++) {
+    threads.emplace_back([&, t] {
+      DataPage page(t);
+      for (int i = 0; i < commitsPerThread; i++) {
+        const uint64_t lsn = log.logUpdate(page, Page::HEADER_SIZE, 32);
+        const uint64_t commitLsn = log.commit();
+
+        // The commit is durable, and so is everything logged before it.
+        if (commitLsn <= lsn || log.flushedLsn() < commitLsn) {
+          failures++;
+        }
+      }
+    });
+  }
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  REQUIRE(failures == 0);
+  REQUIRE(log.flushedLsn() == log.currentLsn());
+  REQUIRE(log.syncCount() <= threadCount * commitsPerThread);
+}
+
+TEST_CASE("LogManager recovery", "[wal][log_manager]") {
+  cleanupWal();
+
+  SECTION("redo pages that never reached the disk") {
+    uint32_t pageId;
+
+    {
+      DiskManager dm(walDbPath, true);
+      LogManager log(walPath, true);
+
+      pageId = dm.allocatePage();
+      DataPage page(pageId);
+      REQUIRE(page.insertRecord(7, "logged", 7, 1));
+
+      log.logPage(page);
+      REQUIRE(log.commit() > 0);
+
+      // Crash before the page is written.
+    }
+
+    DiskManager dm(walDbPath, false);
+    LogManager log(walPath, false);
+    REQUIRE(readValue(dm, pageId, 7).empty());
+
+    REQUIRE(log.recover(dm) == 1);
+    REQUIRE(readValue(dm, pageId, 7) == "logged");
+    REQUIRE(dm.lastLsn() == log.currentLsn());
+
+    // Redo is idempotent.
+    REQUIRE(log.recover(dm) == 0);
+    REQUIRE(readValue(dm, pageId, 7) == "logged");
+  }
+
+  SECTION("redo allocates pages the header lost") {
+    {
+      DiskManager dm(walDbPath, true);
+      LogManager log(walPath, true);
+
+      DataPage page(4);
+      REQUIRE(page.insertRecord(1, "late", 5, 1));
+      log.logPage(page);
+      log.commit();
+    }
+
+    DiskManager dm(walDbPath, false);
+    LogManager log(walPath, false);
+    REQUIRE(dm.pageCount() == 0);
+
+    // The sync after redo adds the free space map after the recovered pages.
+    REQUIRE(log.recover(dm) == 1);
+    REQUIRE(dm.pageCount() == 6);
+    REQUIRE(readValue(dm, 4, 1) == "late");
+  }
+
+  SECTION("updates apply on top of the written page") {
+    uint32_t pageId;
+
+    {
+      DiskManager dm(walDbPath, true);
+      LogManager log(walPath, true);
+
+      pageId = dm.allocatePage();
+      DataPage page(pageId);
+      REQUIRE(page.insertRecord(1, "first", 6, 1));
+      log.logPage(page);
+      log.commit();
+      dm.flushPage(page);
+
+      // Only the update is lost.
+      REQUIRE(page.insertRecord(2, "second", 7, 1));
+      log.logUpdate(page, 0, Page::PAGE_SIZE);
+      log.commit();
+    }
+
+    DiskManager dm(walDbPath, false);
+    LogManager log(walPath, false);
+
+    REQUIRE(log.recover(dm) == 1);
+    REQUIRE(dm.fetchPage(pageId)->itemCount() == 2);
+    REQUIRE(readValue(dm, pageId, 1) == "first");
+    REQUIRE(readValue(dm, pageId, 2) == "second");
+  }
+
+  SECTION("pages newer than the log are left alone") {
+    uint32_t pageId;
+
+    {
+      DiskManager dm(walDbPath, true);
+      LogManager log(walPath, true);
+
+      pageId = dm.allocatePage();
+      DataPage page(pageId);
+      REQUIRE(page.insertRecord(1, "old", 4, 1));
+      log.logPage(page);
+
+      REQUIRE(page.insertRecord(2, "new", 4, 1));
+      log.logPage(page);
+      log.commit();
+      dm.flushPage(page);
+    }
+
+    DiskManager dm(walDbPath, false);
+    LogManager log(walPath, false);
+
+    REQUIRE(log.recover(dm) == 0);
+    REQUIRE(readValue(dm, pageId, 2) == "new");
+  }
+
+  SECTION("torn tail is cut off") {
+    uint64_t end;
+
+    {
+      LogManager log(walPath, true);
+      DataPage page(0);
+      log.logPage(page);
+      end = log.commit();
+    }
+
+    // A record that only partly reached the disk.
+    {
+      std::ofstream out(walPath, std::ios::binary | std::ios::app);
+      const char torn[LogManager::RECORD_HEADER_SIZE + 3] = {42};
+      out.write(torn, sizeof(torn));
+    }
+
+    REQUIRE(fs::file_size(walPath) > end);
+
+    LogManager log(walPath, false);
+    REQUIRE(log.currentLsn() == end);
+    REQUIRE(fs::file_size(walPath) == end);
+  }
+
+  SECTION("corrupt record ends the log") {
+    uint64_t first;
+
+    {
+      LogManager log(walPath, true);
+      DataPage page(0);
+      first = log.logPage(page);
+      log.logPage(page);
+      log.commit();
+    }
+
+    // Flip a payload byte of the second record.
+    {
+      std::fstream file(walPath, std::ios::binary | std::ios::in | std::ios::out);
+      file.seekp(static_cast<std::streamoff>(first + LogManager::RECORD_HEADER_SIZE + 100));
+      file.put('\x7f');
+    }
+
+    LogManager log(walPath, false);
+    REQUIRE(log.currentLsn() == first);
+  }
+
+  cleanupWal();
+}
+
+TEST_CASE("LogManager checkpoints", "[wal][log_manager]") {
+  cleanupWal();
+
+  SECTION("reopening starts at the last checkpoint") {
+    uint64_t lsn;
+    uint64_t end;
+
+    {
+      LogManager log(walPath, true);
+      REQUIRE(log.checkpointLsn() == 0);
+
+      DataPage page(0);
+      log.logPage(page);
+      lsn = log.checkpoint(log.currentLsn(), {});
+      REQUIRE(lsn == log.currentLsn());
+      REQUIRE(log.flushedLsn() == lsn);
+      REQUIRE(log.checkpointLsn() == lsn);
+
+      log.logPage(page);
+      end = log.commit();
+    }
+
+    LogManager log(walPath, false);
+    REQUIRE(log.checkpointLsn() == lsn);
+    REQUIRE(log.currentLsn() == end);
+  }
+
+  SECTION("redo skips pages the checkpoint found clean") {
+    uint32_t cleanId;
+    uint32_t dirtyId;
+    uint32_t laterId;
+
+    {
+      DiskManager dm(walDbPath, true);
+      LogManager log(walPath, true);
+
+      cleanId = dm.allocatePage();
+      dirtyId = dm.allocatePage();
+      laterId = dm.allocatePage();
+
+      // Claimed clean by the checkpoint, so its unwritten record is never looked at.
+      DataPage clean(cleanId);
+      REQUIRE(clean.insertRecord(1, "skipped", 8, 1));
+      log.logPage(clean);
+
+      const uint64_t recLsn = log.currentLsn();
+      DataPage dirty(dirtyId);
+      REQUIRE(dirty.insertRecord(1, "dirty", 6, 1));
+      log.logPage(dirty);
+
+      const DirtyPage table[] = {{dirtyId, recLsn}};
+      REQUIRE(log.checkpoint(log.currentLsn(), table) > 0);
+
+      DataPage later(laterId);
+      REQUIRE(later.insertRecord(1, "later", 6, 1));
+      log.logPage(later);
+      log.commit();
+    }
+
+    DiskManager dm(walDbPath, false);
+    LogManager log(walPath, false);
+
+    REQUIRE(log.recover(dm) == 2);
+    REQUIRE(readValue(dm, cleanId, 1).empty());
+    REQUIRE(readValue(dm, dirtyId, 1) == "dirty");
+    REQUIRE(readValue(dm, laterId, 1) == "later");
+  }
+
+  SECTION("parallel redo replays every page in order") {
+    static constexpr uint32_t PAGES = 64;
+
+    {
+      DiskManager dm(walDbPath, true);
+      LogManager log(walPath, true);
+
+      for (uint32_t i = 0; i < PAGES; i++) {
+        DataPage page(dm.allocatePage());
+        REQUIRE(page.insertRecord(1, "first", 6, 1));
+        log.logPage(page);
+      }
+
+      // A second change to every page, which only lands if redo keeps each page's order.
+      for (uint32_t i = 0; i < PAGES; i++) {
+        DataPage page(i);
+        REQUIRE(page.insertRecord(1, "second", 7, 1));
+        log.logPage(page);
+      }
+
+      log.commit();
+    }
+
+    DiskManager dm(walDbPath, false);
+    LogManager log(walPath, false);
+
+    REQUIRE(log.recover(dm, 8) == 2 * PAGES);
+    for (uint32_t i = 0; i < PAGES; i++) {
+      REQUIRE(readValue(dm, i, 1) == "second");
+    }
+
+    REQUIRE(log.recover(dm, 8) == 0);
+  }
+
+  cleanupWal();
+}
+
+TEST_CASE("BufferPool checkpoints", "[wal][log_manager][buffer_pool]") {
+  cleanupWal();
+  DiskManager dm(walDbPath, true);
+  LogManager log(walPath, true);
+
+  pulse::cache::BufferPool pool(dm, 4);
+
+  SECTION("no checkpoint without a log") {
+    REQUIRE(pool.checkpoint() == 0);
+  }
+
+  SECTION("dirty and pinned pages are listed") {
+    pool.attachLog(&log);
+
+    auto *flushed = pool.createPage(PageType::DATA);
+    auto *dirty = pool.createPage(PageType::DATA);
+    auto *pinned = pool.createPage(PageType::DATA);
+    REQUIRE(flushed != nullptr);
+    REQUIRE(dirty != nullptr);
+    REQUIRE(pinned != nullptr);
+
+    const uint32_t flushedId = flushed->id();
+    const uint32_t dirtyId = dirty->id();
+    const uint32_t pinnedId = pinned->id();
+
+    const uint64_t recLsn = log.currentLsn();
+    log.logPage(*dirty);
+    pool.unpinPage(dirtyId, true);
+
+    log.logPage(*flushed);
+    pool.unpinPage(flushedId, true);
+    REQUIRE(pool.flushPage(flushedId));
+    REQUIRE(pool.flushPage(pinnedId));
+
+    auto pages = pool.dirtyPages();
+    std::sort(pages.begin(), pages.end(), [](const DirtyPage &a, const DirtyPage &b) {
+      return a.pageId < b.pageId;
+    });
+
+    REQUIRE(pages.size() == 2);
+    REQUIRE(pages[0].pageId == dirtyId);
+    REQUIRE(pages[0].recLsn == recLsn);
+    REQUIRE(pages[1].pageId == pinnedId);
+    REQUIRE(pages[1].recLsn >= log.flushedLsn());
+
+    const uint64_t lsn = pool.checkpoint();
+    REQUIRE(lsn > 0);
+    REQUIRE(log.checkpointLsn() == lsn);
+    REQUIRE(log.flushedLsn() == lsn);
+    pool.unpinPage(pinnedId, false);
+  }
+
+  cleanupWal();
+}
+
+TEST_CASE("BufferPool writes the log ahead of pages", "[wal][log_manager][buffer_pool]") {
+  cleanupWal();
+  DiskManager dm(walDbPath, true);
+  LogManager log(walPath, true);
+
+  pulse::cache::BufferPool pool(dm, 2);
+  pool.attachLog(&log);
+
+  auto *page = pool.createPage(PageType::DATA);
+  REQUIRE(page != nullptr);
+
+  const uint64_t lsn = log.logPage(*page);
+  REQUIRE(log.flushedLsn() < lsn);
+
+  SECTION("flushing a page") {
+    pool.unpinPage(page->id(), true);
+    REQUIRE(pool.flushPage(page->id()));
+    REQUIRE(log.flushedLsn() >= lsn);
+  }
+
+  SECTION("evicting a page") {
+    const uint32_t pageId = page->id();
+    pool.unpinPage(pageId, true);
+
+    // Fill the pool so the logged page has to go.
+    for (int i = 0; i < 2; i++) {
+      auto *other = pool.createPage(PageType::DATA);
+      REQUIRE(other != nullptr);
+      pool.unpinPage(other->id(), false);
+    }
+
+    REQUIRE(log.flushedLsn() >= lsn);
+    REQUIRE(dm.fetchPage(pageId)->lsn() == lsn);
+  }
+
+  SECTION("writing back a page") {
+    pool.unpinPage(page->id(), true);
+    REQUIRE(pool.writeBack(8, 8, true) == 1);
+    REQUIRE(log.flushedLsn() >= lsn);
+  }
+
+  cleanupWal();
+}